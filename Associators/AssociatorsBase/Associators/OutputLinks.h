@@ -35,6 +35,8 @@ public:
       auto link = m_links.linkMgr()->link( linkID );
       r.linkMgr()->addLink( link->path(), link->object() );
     }
+    // the links are complete: copy them in compressed form for the readers
+    r.freeze();
     return r;
   }
 
@@ -76,7 +76,8 @@ CaloFutureRawToDigits::CaloFutureRawToDigits( const std::string& name, ISvcLocat
           name, pSvcLocator,
           {KeyValue{"RawEventLocation", Gaudi::Functional::concat_alternatives( LHCb::RawEventLocation::Calo,
                                                                                 LHCb::RawEventLocation::Default )},
-           KeyValue{"DetectorLocation", LHCb::CaloFutureAlgUtils::DeCaloFutureLocation( name.substr( 6, 4 ) )}},
+           KeyValue{"DetectorLocation", LHCb::CaloFutureAlgUtils::DeCaloFutureLocation( name.substr( 6, 4 ) )},
+           KeyValue{"ReadoutMap", "AlgorithmSpecific-" + name + "-ReadoutMap"}},
           {KeyValue{"OutputAdcData", LHCb::CaloFutureAlgUtils::CaloFutureAdcLocation( name.substr( 6, 4 ) )},
            KeyValue{"OutputDigitData", LHCb::CaloFutureAlgUtils::CaloFutureDigitLocation( name.substr( 6, 4 ) )},
            KeyValue{"OutputReadoutStatusData",
@@ -95,6 +96,9 @@ StatusCode CaloFutureRawToDigits::initialize() {
     return StatusCode::FAILURE;
   }
   info() << "Zsup method " << m_zsupMethod.value() << " Threshold " << m_zsupThreshold.value() << endmsg;
+
+  // flat readout map, rebuilt when the calorimeter conditions change
+  addConditionDerivation<CaloFutureReadoutMap( const DeCalorimeter& )>( inputLocation<1>(), inputLocation<2>() );
   return sc;
 }
 
@@ -102,7 +106,7 @@ StatusCode CaloFutureRawToDigits::initialize() {
 // Main execution
 //=============================================================================
 std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus> CaloFutureRawToDigits::
-                                                                         operator()( const LHCb::RawEvent& rawEvt, const DeCalorimeter& calo ) const {
+operator()( const LHCb::RawEvent& rawEvt, const DeCalorimeter& calo, const CaloFutureReadoutMap& map ) const {
 
   // ------------------------------------
   // --- Get RawBank AND ReadoutStatus
@@ -166,9 +170,12 @@ std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus> CaloFut
   // ------------------------------------
   // ---  Decode the rawBanks
   // ------------------------------------
-  std::vector<LHCb::CaloAdc> dataVec;
+  // one buffer per thread, shared by the Ecal and Hcal decoders, which do not run concurrently on it
+  static thread_local DecodedADCs adcs;
+  adcs.reset( map.nCells() );
 
-  std::vector<int> readSources;
+  auto& readSources = sources; // reuse the buffer
+  readSources.clear();
   for ( const auto& bank : banks ) {
     int sourceID = bank->sourceID();
 
@@ -181,11 +188,10 @@ std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus> CaloFut
     readSources.push_back( sourceID );
 
     //--- decode the rawbanks
-    std::vector<LHCb::CaloAdc> dataVecDec =
-        decode_<Decode::Cell>( *bank, status, calo ); // false is to get data, not pinData
-    dataVec.insert( dataVec.end(), dataVecDec.begin(), dataVecDec.end() );
+    const auto nRead = adcs.read.size();
+    decode_( *bank, status, calo, map, adcs );
 
-    if ( dataVecDec.empty() && msgLevel( MSG::DEBUG ) )
+    if ( adcs.read.size() == nRead && msgLevel( MSG::DEBUG ) )
       debug() << "Error when decoding bank " << sourceID << " -> incomplete data - May be corrupted" << endmsg;
   }
 
@@ -194,57 +200,45 @@ std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus> CaloFut
   // ------------------------------------
   LHCb::CaloAdcs   newAdcs;
   LHCb::CaloDigits newDigits;
-  if ( msgLevel( MSG::DEBUG ) ) debug() << "Processing " << dataVec.size() << " Digits." << endmsg;
-
-  enum { DefaultFlag, NeighbourFlag, SeedFlag };
-  std::vector<int> caloFlags( calo.numberOfCells(), DefaultFlag );
+  if ( msgLevel( MSG::DEBUG ) ) debug() << "Processing " << adcs.read.size() << " Digits." << endmsg;
 
   // == Apply the threshold. If 2DZsup, tag also the neighbours
-  for ( const auto& anAdc : dataVec ) {
-    LHCb::CaloCellID id     = anAdc.cellID();
-    int              index  = calo.cellIndex( id );
-    int              digAdc = anAdc.adc();
+  const bool zsup2D = ( m_zsupMethod == "2D" );
+  for ( const auto cell : adcs.read ) {
+    const int digAdc = adcs.cells[cell].adc;
     if ( m_zsupThreshold <= digAdc ) {
-      verbose() << id << format( " Energy adc %4d", digAdc );
-      if ( m_zsupThreshold <= digAdc ) debug() << " seed";
-      verbose() << endmsg;
-      caloFlags[index] = SeedFlag;
-      if ( m_zsupMethod == "2D" ) {
-        for ( const auto& neighbour : calo.neighborCells( id ) ) {
-          int& neighFlag = caloFlags[calo.cellIndex( neighbour )];
-          if ( neighFlag != SeedFlag ) neighFlag = NeighbourFlag;
+      if ( msgLevel( MSG::VERBOSE ) )
+        verbose() << map.cellID( cell ) << format( " Energy adc %4d seed", digAdc ) << endmsg;
+      adcs.cells[cell].flag = DecodedADCs::Seed;
+      if ( zsup2D ) {
+        for ( const auto neighbour : map.neighbours( cell ) ) {
+          auto& neighFlag = adcs.cells[neighbour].flag;
+          if ( neighFlag != DecodedADCs::Seed ) neighFlag = DecodedADCs::Neighbour;
         }
       }
     }
   }
 
   // write tagged data as CaloAdc and CaloDigits
-  double pedShift = calo.pedestalShift();
-  for ( const auto& anAdc : dataVec ) {
-    LHCb::CaloCellID id    = anAdc.cellID();
-    int              index = calo.cellIndex( id );
-    if ( DefaultFlag == caloFlags[index] ) continue;
-    if ( NeighbourFlag == caloFlags[index] && anAdc.adc() < m_zsupNeighbour ) continue;
-
-    double e = ( double( anAdc.adc() ) - pedShift ) * calo.cellGain( id );
-    try {
-      auto adc = std::make_unique<LHCb::CaloAdc>( id, anAdc.adc() );
-      newAdcs.insert( adc.get() );
-      adc.release();
-      auto digit = std::make_unique<LHCb::CaloDigit>( id, e );
-      newDigits.insert( digit.get() );
-      digit.release();
-    } catch ( GaudiException& exc ) {
-      ++m_duplicateADCDigits; // Duplicate ADC/Digit
-      warning() << "Duplicate ADC/Digit for channel " << id << endmsg;
-      int card  = calo.cardNumber( id );
-      int tell1 = calo.cardToTell1( card );
-      // to be completed --- LHCb::RawBankReadoutStatus& status = m_adcTool->status();
-      status.addStatus( tell1, LHCb::RawBankReadoutStatus::Status::DuplicateEntry );
-    }
+  newAdcs.reserve( adcs.read.size() );
+  newDigits.reserve( adcs.read.size() );
+  const double pedShift = map.pedestalShift();
+  for ( const auto cell : adcs.read ) {
+    const auto [digAdc, flag] = adcs.cells[cell];
+    if ( DecodedADCs::Default == flag ) continue;
+    if ( DecodedADCs::Neighbour == flag && digAdc < m_zsupNeighbour ) continue;
+
+    const auto id  = map.cellID( cell );
+    const auto e   = ( double( digAdc ) - pedShift ) * map.cellGain( cell );
+    auto       adc = std::make_unique<LHCb::CaloAdc>( id, digAdc );
+    newAdcs.insert( adc.get() );
+    adc.release();
+    auto digit = std::make_unique<LHCb::CaloDigit>( id, e );
+    newDigits.insert( digit.get() );
+    digit.release();
 
     if ( msgLevel( MSG::VERBOSE ) ) {
-      verbose() << id << " added as " << ( caloFlags[index] == NeighbourFlag ? "Neighbour." : "Seed." ) << endmsg;
+      verbose() << id << " added as " << ( flag == DecodedADCs::Neighbour ? "Neighbour." : "Seed." ) << endmsg;
     }
   }
 
@@ -256,12 +250,37 @@ std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus> CaloFut
   return {std::move( newAdcs ), std::move( newDigits ), std::move( status )};
 }
 //=============================================================================
-template <CaloFutureRawToDigits::Decode decode>
-std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v1( int sourceID, LHCb::span<const unsigned int> data,
-                                                             LHCb::RawBankReadoutStatus&,
-                                                             const DeCalorimeter& calo ) const {
-  std::vector<LHCb::CaloAdc> dataVec;
-  dataVec.reserve( decode == Decode::PinData ? calo.numberOfPins() : calo.numberOfCells() );
+// Store the ADC of a cell. Only the first ADC of a cell is kept
+//=============================================================================
+void CaloFutureRawToDigits::addADC( CellIndex cell, int adc, LHCb::RawBankReadoutStatus& status,
+                                    const DeCalorimeter& calo, const CaloFutureReadoutMap& map,
+                                    DecodedADCs& adcs ) const {
+  auto& data = adcs.cells[cell];
+  if ( data.flag != DecodedADCs::NotRead ) {
+    ++m_duplicateADCDigits; // Duplicate ADC/Digit
+    warning() << "Duplicate ADC/Digit for channel " << map.cellID( cell ) << endmsg;
+    status.addStatus( calo.cardToTell1( map.cardNumber( cell ) ), LHCb::RawBankReadoutStatus::Status::DuplicateEntry );
+    return;
+  }
+  data = {adc, DecodedADCs::Default};
+  adcs.read.push_back( cell );
+}
+//=============================================================================
+// Remove the ADCs read from the given FE-card, when its data may be corrupted
+//=============================================================================
+void CaloFutureRawToDigits::removeCard( const Card* card, const CaloFutureReadoutMap& map, DecodedADCs& adcs ) const {
+  if ( !m_cleanCorrupted || !card || card->isPin ) return;
+  auto hasBadCardNumber = [&]( CellIndex cell ) {
+    if ( map.cardNumber( cell ) != card->number ) return false;
+    adcs.cells[cell] = {};
+    return true;
+  };
+  adcs.read.erase( std::remove_if( adcs.read.begin(), adcs.read.end(), hasBadCardNumber ), adcs.read.end() );
+}
+//=============================================================================
+void CaloFutureRawToDigits::decode_v1( int sourceID, LHCb::span<const unsigned int> data,
+                                       LHCb::RawBankReadoutStatus& status, const DeCalorimeter& calo,
+                                       const CaloFutureReadoutMap& map, DecodedADCs& adcs ) const {
   //******************************************************************
   //**** Simple coding, ID + adc in 32 bits.
   //******************************************************************
@@ -270,32 +289,29 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v1( int sourceID, LHCb:
     int  adc = d & 0xFFFF;
     if ( 32767 < adc ) adc |= 0xFFFF0000; //= negative value
     LHCb::CaloCellID cellId( ( d >> 16 ) & 0xFFFF );
-    LHCb::CaloAdc    temp( cellId, adc );
     // event dump
-    verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << calo.cardNumber( cellId ) << " |  CaloCell "
-              << cellId << " |  valid ? " << calo.valid( cellId ) << " |  ADC value = " << adc << endmsg;
+    if ( msgLevel( MSG::VERBOSE ) )
+      verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << calo.cardNumber( cellId ) << " |  CaloCell "
+                << cellId << " |  valid ? " << calo.valid( cellId ) << " |  ADC value = " << adc << endmsg;
 
-    if ( 0 != cellId.index() && cellId.isPin() == ( decode == Decode::PinData ) ) dataVec.push_back( temp );
+    if ( 0 == cellId.index() || cellId.isPin() ) continue;
+    const auto cell = map.cellIndex( cellId );
+    if ( cell != CaloFutureReadoutMap::NoCell ) addADC( cell, adc, status, calo, map, adcs );
   }
-  return dataVec;
 }
 //=============================================================================
-template <CaloFutureRawToDigits::Decode decode>
-std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v2( int sourceID, LHCb::span<const unsigned int> data,
-                                                             LHCb::RawBankReadoutStatus& status,
-                                                             const DeCalorimeter&        calo ) const {
-  std::vector<LHCb::CaloAdc> dataVec;
-  dataVec.reserve( decode == Decode::PinData ? calo.numberOfPins() : calo.numberOfCells() );
+void CaloFutureRawToDigits::decode_v2( int sourceID, LHCb::span<const unsigned int> data,
+                                       LHCb::RawBankReadoutStatus& status, const DeCalorimeter& calo,
+                                       const CaloFutureReadoutMap& map, DecodedADCs& adcs ) const {
   //******************************************************************
   //**** 1 MHz compression format, Ecal and Hcal
   //******************************************************************
   // Get the FE-Cards associated to that bank (via condDB)
-  std::vector<int> feCards = calo.tell1ToCards( sourceID );
-  int              nCards  = feCards.size();
+  const auto    cards     = map.tell1Cards( sourceID );
+  std::uint64_t readCards = 0;
   if ( msgLevel( MSG::DEBUG ) )
-    debug() << nCards << " FE-Cards are expected to be readout : " << feCards << " in Tell1 bank " << sourceID
-            << endmsg;
-  int prevCard = -1;
+    debug() << cards.size() << " FE-Cards are expected to be readout in Tell1 bank " << sourceID << endmsg;
+  const Card* prevCard = nullptr;
   while ( !data.empty() ) {
     // Skip
     unsigned int word = pop( data );
@@ -304,25 +320,19 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v2( int sourceID, LHCb:
     int code    = ( word >> 14 ) & 0x1FF;
     int ctrl    = ( word >> 23 ) & 0x1FF;
     checkCtrl( ctrl, sourceID, status );
-    // access chanID via condDB
-    std::vector<LHCb::CaloCellID> chanID;
-    // look for the FE-Card in the Tell1->cards vector
-    int card = findCardbyCode( calo, feCards, code );
-    if ( 0 <= card ) {
-      chanID = calo.cardChannels( feCards[card] );
-      feCards.erase( feCards.begin() + card );
+    // access chanID via the readout map
+    LHCb::span<const CellIndex> chanID;
+    // look for the FE-Card in the Tell1->cards list
+    const Card* card = findCardbyCode( cards, readCards, code );
+    if ( card ) {
+      chanID = map.channels( *card );
     } else {
       error() << " FE-Card w/ [code : " << Gaudi::Utils::toString( code )
               << " ] is not associated with TELL1 bank sourceID : " << sourceID << " in condDB :  Cannot read that bank"
               << endmsg;
 
       error() << "Warning : previous data may be corrupted" << endmsg;
-      if ( m_cleanCorrupted && calo.isPinCard( prevCard ) == ( decode == Decode::PinData ) ) {
-        auto hasBadCardNumber = [&]( const LHCb::CaloAdc& adc ) {
-          return calo.cellParam( adc.cellID() ).cardNumber() == prevCard;
-        };
-        dataVec.erase( std::remove_if( dataVec.begin(), dataVec.end(), hasBadCardNumber ), dataVec.end() );
-      }
+      removeCard( prevCard, map, adcs );
       status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Incomplete );
       status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Corrupted );
     }
@@ -358,44 +368,36 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v2( int sourceID, LHCb:
         adc -= 256;
       }
 
-      LHCb::CaloCellID id = ( bitNum < chanID.size() ? chanID[bitNum] : LHCb::CaloCellID() );
+      const CellIndex cell = ( bitNum < chanID.size() ? chanID[bitNum] : CaloFutureReadoutMap::NoCell );
 
       // event dump
-      verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << calo.cardNumber( id )
-                << " |  Channel : " << bitNum << " |  CaloCell " << id << " |  valid ? " << calo.valid( id )
-                << " |  ADC value = " << adc << endmsg;
+      if ( msgLevel( MSG::VERBOSE ) ) {
+        const auto id = ( cell != CaloFutureReadoutMap::NoCell ? map.cellID( cell ) : LHCb::CaloCellID() );
+        verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << ( card ? card->number : -1 )
+                  << " |  Channel : " << bitNum << " |  CaloCell " << id << " |  ADC value = " << adc << endmsg;
+      }
 
       //== Keep only valid cells
-      if ( 0 != id.index() ) {
-        LHCb::CaloAdc temp( id, adc );
-        if ( id.isPin() == ( decode == Decode::PinData ) ) dataVec.push_back( temp );
-      }
+      if ( cell != CaloFutureReadoutMap::NoCell ) addADC( cell, adc, status, calo, map, adcs );
     }
   }
   // Check All cards have been read
-  if ( !checkCards( calo, nCards, feCards ) )
-    status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Incomplete );
-
-  return dataVec;
+  if ( !checkCards( cards, readCards ) ) status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Incomplete );
 }
 //=============================================================================
-template <CaloFutureRawToDigits::Decode decode>
-std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v3( int sourceID, LHCb::span<const unsigned int> data,
-                                                             LHCb::RawBankReadoutStatus& status,
-                                                             const DeCalorimeter&        calo ) const {
-  std::vector<LHCb::CaloAdc> dataVec;
-  dataVec.reserve( decode == Decode::PinData ? calo.numberOfPins() : calo.numberOfCells() );
+void CaloFutureRawToDigits::decode_v3( int sourceID, LHCb::span<const unsigned int> data,
+                                       LHCb::RawBankReadoutStatus& status, const DeCalorimeter& calo,
+                                       const CaloFutureReadoutMap& map, DecodedADCs& adcs ) const {
   //******************************************************************
   //**** 1 MHz compression format, Preshower + SPD
   //******************************************************************
 
   // Get the FE-Cards associated to that bank (via condDB)
-  std::vector<int> feCards = calo.tell1ToCards( sourceID );
-  int              nCards  = feCards.size();
+  const auto    cards     = map.tell1Cards( sourceID );
+  std::uint64_t readCards = 0;
   if ( msgLevel( MSG::DEBUG ) )
-    debug() << nCards << " FE-Cards are expected to be readout : " << feCards << " in Tell1 bank " << sourceID
-            << endmsg;
-  int prevCard = -1;
+    debug() << cards.size() << " FE-Cards are expected to be readout in Tell1 bank " << sourceID << endmsg;
+  const Card* prevCard = nullptr;
   while ( !data.empty() ) {
     // Skip
     unsigned int word = pop( data );
@@ -405,26 +407,20 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v3( int sourceID, LHCb:
     int code    = ( word >> 14 ) & 0x1FF;
     int ctrl    = ( word >> 23 ) & 0x1FF;
     checkCtrl( ctrl, sourceID, status );
-    // access chanID via condDB
-    // look for the FE-Card in the Tell1->cards vector
-    int card = findCardbyCode( calo, feCards, code );
-    if ( card < 0 ) {
+    // access chanID via the readout map
+    // look for the FE-Card in the Tell1->cards list
+    const Card* card = findCardbyCode( cards, readCards, code );
+    if ( !card ) {
       error() << " FE-Card w/ [code : " << code << " ] is not associated with TELL1 bank sourceID : " << sourceID
               << " in condDB :  Cannot read that bank" << endmsg;
       error() << "Warning : previous data may be corrupted" << endmsg;
-      if ( m_cleanCorrupted && calo.isPinCard( prevCard ) == ( decode == Decode::PinData ) ) {
-        auto hasBadCardNumber = [&]( const LHCb::CaloAdc& adc ) {
-          return calo.cellParam( adc.cellID() ).cardNumber() == prevCard;
-        };
-        dataVec.erase( std::remove_if( dataVec.begin(), dataVec.end(), hasBadCardNumber ), dataVec.end() );
-      }
+      removeCard( prevCard, map, adcs );
 
       status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Corrupted |
                                       LHCb::RawBankReadoutStatus::Status::Incomplete );
     }
-    std::vector<LHCb::CaloCellID> chanID = calo.cardChannels( feCards[card] );
-    feCards.erase( feCards.begin() + card );
-    prevCard = card;
+    const auto chanID = ( card ? map.channels( *card ) : LHCb::span<const CellIndex>{} );
+    prevCard          = card;
 
     // Read the FE-Board
     // skip the trigger bits
@@ -442,31 +438,31 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_v3( int sourceID, LHCb:
       int          adc = ( lastData >> offset ) & 0x3FF;
       unsigned int num = ( lastData >> ( offset + 10 ) ) & 0x3F;
 
-      LHCb::CaloCellID id = ( num < chanID.size() ? chanID[num] : LHCb::CaloCellID{} );
+      const CellIndex cell = ( num < chanID.size() ? chanID[num] : CaloFutureReadoutMap::NoCell );
 
       // event dump
-      verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << calo.cardNumber( id ) << " |  Channel : " << num
-                << " |  CaloCell " << id << " |  valid ? " << calo.valid( id ) << " |  ADC value = " << adc << endmsg;
+      if ( msgLevel( MSG::VERBOSE ) ) {
+        const auto id = ( cell != CaloFutureReadoutMap::NoCell ? map.cellID( cell ) : LHCb::CaloCellID() );
+        verbose() << " |  SourceID : " << sourceID << " |  FeBoard : " << ( card ? card->number : -1 )
+                  << " |  Channel : " << num << " |  CaloCell " << id << " |  ADC value = " << adc << endmsg;
+      }
 
-      if ( 0 != id.index() && id.isPin() == ( decode == Decode::PinData ) ) dataVec.emplace_back( id, adc );
+      if ( cell != CaloFutureReadoutMap::NoCell ) addADC( cell, adc, status, calo, map, adcs );
 
       --lenAdc;
       offset += 16;
     }
   } //== DataSize
   // Check All cards have been read
-  if ( !checkCards( calo, nCards, feCards ) )
-    status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Incomplete );
-  return dataVec;
+  if ( !checkCards( cards, readCards ) ) status.addStatus( sourceID, LHCb::RawBankReadoutStatus::Status::Incomplete );
 }
 //=============================================================================
 // Main method to decode the rawBank
 //=============================================================================
-template <CaloFutureRawToDigits::Decode decode>
-std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_( const LHCb::RawBank&        bank,
-                                                           LHCb::RawBankReadoutStatus& status,
-                                                           const DeCalorimeter&        calo ) const {
-  if ( LHCb::RawBank::MagicPattern != bank.magic() ) return {}; // do not try to decode when MagicPattern is bad
+void CaloFutureRawToDigits::decode_( const LHCb::RawBank& bank, LHCb::RawBankReadoutStatus& status,
+                                     const DeCalorimeter& calo, const CaloFutureReadoutMap& map,
+                                     DecodedADCs& adcs ) const {
+  if ( LHCb::RawBank::MagicPattern != bank.magic() ) return; // do not try to decode when MagicPattern is bad
   // Get bank info
   auto data     = bank.range<unsigned int>();
   int  version  = bank.version();
@@ -483,32 +479,34 @@ std::vector<LHCb::CaloAdc> CaloFutureRawToDigits::decode_( const LHCb::RawBank&
 
   switch ( version ) {
   case 1:
-    return decode_v1<decode>( sourceID, data, status, calo );
+    return decode_v1( sourceID, data, status, calo, map, adcs );
   case 2:
-    return decode_v2<decode>( sourceID, data, status, calo );
+    return decode_v2( sourceID, data, status, calo, map, adcs );
   case 3:
-    return decode_v3<decode>( sourceID, data, status, calo );
+    return decode_v3( sourceID, data, status, calo, map, adcs );
   default:
     warning() << "Bank type " << bank.type() << " sourceID " << sourceID << " has version " << version
               << " which is not supported" << endmsg;
-    return {};
   }
 }
 
 //========================
 //  Check FE-Cards is PIN
 //========================
-bool CaloFutureRawToDigits::checkCards( const DeCalorimeter& calo, int nCards, const std::vector<int>& feCards ) const {
+bool CaloFutureRawToDigits::checkCards( LHCb::span<const Card> cards, std::uint64_t readCards ) const {
   bool check = true;
   if ( msgLevel( MSG::DEBUG ) )
-    debug() << nCards - feCards.size() << "FE-Cards have been read among the " << nCards << " expected" << endmsg;
-  for ( auto i : feCards ) {
+    debug() << __builtin_popcountll( readCards ) << " FE-Cards have been read among the " << cards.size()
+            << " expected" << endmsg;
+  for ( std::size_t i = 0; i < std::size_t( cards.size() ); ++i ) {
+    if ( readCards & ( std::uint64_t{1} << i ) ) continue;
+    const auto& card = cards[i];
     if ( msgLevel( MSG::DEBUG ) )
-      debug() << " Unread FE-Cards : " << calo.cardCode( i ) << "  - Is it a PinDiode readout FE-Card ? "
-              << calo.isPinCard( i ) << endmsg;
-    if ( calo.isPmtCard( i ) ) {
-      warning() << " The standard (PMT) FE-Card " << calo.cardCode( i )
-                << " expected in TELL1 bank has not been read !!" << endmsg;
+      debug() << " Unread FE-Cards : " << card.code << "  - Is it a PinDiode readout FE-Card ? " << card.isPin
+              << endmsg;
+    if ( card.isPmt ) {
+      warning() << " The standard (PMT) FE-Card " << card.code << " expected in TELL1 bank has not been read !!"
+                << endmsg;
       check = false;
     }
   }
@@ -518,18 +516,19 @@ bool CaloFutureRawToDigits::checkCards( const DeCalorimeter& calo, int nCards, c
 //===========================
 //  Find Card number by code
 //===========================
-int CaloFutureRawToDigits::findCardbyCode( const DeCalorimeter& calo, const std::vector<int>& feCards,
-                                           int code ) const {
-  auto i = std::find_if( feCards.begin(), feCards.end(), [&]( int ife ) { return code == calo.cardCode( ife ); } );
-  if ( i == feCards.end() ) {
-    error() << "FE-Card [code : " << code << "] does not match the condDB cabling scheme  " << endmsg;
-    return -1;
+const CaloFutureReadoutMap::Card*
+CaloFutureRawToDigits::findCardbyCode( LHCb::span<const Card> cards, std::uint64_t& readCards, int code ) const {
+  for ( std::size_t i = 0; i < std::size_t( cards.size() ); ++i ) {
+    const auto bit = std::uint64_t{1} << i;
+    if ( ( readCards & bit ) || cards[i].code != code ) continue;
+    readCards |= bit;
+    if ( msgLevel( MSG::DEBUG ) )
+      debug() << " FE-Card [code : " << code << "] has been found with (num : " << cards[i].number << ")  in condDB"
+              << endmsg;
+    return &cards[i];
   }
-  if ( msgLevel( MSG::DEBUG ) )
-    debug() << " FE-Card [code : " << code << " | crate : " << calo.cardParam( *i ).crate()
-            << " slot : " << calo.cardParam( *i ).slot() << "] has been found with (num : " << *i << ")  in condDB"
-            << endmsg;
-  return std::distance( feCards.begin(), i );
+  error() << "FE-Card [code : " << code << "] does not match the condDB cabling scheme  " << endmsg;
+  return nullptr;
 }
 
 void CaloFutureRawToDigits::checkCtrl( int ctrl, int sourceID, LHCb::RawBankReadoutStatus& status ) const {
@@ -27,6 +27,7 @@
 #include "CaloDet/DeCalorimeter.h"
 
 // CaloDAQ
+#include "CaloFutureReadoutMap.h"
 #include "futuredetails.h"
 
 #include "Event/CaloAdc.h"
@@ -34,35 +35,58 @@
 #include "Event/RawBankReadoutStatus.h"
 #include "Event/RawEvent.h"
 
+#include <cstdint>
+#include <vector>
+
 class CaloFutureRawToDigits : public Gaudi::Functional::MultiTransformer<
                                   std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus>(
-                                      const LHCb::RawEvent& rawEvt, const DeCalorimeter& ),
-                                  LHCb::DetDesc::usesConditions<DeCalorimeter>> {
+                                      const LHCb::RawEvent& rawEvt, const DeCalorimeter&, const CaloFutureReadoutMap& ),
+                                  LHCb::DetDesc::usesConditions<DeCalorimeter, CaloFutureReadoutMap>> {
 
 public:
   CaloFutureRawToDigits( const std::string& name, ISvcLocator* pSvcLocator );
   StatusCode initialize() override;
   std::tuple<LHCb::CaloAdcs, LHCb::CaloDigits, LHCb::RawBankReadoutStatus>
-  operator()( const LHCb::RawEvent&, const DeCalorimeter& ) const override;
+  operator()( const LHCb::RawEvent&, const DeCalorimeter&, const CaloFutureReadoutMap& ) const override;
 
 private:
-  enum class Decode { PinData, Cell };
-
-  template <Decode>
-  std::vector<LHCb::CaloAdc> decode_( const LHCb::RawBank&, LHCb::RawBankReadoutStatus&, const DeCalorimeter& ) const;
-  template <Decode>
-  std::vector<LHCb::CaloAdc> decode_v1( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&,
-                                        const DeCalorimeter& ) const;
-  template <Decode>
-  std::vector<LHCb::CaloAdc> decode_v2( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&,
-                                        const DeCalorimeter& ) const;
-  template <Decode>
-  std::vector<LHCb::CaloAdc> decode_v3( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&,
-                                        const DeCalorimeter& ) const;
-
-  bool checkCards( const DeCalorimeter&, int nCards, const std::vector<int>& feCards ) const;
-  int  findCardbyCode( const DeCalorimeter&, const std::vector<int>& feCards, int code ) const;
-  void checkCtrl( int ctrl, int sourceID, LHCb::RawBankReadoutStatus& status ) const;
+  using CellIndex = CaloFutureReadoutMap::CellIndex;
+  using Card      = CaloFutureReadoutMap::Card;
+
+  /** The decoded ADCs of an event, stored by dense cell index, and the list of cells read, in readout order.
+   *  Reset at the start of each event, keeping the memory allocated for the previous ones
+   */
+  struct DecodedADCs {
+    enum Flag : unsigned char { NotRead, Default, Neighbour, Seed };
+    struct Cell {
+      int  adc  = 0;
+      Flag flag = NotRead;
+    };
+    void reset( std::size_t nCells ) {
+      cells.assign( nCells, Cell{} );
+      read.clear();
+      read.reserve( nCells );
+    }
+    std::vector<Cell>      cells;
+    std::vector<CellIndex> read;
+  };
+
+  void decode_( const LHCb::RawBank&, LHCb::RawBankReadoutStatus&, const DeCalorimeter&, const CaloFutureReadoutMap&,
+                DecodedADCs& ) const;
+  void decode_v1( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&, const DeCalorimeter&,
+                  const CaloFutureReadoutMap&, DecodedADCs& ) const;
+  void decode_v2( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&, const DeCalorimeter&,
+                  const CaloFutureReadoutMap&, DecodedADCs& ) const;
+  void decode_v3( int sourceID, LHCb::span<const unsigned int>, LHCb::RawBankReadoutStatus&, const DeCalorimeter&,
+                  const CaloFutureReadoutMap&, DecodedADCs& ) const;
+
+  void addADC( CellIndex cell, int adc, LHCb::RawBankReadoutStatus&, const DeCalorimeter&, const CaloFutureReadoutMap&,
+               DecodedADCs& ) const;
+  void removeCard( const Card* card, const CaloFutureReadoutMap&, DecodedADCs& ) const;
+
+  bool        checkCards( LHCb::span<const Card> cards, std::uint64_t readCards ) const;
+  const Card* findCardbyCode( LHCb::span<const Card> cards, std::uint64_t& readCards, int code ) const;
+  void        checkCtrl( int ctrl, int sourceID, LHCb::RawBankReadoutStatus& status ) const;
 
   Gaudi::Property<std::string> m_zsupMethod{this, "ZSupMethod", "1D"};
   Gaudi::Property<int>         m_zsupThreshold{this, "ZSupThreshold", -1000, "Initial threshold, in ADC counts"};
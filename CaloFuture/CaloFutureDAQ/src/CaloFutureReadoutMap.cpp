@@ -0,0 +1,71 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "CaloFutureReadoutMap.h"
+
+#include "CaloDet/DeCalorimeter.h"
+#include "GaudiKernel/GaudiException.h"
+
+#include <string>
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : CaloFutureReadoutMap
+//-----------------------------------------------------------------------------
+
+CaloFutureReadoutMap::CaloFutureReadoutMap( const DeCalorimeter& calo ) : m_pedestalShift( calo.pedestalShift() ) {
+
+  // cells
+  const auto& cells  = calo.cellParams();
+  const auto  nCells = cells.size();
+  m_cellIDs.reserve( nCells );
+  m_gains.reserve( nCells );
+  m_cellCards.reserve( nCells );
+  for ( const auto& cell : cells ) {
+    const auto id = cell.cellID();
+    if ( id.index() >= m_indexOfCell.size() ) m_indexOfCell.resize( id.index() + 1, NoCell );
+    m_indexOfCell[id.index()] = m_cellIDs.size();
+    m_cellIDs.push_back( id );
+    m_gains.push_back( cell.gain() );
+    m_cellCards.push_back( cell.cardNumber() );
+  }
+
+  // neighbours
+  m_neighbourOffsets.reserve( nCells + 1 );
+  m_neighbourOffsets.push_back( 0 );
+  for ( const auto& cell : cells ) {
+    for ( const auto& neighbour : cell.neighbors() ) {
+      const auto index = cellIndex( neighbour );
+      if ( index != NoCell ) m_neighbours.push_back( index );
+    }
+    m_neighbourOffsets.push_back( m_neighbours.size() );
+  }
+
+  // TELL1s -> FE-cards -> channels
+  const auto& tell1s = calo.tell1Params();
+  m_tell1Offsets.reserve( tell1s.size() + 1 );
+  m_tell1Offsets.push_back( 0 );
+  for ( const auto& tell1 : tell1s ) {
+    const auto feCards = tell1.feCards();
+    if ( feCards.size() > MaxCardsPerTell1 ) {
+      throw GaudiException( "TELL1 " + std::to_string( tell1.number() ) + " reads more than " +
+                                std::to_string( MaxCardsPerTell1 ) + " FE-cards",
+                            "CaloFutureReadoutMap", StatusCode::FAILURE );
+    }
+    for ( const auto number : feCards ) {
+      const auto& ids = calo.cardChannels( number );
+      m_cards.push_back( {number, calo.cardCode( number ), calo.isPmtCard( number ), calo.isPinCard( number ),
+                          std::uint32_t( m_channels.size() ), std::uint32_t( ids.size() )} );
+      for ( const auto& id : ids ) {
+        m_channels.push_back( ( 0 != id.index() && !id.isPin() ) ? cellIndex( id ) : NoCell );
+      }
+    }
+    m_tell1Offsets.push_back( m_cards.size() );
+  }
+}
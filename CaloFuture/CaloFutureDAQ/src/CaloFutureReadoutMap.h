@@ -0,0 +1,110 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef CALOFUTUREDAQ_CALOFUTUREREADOUTMAP_H
+#define CALOFUTUREDAQ_CALOFUTUREREADOUTMAP_H 1
+
+#include "Kernel/CaloCellID.h"
+#include "Kernel/STLExtensions.h"
+
+#include <cstdint>
+#include <vector>
+
+class DeCalorimeter;
+
+/** @class CaloFutureReadoutMap CaloFutureReadoutMap.h
+ *
+ *  Flat copy of the readout map of a DeCalorimeter, used as derived condition by
+ *  CaloFutureRawToDigits so that decoding needs neither temporary vectors nor lookups in
+ *  the detector element.
+ *
+ *  Cells are identified by their dense index in DeCalorimeter::cellParams(), used to index
+ *  the per cell arrays (ID, gain, FE-card, neighbours). The FE-cards of each TELL1 are
+ *  stored contiguously, in the order of the condition database, and each card points to
+ *  its channels in a single array holding the dense index of the cell read by the channel
+ *  (NoCell for unconnected or PIN-diode channels).
+ */
+class CaloFutureReadoutMap final {
+
+public:
+  /// Dense index of a cell
+  using CellIndex = std::int32_t;
+
+  /// Index of the channels not connected to a cell
+  static constexpr CellIndex NoCell = -1;
+
+  /// Maximal number of FE-cards per TELL1, for the bit mask of the cards read in a bank
+  static constexpr std::size_t MaxCardsPerTell1 = 64;
+
+  /// A FE-card
+  struct Card {
+    int           number;       ///< FE-card number in DeCalorimeter
+    int           code;         ///< FE-card code, as found in the bank header
+    bool          isPmt;        ///< Standard (PMT) FE-card
+    bool          isPin;        ///< PIN-diode FE-card
+    std::uint32_t firstChannel; ///< Index of the first channel in channels()
+    std::uint32_t nChannels;    ///< Number of channels
+  };
+
+public:
+  /// Build the map from the detector element
+  explicit CaloFutureReadoutMap( const DeCalorimeter& calo );
+
+  /// Number of cells, including the PIN-diodes
+  std::size_t nCells() const noexcept { return m_cellIDs.size(); }
+
+  /// The dense index of the given cell, NoCell if unknown
+  CellIndex cellIndex( const LHCb::CaloCellID id ) const noexcept {
+    const auto i = id.index();
+    return i < m_indexOfCell.size() ? m_indexOfCell[i] : NoCell;
+  }
+
+  /// The ID of the given cell
+  LHCb::CaloCellID cellID( const CellIndex cell ) const noexcept { return m_cellIDs[cell]; }
+
+  /// The gain of the given cell
+  double cellGain( const CellIndex cell ) const noexcept { return m_gains[cell]; }
+
+  /// The FE-card number of the given cell
+  int cardNumber( const CellIndex cell ) const noexcept { return m_cellCards[cell]; }
+
+  /// The neighbours of the given cell
+  LHCb::span<const CellIndex> neighbours( const CellIndex cell ) const noexcept {
+    return {m_neighbours.data() + m_neighbourOffsets[cell], m_neighbours.data() + m_neighbourOffsets[cell + 1]};
+  }
+
+  /// The FE-cards of the given TELL1, empty if unknown
+  LHCb::span<const Card> tell1Cards( const int tell1 ) const noexcept {
+    if ( tell1 < 0 || std::size_t( tell1 ) + 1 >= m_tell1Offsets.size() ) return {};
+    return {m_cards.data() + m_tell1Offsets[tell1], m_cards.data() + m_tell1Offsets[tell1 + 1]};
+  }
+
+  /// The cells read by the channels of the given FE-card
+  LHCb::span<const CellIndex> channels( const Card& card ) const noexcept {
+    return {m_channels.data() + card.firstChannel, m_channels.data() + card.firstChannel + card.nChannels};
+  }
+
+  /// Pedestal shift of the calorimeter
+  double pedestalShift() const noexcept { return m_pedestalShift; }
+
+private:
+  std::vector<CellIndex>        m_indexOfCell;      ///< Dense index of the cells, by CaloCellID::index()
+  std::vector<LHCb::CaloCellID> m_cellIDs;          ///< Cell IDs, by dense index
+  std::vector<double>           m_gains;            ///< Cell gains, by dense index
+  std::vector<int>              m_cellCards;        ///< FE-card of the cells, by dense index
+  std::vector<std::uint32_t>    m_neighbourOffsets; ///< Offsets of the neighbours of each cell in m_neighbours
+  std::vector<CellIndex>        m_neighbours;       ///< Neighbours of all cells
+  std::vector<std::uint32_t>    m_tell1Offsets;     ///< Offsets of the FE-cards of each TELL1 in m_cards
+  std::vector<Card>             m_cards;            ///< FE-cards of all TELL1s
+  std::vector<CellIndex>        m_channels;         ///< Channels of all FE-cards
+  double                        m_pedestalShift = 0;
+};
+
+#endif // CALOFUTUREDAQ_CALOFUTUREREADOUTMAP_H
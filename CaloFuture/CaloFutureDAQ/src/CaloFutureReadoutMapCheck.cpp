@@ -0,0 +1,117 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "CaloFutureReadoutMap.h"
+
+#include "CaloDet/DeCalorimeter.h"
+#include "CaloFutureUtils/CaloFutureAlgUtils.h"
+#include "DetDesc/ConditionAccessorHolder.h"
+#include "GaudiAlg/Consumer.h"
+#include "GaudiKernel/Counters.h"
+
+#include <string>
+#include <vector>
+
+/** @class CaloFutureReadoutMapCheck CaloFutureReadoutMapCheck.cpp
+ *
+ *  Check the CaloFutureReadoutMap derived condition, as used by CaloFutureRawToDigits,
+ *  against the readout map of the DeCalorimeter it is derived from: cells, gains,
+ *  FE-cards, neighbours, and the cells read by the channels of each FE-card of each TELL1.
+ *  Every difference is reported as an error.
+ */
+class CaloFutureReadoutMapCheck
+    : public Gaudi::Functional::Consumer<void( const DeCalorimeter&, const CaloFutureReadoutMap& ),
+                                         LHCb::DetDesc::usesConditions<DeCalorimeter, CaloFutureReadoutMap>> {
+
+public:
+  CaloFutureReadoutMapCheck( const std::string& name, ISvcLocator* pSvcLocator )
+      : Consumer( name, pSvcLocator,
+                  {KeyValue{"DetectorLocation", LHCb::CaloFutureAlgUtils::DeCaloFutureLocation( name )},
+                   KeyValue{"ReadoutMap", "AlgorithmSpecific-" + name + "-ReadoutMap"}} ) {}
+
+  StatusCode initialize() override {
+    StatusCode sc = Consumer::initialize();
+    if ( sc.isFailure() ) return sc;
+    addConditionDerivation<CaloFutureReadoutMap( const DeCalorimeter& )>( inputLocation<0>(), inputLocation<1>() );
+    return sc;
+  }
+
+  void operator()( const DeCalorimeter& calo, const CaloFutureReadoutMap& map ) const override {
+    using CellIndex = CaloFutureReadoutMap::CellIndex;
+    // only the first 20 differences are printed
+    auto mismatch = [&]( const std::string& what ) {
+      if ( m_mismatches.nEntries() < 20 ) error() << what << endmsg;
+      ++m_mismatches;
+    };
+
+    // cells
+    const auto& cells = calo.cellParams();
+    if ( map.nCells() != cells.size() ) {
+      mismatch( "number of cells " + std::to_string( map.nCells() ) + " instead of " + std::to_string( cells.size() ) );
+    }
+    for ( const auto& cell : cells ) {
+      const auto id    = cell.cellID();
+      const auto index = map.cellIndex( id );
+      if ( index == CaloFutureReadoutMap::NoCell || map.cellID( index ) != id ) {
+        mismatch( "unknown cell " + id.toString() );
+        continue;
+      }
+      if ( map.cellGain( index ) != cell.gain() ) mismatch( "gain of cell " + id.toString() );
+      if ( map.cardNumber( index ) != cell.cardNumber() ) mismatch( "FE-card of cell " + id.toString() );
+      std::vector<LHCb::CaloCellID> neighbours;
+      for ( const auto neighbour : map.neighbours( index ) ) neighbours.push_back( map.cellID( neighbour ) );
+      std::vector<LHCb::CaloCellID> expected;
+      for ( const auto& neighbour : cell.neighbors() ) {
+        if ( map.cellIndex( neighbour ) != CaloFutureReadoutMap::NoCell ) expected.push_back( neighbour );
+      }
+      if ( neighbours != expected ) mismatch( "neighbours of cell " + id.toString() );
+    }
+
+    // TELL1s -> FE-cards -> channels, including one TELL1 beyond the last one
+    for ( int tell1 = 0; tell1 <= calo.nTell1s(); ++tell1 ) {
+      const auto cards    = map.tell1Cards( tell1 );
+      const auto expected = calo.tell1ToCards( tell1 );
+      if ( cards.size() != expected.size() ) {
+        mismatch( "number of FE-cards of TELL1 " + std::to_string( tell1 ) );
+        continue;
+      }
+      for ( std::size_t i = 0; i < expected.size(); ++i ) {
+        const auto& card   = cards[i];
+        const int   number = expected[i];
+        if ( card.number != number || card.code != calo.cardCode( number ) || card.isPmt != calo.isPmtCard( number ) ||
+             card.isPin != calo.isPinCard( number ) ) {
+          mismatch( "FE-card " + std::to_string( number ) + " of TELL1 " + std::to_string( tell1 ) );
+          continue;
+        }
+        const auto  channels = map.channels( card );
+        const auto& ids      = calo.cardChannels( number );
+        if ( channels.size() != ids.size() ) {
+          mismatch( "number of channels of FE-card " + std::to_string( number ) );
+          continue;
+        }
+        for ( std::size_t j = 0; j < ids.size(); ++j ) {
+          const bool      read = 0 != ids[j].index() && !ids[j].isPin();
+          const CellIndex cell = channels[j];
+          if ( read ? ( cell == CaloFutureReadoutMap::NoCell || map.cellID( cell ) != ids[j] )
+                    : cell != CaloFutureReadoutMap::NoCell ) {
+            mismatch( "channel " + std::to_string( j ) + " of FE-card " + std::to_string( number ) );
+          }
+        }
+      }
+    }
+
+    if ( map.pedestalShift() != calo.pedestalShift() ) mismatch( "pedestal shift" );
+  }
+
+private:
+  mutable Gaudi::Accumulators::Counter<> m_mismatches{this, "# mismatches"};
+};
+
+DECLARE_COMPONENT( CaloFutureReadoutMapCheck )
@@ -10,6 +10,9 @@
 \*****************************************************************************/
 #pragma once
 
+#include "MDF/BufferPool.h"
+#include "MDF/MDFHeader.h"
+
 #include "Event/RawEvent.h"
 
 #include "Kernel/STLExtensions.h"
@@ -26,18 +29,26 @@ namespace LHCb::MDF {
    * Upon creation, it only gets a raw buffer and a size.
    * Banks are then decoded from the buffer and added to the m_event when
    * calling get on the Buffer object
+   * When given the MDF record it comes from, its checksum is verified before decoding
    */
   class MDFEvent {
   public:
     MDFEvent() = default;
     MDFEvent( LHCb::span<std::byte> data ) : m_data( data ) {}
-    LHCb::RawEvent& event() { return m_event; }
-    std::byte*      data() { return m_data.data(); }
-    unsigned int    size() { return m_data.size(); }
+    MDFEvent( LHCb::span<std::byte> data, const MDFHeader* record, int checksumType )
+        : m_data( data ), m_record( record ), m_checksumType( checksumType ) {}
+    LHCb::RawEvent&  event() { return m_event; }
+    std::byte*       data() { return m_data.data(); }
+    unsigned int     size() { return m_data.size(); }
+    const MDFHeader* record() const { return m_record; }
+    int              checksumType() const { return m_checksumType; }
 
   private:
     LHCb::RawEvent        m_event;
     LHCb::span<std::byte> m_data;
+    /// record to be verified, if any
+    const MDFHeader* m_record{nullptr};
+    int              m_checksumType{0};
   };
 
   /**
@@ -84,16 +95,22 @@ namespace LHCb::MDF {
    * Accepted RawBuffer types are std::unique_ptr<byte[]> or std::shared_ptr<some file wrapper>
    * The key point being that the RawBufferPtr will be detroyed when the Buffer object is
    * destroyed
+   * Events of compressed records point to an additional block, holding their decompressed
+   * data, which is owned the same way
    */
   template <typename RawBuffer, typename = std::enable_if_t<details::is_owner_ptr_v<RawBuffer>>>
   class OwningBuffer : public Buffer {
   public:
-    OwningBuffer( RawBuffer&& rawBuffer, std::vector<MDFEvent>&& events )
-        : Buffer( std::move( events ) ), m_rawBuffer( std::move( rawBuffer ) ) {}
+    OwningBuffer( RawBuffer&& rawBuffer, std::vector<MDFEvent>&& events, BufferPool::Block&& decompressed = {} )
+        : Buffer( std::move( events ) )
+        , m_rawBuffer( std::move( rawBuffer ) )
+        , m_decompressed( std::move( decompressed ) ) {}
 
   private:
     /// raw buffer containing rawbanks
     RawBuffer m_rawBuffer;
+    /// block containing the decompressed rawbanks, if any
+    BufferPool::Block m_decompressed;
   };
 
 } // namespace LHCb::MDF
@@ -0,0 +1,83 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace LHCb::MDF {
+
+  /**
+   * Pool of aligned memory blocks, used for the memory backing event Buffers
+   * Blocks are handed out as unique_ptrs giving them back to the pool on destruction,
+   * so that the memory is recycled when the last event using it is gone.
+   * A free block is reused when it is large enough for the request, and at most
+   * maxFree blocks are kept, the others being released to the system
+   */
+  class BufferPool : public std::enable_shared_from_this<BufferPool> {
+  public:
+    struct Recycler {
+      std::shared_ptr<BufferPool> pool;
+      std::size_t                 size{0};
+      void                        operator()( std::byte* p ) const { pool->recycle( p, size ); }
+    };
+    using Block = std::unique_ptr<std::byte, Recycler>;
+
+    BufferPool( std::size_t alignment, std::size_t maxFree ) : m_alignment( alignment ), m_maxFree( maxFree ) {}
+    ~BufferPool() {
+      for ( auto& [p, size] : m_free ) std::free( p );
+    }
+
+    /**
+     * get a block of at least the given size
+     * @throws std::bad_alloc
+     */
+    Block get( std::size_t size ) {
+      size = ( size + m_alignment - 1 ) / m_alignment * m_alignment;
+      {
+        std::lock_guard lock( m_mutex );
+        for ( auto it = m_free.begin(); it != m_free.end(); ++it ) {
+          if ( it->second >= size ) {
+            auto block = Block{it->first, Recycler{shared_from_this(), it->second}};
+            m_free.erase( it );
+            return block;
+          }
+        }
+      }
+      auto* p = static_cast<std::byte*>( std::aligned_alloc( m_alignment, size ) );
+      if ( !p ) throw std::bad_alloc();
+      return Block{p, Recycler{shared_from_this(), size}};
+    }
+
+  private:
+    void recycle( std::byte* p, std::size_t size ) {
+      {
+        std::lock_guard lock( m_mutex );
+        if ( m_free.size() < m_maxFree ) {
+          m_free.emplace_back( p, size );
+          return;
+        }
+      }
+      std::free( p );
+    }
+
+    std::size_t                                    m_alignment;
+    std::size_t                                    m_maxFree;
+    std::mutex                                     m_mutex;
+    std::vector<std::pair<std::byte*, std::size_t>> m_free;
+  };
+
+} // namespace LHCb::MDF
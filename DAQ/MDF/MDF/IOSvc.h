@@ -11,7 +11,9 @@
 #pragma once
 
 #include "MDF/Buffer.h"
+#include "MDF/BufferPool.h"
 #include "MDF/IIOSvc.h"
+#include "MDF/MDFHeader.h"
 
 #include "Event/RawEvent.h"
 
@@ -38,6 +40,8 @@ namespace LHCb::MDF {
     using extends::extends;
     virtual ~IOSvc() = default;
 
+    /// Service initialization
+    StatusCode initialize() override;
     /// Service finalization
     StatusCode finalize() override;
 
@@ -50,15 +54,61 @@ namespace LHCb::MDF {
      */
     std::tuple<RawEvent, std::shared_ptr<Buffer>> next() override;
 
+    /**
+     * builds the events of the given MDF records, to be used by implementations when
+     * creating a Buffer. Uncompressed records are used in place, while compressed ones are
+     * decompressed in parallel into a single block taken from a pool
+     * Checksums are verified here when requested, or attached to the events to be
+     * verified by the consumer when VerifyChecksumsOnWorker is set
+     * @return the block holding the decompressed data, to be owned by the Buffer, or an
+     * empty block if no record was compressed
+     * @throws GaudiException if a record is corrupted or cannot be decompressed
+     */
+    BufferPool::Block decodeRecords( LHCb::span<MDFHeader* const> records, std::vector<MDFEvent>& events );
+
+  protected:
+    /**
+     * set of buffers events are dispatched from. There is a single one by default,
+     * and one per NUMA node when NUMAAware is set, so that events are served from
+     * memory local to the thread asking for them
+     */
+    struct Partition {
+      /// current Buffer to events
+      std::shared_ptr<Buffer> curBuffer{nullptr};
+      /// std::future holding the next buffer to use
+      std::future<std::shared_ptr<Buffer>> nextBuffer;
+      /// lock for handling the change of buffer
+      std::mutex changeBufferLock;
+    };
+
+    /**
+     * reads the next buffer of events from input
+     * Needs to be thread safe, as different partitions may call it concurrently
+     * @throws IIOSvc::EndOfInput
+     */
+    virtual std::shared_ptr<Buffer> prefetch() = 0;
+
+    /**
+     * fills the current and next buffers of the default partition. To be called by
+     * implementations at the end of their initialize, once the input is ready.
+     * In NUMAAware mode, nothing is read: each partition is filled by the first
+     * thread asking for an event from it, and thus on the right NUMA node
+     * @throws IIOSvc::EndOfInput
+     */
+    void prefetchInitialBuffers();
+
   private:
     /**
-     * preloads data into the next buffer
+     * preloads data into the next buffer of the given partition
      * Practically it first creates a task that will do the job,
-     * then fills m_nextBuffer with the future of this task,
+     * then fills partition.nextBuffer with the future of this task,
      * then releases the lock hold by the guard to release other
      * threads running on current buffer and finally does the job
      */
-    virtual void preloadNextBuffer( std::unique_lock<std::mutex>& guard ) = 0;
+    void preloadNextBuffer( Partition& partition, std::unique_lock<std::mutex>& guard );
+
+    /// partition to be used by the calling thread
+    Partition& currentPartition();
 
   protected:
     Gaudi::Property<unsigned int> m_bufferNbEvents{
@@ -66,14 +116,20 @@ namespace LHCb::MDF {
         "approximate size of the buffer used to prefetch rawbanks in terms of number of events. Default is 20000"};
     Gaudi::Property<std::vector<std::string>> m_input{this, "Input", {}, "List of inputs"};
     Gaudi::Property<unsigned int>             m_nbSkippedEvents{this, "NSkip", 0, "First event to process"};
+    Gaudi::Property<bool>                     m_numaAware{
+        this, "NUMAAware", false,
+        "Keep separate buffers per NUMA node, filled by and served to threads running on that node"};
+    Gaudi::Property<bool> m_verifyChecksums{this, "VerifyChecksums", false, "Verify the checksum of MDF records"};
+    Gaudi::Property<int>  m_checksumType{this, "ChecksumType", 1,
+                                        "Type of checksum of the input, see LHCb::genChecksum"};
+    Gaudi::Property<bool> m_verifyOnWorker{
+        this, "VerifyChecksumsOnWorker", false,
+        "Verify checksums when events are consumed, on the worker threads, rather than when prefetching them"};
 
-    /// current Buffer to events
-    std::shared_ptr<Buffer> m_curBuffer{nullptr};
-
-    /// std::future holding the next buffer to use
-    std::future<std::shared_ptr<Buffer>> m_nextBuffer;
-
-    /// lock for handling the change of buffer
-    std::mutex m_changeBufferLock;
+  private:
+    /// the partitions, one per NUMA node or a single one
+    std::vector<Partition> m_partitions;
+    /// memory for decompressed events
+    std::shared_ptr<BufferPool> m_decompressionPool;
   };
 } // namespace LHCb::MDF
@@ -65,14 +65,26 @@ namespace LHCb {
   /// Determine number of bank types from rawEvent object
   size_t numberOfBankTypes( const RawEvent* evt );
   /// Generate XOR Checksum
+  /** flag selects the checksum: 0 xor, 1 hash32, 2 crc32, 3 crc16, 4 crc8, 5 adler32,
+   * 6 crc32c (hardware accelerated where available)
+   */
   unsigned int genChecksum( int flag, const void* ptr, size_t len );
+  /// Check the checksum of an MDF record computed with the given flag. Records without checksum are accepted
+  bool checkMDFChecksum( const MDFHeader* h, int flag );
+  /// Compression codes of MDF records beyond the ZLIB levels 1-9 (low nibble of MDFHeader::compression())
+  enum MDFCompression { MDF_LZ4 = 10, MDF_LZ4HC = 11, MDF_ZSTD_FAST = 12, MDF_ZSTD = 13, MDF_ZSTD_HIGH = 14 };
+  /// Check whether the given compression code is supported by the ROOT version in use
+  bool compressionSupported( int algtype );
   /// Compress opaque data buffer
   /** The algorithm applied is the ROOT compression mechanism.
-   * Option "algtype" is used to specify the compression level:
+   * Option "algtype" is used to specify the algorithm and compression level:
    * compress = 0 objects written to this file will not be compressed.
-   * compress = 1 minimal compression level but fast.
+   * compress = 1 minimal ZLIB compression level but fast.
    * ....
-   * compress = 9 maximal compression level but slow.
+   * compress = 9 maximal ZLIB compression level but slow.
+   * compress = 10 (MDF_LZ4) LZ4, very fast decompression
+   * compress = 11 (MDF_LZ4HC) LZ4 high compression
+   * compress = 12-14 (MDF_ZSTD_FAST, MDF_ZSTD, MDF_ZSTD_HIGH) ZSTD, increasing levels
    */
   StatusCode compressBuffer( int algtype, char* tar, size_t tar_len, char* src, size_t src_len, size_t& new_len );
   /// Decompress opaque data buffer using the ROOT (de-)compression mechanism.
@@ -107,15 +107,16 @@ namespace {
    * It will try to fill the buffer unless input is empty
    * @param bufferSize the size of the buffer to allocate
    */
-  std::shared_ptr<LHCb::MDF::Buffer> prefetchEvents( InputHandler& input, unsigned int nbEvents ) {
+  std::shared_ptr<LHCb::MDF::Buffer> prefetchEvents( LHCb::MDF::IOSvc& ioSvc, InputHandler& input,
+                                                     unsigned int nbEvents ) {
     // allocate a new buffer according to requested size, taking 50K per event
     // 50K is low, this is to ensure that in most cases we will not reallocate the event vector
     unsigned int bufferSize = nbEvents * 50000;
     auto         buffer     = unique_ptr_free<std::byte>{reinterpret_cast<std::byte*>( std::malloc( bufferSize ) )};
     if ( nullptr == buffer ) { throw( "Unable to allocate memory for new buffer" ); }
-    // create associated events vector and reserve space
-    std::vector<LHCb::MDF::MDFEvent> events;
-    events.reserve( nbEvents );
+    // create associated records vector and reserve space
+    std::vector<LHCb::MDFHeader*> records;
+    records.reserve( nbEvents );
     // Fill buffer with banks while there is enough space and create associated events
     auto curBufPtr  = buffer.get();
     auto headerSize = sizeof( LHCb::MDFHeader );
@@ -136,11 +137,13 @@ namespace {
       }
       // enough space for rawbanks of the next event in buffer. Let's first copy the banks to the buffer
       input.read( {curBufPtr + headerSize, (long)( header->recordSize() - headerSize )} );
-      // now let's build the event and copy the raw banks
-      events.emplace_back( LHCb::span<std::byte>{(std::byte*)header->data(), header->size()} );
+      records.push_back( header );
       curBufPtr += header->recordSize();
     }
-    return std::make_shared<ByteBuffer>( std::move( buffer ), std::move( events ) );
+    // now let's build the events, decompressing them if needed
+    std::vector<LHCb::MDF::MDFEvent> events;
+    auto decompressed = ioSvc.decodeRecords( records, events );
+    return std::make_shared<ByteBuffer>( std::move( buffer ), std::move( events ), std::move( decompressed ) );
   }
 
 } // namespace
@@ -194,13 +197,15 @@ namespace LHCb::MDF {
 
   private:
     /**
-     * preloads data into the next buffer
+     * reads the next buffer of events from input
      */
-    void preloadNextBuffer( std::unique_lock<std::mutex>& guard ) override;
+    std::shared_ptr<LHCb::MDF::Buffer> prefetch() override;
 
   private:
     /// Helper Object for handling inputs
     std::unique_ptr<InputHandler> m_inputHandler{nullptr};
+    /// serializes the access to the input, for the case of several partitions prefetching
+    std::mutex m_inputLock;
 
     Gaudi::Property<std::string> m_ioMgrName{this, "DataManager", "Gaudi::IODataManager/IODataManager",
                                              "Name of the file manager service"};
@@ -228,12 +233,8 @@ StatusCode LHCb::MDF::IOSvcFileRead::initialize() {
     // connect to first input
     m_inputHandler = std::make_unique<InputHandler>( this, m_input.value(), ioMgr );
     m_inputHandler->skip( m_nbSkippedEvents );
-    // prefetch data in the current buffer
-    m_curBuffer = prefetchEvents( std::ref( *m_inputHandler ), m_bufferNbEvents.value() );
-    // and prefetch more data into the next buffer
-    std::packaged_task<std::shared_ptr<LHCb::MDF::Buffer>( InputHandler&, unsigned int )> task( prefetchEvents );
-    m_nextBuffer = task.get_future();
-    task( std::ref( *m_inputHandler ), m_bufferNbEvents.value() );
+    // prefetch data in the current and next buffers
+    prefetchInitialBuffers();
   } catch ( LHCb::IIOSvc::EndOfInput& e ) {
     error() << "Empty input in IOSvcFileRead" << endmsg;
     return StatusCode::FAILURE;
@@ -241,13 +242,7 @@ StatusCode LHCb::MDF::IOSvcFileRead::initialize() {
   return sc;
 }
 
-void LHCb::MDF::IOSvcFileRead::preloadNextBuffer( std::unique_lock<std::mutex>& guard ) {
-  // use a task, and associate its future to next buffer
-  std::packaged_task<std::shared_ptr<LHCb::MDF::Buffer>( InputHandler&, unsigned int )> task( prefetchEvents );
-  m_nextBuffer = task.get_future();
-  // now that next buffer is set, we can unlock to let other theads consume the current buffer
-  // while we are preloading the next one
-  guard.unlock();
-  // and preload data into the next bufferby running the task
-  task( std::ref( *this->m_inputHandler ), this->m_bufferNbEvents.value() );
+std::shared_ptr<LHCb::MDF::Buffer> LHCb::MDF::IOSvcFileRead::prefetch() {
+  std::lock_guard lock( m_inputLock );
+  return prefetchEvents( *this, *m_inputHandler, m_bufferNbEvents.value() );
 }
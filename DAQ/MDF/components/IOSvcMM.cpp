@@ -83,18 +83,18 @@ namespace {
    * in case the current mapped files does not contain enough events, only prefetches from that file anyway
    * @param bufferSize the size of the buffer to allocate
    */
-  std::shared_ptr<LHCb::MDF::Buffer> prefetchEvents( InputHandler& input, unsigned int nbEvents ) {
-    // prepare a vector to host events and reserve space
-    std::vector<LHCb::MDF::MDFEvent> events;
-    events.reserve( nbEvents );
+  std::shared_ptr<LHCb::MDF::Buffer> prefetchEvents( LHCb::MDF::IOSvc& ioSvc, InputHandler& input,
+                                                     unsigned int nbEvents ) {
+    // prepare a vector to host records and reserve space
+    std::vector<LHCb::MDFHeader*> records;
+    records.reserve( nbEvents );
     // get hold of current mapped files
     auto mmapBuffer = input.curMappedFile();
     // Fill buffer with banks while there is enough space and create associated events
     try {
       for ( unsigned int i = 0; i < nbEvents; i++ ) {
         auto* header = input.readNextEventHeader();
-        // now let's build the event and copy the raw banks
-        events.emplace_back( LHCb::span<std::byte>{(std::byte*)header->data(), header->size()} );
+        records.push_back( header );
         input.skip( *header );
       }
     } catch ( InputHandler::EndOfFile& e ) {
@@ -102,9 +102,12 @@ namespace {
     } catch ( LHCb::IIOSvc::EndOfInput& e ) {
       // we've reached the end of the input
       // if we have no data rethrow
-      if ( events.size() == 0 ) throw e;
+      if ( records.size() == 0 ) throw e;
     }
-    return std::make_shared<MMapBuffer>( std::move( mmapBuffer ), std::move( events ) );
+    // now let's build the events, decompressing them if needed
+    std::vector<LHCb::MDF::MDFEvent> events;
+    auto decompressed = ioSvc.decodeRecords( records, events );
+    return std::make_shared<MMapBuffer>( std::move( mmapBuffer ), std::move( events ), std::move( decompressed ) );
   }
 
 } // namespace
@@ -155,22 +158,24 @@ namespace LHCb::MDF {
 
   private:
     /**
-     * preloads data into the next buffer
+     * reads the next buffer of events from input
      */
-    void preloadNextBuffer( std::unique_lock<std::mutex>& guard ) override;
+    std::shared_ptr<LHCb::MDF::Buffer> prefetch() override;
 
   private:
     /// Helper Object for handling inputs
     std::unique_ptr<InputHandler> m_inputHandler{nullptr};
+    /// serializes the access to the input, for the case of several partitions prefetching
+    std::mutex m_inputLock;
   };
 } // namespace LHCb::MDF
 
 DECLARE_COMPONENT( LHCb::MDF::IOSvcMM )
 
 StatusCode LHCb::MDF::IOSvcMM::initialize() {
-  StatusCode sc = Service::initialize();
+  StatusCode sc = IOSvc::initialize();
   if ( !sc.isSuccess() ) {
-    error() << "Unable to initialize base class Service." << endmsg;
+    error() << "Unable to initialize base class IOSvc." << endmsg;
     return sc;
   }
   try {
@@ -179,12 +184,8 @@ StatusCode LHCb::MDF::IOSvcMM::initialize() {
     // connect to first input
     m_inputHandler = std::make_unique<InputHandler>( this, m_input.value() );
     m_inputHandler->skip( m_nbSkippedEvents );
-    // prefetch data in the current buffer
-    m_curBuffer = prefetchEvents( std::ref( *m_inputHandler ), m_bufferNbEvents.value() );
-    // and prefetch more data into the next buffer
-    std::packaged_task<std::shared_ptr<LHCb::MDF::Buffer>( InputHandler&, unsigned int )> task( prefetchEvents );
-    m_nextBuffer = task.get_future();
-    task( std::ref( *m_inputHandler ), m_bufferNbEvents.value() );
+    // prefetch data in the current and next buffers
+    prefetchInitialBuffers();
   } catch ( EndOfInput& e ) {
     error() << "Empty input in IOSvc" << endmsg;
     return StatusCode::FAILURE;
@@ -192,13 +193,7 @@ StatusCode LHCb::MDF::IOSvcMM::initialize() {
   return sc;
 }
 
-void LHCb::MDF::IOSvcMM::preloadNextBuffer( std::unique_lock<std::mutex>& guard ) {
-  // use a task, and associate its future to next buffer
-  std::packaged_task<std::shared_ptr<LHCb::MDF::Buffer>( InputHandler&, unsigned int )> task( prefetchEvents );
-  m_nextBuffer = task.get_future();
-  // now that next buffer is set, we can unlock to let other theads consume the current buffer
-  // while we are preloading the next one
-  guard.unlock();
-  // and preload data into the next bufferby running the task
-  task( std::ref( *this->m_inputHandler ), this->m_bufferNbEvents.value() );
+std::shared_ptr<LHCb::MDF::Buffer> LHCb::MDF::IOSvcMM::prefetch() {
+  std::lock_guard lock( m_inputLock );
+  return prefetchEvents( *this, *m_inputHandler, m_bufferNbEvents.value() );
 }
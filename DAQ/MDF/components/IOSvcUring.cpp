@@ -0,0 +1,525 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// io_uring is only available with recent kernel headers (>= 5.1)
+#if __has_include( <linux/io_uring.h> )
+
+#  include "MDF/Buffer.h"
+#  include "MDF/BufferPool.h"
+#  include "MDF/IOSvc.h"
+#  include "MDF/MDFHeader.h"
+
+#  include <cerrno>
+#  include <cstdint>
+#  include <cstdlib>
+#  include <cstring>
+#  include <deque>
+#  include <memory>
+#  include <mutex>
+#  include <string>
+#  include <vector>
+
+#  include <fcntl.h>
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+
+#  ifndef __NR_io_uring_setup
+#    define __NR_io_uring_setup 425
+#  endif
+#  ifndef __NR_io_uring_enter
+#    define __NR_io_uring_enter 426
+#  endif
+
+namespace {
+
+  /// alignment of memory, offsets and sizes for O_DIRECT reads
+  constexpr std::size_t s_alignment = 4096;
+
+  constexpr std::size_t alignUp( std::size_t n ) { return ( n + s_alignment - 1 ) / s_alignment * s_alignment; }
+
+  std::string errnoString( int err ) { return std::strerror( err ); }
+
+  /**
+   * minimal wrapper around an io_uring instance, using the raw system calls so that
+   * no dependency on liburing is needed. Not thread safe, used by a single reader.
+   */
+  class IOUring {
+  public:
+    /// @throws std::string in case the ring cannot be created
+    IOUring( unsigned entries ) {
+      io_uring_params params{};
+      m_fd = syscall( __NR_io_uring_setup, entries, &params );
+      if ( m_fd < 0 ) throw "io_uring_setup failed : " + errnoString( errno );
+      m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+      m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+      m_sqesSize   = params.sq_entries * sizeof( io_uring_sqe );
+      m_sqRing = mmap( nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING );
+      m_cqRing = mmap( nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING );
+      m_sqes   = mmap( nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES );
+      if ( m_sqRing == MAP_FAILED || m_cqRing == MAP_FAILED || m_sqes == MAP_FAILED ) {
+        auto err = errno;
+        release();
+        throw "unable to map io_uring : " + errnoString( err );
+      }
+      auto* sq  = static_cast<char*>( m_sqRing );
+      m_sqTail  = reinterpret_cast<unsigned*>( sq + params.sq_off.tail );
+      m_sqMask  = reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask );
+      m_sqArray = reinterpret_cast<unsigned*>( sq + params.sq_off.array );
+      auto* cq  = static_cast<char*>( m_cqRing );
+      m_cqHead  = reinterpret_cast<unsigned*>( cq + params.cq_off.head );
+      m_cqTail  = reinterpret_cast<unsigned*>( cq + params.cq_off.tail );
+      m_cqMask  = reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask );
+      m_cqes    = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes );
+      m_entries = params.sq_entries;
+    }
+    ~IOUring() { release(); }
+    IOUring( IOUring const& ) = delete;
+    IOUring& operator=( IOUring const& ) = delete;
+
+    /// number of submission entries
+    unsigned entries() const { return m_entries; }
+
+    /// queues a read, submitted with the next call to submit. iov must stay valid until completion
+    void prepareRead( int fd, iovec* iov, std::uint64_t offset, std::uint64_t userData ) {
+      auto const tail  = *m_sqTail; // only written by us
+      auto const index = tail & *m_sqMask;
+      auto&      sqe   = static_cast<io_uring_sqe*>( m_sqes )[index];
+      std::memset( &sqe, 0, sizeof( sqe ) );
+      sqe.opcode    = IORING_OP_READV;
+      sqe.fd        = fd;
+      sqe.addr      = reinterpret_cast<std::uint64_t>( iov );
+      sqe.len       = 1;
+      sqe.off       = offset;
+      sqe.user_data = userData;
+      m_sqArray[index] = index;
+      __atomic_store_n( m_sqTail, tail + 1, __ATOMIC_RELEASE );
+      ++m_toSubmit;
+    }
+
+    /// submits queued reads and waits for at least minComplete completions
+    void submit( unsigned minComplete ) {
+      while ( m_toSubmit > 0 || minComplete > 0 ) {
+        auto ret = syscall( __NR_io_uring_enter, m_fd, m_toSubmit, minComplete,
+                            minComplete > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0 );
+        if ( ret < 0 ) {
+          if ( errno == EINTR ) continue;
+          throw "io_uring_enter failed : " + errnoString( errno );
+        }
+        m_toSubmit -= ret;
+        break;
+      }
+    }
+
+    /// calls f( userData, result ) for all available completions
+    template <typename F>
+    void reap( F&& f ) {
+      for ( auto head = *m_cqHead; head != __atomic_load_n( m_cqTail, __ATOMIC_ACQUIRE ); ++head ) {
+        auto const& cqe      = m_cqes[head & *m_cqMask];
+        auto const  userData = cqe.user_data;
+        auto const  res      = cqe.res;
+        // consume the entry before calling f, so that it is never seen twice even if f throws
+        __atomic_store_n( m_cqHead, head + 1, __ATOMIC_RELEASE );
+        f( userData, res );
+      }
+    }
+
+    /// closes the ring, the kernel stops writing to the buffers of the reads in flight
+    void close() { release(); }
+
+  private:
+    void release() {
+      if ( m_sqes && m_sqes != MAP_FAILED ) munmap( m_sqes, m_sqesSize );
+      if ( m_cqRing && m_cqRing != MAP_FAILED ) munmap( m_cqRing, m_cqRingSize );
+      if ( m_sqRing && m_sqRing != MAP_FAILED ) munmap( m_sqRing, m_sqRingSize );
+      if ( m_fd >= 0 ) ::close( m_fd );
+      m_sqes = m_cqRing = m_sqRing = nullptr;
+      m_fd                         = -1;
+    }
+
+    int           m_fd{-1};
+    void*         m_sqRing{nullptr};
+    void*         m_cqRing{nullptr};
+    void*         m_sqes{nullptr};
+    std::size_t   m_sqRingSize{0}, m_cqRingSize{0}, m_sqesSize{0};
+    unsigned*     m_sqTail{nullptr};
+    unsigned*     m_sqMask{nullptr};
+    unsigned*     m_sqArray{nullptr};
+    unsigned*     m_cqHead{nullptr};
+    unsigned*     m_cqTail{nullptr};
+    unsigned*     m_cqMask{nullptr};
+    io_uring_cqe* m_cqes{nullptr};
+    unsigned      m_entries{0};
+    unsigned      m_toSubmit{0};
+  };
+
+  using LHCb::MDF::BufferPool;
+  using UringBuffer = LHCb::MDF::OwningBuffer<BufferPool::Block>;
+
+  /**
+   * reader of MDF files through io_uring
+   *
+   * Files are read sequentially in chunks of chunkSize bytes, each of them being split into
+   * reads of blockSize bytes. Up to depth reads are kept in flight, spanning as many chunks
+   * as needed, so that the device is kept busy while events are parsed and consumed.
+   * Each chunk is preceded in memory by a carry area of maxEventSize bytes, where the
+   * incomplete record at the end of the previous chunk is copied, so that records are always
+   * contiguous in memory.
+   */
+  class URingReader {
+  public:
+    struct Config {
+      std::size_t chunkSize;
+      std::size_t blockSize;
+      std::size_t maxEventSize;
+      unsigned    depth;
+      unsigned    maxFreeChunks;
+      bool        direct;
+    };
+
+    URingReader( LHCb::MDF::IOSvc* ioSvc, std::vector<std::string> const& input, Config const& config )
+        : m_ioSvc( ioSvc )
+        , m_input( input )
+        , m_config( config )
+        , m_ring( config.depth )
+        , m_pool( std::make_shared<BufferPool>( s_alignment, config.maxFreeChunks ) ) {
+      openCurrentInput();
+    }
+    ~URingReader() {
+      // we cannot free memory the kernel may still write to: wait for the reads in flight,
+      // whatever their result, then close the ring before the chunks are freed
+      while ( m_inFlight > 0 ) {
+        auto const inFlight = m_inFlight;
+        try {
+          complete( 1 );
+        } catch ( std::string const& e ) {
+          m_ioSvc->error() << e << endmsg;
+          // no completion could be waited for
+          if ( m_inFlight == inFlight ) break;
+        }
+      }
+      m_ring.close();
+      if ( m_fd >= 0 ) close( m_fd );
+    }
+
+    /**
+     * returns a buffer containing all complete events of the next chunk
+     * @throws IIOSvc::EndOfInput
+     */
+    std::shared_ptr<LHCb::MDF::Buffer> next( unsigned int& nbToSkip );
+
+  private:
+    struct Chunk;
+    struct Request {
+      Chunk*        chunk;
+      iovec         iov;
+      std::uint64_t offset;
+    };
+    struct Chunk {
+      BufferPool::Block    memory;
+      std::uint64_t        fileOffset{0};
+      std::size_t          length{0};    // bytes to read in total
+      std::size_t          submitted{0}; // bytes requested so far
+      std::size_t          bytesRead{0};
+      unsigned             inFlight{0};
+      std::size_t          carrySize{0};
+      std::vector<Request> requests;
+      /// start of the data read from file, after the carry area
+      std::byte* data() { return memory.get() + carrySize; }
+    };
+
+    /// opens the current input, skipping the ones failing
+    /// @throws IIOSvc::EndOfInput
+    void openCurrentInput();
+    /// submits reads until depth reads are in flight or the file is fully requested
+    void fillPipeline();
+    /// handles available completions, waiting for at least minComplete
+    void complete( unsigned minComplete );
+    /// waits for all reads in flight
+    void drain() {
+      while ( m_inFlight > 0 ) complete( 1 );
+    }
+
+    LHCb::MDF::IOSvc*               m_ioSvc;
+    std::vector<std::string> const& m_input;
+    Config                          m_config;
+    IOUring                         m_ring;
+    std::shared_ptr<BufferPool>     m_pool;
+    unsigned int                    m_curInput{0};
+    int                             m_fd{-1};
+    bool                            m_direct{false}; // m_fd opened with O_DIRECT
+    std::uint64_t                   m_fileSize{0};
+    std::uint64_t                   m_nextOffset{0};
+    unsigned                        m_inFlight{0};
+    std::deque<Chunk>               m_chunks;
+    /// incomplete record at the end of the last parsed chunk
+    std::vector<std::byte> m_carry;
+  };
+
+  void URingReader::openCurrentInput() {
+    for ( ; m_curInput < m_input.size(); ++m_curInput ) {
+      auto const& name = m_input[m_curInput];
+      m_fd             = m_config.direct ? open( name.c_str(), O_RDONLY | O_DIRECT ) : -1;
+      m_direct         = m_fd >= 0;
+      // e.g. tmpfs does not support O_DIRECT
+      if ( m_fd < 0 ) m_fd = open( name.c_str(), O_RDONLY );
+      if ( m_fd < 0 ) {
+        m_ioSvc->error() << "could not open input " << name << " : " << errnoString( errno ) << endmsg;
+        continue;
+      }
+      struct stat st;
+      if ( fstat( m_fd, &st ) != 0 ) {
+        m_ioSvc->error() << "could not stat input " << name << " : " << errnoString( errno ) << endmsg;
+        close( m_fd );
+        m_fd = -1;
+        continue;
+      }
+      m_fileSize   = st.st_size;
+      m_nextOffset = 0;
+      return;
+    }
+    throw LHCb::IIOSvc::EndOfInput();
+  }
+
+  void URingReader::fillPipeline() {
+    while ( m_fd >= 0 && m_inFlight < m_ring.entries() && m_inFlight < m_config.depth ) {
+      if ( m_chunks.empty() || m_chunks.back().submitted == m_chunks.back().length ) {
+        // all requested for the last chunk, start a new one if the file is not fully requested
+        if ( m_nextOffset >= m_fileSize ) break;
+        auto& chunk       = m_chunks.emplace_back();
+        chunk.memory      = m_pool->get( m_config.maxEventSize + m_config.chunkSize );
+        chunk.carrySize   = m_config.maxEventSize;
+        chunk.fileOffset  = m_nextOffset;
+        chunk.length      = std::min<std::uint64_t>( m_config.chunkSize, m_fileSize - m_nextOffset );
+        chunk.requests.reserve( m_config.chunkSize / m_config.blockSize + 1 );
+        m_nextOffset += chunk.length;
+      }
+      auto& chunk = m_chunks.back();
+      // O_DIRECT needs aligned sizes, the end of the file is handled by the short read
+      auto const size   = alignUp( std::min( m_config.blockSize, chunk.length - chunk.submitted ) );
+      auto&      req    = chunk.requests.emplace_back();
+      req.chunk         = &chunk;
+      req.iov.iov_base  = chunk.data() + chunk.submitted;
+      req.iov.iov_len   = size;
+      req.offset        = chunk.fileOffset + chunk.submitted;
+      chunk.submitted   = std::min( chunk.length, chunk.submitted + size );
+      m_ring.prepareRead( m_fd, &req.iov, req.offset, reinterpret_cast<std::uint64_t>( &req ) );
+      ++chunk.inFlight;
+      ++m_inFlight;
+    }
+    m_ring.submit( 0 );
+  }
+
+  void URingReader::complete( unsigned minComplete ) {
+    m_ring.submit( minComplete );
+    // the first error is reported once all the available completions are accounted for
+    std::string error;
+    m_ring.reap( [&]( std::uint64_t userData, int res ) {
+      auto& req = *reinterpret_cast<Request*>( userData );
+      --m_inFlight;
+      if ( res < 0 ) {
+        --req.chunk->inFlight;
+        if ( error.empty() ) error = "read error on " + m_input[m_curInput] + " : " + errnoString( -res );
+        return;
+      }
+      auto const wanted = std::min<std::uint64_t>( req.iov.iov_len, m_fileSize - req.offset );
+      // with O_DIRECT the offset and the length must stay aligned, so after a short read the
+      // last incomplete block is read again
+      auto const done = m_direct && static_cast<std::uint64_t>( res ) < wanted
+                            ? static_cast<std::size_t>( res ) / s_alignment * s_alignment
+                            : static_cast<std::size_t>( res );
+      if ( done == 0 && wanted > 0 ) {
+        // no progress before the expected end of file
+        --req.chunk->inFlight;
+        if ( error.empty() )
+          error = "truncated input " + m_input[m_curInput] + " : end of file at offset " +
+                  std::to_string( req.offset + res ) + " instead of " + std::to_string( m_fileSize );
+        return;
+      }
+      if ( done < wanted ) {
+        // short read before the end of file, request the rest
+        req.iov.iov_base = static_cast<std::byte*>( req.iov.iov_base ) + done;
+        req.iov.iov_len -= done;
+        req.offset += done;
+        req.chunk->bytesRead += done;
+        m_ring.prepareRead( m_fd, &req.iov, req.offset, userData );
+        ++m_inFlight;
+        return;
+      }
+      req.chunk->bytesRead += wanted;
+      --req.chunk->inFlight;
+    } );
+    if ( !error.empty() ) throw error;
+  }
+
+  std::shared_ptr<LHCb::MDF::Buffer> URingReader::next( unsigned int& nbToSkip ) {
+    while ( true ) {
+      fillPipeline();
+      if ( m_chunks.empty() ) {
+        // current file is over, go to next one
+        if ( !m_carry.empty() ) {
+          m_ioSvc->warning() << "Truncated record of " << m_carry.size() << " bytes at the end of "
+                             << m_input[m_curInput] << ", ignoring it" << endmsg;
+          m_carry.clear();
+        }
+        m_ioSvc->info() << "Over with input from " << m_input[m_curInput] << endmsg;
+        close( m_fd );
+        m_fd = -1;
+        ++m_curInput;
+        openCurrentInput();
+        continue;
+      }
+      auto& chunk = m_chunks.front();
+      while ( chunk.inFlight > 0 || chunk.submitted < chunk.length ) {
+        complete( 1 );
+        fillPipeline();
+      }
+      // chunk is complete, prepend the carried incomplete record
+      auto* begin = chunk.data() - m_carry.size();
+      if ( !m_carry.empty() ) std::memcpy( begin, m_carry.data(), m_carry.size() );
+      auto* const end = chunk.data() + chunk.bytesRead;
+      m_carry.clear();
+
+      std::vector<LHCb::MDFHeader*> records;
+      auto*                         cur = begin;
+      while ( cur + sizeof( LHCb::MDFHeader ) <= end ) {
+        auto*      header     = reinterpret_cast<LHCb::MDFHeader*>( cur );
+        auto const recordSize = header->recordSize();
+        if ( recordSize < LHCb::MDFHeader::sizeOf( header->headerVersion() ) ) {
+          throw "corrupted MDF record in " + m_input[m_curInput] + " at offset " +
+              std::to_string( chunk.fileOffset - ( chunk.data() - cur ) );
+        }
+        if ( cur + recordSize > end ) break;
+        if ( nbToSkip > 0 ) {
+          --nbToSkip;
+        } else {
+          records.push_back( header );
+        }
+        cur += recordSize;
+      }
+      if ( static_cast<std::size_t>( end - cur ) > m_config.maxEventSize ) {
+        throw "MDF record larger than MaxEventSize in " + m_input[m_curInput];
+      }
+      m_carry.assign( cur, end );
+
+      auto memory = std::move( chunk.memory );
+      m_chunks.pop_front();
+      if ( !records.empty() ) {
+        std::vector<LHCb::MDF::MDFEvent> events;
+        auto                             decompressed = m_ioSvc->decodeRecords( records, events );
+        return std::make_shared<UringBuffer>( std::move( memory ), std::move( events ), std::move( decompressed ) );
+      }
+    }
+  }
+
+} // namespace
+
+namespace LHCb::MDF {
+
+  /**
+   * Implementation of IOSvc reading MDF files via io_uring
+   *
+   * Large aligned reads are queued (optionally with O_DIRECT, bypassing the page cache)
+   * with a configurable readahead depth, and the event buffers are recycled through a pool.
+   * This allows a single reader to feed many worker threads without page faults.
+   * Each prefetched Buffer corresponds to one chunk of ChunkSize bytes of the input.
+   */
+  class IOSvcUring : public IOSvc {
+
+  public:
+    using IOSvc::IOSvc;
+    /// Service initialization
+    StatusCode initialize() override;
+    /// Service finalization
+    StatusCode finalize() override;
+
+  private:
+    /**
+     * reads the next buffer of events from input
+     */
+    std::shared_ptr<LHCb::MDF::Buffer> prefetch() override;
+
+  private:
+    Gaudi::Property<unsigned int> m_depth{this, "ReadaheadDepth", 8, "Maximum number of reads in flight"};
+    Gaudi::Property<unsigned int> m_blockSize{this, "BlockSize", 4 * 1024 * 1024, "Size of a single read, in bytes"};
+    Gaudi::Property<unsigned int> m_chunkSize{this, "ChunkSize", 64 * 1024 * 1024,
+                                              "Size of the chunks of input events are served from, in bytes"};
+    Gaudi::Property<unsigned int> m_maxEventSize{this, "MaxEventSize", 4 * 1024 * 1024,
+                                                 "Maximum size of an MDF record, in bytes"};
+    Gaudi::Property<unsigned int> m_maxFreeChunks{this, "MaxFreeChunks", 4,
+                                                  "Maximum number of unused chunks kept for recycling"};
+    Gaudi::Property<bool> m_direct{this, "UseODirect", true, "Bypass the page cache, if supported by the filesystem"};
+
+    /// Helper Object for handling inputs
+    std::unique_ptr<URingReader> m_reader{nullptr};
+    /// serializes the access to the input, for the case of several partitions prefetching
+    std::mutex m_inputLock;
+    /// number of events still to be skipped
+    unsigned int m_nbToSkip{0};
+  };
+} // namespace LHCb::MDF
+
+DECLARE_COMPONENT( LHCb::MDF::IOSvcUring )
+
+StatusCode LHCb::MDF::IOSvcUring::initialize() {
+  StatusCode sc = IOSvc::initialize();
+  if ( !sc.isSuccess() ) {
+    error() << "Unable to initialize base class IOSvc." << endmsg;
+    return sc;
+  }
+  try {
+    // check there are inputs
+    if ( m_input.value().size() == 0 ) throw EndOfInput();
+    auto const blockSize = alignUp( m_blockSize.value() );
+    auto const config    = URingReader::Config{std::max( alignUp( m_chunkSize.value() ), blockSize ),
+                                            blockSize,
+                                            alignUp( m_maxEventSize.value() ),
+                                            std::max( 1u, m_depth.value() ),
+                                            m_maxFreeChunks.value(),
+                                            m_direct.value()};
+    m_nbToSkip           = m_nbSkippedEvents;
+    // connect to first input
+    m_reader = std::make_unique<URingReader>( this, m_input.value(), config );
+    // prefetch data in the current and next buffers
+    prefetchInitialBuffers();
+  } catch ( EndOfInput& e ) {
+    error() << "Empty input in IOSvcUring" << endmsg;
+    return StatusCode::FAILURE;
+  } catch ( std::string const& e ) {
+    error() << e << endmsg;
+    return StatusCode::FAILURE;
+  }
+  return sc;
+}
+
+StatusCode LHCb::MDF::IOSvcUring::finalize() {
+  auto sc = IOSvc::finalize();
+  m_reader.reset();
+  return sc;
+}
+
+std::shared_ptr<LHCb::MDF::Buffer> LHCb::MDF::IOSvcUring::prefetch() {
+  std::lock_guard lock( m_inputLock );
+  try {
+    return m_reader->next( m_nbToSkip );
+  } catch ( std::string const& e ) {
+    // read errors are handled as the end of the input, as in the other implementations
+    error() << e << endmsg;
+    throw EndOfInput();
+  } catch ( std::runtime_error const& e ) {
+    error() << e.what() << endmsg;
+    throw EndOfInput();
+  }
+}
+
+#endif
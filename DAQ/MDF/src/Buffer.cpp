@@ -10,6 +10,7 @@
 \*****************************************************************************/
 
 #include "MDF/Buffer.h"
+#include "MDF/RawEventHelpers.h"
 #include "MDF/RawEventPrintout.h"
 
 #include "GaudiKernel/GaudiException.h"
@@ -21,6 +22,10 @@ std::optional<LHCb::RawEvent> LHCb::MDF::Buffer::get() {
   if ( evtId <= 0 ) return {};
   /// get the event we've picked
   auto& event = m_events[size() - evtId];
+  // verify the checksum, when it was not done while prefetching
+  if ( event.record() && !checkMDFChecksum( event.record(), event.checksumType() ) ) {
+    throw GaudiException( "Data corruption, invalid checksum of MDF record", "MDF::Buffer", StatusCode::FAILURE );
+  }
   // Decode banks of the event
   event.event().reserve( 1000 ); // reserving enough space for all banks in most cases
   std::byte* start = event.data();
@@ -0,0 +1,122 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "Checksums.h"
+
+#include "LHCbMath/CPUDispatch.h"
+
+#include <array>
+#include <utility>
+
+namespace {
+  constexpr std::array<unsigned int, 256> makeCRC32CTable() {
+    std::array<unsigned int, 256> table{};
+    for ( unsigned int i = 0; i < 256; i++ ) {
+      unsigned int crc = i;
+      for ( int j = 0; j < 8; j++ ) crc = ( crc >> 1 ) ^ ( ( crc & 1 ) ? 0x82F63B78 : 0 );
+      table[i] = crc;
+    }
+    return table;
+  }
+  constexpr auto s_crc32cTable = makeCRC32CTable();
+} // namespace
+
+unsigned int LHCb::MDF::Checksum::generic::xor32( const int* ptr, std::size_t nWords ) {
+  unsigned int checksum = 0;
+  for ( const int *p = ptr, *end = p + nWords; p < end; ++p ) { checksum ^= *p; }
+  return checksum;
+}
+
+/* ========================================================================= */
+unsigned int LHCb::MDF::Checksum::generic::adler32( unsigned int adler, const char* buf, std::size_t len ) {
+#define DO1( buf, i )                                                                                                  \
+  {                                                                                                                    \
+    s1 += (unsigned char)buf[i];                                                                                       \
+    s2 += s1;                                                                                                          \
+  }
+#define DO2( buf, i )                                                                                                  \
+  DO1( buf, i );                                                                                                       \
+  DO1( buf, i + 1 );
+#define DO4( buf, i )                                                                                                  \
+  DO2( buf, i );                                                                                                       \
+  DO2( buf, i + 2 );
+#define DO8( buf, i )                                                                                                  \
+  DO4( buf, i );                                                                                                       \
+  DO4( buf, i + 4 );
+#define DO16( buf )                                                                                                    \
+  DO8( buf, 0 );                                                                                                       \
+  DO8( buf, 8 );
+
+  static const unsigned int BASE = 65521; /* largest prime smaller than 65536 */
+  /* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+  static const unsigned int NMAX = 5550;
+  unsigned int              s1   = adler & 0xffff;
+  unsigned int              s2   = ( adler >> 16 ) & 0xffff;
+  int                       k;
+
+  if ( buf == NULL ) return 1;
+
+  while ( len > 0 ) {
+    k = len < NMAX ? (int)len : NMAX;
+    len -= k;
+    while ( k >= 16 ) {
+      DO16( buf );
+      buf += 16;
+      k -= 16;
+    }
+    if ( k != 0 ) do {
+        s1 += (unsigned char)*buf++;
+        s2 += s1;
+      } while ( --k );
+    s1 %= BASE;
+    s2 %= BASE;
+  }
+  unsigned int result = ( s2 << 16 ) | s1;
+  return result;
+#undef DO1
+#undef DO2
+#undef DO4
+#undef DO8
+#undef DO16
+}
+/* ========================================================================= */
+
+unsigned int LHCb::MDF::Checksum::generic::crc32c( unsigned int crc, const char* buf, std::size_t len ) {
+  crc = ~crc;
+  while ( len-- ) crc = s_crc32cTable[( crc ^ (unsigned char)*buf++ ) & 0xff] ^ ( crc >> 8 );
+  return ~crc;
+}
+
+unsigned int LHCb::MDF::Checksum::xor32( const int* ptr, std::size_t nWords ) {
+  static const auto impl = [] {
+    auto vtbl = {std::pair{LHCb::CPU::AVX2, &avx2::xor32}, std::pair{LHCb::CPU::SSE4, &sse4::xor32},
+                 std::pair{LHCb::CPU::GENERIC, &generic::xor32}};
+    return LHCb::CPU::dispatch( vtbl );
+  }();
+  return ( *impl )( ptr, nWords );
+}
+
+unsigned int LHCb::MDF::Checksum::adler32( unsigned int adler, const char* buf, std::size_t len ) {
+  static const auto impl = [] {
+    auto vtbl = {std::pair{LHCb::CPU::AVX2, &avx2::adler32}, std::pair{LHCb::CPU::SSE4, &sse4::adler32},
+                 std::pair{LHCb::CPU::GENERIC, &generic::adler32}};
+    return LHCb::CPU::dispatch( vtbl );
+  }();
+  if ( buf == nullptr ) return 1;
+  return ( *impl )( adler, buf, len );
+}
+
+unsigned int LHCb::MDF::Checksum::crc32c( unsigned int crc, const char* buf, std::size_t len ) {
+  static const auto impl = [] {
+    auto vtbl = {std::pair{LHCb::CPU::SSE4, &sse4::crc32c}, std::pair{LHCb::CPU::GENERIC, &generic::crc32c}};
+    return LHCb::CPU::dispatch( vtbl );
+  }();
+  return ( *impl )( crc, buf, len );
+}
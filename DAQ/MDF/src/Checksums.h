@@ -0,0 +1,47 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Implementations of the MDF checksums for the different instruction sets.
+ * The functions at namespace level select the best implementation for the
+ * running CPU on first use, see LHCb::CPU::dispatch. All implementations of
+ * a given checksum give bit-identical results.
+ */
+namespace LHCb::MDF::Checksum {
+
+  namespace generic {
+    /// xor of nWords 32 bits words
+    unsigned int xor32( const int* ptr, std::size_t nWords );
+    /// Adler32 checksum, as defined by zlib, continuing from adler
+    unsigned int adler32( unsigned int adler, const char* buf, std::size_t len );
+    /// CRC32C (Castagnoli polynomial), as computed by the SSE4.2 crc32 instruction, continuing from crc
+    unsigned int crc32c( unsigned int crc, const char* buf, std::size_t len );
+  } // namespace generic
+
+  namespace sse4 {
+    unsigned int xor32( const int* ptr, std::size_t nWords );
+    unsigned int adler32( unsigned int adler, const char* buf, std::size_t len );
+    unsigned int crc32c( unsigned int crc, const char* buf, std::size_t len );
+  } // namespace sse4
+
+  namespace avx2 {
+    unsigned int xor32( const int* ptr, std::size_t nWords );
+    unsigned int adler32( unsigned int adler, const char* buf, std::size_t len );
+  } // namespace avx2
+
+  unsigned int xor32( const int* ptr, std::size_t nWords );
+  unsigned int adler32( unsigned int adler, const char* buf, std::size_t len );
+  unsigned int crc32c( unsigned int crc, const char* buf, std::size_t len );
+
+} // namespace LHCb::MDF::Checksum
@@ -0,0 +1,84 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "Checksums.h"
+
+#include <x86intrin.h>
+
+#include <algorithm>
+
+namespace {
+  constexpr unsigned int BASE = 65521; // largest prime smaller than 65536
+  constexpr unsigned int NMAX = 5552;  // largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1
+  constexpr std::size_t  BLOCK_SIZE = 32;
+
+  unsigned int hsum( __m256i v ) {
+    __m128i s = _mm_add_epi32( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) );
+    s         = _mm_add_epi32( s, _mm_shuffle_epi32( s, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    s         = _mm_add_epi32( s, _mm_shuffle_epi32( s, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    return _mm_cvtsi128_si32( s );
+  }
+} // namespace
+
+unsigned int LHCb::MDF::Checksum::avx2::xor32( const int* ptr, std::size_t nWords ) {
+  __m256i     acc0 = _mm256_setzero_si256();
+  __m256i     acc1 = _mm256_setzero_si256();
+  std::size_t i    = 0;
+  for ( ; i + 16 <= nWords; i += 16 ) {
+    acc0 = _mm256_xor_si256( acc0, _mm256_loadu_si256( reinterpret_cast<const __m256i*>( ptr + i ) ) );
+    acc1 = _mm256_xor_si256( acc1, _mm256_loadu_si256( reinterpret_cast<const __m256i*>( ptr + i + 8 ) ) );
+  }
+  acc0      = _mm256_xor_si256( acc0, acc1 );
+  __m128i s = _mm_xor_si128( _mm256_castsi256_si128( acc0 ), _mm256_extracti128_si256( acc0, 1 ) );
+  s         = _mm_xor_si128( s, _mm_srli_si128( s, 8 ) );
+  s         = _mm_xor_si128( s, _mm_srli_si128( s, 4 ) );
+  unsigned int checksum = _mm_cvtsi128_si32( s );
+  for ( ; i < nWords; ++i ) checksum ^= ptr[i];
+  return checksum;
+}
+
+// same algorithm as the SSE4 version, handling a full 32 bytes block per register
+unsigned int LHCb::MDF::Checksum::avx2::adler32( unsigned int adler, const char* buf, std::size_t len ) {
+  unsigned int s1     = adler & 0xffff;
+  unsigned int s2     = ( adler >> 16 ) & 0xffff;
+  std::size_t  blocks = len / BLOCK_SIZE;
+  len -= blocks * BLOCK_SIZE;
+  const __m256i tap  = _mm256_setr_epi8( 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14,
+                                        13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 );
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi16( 1 );
+  while ( blocks ) {
+    std::size_t n = std::min<std::size_t>( NMAX / BLOCK_SIZE, blocks );
+    blocks -= n;
+    __m256i v_ps = _mm256_setr_epi32( s1 * n, 0, 0, 0, 0, 0, 0, 0 );
+    __m256i v_s2 = _mm256_setr_epi32( s2, 0, 0, 0, 0, 0, 0, 0 );
+    __m256i v_s1 = _mm256_setzero_si256();
+    do {
+      const __m256i bytes = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( buf ) );
+      v_ps                = _mm256_add_epi32( v_ps, v_s1 );
+      v_s1                = _mm256_add_epi32( v_s1, _mm256_sad_epu8( bytes, zero ) );
+      v_s2 = _mm256_add_epi32( v_s2, _mm256_madd_epi16( _mm256_maddubs_epi16( bytes, tap ), ones ) );
+      buf += BLOCK_SIZE;
+    } while ( --n );
+    v_s2 = _mm256_add_epi32( v_s2, _mm256_slli_epi32( v_ps, 5 ) );
+    s1 += hsum( v_s1 );
+    s2 = hsum( v_s2 );
+    s1 %= BASE;
+    s2 %= BASE;
+  }
+  // remaining bytes
+  while ( len-- ) {
+    s1 += (unsigned char)*buf++;
+    s2 += s1;
+  }
+  s1 %= BASE;
+  s2 %= BASE;
+  return ( s2 << 16 ) | s1;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "Checksums.h"
+
+#include <x86intrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+  constexpr unsigned int BASE = 65521; // largest prime smaller than 65536
+  constexpr unsigned int NMAX = 5552;  // largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1
+  constexpr std::size_t  BLOCK_SIZE = 32;
+
+  unsigned int hsum( __m128i v ) {
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    return _mm_cvtsi128_si32( v );
+  }
+} // namespace
+
+unsigned int LHCb::MDF::Checksum::sse4::xor32( const int* ptr, std::size_t nWords ) {
+  __m128i     acc0 = _mm_setzero_si128();
+  __m128i     acc1 = _mm_setzero_si128();
+  std::size_t i    = 0;
+  for ( ; i + 8 <= nWords; i += 8 ) {
+    acc0 = _mm_xor_si128( acc0, _mm_loadu_si128( reinterpret_cast<const __m128i*>( ptr + i ) ) );
+    acc1 = _mm_xor_si128( acc1, _mm_loadu_si128( reinterpret_cast<const __m128i*>( ptr + i + 4 ) ) );
+  }
+  acc0 = _mm_xor_si128( acc0, acc1 );
+  acc0 = _mm_xor_si128( acc0, _mm_srli_si128( acc0, 8 ) );
+  acc0 = _mm_xor_si128( acc0, _mm_srli_si128( acc0, 4 ) );
+  unsigned int checksum = _mm_cvtsi128_si32( acc0 );
+  for ( ; i < nWords; ++i ) checksum ^= ptr[i];
+  return checksum;
+}
+
+// Adler32 on 32 bytes blocks: s1 gets the sum of the bytes, s2 the bytes weighted by their
+// distance to the end of the block, plus 32 times s1 at the start of the block
+unsigned int LHCb::MDF::Checksum::sse4::adler32( unsigned int adler, const char* buf, std::size_t len ) {
+  unsigned int s1     = adler & 0xffff;
+  unsigned int s2     = ( adler >> 16 ) & 0xffff;
+  std::size_t  blocks = len / BLOCK_SIZE;
+  len -= blocks * BLOCK_SIZE;
+  const __m128i tap1 = _mm_setr_epi8( 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17 );
+  const __m128i tap2 = _mm_setr_epi8( 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 );
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16( 1 );
+  while ( blocks ) {
+    std::size_t n = std::min<std::size_t>( NMAX / BLOCK_SIZE, blocks );
+    blocks -= n;
+    __m128i v_ps = _mm_setr_epi32( s1 * n, 0, 0, 0 );
+    __m128i v_s2 = _mm_setr_epi32( s2, 0, 0, 0 );
+    __m128i v_s1 = _mm_setzero_si128();
+    do {
+      const __m128i bytes1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( buf ) );
+      const __m128i bytes2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( buf + 16 ) );
+      v_ps                 = _mm_add_epi32( v_ps, v_s1 );
+      v_s1                 = _mm_add_epi32( v_s1, _mm_sad_epu8( bytes1, zero ) );
+      v_s2                 = _mm_add_epi32( v_s2, _mm_madd_epi16( _mm_maddubs_epi16( bytes1, tap1 ), ones ) );
+      v_s1                 = _mm_add_epi32( v_s1, _mm_sad_epu8( bytes2, zero ) );
+      v_s2                 = _mm_add_epi32( v_s2, _mm_madd_epi16( _mm_maddubs_epi16( bytes2, tap2 ), ones ) );
+      buf += BLOCK_SIZE;
+    } while ( --n );
+    v_s2 = _mm_add_epi32( v_s2, _mm_slli_epi32( v_ps, 5 ) );
+    s1 += hsum( v_s1 );
+    s2 = hsum( v_s2 );
+    s1 %= BASE;
+    s2 %= BASE;
+  }
+  // remaining bytes
+  while ( len-- ) {
+    s1 += (unsigned char)*buf++;
+    s2 += s1;
+  }
+  s1 %= BASE;
+  s2 %= BASE;
+  return ( s2 << 16 ) | s1;
+}
+
+unsigned int LHCb::MDF::Checksum::sse4::crc32c( unsigned int crc, const char* buf, std::size_t len ) {
+  std::uint64_t c = ~crc;
+  for ( ; len > 0 && ( reinterpret_cast<std::uintptr_t>( buf ) & 7 ); --len ) {
+    c = _mm_crc32_u8( c, (unsigned char)*buf++ );
+  }
+  for ( ; len >= 8; len -= 8, buf += 8 ) {
+    std::uint64_t word;
+    std::memcpy( &word, buf, 8 );
+    c = _mm_crc32_u64( c, word );
+  }
+  for ( ; len > 0; --len ) c = _mm_crc32_u8( c, (unsigned char)*buf++ );
+  return ~static_cast<unsigned int>( c );
+}
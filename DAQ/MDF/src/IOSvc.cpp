@@ -11,51 +11,168 @@
 
 #include "MDF/IOSvc.h"
 #include "MDF/Buffer.h"
+#include "MDF/RawEventHelpers.h"
 
 #include "Event/RawEvent.h"
 
+#include "Kernel/NUMATopology.h"
+
+#include "GaudiKernel/GaudiException.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+#include <atomic>
 #include <thread>
 #include <tuple>
 
+StatusCode LHCb::MDF::IOSvc::initialize() {
+  StatusCode sc = Service::initialize();
+  if ( !sc.isSuccess() ) {
+    error() << "Unable to initialize base class Service." << endmsg;
+    return sc;
+  }
+  m_partitions = std::vector<Partition>( m_numaAware ? LHCb::NUMA::nNodes() : 1 );
+  if ( m_numaAware ) info() << "Using one event buffer per NUMA node (" << m_partitions.size() << ")" << endmsg;
+  // current and next buffers of each partition may hold decompressed data, keep as many spare blocks
+  m_decompressionPool = std::make_shared<BufferPool>( 64, 2 * m_partitions.size() );
+  return sc;
+}
+
 StatusCode LHCb::MDF::IOSvc::finalize() {
-  // join the thread that may be running in the bask, trying to prefetch more data
-  m_nextBuffer.wait();
+  // join the threads that may be running in the back, trying to prefetch more data
+  for ( auto& partition : m_partitions ) {
+    if ( partition.nextBuffer.valid() ) partition.nextBuffer.wait();
+  }
   return Service::finalize();
 }
 
+void LHCb::MDF::IOSvc::prefetchInitialBuffers() {
+  if ( m_numaAware ) return;
+  auto& partition = m_partitions.front();
+  // prefetch data in the current buffer
+  partition.curBuffer = prefetch();
+  // and prefetch more data into the next buffer
+  std::packaged_task<std::shared_ptr<Buffer>()> task( [this] { return prefetch(); } );
+  partition.nextBuffer = task.get_future();
+  task();
+}
+
+void LHCb::MDF::IOSvc::preloadNextBuffer( Partition& partition, std::unique_lock<std::mutex>& guard ) {
+  // use a task, and associate its future to next buffer
+  std::packaged_task<std::shared_ptr<Buffer>()> task( [this] { return prefetch(); } );
+  partition.nextBuffer = task.get_future();
+  // now that next buffer is set, we can unlock to let other theads consume the current buffer
+  // while we are preloading the next one
+  guard.unlock();
+  // and preload data into the next buffer by running the task
+  task();
+}
+
+LHCb::MDF::IOSvc::Partition& LHCb::MDF::IOSvc::currentPartition() {
+  return m_partitions.size() == 1 ? m_partitions.front()
+                                  : m_partitions[LHCb::NUMA::currentNode() % m_partitions.size()];
+}
+
 std::tuple<LHCb::RawEvent, std::shared_ptr<LHCb::MDF::Buffer>> LHCb::MDF::IOSvc::next() {
+  auto& partition = currentPartition();
   // get hold of current buffer, by copying the shared_ptr
-  auto buffer = m_curBuffer;
+  auto buffer = partition.curBuffer;
   // pick an event in it atomically
-  auto event = buffer->get();
-  if ( event.has_value() ) {
-    return {std::move( event.value() ), buffer};
-  } else {
-    // No events remaining in current buffer, we need to renew the buffer
-    while ( true ) {
-      // new scope with serialized access so that only on thread deal with the renewal
-      std::unique_lock guard( m_changeBufferLock );
-      // We got the lock, but maybe the buffer was renewed while we waited. So double check
-      // get hold of current buffer, by copying the shared_ptr
-      buffer = m_curBuffer;
-      // pick an event in it atomicall
+  if ( buffer ) {
+    auto event = buffer->get();
+    if ( event.has_value() ) return {std::move( event.value() ), buffer};
+  }
+  // No events remaining in current buffer, we need to renew the buffer
+  while ( true ) {
+    // new scope with serialized access so that only on thread deal with the renewal
+    std::unique_lock guard( partition.changeBufferLock );
+    // We got the lock, but maybe the buffer was renewed while we waited. So double check
+    // get hold of current buffer, by copying the shared_ptr
+    buffer = partition.curBuffer;
+    // pick an event in it atomically
+    if ( buffer ) {
       auto event = buffer->get();
-      if ( event.has_value() ) {
-        return {std::move( event.value() ), buffer};
-      } else {
-        // ok, buffers still need to be renewed, or needs it again. Anyway we are in charge now
-        // let's just use the "ready to use" nextBuffer. Note that in case it's not yet
-        // fully ready, the "get" call will be waiting for it to be ready
-        m_curBuffer = m_nextBuffer.get();
-        // check whether we reached the end of input, only continue if no
-        if ( m_curBuffer->size() != 0 ) {
-          // Now launch the preload of next buffer. Note that the lock will be released
-          // before the actual preloading but after m_nextBuffer has been filled with a new future
-          // This ensures that other threads will wait on that future if they exhaust the current
-          // buffer before the preloading is over
-          preloadNextBuffer( guard );
-        }
-      }
-    } // guard is released here, if not already released by the preload
+      if ( event.has_value() ) return {std::move( event.value() ), buffer};
+    }
+    // ok, buffers still need to be renewed, or needs it again. Anyway we are in charge now
+    // let's just use the "ready to use" nextBuffer. Note that in case it's not yet
+    // fully ready, the "get" call will be waiting for it to be ready.
+    // If there is no next buffer (first use of a NUMA partition, or previous failure), read one now
+    partition.curBuffer = partition.nextBuffer.valid() ? partition.nextBuffer.get() : prefetch();
+    // check whether we reached the end of input, only continue if no
+    if ( partition.curBuffer->size() != 0 ) {
+      // Now launch the preload of next buffer. Note that the lock will be released
+      // before the actual preloading but after nextBuffer has been filled with a new future
+      // This ensures that other threads will wait on that future if they exhaust the current
+      // buffer before the preloading is over
+      preloadNextBuffer( partition, guard );
+    }
+  } // guard is released here, if not already released by the preload
+}
+
+LHCb::MDF::BufferPool::Block LHCb::MDF::IOSvc::decodeRecords( LHCb::span<MDFHeader* const> records,
+                                                              std::vector<MDFEvent>&       events ) {
+  if ( m_verifyChecksums && !m_verifyOnWorker ) {
+    std::atomic<bool> corrupted{false};
+    tbb::parallel_for( tbb::blocked_range<std::size_t>( 0, records.size() ),
+                       [&]( tbb::blocked_range<std::size_t> const& range ) {
+                         for ( auto i = range.begin(); i != range.end(); i++ ) {
+                           if ( !checkMDFChecksum( records[i], m_checksumType ) ) corrupted = true;
+                         }
+                       } );
+    if ( corrupted ) {
+      throw GaudiException( "Data corruption, invalid checksum of MDF record", "MDF::IOSvc", StatusCode::FAILURE );
+    }
+  }
+  // expected expansion factor of each record, 0 for uncompressed ones
+  std::vector<unsigned int> expand( records.size(), 0 );
+  for ( std::size_t i = 0; i < records.size(); i++ ) {
+    if ( records[i]->compression() & 0xF ) expand[i] = ( records[i]->compression() >> 4 ) + 1;
+  }
+  BufferPool::Block        block;
+  std::vector<std::size_t> offsets( records.size() + 1, 0 );
+  std::vector<std::size_t> sizes( records.size(), 0 );
+  // the expansion factor stored in the header saturates, so retry with more space, as MDFIO does
+  for ( int attempt = 0;; attempt++ ) {
+    // offsets in the decompression block, keeping each event 8 bytes aligned
+    for ( std::size_t i = 0; i < records.size(); i++ ) {
+      offsets[i + 1] = offsets[i] + ( ( std::size_t{expand[i]} * records[i]->size() + 7 ) & ~std::size_t{7} );
+    }
+    if ( offsets.back() == 0 ) break;
+    block = m_decompressionPool->get( offsets.back() );
+    std::atomic<bool> failed{false};
+    tbb::parallel_for( tbb::blocked_range<std::size_t>( 0, records.size() ),
+                       [&]( tbb::blocked_range<std::size_t> const& range ) {
+                         for ( auto i = range.begin(); i != range.end(); i++ ) {
+                           if ( !expand[i] ) continue;
+                           auto const* header = records[i];
+                           auto*       target = reinterpret_cast<char*>( block.get() + offsets[i] );
+                           if ( !decompressBuffer( header->compression() & 0xF, target, offsets[i + 1] - offsets[i],
+                                                   header->data(), header->size(), sizes[i] )
+                                     .isSuccess() ) {
+                             // give more space to this record for the next attempt
+                             expand[i] *= 2;
+                             failed = true;
+                           }
+                         }
+                       } );
+    if ( !failed ) break;
+    if ( attempt == 4 ) {
+      throw GaudiException( "Unable to decompress MDF record", "MDF::IOSvc", StatusCode::FAILURE );
+    }
+    if ( msgLevel( MSG::DEBUG ) ) debug() << "Insufficient space for decompression, retrying with more" << endmsg;
+  }
+  events.reserve( events.size() + records.size() );
+  bool const verifyLater = m_verifyChecksums && m_verifyOnWorker;
+  for ( std::size_t i = 0; i < records.size(); i++ ) {
+    auto const data = expand[i] ? LHCb::span<std::byte>{block.get() + offsets[i], sizes[i]}
+                                : LHCb::span<std::byte>{(std::byte*)records[i]->data(), records[i]->size()};
+    if ( verifyLater ) {
+      events.emplace_back( data, records[i], m_checksumType );
+    } else {
+      events.emplace_back( data );
+    }
   }
+  return block;
 }
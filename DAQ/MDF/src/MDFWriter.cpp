@@ -52,7 +52,7 @@ void MDFWriter::construct() {
   m_md5          = new TMD5();
   m_data.reserve( 1024 * 64 );
   declareProperty( "Connection", m_connectParams = "" );
-  declareProperty( "Compress", m_compress = 2 );                                 // File compression
+  declareProperty( "Compress", m_compress = 2 ); // File compression (0: none, 1-9: ZLIB, 10-11: LZ4, 12-14: ZSTD)
   declareProperty( "ChecksumType", m_genChecksum = 1 );                          // Generate checksum
   declareProperty( "GenerateMD5", m_genMD5 = true );                             // Generate MD5 checksum
   declareProperty( "InputDataType", m_inputType );                               // Input data type
@@ -71,6 +71,10 @@ MDFWriter::~MDFWriter() {
 StatusCode MDFWriter::initialize() {
   MsgStream log( msgSvc(), name() );
   log << MSG::INFO << "Initialize MDFWriter" << endmsg;
+  if ( !compressionSupported( m_compress ) ) {
+    log << MSG::ERROR << "Compression algorithm " << m_compress << " is not supported by this ROOT version" << endmsg;
+    return StatusCode::FAILURE;
+  }
 
   std::string con = getConnection( m_connectParams );
   // Retrieve conversion service handling event iteration
@@ -16,6 +16,7 @@
 //
 //  ====================================================================
 #include "MDF/RawEventHelpers.h"
+#include "Checksums.h"
 #include "Event/RawEvent.h"
 #include "MDF/MDFHeader.h"
 #include "MDF/OnlineRunInfo.h"
@@ -83,60 +84,13 @@ unsigned int LHCb::hash32Checksum( const void* ptr, size_t len ) {
   return hash;
 }
 
-/* ========================================================================= */
 unsigned int LHCb::adler32Checksum( unsigned int adler, const char* buf, size_t len ) {
-#define DO1( buf, i )                                                                                                  \
-  {                                                                                                                    \
-    s1 += (unsigned char)buf[i];                                                                                       \
-    s2 += s1;                                                                                                          \
-  }
-#define DO2( buf, i )                                                                                                  \
-  DO1( buf, i );                                                                                                       \
-  DO1( buf, i + 1 );
-#define DO4( buf, i )                                                                                                  \
-  DO2( buf, i );                                                                                                       \
-  DO2( buf, i + 2 );
-#define DO8( buf, i )                                                                                                  \
-  DO4( buf, i );                                                                                                       \
-  DO4( buf, i + 4 );
-#define DO16( buf )                                                                                                    \
-  DO8( buf, 0 );                                                                                                       \
-  DO8( buf, 8 );
-
-  static const unsigned int BASE = 65521; /* largest prime smaller than 65536 */
-  /* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
-  static const unsigned int NMAX = 5550;
-  unsigned int              s1   = adler & 0xffff;
-  unsigned int              s2   = ( adler >> 16 ) & 0xffff;
-  int                       k;
-
-  if ( buf == NULL ) return 1;
-
-  while ( len > 0 ) {
-    k = len < NMAX ? (int)len : NMAX;
-    len -= k;
-    while ( k >= 16 ) {
-      DO16( buf );
-      buf += 16;
-      k -= 16;
-    }
-    if ( k != 0 ) do {
-        s1 += (unsigned char)*buf++;
-        s2 += s1;
-      } while ( --k );
-    s1 %= BASE;
-    s2 %= BASE;
-  }
-  unsigned int result = ( s2 << 16 ) | s1;
-  return result;
+  return MDF::Checksum::adler32( adler, buf, len );
 }
-/* ========================================================================= */
 
 static unsigned int xorChecksum( const int* ptr, size_t len ) {
-  unsigned int checksum = 0;
-  len                   = len / sizeof( int ) + ( len % sizeof( int ) ? 1 : 0 );
-  for ( const int *p = ptr, *end = p + len; p < end; ++p ) { checksum ^= *p; }
-  return checksum;
+  len = len / sizeof( int ) + ( len % sizeof( int ) ? 1 : 0 );
+  return LHCb::MDF::Checksum::xor32( ptr, len );
 }
 
 #define QUOTIENT 0x04c11db7
@@ -256,6 +210,8 @@ unsigned int LHCb::genChecksum( int flag, const void* ptr, size_t len ) {
   case 5:
     len = ( len / sizeof( int ) ) * sizeof( int );
     return adler32Checksum( 1, (const char*)ptr, len );
+  case 6:
+    return MDF::Checksum::crc32c( 0, (const char*)ptr, len );
   case 22: // Old CRC32 (fixed by now)
     return crc32Checksum( (const char*)ptr, len );
   default:
@@ -263,14 +219,71 @@ unsigned int LHCb::genChecksum( int flag, const void* ptr, size_t len ) {
   }
 }
 
+/// Check the checksum of an MDF record, covering the record after the size words
+bool LHCb::checkMDFChecksum( const MDFHeader* h, int flag ) {
+  if ( h->checkSum() == 0 ) return true;
+  const int skip = 4 * sizeof( int );
+  return h->checkSum() == genChecksum( flag, ( (const char*)h ) + skip, h->recordSize() - skip );
+}
+
+namespace {
+#if ROOT_VERSION_CODE < ROOT_VERSION( 6, 16, 0 )
+  using ZipAlgorithm = ROOT::ECompressionAlgorithm;
+  constexpr auto kZLIB = ROOT::kZLIB;
+  constexpr auto kLZ4  = ROOT::kLZ4;
+#else
+  using ZipAlgorithm   = ROOT::RCompressionSetting::EAlgorithm::EValues;
+  constexpr auto kZLIB = ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+  constexpr auto kLZ4  = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+#endif
+  struct ZipSetting {
+    int          level;
+    ZipAlgorithm algorithm;
+  };
+  /// ROOT compression level and algorithm for an MDF compression code, level 0 if not supported
+  ZipSetting zipSetting( int algtype ) {
+    switch ( algtype ) {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+    case 9:
+      return {algtype, kZLIB};
+    // ROOT uses LZ4HC from level 4 on
+    case LHCb::MDF_LZ4:
+      return {1, kLZ4};
+    case LHCb::MDF_LZ4HC:
+      return {9, kLZ4};
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 6, 20, 0 )
+    // ROOT uses twice the level given as ZSTD level
+    case LHCb::MDF_ZSTD_FAST:
+      return {1, ROOT::RCompressionSetting::EAlgorithm::kZSTD};
+    case LHCb::MDF_ZSTD:
+      return {3, ROOT::RCompressionSetting::EAlgorithm::kZSTD};
+    case LHCb::MDF_ZSTD_HIGH:
+      return {9, ROOT::RCompressionSetting::EAlgorithm::kZSTD};
+#endif
+    default:
+      return {0, kZLIB};
+    }
+  }
+} // namespace
+
+bool LHCb::compressionSupported( int algtype ) { return algtype == 0 || zipSetting( algtype ).level > 0; }
+
 /// Compress opaque data buffer
 /*
   The algorithm applied is the ROOT compression mechanism.
-  Option "algtype" is used to specify the compression level:
+  Option "algtype" is used to specify the algorithm and compression level:
   compress = 0 objects written to this file will not be compressed.
-  compress = 1 minimal compression level but fast.
+  compress = 1 minimal ZLIB compression level but fast.
   ....
-  compress = 9 maximal compression level but slow.
+  compress = 9 maximal ZLIB compression level but slow.
+  compress = 10-11 LZ4, 12-14 ZSTD (see MDFCompression)
 */
 StatusCode LHCb::compressBuffer( int algtype, char* tar, size_t tar_len, char* src, size_t src_len, size_t& new_len ) {
   int in_len, out_len, res_len = 0;
@@ -295,15 +308,16 @@ StatusCode LHCb::compressBuffer( int algtype, char* tar, size_t tar_len, char* s
   case 7:
   case 8:
   case 9:
+  case MDF_LZ4:
+  case MDF_LZ4HC:
+  case MDF_ZSTD_FAST:
+  case MDF_ZSTD:
+  case MDF_ZSTD_HIGH: {
+    auto const setting = zipSetting( algtype );
+    if ( setting.level == 0 ) return StatusCode::FAILURE;
     in_len  = src_len;
     out_len = tar_len;
-    ::R__zipMultipleAlgorithm( algtype, &in_len, src, &out_len, tar, &res_len,
-#if ROOT_VERSION_CODE < ROOT_VERSION( 6, 16, 0 )
-                               ROOT::kZLIB
-#else
-                               ROOT::RCompressionSetting::EAlgorithm::kZLIB
-#endif
-    );
+    ::R__zipMultipleAlgorithm( setting.level, &in_len, src, &out_len, tar, &res_len, setting.algorithm );
     if ( res_len == 0 || size_t( res_len ) >= src_len ) {
       // this happens when the buffer cannot be compressed
       res_len = 0;
@@ -311,6 +325,7 @@ StatusCode LHCb::compressBuffer( int algtype, char* tar, size_t tar_len, char* s
     }
     new_len = res_len;
     return StatusCode::SUCCESS;
+  }
   default:
     break;
   }
@@ -338,6 +353,12 @@ StatusCode LHCb::decompressBuffer( int algtype, char* tar, size_t tar_len, const
   case 7:
   case 8:
   case 9:
+  case MDF_LZ4:
+  case MDF_LZ4HC:
+  case MDF_ZSTD_FAST:
+  case MDF_ZSTD:
+  case MDF_ZSTD_HIGH:
+    // the algorithm is identified by R__unzip from the header of the compressed buffer
     in_len  = src_len;
     out_len = tar_len;
     ::R__unzip( &in_len, reinterpret_cast<unsigned char*>( const_cast<char*>( src ) ), &out_len,
@@ -0,0 +1,135 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Benchmark of the compression algorithms available for MDF records.
+// Events are read from the given MDF file (decompressing them if needed), then each of them is
+// compressed and decompressed with every supported algorithm, as MDFIO and IOSvc do.
+// For each algorithm, the compression ratio and the compression/decompression speeds are reported,
+// in MB/s of uncompressed data and for a single thread.
+//
+// usage: benchmark_MDFCompression <file.mdf> [maxEvents]
+#include "MDF/MDFHeader.h"
+#include "MDF/RawEventHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  /// reads the payload of up to maxEvents events from the given file
+  std::vector<std::vector<char>> readEvents( std::string const& fileName, std::size_t maxEvents ) {
+    std::vector<std::vector<char>> events;
+    std::ifstream                  input( fileName, std::ios::binary );
+    std::vector<char>              record;
+    while ( events.size() < maxEvents ) {
+      LHCb::MDFHeader header;
+      if ( !input.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ) break;
+      record.resize( header.recordSize() );
+      std::memcpy( record.data(), &header, sizeof( header ) );
+      if ( !input.read( record.data() + sizeof( header ), header.recordSize() - sizeof( header ) ) ) break;
+      auto const* h        = reinterpret_cast<LHCb::MDFHeader const*>( record.data() );
+      auto const  compress = h->compression() & 0xF;
+      if ( compress == 0 ) {
+        events.emplace_back( h->data(), h->data() + h->size() );
+        continue;
+      }
+      std::vector<char> event( std::size_t{64} * h->size() );
+      std::size_t       len = 0;
+      if ( !LHCb::decompressBuffer( compress, event.data(), event.size(), h->data(), h->size(), len ).isSuccess() ) {
+        std::fprintf( stderr, "unable to decompress event %zu, skipping it\n", events.size() );
+        continue;
+      }
+      event.resize( len );
+      events.push_back( std::move( event ) );
+    }
+    return events;
+  }
+
+  struct Algorithm {
+    int         code;
+    char const* name;
+  };
+  constexpr Algorithm s_algorithms[] = {
+      {1, "ZLIB-1"},          {4, "ZLIB-4"},   {6, "ZLIB-6"},          {9, "ZLIB-9"},
+      {LHCb::MDF_LZ4, "LZ4"}, {LHCb::MDF_LZ4HC, "LZ4HC"},
+      {LHCb::MDF_ZSTD_FAST, "ZSTD-fast"}, {LHCb::MDF_ZSTD, "ZSTD"}, {LHCb::MDF_ZSTD_HIGH, "ZSTD-high"}};
+} // namespace
+
+int main( int argc, char* argv[] ) {
+  if ( argc < 2 ) {
+    std::fprintf( stderr, "usage: %s <file.mdf> [maxEvents]\n", argv[0] );
+    return 1;
+  }
+  std::size_t const maxEvents = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 10000;
+  auto const        events    = readEvents( argv[1], maxEvents );
+  if ( events.empty() ) {
+    std::fprintf( stderr, "no events read from %s\n", argv[1] );
+    return 1;
+  }
+  std::size_t totalSize = 0, maxSize = 0;
+  for ( auto const& event : events ) {
+    totalSize += event.size();
+    maxSize = std::max( maxSize, event.size() );
+  }
+  std::printf( "%zu events, %.1f MB, average event size %.1f kB\n", events.size(), totalSize / 1e6,
+               totalSize / 1e3 / events.size() );
+  std::printf( "%-10s | %6s | %14s | %16s\n", "Algorithm", "Ratio", "Compress MB/s", "Decompress MB/s" );
+
+  std::vector<std::vector<char>> compressed( events.size() );
+  std::vector<char>              source( maxSize ), decompressed( maxSize );
+  for ( auto const& algorithm : s_algorithms ) {
+    if ( !LHCb::compressionSupported( algorithm.code ) ) {
+      std::printf( "%-10s | not supported by this ROOT version\n", algorithm.name );
+      continue;
+    }
+    // compression, keeping the uncompressed events when compression is not worth it, as MDFIO does
+    std::size_t compressedSize = 0;
+    auto        start          = Clock::now();
+    for ( std::size_t i = 0; i < events.size(); i++ ) {
+      // compressBuffer takes a non const source
+      std::copy( events[i].begin(), events[i].end(), source.begin() );
+      compressed[i].resize( events[i].size() );
+      std::size_t len = 0;
+      if ( LHCb::compressBuffer( algorithm.code, compressed[i].data(), compressed[i].size(), source.data(),
+                                 events[i].size(), len )
+               .isSuccess() ) {
+        compressed[i].resize( len );
+      } else {
+        compressed[i].clear();
+      }
+      compressedSize += compressed[i].empty() ? events[i].size() : compressed[i].size();
+    }
+    double const compressTime = std::chrono::duration<double>( Clock::now() - start ).count();
+    // decompression, checking the result
+    start = Clock::now();
+    for ( std::size_t i = 0; i < events.size(); i++ ) {
+      if ( compressed[i].empty() ) continue;
+      std::size_t len = 0;
+      if ( !LHCb::decompressBuffer( algorithm.code, decompressed.data(), decompressed.size(), compressed[i].data(),
+                                    compressed[i].size(), len )
+                .isSuccess() ||
+           len != events[i].size() || !std::equal( events[i].begin(), events[i].end(), decompressed.begin() ) ) {
+        std::fprintf( stderr, "%s : decompression of event %zu does not match the original\n", algorithm.name, i );
+        return 1;
+      }
+    }
+    double const decompressTime = std::chrono::duration<double>( Clock::now() - start ).count();
+    std::printf( "%-10s | %6.3f | %14.1f | %16.1f\n", algorithm.name, double( totalSize ) / compressedSize,
+                 totalSize / 1e6 / compressTime, totalSize / 1e6 / decompressTime );
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_MODULE test_Checksums
+#include <boost/test/included/unit_test.hpp>
+
+#include "../../src/Checksums.h"
+
+#include "MDF/RawEventHelpers.h"
+
+#include "LHCbMath/CPUDispatch.h"
+
+#include "GaudiKernel/System.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Checksum = LHCb::MDF::Checksum;
+
+namespace {
+  // buffer of random bytes, with extra space to test all alignments
+  std::vector<char> randomBytes( std::size_t size, unsigned int seed ) {
+    std::mt19937      rng( seed );
+    std::vector<char> buffer( size + 64 );
+    for ( auto& c : buffer ) c = static_cast<char>( rng() );
+    return buffer;
+  }
+  // lengths covering the tails of all implementations and the NMAX boundaries of adler32
+  std::vector<std::size_t> testLengths() {
+    std::vector<std::size_t> lengths;
+    for ( std::size_t len = 0; len < 200; len++ ) lengths.push_back( len );
+    for ( std::size_t len : {5535u, 5536u, 5550u, 5551u, 5552u, 5553u, 11104u, 65536u, 1000003u} )
+      lengths.push_back( len );
+    return lengths;
+  }
+  const bool hasSSE4 = System::instructionsetLevel() >= LHCb::CPU::SSE4;
+  const bool hasAVX2 = System::instructionsetLevel() >= LHCb::CPU::AVX2;
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_reference_values ) {
+  const char* wiki = "Wikipedia";
+  BOOST_CHECK_EQUAL( Checksum::generic::adler32( 1, wiki, 9 ), 0x11E60398u );
+  BOOST_CHECK_EQUAL( Checksum::adler32( 1, wiki, 9 ), 0x11E60398u );
+  const char* digits = "123456789";
+  BOOST_CHECK_EQUAL( Checksum::generic::crc32c( 0, digits, 9 ), 0xE3069283u );
+  BOOST_CHECK_EQUAL( Checksum::crc32c( 0, digits, 9 ), 0xE3069283u );
+  BOOST_CHECK_EQUAL( LHCb::genChecksum( 6, digits, 9 ), 0xE3069283u );
+}
+
+BOOST_AUTO_TEST_CASE( test_adler32 ) {
+  auto const buffer = randomBytes( 1000003, 42 );
+  for ( auto len : testLengths() ) {
+    for ( std::size_t offset : {0, 1, 3, 7} ) {
+      auto const* data     = buffer.data() + offset;
+      auto const  expected = Checksum::generic::adler32( 1, data, len );
+      if ( hasSSE4 ) BOOST_CHECK_EQUAL( Checksum::sse4::adler32( 1, data, len ), expected );
+      if ( hasAVX2 ) BOOST_CHECK_EQUAL( Checksum::avx2::adler32( 1, data, len ), expected );
+      BOOST_CHECK_EQUAL( LHCb::adler32Checksum( 1, data, len ), expected );
+    }
+  }
+  // all bytes at 0xff, to exercise the overflow limits
+  std::vector<char> ones( 200000, char( 0xff ) );
+  auto const        expected = Checksum::generic::adler32( 1, ones.data(), ones.size() );
+  if ( hasSSE4 ) BOOST_CHECK_EQUAL( Checksum::sse4::adler32( 1, ones.data(), ones.size() ), expected );
+  if ( hasAVX2 ) BOOST_CHECK_EQUAL( Checksum::avx2::adler32( 1, ones.data(), ones.size() ), expected );
+  // continuing a checksum
+  auto const first = Checksum::adler32( 1, ones.data(), 1000 );
+  BOOST_CHECK_EQUAL( Checksum::adler32( first, ones.data() + 1000, ones.size() - 1000 ), expected );
+}
+
+BOOST_AUTO_TEST_CASE( test_xor32 ) {
+  auto const buffer = randomBytes( 1000003, 43 );
+  for ( auto len : testLengths() ) {
+    std::vector<int> words( len / sizeof( int ) + 1 );
+    std::memcpy( words.data(), buffer.data(), len );
+    auto const nWords   = len / sizeof( int );
+    auto const expected = Checksum::generic::xor32( words.data(), nWords );
+    if ( hasSSE4 ) BOOST_CHECK_EQUAL( Checksum::sse4::xor32( words.data(), nWords ), expected );
+    if ( hasAVX2 ) BOOST_CHECK_EQUAL( Checksum::avx2::xor32( words.data(), nWords ), expected );
+    BOOST_CHECK_EQUAL( LHCb::genChecksum( 0, words.data(), nWords * sizeof( int ) ), expected );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_crc32c ) {
+  auto const buffer = randomBytes( 1000003, 44 );
+  for ( auto len : testLengths() ) {
+    for ( std::size_t offset : {0, 1, 3, 7} ) {
+      auto const* data     = buffer.data() + offset;
+      auto const  expected = Checksum::generic::crc32c( 0, data, len );
+      if ( hasSSE4 ) BOOST_CHECK_EQUAL( Checksum::sse4::crc32c( 0, data, len ), expected );
+      BOOST_CHECK_EQUAL( LHCb::genChecksum( 6, data, len ), expected );
+    }
+  }
+  // continuing a checksum
+  auto const first = Checksum::crc32c( 0, buffer.data(), 1001 );
+  BOOST_CHECK_EQUAL( Checksum::crc32c( first, buffer.data() + 1001, 5000 ),
+                     Checksum::generic::crc32c( 0, buffer.data(), 6001 ) );
+}
@@ -85,7 +85,15 @@ namespace LHCb::DetDesc {
     const ConditionKey& key() const { return m_key; }
 
     // Access the value of the condition, for a given condition context
-    const T& get( const ConditionContext& /*ctx*/ ) const {
+    const T& get( const ConditionContext& ctx ) const {
+      // when the IOVs are held in slots, the condition is the copy for the IOV of the event
+      if ( const auto* slotted = ctx.condition( m_slotIndex ) ) {
+        if constexpr ( details::is_condition_type_v<T> ) {
+          if ( const auto* cond = dynamic_cast<const T*>( slotted ) ) return *cond;
+        } else {
+          return *std::any_cast<T>( &slotted->payload );
+        }
+      }
       if ( !m_ptr )
         throw GaudiException( "payload not present: " + m_key.toString(), "ConditionAccessor::get",
                               StatusCode::FAILURE );
@@ -101,6 +109,9 @@ namespace LHCb::DetDesc {
 
     // Pointer to the condition in the Detector Transien Store
     details::accessor_storage_t<T> m_ptr;
+
+    // Index of the condition in the IOV slots of the condition context
+    std::size_t m_slotIndex = ICondIOVResource::NoSlotIndex;
   };
 
   template <typename C, typename A>
@@ -13,6 +13,7 @@
 #include <DetDesc/ConditionAccessor.h>
 #include <DetDesc/ConditionContext.h>
 #include <DetDesc/ConditionKey.h>
+#include <DetDesc/ICondIOVResource.h>
 #include <DetDesc/IConditionDerivationMgr.h>
 
 #include <GaudiKernel/DataObjectHandle.h>
@@ -121,6 +122,9 @@ namespace LHCb::DetDesc {
     void registerConditionAccessor( ConditionAccessor<T>& accessor ) {
       if ( m_ums ) {
         m_ums->registerCondition( this, accessor.key(), nullptr, accessor.m_ptr );
+        if ( auto iovResource = m_ums.as<ICondIOVResource>() ) {
+          accessor.m_slotIndex = iovResource->slotIndex( accessor.key(), this );
+        }
       } else {
         m_delayedRegistrations.emplace( [this, ptr = &accessor]() { registerConditionAccessor( *ptr ); } );
       }
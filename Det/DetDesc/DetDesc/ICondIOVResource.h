@@ -17,7 +17,11 @@
 #include "GaudiKernel/StringKey.h"
 #include "GaudiKernel/Time.h"
 
+#include <cstddef>
 #include <shared_mutex>
+#include <string>
+
+class ParamValidDataObject;
 
 /**
  * @brief Interface to allow reservation/lock of IOVs.
@@ -28,7 +32,10 @@
  */
 class ICondIOVResource : virtual public IInterface {
 public:
-  DeclareInterfaceID( ICondIOVResource, 1, 0 );
+  DeclareInterfaceID( ICondIOVResource, 1, 1 );
+
+  /// Index of the conditions which are not held in IOV slots
+  static constexpr std::size_t NoSlotIndex = ~std::size_t{0};
 
   /**
    * The reserved IOV (via ICondIOVResource::reserve) will stay reserved for the lifetime
@@ -44,17 +51,33 @@ public:
     /// return an IOVLock wrapping a LockHandle.
     struct LockManager {
       virtual ~LockManager() = default;
+      /// Copy of the condition with the given slot index (see ICondIOVResource::slotIndex)
+      /// valid for the reserved IOV, nullptr if the condition is not held in an IOV slot.
+      virtual const ParamValidDataObject* condition( std::size_t /*index*/ ) const { return nullptr; }
     };
     using LockHandle = std::unique_ptr<LockManager>;
 
     IOVLock( LockHandle&& lock ) : m_resourceLock{std::move( lock )} {}
 
+    /// Copy of the condition with the given slot index valid for the reserved IOV,
+    /// nullptr if the condition must be taken from the transient store.
+    const ParamValidDataObject* condition( std::size_t index ) const {
+      return m_resourceLock && index != NoSlotIndex ? m_resourceLock->condition( index ) : nullptr;
+    }
+
   private:
     LockHandle m_resourceLock;
   };
 
   /// Reserve the IOV valid for the given event time
   virtual IOVLock reserve( const Gaudi::Time& eventTime ) const = 0;
+
+  /// Declare that the condition at the given path, registered to the IUpdateManagerSvc by the
+  /// given consumer, is accessed through the IOVLock of the events, so that an implementation
+  /// holding several IOVs at the same time can keep a copy of it per IOV. Returns the index to
+  /// pass to IOVLock::condition, NoSlotIndex if the condition is always taken from the
+  /// transient store (the default).
+  virtual std::size_t slotIndex( const std::string& /*path*/, const void* /*consumer*/ ) { return NoSlotIndex; }
 };
 
 #endif // ICONDIOVRESOURCE_H
@@ -12,6 +12,7 @@
 #define MAGFIELDGRID_H
 
 // STD
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <vector>
@@ -21,6 +22,10 @@
 #include "GaudiKernel/Point3DTypes.h"
 #include "GaudiKernel/Vector3DTypes.h"
 
+// LHCb
+#include "Kernel/STLExtensions.h"
+#include "LHCbMath/SIMDWrapper.h"
+
 // VectorClass
 #include "vectorclass.h"
 
@@ -56,6 +61,80 @@ namespace LHCb {
     /// closest point on the grid.
     FieldVector fieldVectorClosestPoint( const Gaudi::XYZPoint& xyz ) const;
 
+    /** Return the field vectors at a batch of points, given in SoA layout, by interpolation
+     *  on the grid. If gradient is not empty, it is filled with the field gradients, the
+     *  element ( row, col ) of point n being at gradient[( 3 * row + col ) * nPoints + n].
+     *  The best instruction set available at runtime is used, and the results are those of
+     *  fieldVectorSIMD and fieldGradientSIMD.
+     */
+    void fieldVectors( const std::array<LHCb::span<const float>, 3>& xyz, const std::array<LHCb::span<float>, 3>& field,
+                       LHCb::span<float> gradient = {} ) const;
+
+    /** Return the field vector at the points xyz by interpolation on the grid, using the SoA
+     *  copy of the field map, for SIMDWrapper types of any instruction set.
+     *  As fieldVector, the interpolation is done at float precision, with the same order of
+     *  operations : the two agree exactly, up to the rounding of fused multiply-adds when the
+     *  compiler contracts them, i.e. within a few 1e-7 of the field magnitude. With respect
+     *  to an interpolation in double precision, the float positions (1e-7 relative, below
+     *  1 um over the grid) give interpolation weights exact to 1e-5 for a 100 mm spacing.
+     */
+    template <typename simd>
+    std::array<typename simd::float_v, 3> fieldVectorSIMD( const std::array<typename simd::float_v, 3>& xyz ) const {
+      using F         = typename simd::float_v;
+      using I         = typename simd::int_v;
+      const auto cell = cellSIMD<simd>( xyz );
+      const I    dy{static_cast<int>( m_Nxyz_V[0] )};
+      const I    dz{static_cast<int>( m_Nxyz_V[0] * m_Nxyz_V[1] )};
+      const I    ijk000 = cell.ijk000;
+      const I    ijk010 = ijk000 + dy;
+      const I    ijk001 = ijk000 + dz;
+      const I    ijk011 = ijk001 + dy;
+      const I    one{1};
+
+      const F h0x = F{1.f} - cell.h1[0], h0y = F{1.f} - cell.h1[1], h0z = F{1.f} - cell.h1[2];
+      const F h00 = h0x * h0y;
+      const F h01 = h0x * cell.h1[1];
+      const F h10 = cell.h1[0] * h0y;
+      const F h11 = cell.h1[0] * cell.h1[1];
+      const F scale{static_cast<float>( m_scaleFactor )};
+
+      std::array<F, 3> bf;
+      for ( int c = 0; c < 3; ++c ) {
+        const float* q = m_Q_SOA[c].data();
+        const F      b =
+            h0z * ( ( ( h00 * gather( q, ijk000 ) ) + ( h10 * gather( q, ijk000 + one ) ) ) +
+                    ( ( h01 * gather( q, ijk010 ) ) + ( h11 * gather( q, ijk010 + one ) ) ) ) +
+            cell.h1[2] * ( ( ( h00 * gather( q, ijk001 ) ) + ( h10 * gather( q, ijk001 + one ) ) ) +
+                           ( ( h01 * gather( q, ijk011 ) ) + ( h11 * gather( q, ijk011 + one ) ) ) );
+        bf[c] = select( cell.inside, scale * b, F{0.f} );
+      }
+      return bf;
+    }
+
+    /** Return the field gradient at the points xyz, as fieldGradient does, for SIMDWrapper
+     *  types of any instruction set. Element ( row, col ) is at index 3 * row + col
+     */
+    template <typename simd>
+    std::array<typename simd::float_v, 9> fieldGradientSIMD( const std::array<typename simd::float_v, 3>& xyz ) const {
+      using F                     = typename simd::float_v;
+      using I                     = typename simd::int_v;
+      const auto             cell = cellSIMD<simd>( xyz );
+      const std::array<I, 3> dijk{I{1}, I{static_cast<int>( m_Nxyz_V[0] )},
+                                  I{static_cast<int>( m_Nxyz_V[0] * m_Nxyz_V[1] )}};
+      const F                scale{static_cast<float>( m_scaleFactor )};
+
+      std::array<F, 9> grad;
+      for ( int row = 0; row < 3; ++row ) {
+        const float* q    = m_Q_SOA[row].data();
+        const F      q000 = gather( q, cell.ijk000 );
+        for ( int col = 0; col < 3; ++col ) {
+          const F dQdX        = ( gather( q, cell.ijk000 + dijk[col] ) - q000 ) * scale;
+          grad[3 * row + col] = select( cell.inside, dQdX * F{m_invDxyz_V[col]}, F{0.f} );
+        }
+      }
+      return grad;
+    }
+
     /// Return the magnetic field scale factor
     double scaleFactor() const noexcept { return m_scaleFactor; }
 
@@ -66,6 +145,49 @@ namespace LHCb {
     }
 
   private:
+    /// Cell of the grid containing the points, as in fieldVector
+    template <typename simd>
+    struct CellSIMD {
+      typename simd::int_v                  ijk000; ///< index of the lower corner, 0 outside of the grid
+      typename simd::mask_v                 inside; ///< whether the points are inside of the grid
+      std::array<typename simd::float_v, 3> h1;     ///< position in the cell, in units of the grid spacing
+    };
+
+    template <typename simd>
+    CellSIMD<simd> cellSIMD( const std::array<typename simd::float_v, 3>& xyz ) const {
+      using F = typename simd::float_v;
+      using I = typename simd::int_v;
+      std::array<F, 3> abc;
+      std::array<I, 3> ijk;
+      for ( int c = 0; c < 3; ++c ) {
+        abc[c] = ( xyz[c] - F{m_min_FL_V[c]} ) * F{m_invDxyz_V[c]};
+        // clamp to [-1, N] first, as the conversion to int of NaN or out of range values is undefined
+        // in the scalar implementation : the comparisons are false for NaN, which ends up at -1
+        const F n{static_cast<float>( m_Nxyz_V[c] )};
+        abc[c] = select( abc[c] > F{-1.f}, abc[c], F{-1.f} );
+        abc[c] = select( abc[c] < n, abc[c], n );
+        // truncation, as the unsigned indices of fieldVector
+        ijk[c] = abc[c];
+      }
+      const I nx{static_cast<int>( m_Nxyz_V[0] )};
+      const I ny{static_cast<int>( m_Nxyz_V[1] )};
+      const I nz{static_cast<int>( m_Nxyz_V[2] )};
+      const I minusOne{-1}, one{1};
+      const auto inside = ijk[0] > minusOne && ijk[0] < nx - one && ijk[1] > minusOne && ijk[1] < ny - one &&
+                          ijk[2] > minusOne && ijk[2] < nz - one;
+      return {select( inside, nx * ( ny * ijk[2] + ijk[1] ) + ijk[0], I{0} ),
+              inside,
+              {abc[0] - F{ijk[0]}, abc[1] - F{ijk[1]}, abc[2] - F{ijk[2]}}};
+    }
+
+    /// Fill the SoA copy of the field map, to be called when m_Q_V changes
+    void fillSOA() {
+      for ( int c = 0; c < 3; ++c ) {
+        m_Q_SOA[c].resize( m_Q_V.size() );
+        std::transform( m_Q_V.begin(), m_Q_V.end(), m_Q_SOA[c].begin(), [c]( const Vec4f& q ) { return q[c]; } );
+      }
+    }
+
     template <class vectype, size_t... Is>
     std::array<vectype, 3> fetchVectorQ_helper( const vectype& indices, std::index_sequence<Is...> ) const {
       std::array<Vec4f, sizeof...( Is )> Qs{m_Q_V[indices[Is]]...};
@@ -229,6 +351,8 @@ namespace LHCb {
     Vec4f                   m_Dxyz_V    = {0., 0., 0., 0.}; ///< Steps in x, y and z
     Vec4f                   m_invDxyz_V = {0., 0., 0., 0.}; ///< Inverse of steps in x, y and z (cached for speed)
     std::array<unsigned, 3> m_Nxyz_V    = {0, 0, 0};        ///< Number of steps in x, y and z
+
+    std::array<std::vector<float>, 3> m_Q_SOA; ///< Field map in SoA layout, for native gathers
   };
 
 } // namespace LHCb
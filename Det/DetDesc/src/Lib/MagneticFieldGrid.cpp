@@ -12,7 +12,9 @@
 
 // local
 #include "DetDesc/MagneticFieldGrid.h"
+#include "MagneticFieldGridKernel.h"
 // Gaudi
+#include "GaudiKernel/GaudiException.h"
 #include "GaudiKernel/Kernel.h"
 
 //-----------------------------------------------------------------------------
@@ -112,4 +114,17 @@ namespace LHCb {
       return {0, 0, 0};
     }
   }
+
+  void MagneticFieldGrid::fieldVectors( const std::array<LHCb::span<const float>, 3>& xyz,
+                                        const std::array<LHCb::span<float>, 3>& field,
+                                        LHCb::span<float> gradient ) const {
+    const auto n = xyz[0].size();
+    if ( xyz[1].size() != n || xyz[2].size() != n || field[0].size() != n || field[1].size() != n ||
+         field[2].size() != n || ( !gradient.empty() && gradient.size() != 9 * n ) ) {
+      throw GaudiException( "Inconsistent sizes of the points, field and gradient", "MagneticFieldGrid::fieldVectors",
+                            StatusCode::FAILURE );
+    }
+    static const auto impl = SIMDWrapper::selectKernel<MagneticFieldGridKernel>().second;
+    ( *impl )( *this, xyz, field, gradient );
+  }
 } // namespace LHCb
@@ -0,0 +1,62 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include "DetDesc/MagneticFieldGrid.h"
+#include "LHCbMath/SIMDDispatch.h"
+
+#include <algorithm>
+#include <array>
+
+/** Batched interpolation of the field map, instantiated for each instruction set in
+ *  MagneticFieldGrid_<ISA>.cpp and used by MagneticFieldGrid::fieldVectors
+ */
+template <typename simd>
+struct MagneticFieldGridKernel {
+  using float_v = typename simd::float_v;
+
+  static void apply( const LHCb::MagneticFieldGrid& grid, const std::array<LHCb::span<const float>, 3>& xyz,
+                     const std::array<LHCb::span<float>, 3>& field, LHCb::span<float> gradient ) {
+    const std::size_t n = xyz[0].size();
+    for ( std::size_t i = 0; i < n; i += simd::size ) {
+      const std::size_t width = std::min<std::size_t>( simd::size, n - i );
+      // the last batch goes through padded buffers
+      alignas( 64 ) std::array<float, simd::size> buffer{};
+
+      std::array<float_v, 3> point;
+      for ( int c = 0; c < 3; ++c ) {
+        if ( width == simd::size ) {
+          point[c] = float_v{xyz[c].data() + i};
+        } else {
+          std::copy_n( xyz[c].data() + i, width, buffer.begin() );
+          point[c] = float_v{buffer.data()};
+        }
+      }
+
+      auto store = [&]( const float_v& v, float* out ) {
+        if ( width == simd::size ) {
+          v.store( out );
+        } else {
+          v.store( buffer.data() );
+          std::copy_n( buffer.begin(), width, out );
+        }
+      };
+
+      const auto bf = grid.fieldVectorSIMD<simd>( point );
+      for ( int c = 0; c < 3; ++c ) store( bf[c], field[c].data() + i );
+
+      if ( !gradient.empty() ) {
+        const auto grad = grid.fieldGradientSIMD<simd>( point );
+        for ( int k = 0; k < 9; ++k ) store( grad[k], gradient.data() + k * n + i );
+      }
+    }
+  }
+};
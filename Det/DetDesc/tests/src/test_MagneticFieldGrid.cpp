@@ -0,0 +1,171 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_MagneticFieldGrid
+#include <boost/test/unit_test.hpp>
+
+#include "../../src/Lib/MagneticFieldGridKernel.h"
+#include "DetDesc/MagneticFieldGrid.h"
+
+#include "GaudiKernel/GaudiException.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+// The grid is filled by its friend, the field map reader of Det/Magnet, which is
+// not available here: this one fills a small grid with a smooth, asymmetric field.
+class MagneticFieldGridReader {
+public:
+  static void fill( LHCb::MagneticFieldGrid& grid ) {
+    grid.m_Nxyz_V    = {7, 5, 9};
+    grid.m_Dxyz_V    = Vec4f( 100., 50., 200., 0. );
+    grid.m_invDxyz_V = Vec4f( 1. / grid.m_Dxyz_V[0], 1. / grid.m_Dxyz_V[1], 1. / grid.m_Dxyz_V[2], 0. );
+    grid.m_min_FL_V  = Vec4f( -300., -100., -500., 0. );
+    grid.m_Q_V.resize( grid.m_Nxyz_V[0] * grid.m_Nxyz_V[1] * grid.m_Nxyz_V[2] );
+    for ( unsigned k = 0; k < grid.m_Nxyz_V[2]; ++k )
+      for ( unsigned j = 0; j < grid.m_Nxyz_V[1]; ++j )
+        for ( unsigned i = 0; i < grid.m_Nxyz_V[0]; ++i ) {
+          grid.m_Q_V[grid.m_Nxyz_V[0] * ( grid.m_Nxyz_V[1] * k + j ) + i] =
+              Vec4f( std::sin( 0.7 * i + 0.3 * k ), std::cos( 0.5 * j - 0.2 * i ) + 0.1 * k, 0.05 * i * j - 0.3, 0. );
+        }
+    grid.fillSOA();
+    grid.setScaleFactor( -1.3 );
+  }
+  static const std::array<unsigned, 3>& nxyz( const LHCb::MagneticFieldGrid& grid ) { return grid.m_Nxyz_V; }
+  static float min( const LHCb::MagneticFieldGrid& grid, int c ) { return grid.m_min_FL_V[c]; }
+  static float step( const LHCb::MagneticFieldGrid& grid, int c ) { return grid.m_Dxyz_V[c]; }
+};
+
+namespace {
+  struct Points {
+    std::vector<float> x, y, z;
+    void push_back( float px, float py, float pz ) {
+      x.push_back( px );
+      y.push_back( py );
+      z.push_back( pz );
+    }
+    std::size_t size() const { return x.size(); }
+  };
+
+  struct Fixture {
+    LHCb::MagneticFieldGrid grid;
+    Fixture() { MagneticFieldGridReader::fill( grid ); }
+
+    /// coordinates of the nodes along an axis, one float step around them, and one cell beyond the grid
+    std::vector<float> edges( int c ) const {
+      std::vector<float> v;
+      const int          n = MagneticFieldGridReader::nxyz( grid )[c];
+      for ( int i = -1; i <= n; ++i ) {
+        const float node = MagneticFieldGridReader::min( grid, c ) + i * MagneticFieldGridReader::step( grid, c );
+        v.insert( v.end(), {std::nextafter( node, -std::numeric_limits<float>::infinity() ), node,
+                            std::nextafter( node, std::numeric_limits<float>::infinity() )} );
+      }
+      return v;
+    }
+
+    /// points at the cell edges and around the grid, and random points in and around it
+    Points points() const {
+      Points     p;
+      const auto ex = edges( 0 ), ey = edges( 1 ), ez = edges( 2 );
+      for ( float x : ex )
+        for ( float y : ey )
+          for ( float z : ez ) p.push_back( x, y, z );
+      std::mt19937                          rng( 42 );
+      std::uniform_real_distribution<float> u( -0.2f, 1.2f );
+      for ( int i = 0; i < 10001; ++i ) {
+        std::array<float, 3> r;
+        for ( int c = 0; c < 3; ++c ) {
+          const float length = ( MagneticFieldGridReader::nxyz( grid )[c] - 1 ) * MagneticFieldGridReader::step( grid, c );
+          r[c]               = MagneticFieldGridReader::min( grid, c ) + u( rng ) * length;
+        }
+        p.push_back( r[0], r[1], r[2] );
+      }
+      return p;
+    }
+  };
+
+  /// points far outside of the grid, or not numbers, in any of the coordinates
+  Points farPoints() {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    Points      p;
+    for ( float bad : {nan, inf, -inf, 1e30f, -1e30f, 3e9f, -3e9f} ) {
+      p.push_back( bad, 0.f, 0.f );
+      p.push_back( 0.f, bad, 0.f );
+      p.push_back( 0.f, 0.f, bad );
+    }
+    return p;
+  }
+
+  using Kernel = SIMDWrapper::KernelImpl<MagneticFieldGridKernel>;
+
+  /// the implementations supported by the CPU
+  std::vector<Kernel> kernels() {
+    std::vector<Kernel> k;
+    for ( auto set :
+          {SIMDWrapper::Scalar, SIMDWrapper::SSE, SIMDWrapper::AVX2, SIMDWrapper::AVX256, SIMDWrapper::AVX512} ) {
+      if ( set <= SIMDWrapper::runtimeInstructionSet() ) {
+        k.push_back( SIMDWrapper::selectKernel<MagneticFieldGridKernel>( set ) );
+      }
+    }
+    return k;
+  }
+
+  /// compare an implementation with fieldVector and fieldGradient
+  void check( const LHCb::MagneticFieldGrid& grid, const Kernel& kernel, Points& p, bool outside ) {
+    BOOST_TEST_MESSAGE( "instruction set " << SIMDWrapper::instructionSetName( kernel.first ) );
+    const std::size_t  n = p.size();
+    std::vector<float> bx( n ), by( n ), bz( n ), grad( 9 * n );
+    ( *kernel.second )( grid, {p.x, p.y, p.z}, {bx, by, bz}, grad );
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const Gaudi::XYZPoint point{p.x[i], p.y[i], p.z[i]};
+      const auto            b = grid.fieldVector( point );
+      const auto            g = grid.fieldGradient( point );
+      if ( outside ) {
+        BOOST_CHECK( bx[i] == 0.f && by[i] == 0.f && bz[i] == 0.f );
+        BOOST_CHECK( b.x() == 0. && b.y() == 0. && b.z() == 0. );
+      }
+      // same result, up to the contraction of fused multiply-adds
+      BOOST_CHECK_SMALL( bx[i] - b.x(), 1e-5 );
+      BOOST_CHECK_SMALL( by[i] - b.y(), 1e-5 );
+      BOOST_CHECK_SMALL( bz[i] - b.z(), 1e-5 );
+      for ( int row = 0; row < 3; ++row )
+        for ( int col = 0; col < 3; ++col ) BOOST_CHECK_SMALL( grad[( 3 * row + col ) * n + i] - g( row, col ), 1e-7 );
+    }
+  }
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE( cell_edges, Fixture ) {
+  auto p = points();
+  for ( const auto& kernel : kernels() ) check( grid, kernel, p, false );
+}
+
+BOOST_FIXTURE_TEST_CASE( far_outside, Fixture ) {
+  auto p = farPoints();
+  for ( const auto& kernel : kernels() ) check( grid, kernel, p, true );
+}
+
+BOOST_FIXTURE_TEST_CASE( dispatch, Fixture ) {
+  auto               p = points();
+  const std::size_t  n = p.size();
+  std::vector<float> bx( n ), by( n ), bz( n ), grad( 9 * n ), bestGrad( 9 * n );
+  grid.fieldVectors( {p.x, p.y, p.z}, {bx, by, bz}, bestGrad );
+  ( *SIMDWrapper::selectKernel<MagneticFieldGridKernel>().second )( grid, {p.x, p.y, p.z}, {bx, by, bz}, grad );
+  BOOST_CHECK( grad == bestGrad );
+  // the sizes of the spans must agree
+  BOOST_CHECK_THROW( grid.fieldVectors( {p.x, p.y, p.z}, {bx, by, LHCb::span<float>{bz}.first( n - 1 )} ),
+                     GaudiException );
+  BOOST_CHECK_THROW( grid.fieldVectors( {p.x, p.y, p.z}, {bx, by, bz}, LHCb::span<float>{grad}.first( n ) ),
+                     GaudiException );
+}
@@ -0,0 +1,183 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+// Include files
+// ============================================================================
+// STL & STD
+// ============================================================================
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+// ============================================================================
+// from Gaudi
+// ============================================================================
+#include "GaudiKernel/IRndmGenSvc.h"
+#include "GaudiKernel/Point3DTypes.h"
+#include "GaudiKernel/RndmGenerators.h"
+#include "GaudiKernel/Vector3DTypes.h"
+// ============================================================================
+// GaudiAlg
+// ============================================================================
+#include "GaudiAlg/GaudiHistoAlg.h"
+// ============================================================================
+// DetDesc
+// ============================================================================
+#include "DetDesc/ITransportSvc.h"
+// ============================================================================
+/** @file
+ *  Implementation file for class DetDesc::MaterialGridCheck
+ */
+// ============================================================================
+namespace DetDesc {
+  // ==========================================================================
+  /** @class MaterialGridCheck
+   *  Validation of the material grid of TransportSvc (UseMaterialGrid) :
+   *  random segments are shot inside the given box and their length in
+   *  radiation length units is computed by two instances of the transport
+   *  service, one using the exact geometry and one using the material grid.
+   *  The differences are histogrammed and summarized in finalize, together
+   *  with the time spent in each service.
+   *
+   *  Typical configuration :
+   *  @code
+   *  from Configurables import TransportSvc, DetDesc__MaterialGridCheck
+   *  TransportSvc( "MaterialGridTransportSvc", UseMaterialGrid = True )
+   *  DetDesc__MaterialGridCheck( GridTransportSvc = "TransportSvc/MaterialGridTransportSvc" )
+   *  @endcode
+   */
+  class MaterialGridCheck : public GaudiHistoAlg {
+  public:
+    using GaudiHistoAlg::GaudiHistoAlg;
+    StatusCode initialize() override;
+    StatusCode execute() override;
+    StatusCode finalize() override;
+
+  private:
+    Gaudi::Property<std::string> m_exactSvcName{this, "ExactTransportSvc", "TransportSvc",
+                                                "Transport service using the exact geometry"};
+    Gaudi::Property<std::string> m_gridSvcName{this, "GridTransportSvc", "TransportSvc/MaterialGridTransportSvc",
+                                               "Transport service using the material grid"};
+    Gaudi::Property<int>                 m_shots{this, "Shots", 10000, "Number of segments per event"};
+    Gaudi::Property<std::vector<double>> m_xRange{this, "XRange", {-2000., 2000.}, "x range of the segments (mm)"};
+    Gaudi::Property<std::vector<double>> m_yRange{this, "YRange", {-2000., 2000.}, "y range of the segments (mm)"};
+    Gaudi::Property<std::vector<double>> m_zRange{this, "ZRange", {-500., 12000.}, "z range of the segments (mm)"};
+    Gaudi::Property<double>              m_maxLength{this, "MaxLength", 1000., "Maximal length of the segments (mm)"};
+    Gaudi::Property<double>              m_tolerance{
+        this, "Tolerance", 1.e-3, "Difference (in radiation lengths) above which a segment is counted as bad"};
+
+    ITransportSvc* m_exactSvc  = nullptr;
+    ITransportSvc* m_gridSvc   = nullptr;
+    double         m_maxDiff   = 0;
+    double         m_exactTime = 0;
+    double         m_gridTime  = 0;
+  };
+  // ==========================================================================
+} // namespace DetDesc
+// ============================================================================
+StatusCode DetDesc::MaterialGridCheck::initialize() {
+  StatusCode sc = GaudiHistoAlg::initialize();
+  if ( sc.isFailure() ) { return sc; }
+
+  Assert( randSvc(), "randSvc() points to NULL!" );
+  if ( m_xRange.size() != 2 || m_yRange.size() != 2 || m_zRange.size() != 2 ) {
+    return Error( "XRange, YRange and ZRange must have 2 elements" );
+  }
+
+  m_exactSvc = svc<ITransportSvc>( m_exactSvcName, true );
+  m_gridSvc  = svc<ITransportSvc>( m_gridSvcName, true );
+  if ( m_exactSvc == m_gridSvc ) { return Error( "ExactTransportSvc and GridTransportSvc are the same service" ); }
+
+  return StatusCode::SUCCESS;
+}
+// ============================================================================
+StatusCode DetDesc::MaterialGridCheck::execute() {
+  using Clock = std::chrono::steady_clock;
+
+  Rndm::Numbers x( randSvc(), Rndm::Flat( m_xRange[0], m_xRange[1] ) );
+  Rndm::Numbers y( randSvc(), Rndm::Flat( m_yRange[0], m_yRange[1] ) );
+  Rndm::Numbers z( randSvc(), Rndm::Flat( m_zRange[0], m_zRange[1] ) );
+  Rndm::Numbers flat( randSvc(), Rndm::Flat( 0., 1. ) );
+
+  std::vector<std::pair<Gaudi::XYZPoint, Gaudi::XYZPoint>> segments;
+  segments.reserve( m_shots );
+  for ( int i = 0; i < m_shots; ++i ) {
+    const Gaudi::XYZPoint point( x(), y(), z() );
+    // isotropic direction
+    const double cosTheta = 2 * flat() - 1;
+    const double sinTheta = std::sqrt( 1 - cosTheta * cosTheta );
+    const double phi      = 2 * M_PI * flat();
+    const double length   = m_maxLength * flat();
+    segments.emplace_back(
+        point, point + length * Gaudi::XYZVector( sinTheta * std::cos( phi ), sinTheta * std::sin( phi ), cosTheta ) );
+  }
+
+  std::vector<double> exact( segments.size() ), grid( segments.size() );
+  {
+    std::any   cache = m_exactSvc->createCache();
+    const auto start = Clock::now();
+    std::transform( segments.begin(), segments.end(), exact.begin(), [&]( const auto& s ) {
+      return m_exactSvc->distanceInRadUnits_r( s.first, s.second, cache );
+    } );
+    m_exactTime += std::chrono::duration<double>( Clock::now() - start ).count();
+  }
+  {
+    std::any   cache = m_gridSvc->createCache();
+    const auto start = Clock::now();
+    std::transform( segments.begin(), segments.end(), grid.begin(), [&]( const auto& s ) {
+      return m_gridSvc->distanceInRadUnits_r( s.first, s.second, cache );
+    } );
+    m_gridTime += std::chrono::duration<double>( Clock::now() - start ).count();
+  }
+
+  auto& diffCounter      = counter( "Difference" );
+  auto& absDiffCounter   = counter( "|Difference|" );
+  auto& relDiffCounter   = counter( "Relative difference" );
+  auto& toleranceCounter = counter( "Above tolerance" );
+  for ( std::size_t i = 0; i < segments.size(); ++i ) {
+    const double diff = grid[i] - exact[i];
+    diffCounter += diff;
+    absDiffCounter += std::abs( diff );
+    if ( exact[i] > 0 ) { relDiffCounter += diff / exact[i]; }
+    toleranceCounter += std::abs( diff ) > m_tolerance;
+    m_maxDiff = std::max( m_maxDiff, std::abs( diff ) );
+
+    const double zMid = 0.5 * ( segments[i].first.z() + segments[i].second.z() );
+    plot1D( diff, 1, "Grid - exact (X0)", -10 * m_tolerance, 10 * m_tolerance, 200 );
+    plot2D( zMid, diff, 2, "Grid - exact (X0) versus z", m_zRange[0], m_zRange[1], -10 * m_tolerance,
+            10 * m_tolerance, 100, 100 );
+    plot2D( exact[i], grid[i], 3, "Grid versus exact (X0)", 0., 1., 0., 1., 100, 100 );
+  }
+
+  return StatusCode::SUCCESS;
+}
+// ============================================================================
+StatusCode DetDesc::MaterialGridCheck::finalize() {
+  const auto& absDiff = counter( "|Difference|" );
+  info() << "Material grid versus exact geometry over " << absDiff.nEntries() << " segments :"
+         << " mean |difference| " << absDiff.mean() << " X0, maximal difference " << m_maxDiff << " X0, "
+         << counter( "Above tolerance" ).mean() * 100 << "% above " << m_tolerance.value() << " X0" << endmsg;
+  if ( m_gridTime > 0 ) {
+    info() << "Time spent : exact " << m_exactTime << " s, grid " << m_gridTime << " s, speed-up "
+           << m_exactTime / m_gridTime << endmsg;
+  }
+  return GaudiHistoAlg::finalize();
+}
+// ============================================================================
+/// the factory, necessary for instantiation
+DECLARE_COMPONENT( DetDesc::MaterialGridCheck )
+// ============================================================================
+
+// ============================================================================
+// The END
+// ============================================================================
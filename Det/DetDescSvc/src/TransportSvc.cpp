@@ -15,6 +15,7 @@
 // ============================================================================
 #include "GaudiKernel/IDataProviderSvc.h"
 #include "GaudiKernel/IMessageSvc.h"
+#include "GaudiKernel/IUpdateManagerSvc.h"
 #include "GaudiKernel/SmartDataPtr.h"
 // ============================================================================
 // DetDesc
@@ -88,6 +89,29 @@ StatusCode TransportSvc::initialize() {
   // Load geometry
   m_standardGeometry = findGeometry( m_standardGeometry_address );
 
+  // material grid, (re)built each time one of the conditions it depends on changes
+  if ( m_useGrid ) {
+    if ( m_gridZRange.size() != 2 || !( m_gridZRange[0] < m_gridZRange[1] ) || !( m_gridRMax > 0 ) ||
+         m_gridBins.size() != 3 || 0 == m_gridBins[0] || 0 == m_gridBins[1] || 0 == m_gridBins[2] ||
+         0 == m_gridSamples ) {
+      error() << "Invalid MaterialGrid* properties" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    m_updMgrSvc = service( "UpdateManagerSvc" );
+    if ( !m_updMgrSvc ) {
+      error() << "Cannot find the UpdateManagerSvc" << endmsg;
+      return StatusCode::FAILURE;
+    }
+    for ( const auto& path : m_gridConditions ) {
+      m_updMgrSvc->registerCondition( this, path, &TransportSvc::i_buildMaterialGrid );
+    }
+    const auto nAlignments = m_gridAlignments ? i_registerAlignments( standardGeometry() ) : 0;
+    info() << "Material grid depends on " << nAlignments << " alignment conditions" << endmsg;
+    // with nothing to be notified of, the grid is built once for all
+    statusCode = ( m_gridConditions.empty() && 0 == nAlignments ) ? i_buildMaterialGrid() : m_updMgrSvc->update( this );
+    if ( statusCode.isFailure() ) return statusCode;
+  }
+
   return StatusCode::SUCCESS;
 }
 // ============================================================================
@@ -95,6 +119,11 @@ StatusCode TransportSvc::initialize() {
 // ============================================================================
 StatusCode TransportSvc::finalize() {
   //
+  if ( m_updMgrSvc ) {
+    m_updMgrSvc->unregister( this );
+    m_updMgrSvc.reset();
+  }
+  std::atomic_store( &m_materialGrid, std::shared_ptr<const MaterialGrid>{} );
 
   { // skip map
     always() << " GEOMETRY ERRORS: 'Skip'     map has the size " << m_skip.size() << std::endl;
@@ -217,6 +246,7 @@ IGeometryInfo* TransportSvc::findGeometry( const std::string& address ) const {
 #include "TransportSvcFindLocalGI.h"
 #include "TransportSvcGoodLocalGI.h"
 #include "TransportSvcIntersections.h"
+#include "TransportSvcMaterialGrid.h"
 // ============================================================================
 
 // Create an instance of the accelerator cache
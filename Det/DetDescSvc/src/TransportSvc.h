@@ -17,8 +17,11 @@
 // ============================================================================
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 // ============================================================================
 // GaudiKErnel
 // ============================================================================
@@ -37,6 +40,7 @@
 // ============================================================================
 class IDataProviderSvc;
 class IMessageSvc;
+class IUpdateManagerSvc;
 struct IDetectorElement;
 class ISvcLocator;
 class GaudiException;
@@ -46,6 +50,10 @@ class GaudiException;
  *  Implementation of abstract interface ITransportSvc
  *  and abstract interface DetDesc::IGometryErrorSvc
  *
+ *  With UseMaterialGrid, distanceInRadUnits is answered from a (z, r, phi)
+ *  grid of the average inverse radiation length of the standard geometry,
+ *  see TransportSvcMaterialGrid.h
+ *
  *  @author Vanya Belyaev ibelyaev@physics.syr.edu
  */
 class TransportSvc : public extends<Service, ITransportSvc, DetDesc::IGeometryErrorSvc> {
@@ -213,6 +221,16 @@ private:
   ///  find good local geometry element
   IGeometryInfo* findLocalGI( const Gaudi::XYZPoint& point1, const Gaudi::XYZPoint& point2, IGeometryInfo* gi,
                               IGeometryInfo* topGi ) const;
+  /// (re)build the material grid, called by the UpdateManagerSvc
+  StatusCode i_buildMaterialGrid();
+  /// make the material grid depend on the alignment conditions of gi and its daughters, returns their number
+  std::size_t i_registerAlignments( IGeometryInfo* gi );
+  // ==========================================================================
+  struct MaterialGrid;
+  /** distance in radiation length units from the material grid,
+   *  nullopt if the segment leaves the grid or crosses a cell needing the exact geometry */
+  static std::optional<double> gridDistanceInRadUnits( const MaterialGrid& grid, const Gaudi::XYZPoint& point1,
+                                                       const Gaudi::XYZPoint& point2 );
   // ==========================================================================
 private:
   // ==========================================================================
@@ -230,6 +248,17 @@ private:
     ILVolume::Intersections localIntersections;
   };
   // ==========================================================================
+  /// Average inverse radiation length of the standard geometry in (z, r, phi) cells
+  struct MaterialGrid {
+    double   zMin = 0, dz = 1, dr = 1, dPhi = 1;
+    unsigned nZ = 0, nR = 0, nPhi = 0;
+    /// step used to integrate along a segment
+    double step = 1;
+    /// inverse radiation length per cell, negative for the cells requiring the exact geometry
+    std::vector<float> invX0;
+    std::size_t        index( unsigned iz, unsigned ir, unsigned iphi ) const { return ( iz * nR + ir ) * nPhi + iphi; }
+  };
+  // ==========================================================================
 private:
   // ==========================================================================
   /// Own private data members:
@@ -259,6 +288,34 @@ private:
   Gaudi::Property<bool> m_recovery{this, "Recovery", true, "The flag to allow the recovery of geometry errors"};
   /// property to allow the protocol
   Gaudi::Property<bool> m_protocol{this, "Protocol", true, "The flag to allow protocol for the geometry problems"};
+
+private:
+  // ==========================================================================
+  // material grid
+  // ==========================================================================
+  Gaudi::Property<bool> m_useGrid{this, "UseMaterialGrid", false,
+                                  "Answer distanceInRadUnits from a precomputed grid of the standard geometry"};
+  Gaudi::Property<std::vector<double>> m_gridZRange{this, "MaterialGridZRange", {-1000., 20000.},
+                                                    "z range covered by the material grid (mm)"};
+  Gaudi::Property<double> m_gridRMax{this, "MaterialGridRMax", 5000., "Radius covered by the material grid (mm)"};
+  Gaudi::Property<std::vector<unsigned int>> m_gridBins{
+      this, "MaterialGridBins", {2100, 100, 16}, "Number of bins of the material grid in z, r and phi"};
+  Gaudi::Property<unsigned int> m_gridSamples{
+      this, "MaterialGridSamples", 2, "Number of lines along z per cell in r and in phi used to build the grid"};
+  Gaudi::Property<double> m_gridPrecision{
+      this, "MaterialGridPrecision", 1.e-3,
+      "Maximal spread of the material across a cell (in radiation lengths over its length in z) "
+      "for the grid to be used, the exact geometry is used in the other cells"};
+  Gaudi::Property<bool> m_gridAlignments{
+      this, "MaterialGridAlignments", true,
+      "Rebuild the material grid when the alignment of any detector element of the standard geometry changes"};
+  Gaudi::Property<std::vector<std::string>> m_gridConditions{
+      this, "MaterialGridConditions", {},
+      "Other conditions triggering a rebuild of the material grid when they change"};
+  SmartIF<IUpdateManagerSvc> m_updMgrSvc;
+  /** replaced by the UpdateManagerSvc while other threads use it, hence only accessed
+   *  through std::atomic_load and std::atomic_store, the readers keeping the grid they got alive */
+  std::shared_ptr<const MaterialGrid> m_materialGrid;
 };
 // ============================================================================
 /// access to Detector Data  Service
@@ -48,6 +48,9 @@ double TransportSvc::distanceInRadUnits( const Gaudi::XYZPoint& Point1, const Ga
  *  Similar to distanceInRadUnits but with an additional accelerator
  *  cache for local client storage. This method, unlike distanceInRadUnits
  *  is re-entrant and thus thread safe.
+ *  With UseMaterialGrid, segments within the material grid which do not cross
+ *  any of its high variance cells are integrated from the grid, ignoring the
+ *  threshold and the geometry guess, as long as the standard geometry is used
  *  @see ITransportSvc
  *  @param point1 first point
  *  @param point2 second point
@@ -63,6 +66,13 @@ double TransportSvc::distanceInRadUnits_r( const Gaudi::XYZPoint& point1, const
   // check for the  distance
   if ( point1 == point2 ) { return 0; }
 
+  // precomputed material grid
+  if ( !alternativeGeometry || alternativeGeometry == standardGeometry() ) {
+    if ( const auto grid = std::atomic_load( &m_materialGrid ) ) {
+      if ( const auto radLength = gridDistanceInRadUnits( *grid, point1, point2 ) ) { return *radLength; }
+    }
+  }
+
   // retrieve the history
   const Gaudi::XYZVector Vector( point2 - point1 );
 
@@ -0,0 +1,151 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef __DETDESC_TRANSPORTSVC_TRANSPORTSVCMATERIALGRID_H__
+#define __DETDESC_TRANSPORTSVC_TRANSPORTSVCMATERIALGRID_H__ 1
+
+// STD & STL
+#include <algorithm>
+#include <cmath>
+
+// DetDesc
+#include "DetDesc/Material.h"
+
+// local
+#include "TransportSvc.h"
+
+// ============================================================================
+/** @file
+ *
+ * Material grid of TransportSvc, used by distanceInRadUnits when UseMaterialGrid is set.
+ *
+ * The standard geometry is binned in z, r and phi. Each cell holds the average inverse
+ * radiation length of the material it contains, obtained by intersecting the geometry with
+ * MaterialGridSamples x MaterialGridSamples lines parallel to the z axis, evenly spread in r
+ * and phi over the cell. The spread of the material seen by these lines across the cell,
+ * expressed in radiation lengths over the cell length in z, estimates the error made when
+ * using the average for a segment crossing the cell. Cells where it exceeds
+ * MaterialGridPrecision (thin layers not aligned with the bins, edges of detectors, ...)
+ * are flagged and segments crossing them are handled with the exact geometry, as are the
+ * segments leaving the grid.
+ *
+ * A segment is integrated by sampling the grid at the middle of steps no longer than the
+ * smallest of the cell sizes in z and r.
+ */
+// ============================================================================
+
+StatusCode TransportSvc::i_buildMaterialGrid() {
+  auto grid  = std::make_shared<MaterialGrid>();
+  grid->zMin = m_gridZRange[0];
+  grid->nZ   = m_gridBins[0];
+  grid->nR   = m_gridBins[1];
+  grid->nPhi = m_gridBins[2];
+  grid->dz   = ( m_gridZRange[1] - m_gridZRange[0] ) / grid->nZ;
+  grid->dr   = m_gridRMax / grid->nR;
+  grid->dPhi = 2 * M_PI / grid->nPhi;
+  grid->step = std::min( grid->dz, grid->dr );
+
+  const std::size_t   nCells = std::size_t( grid->nZ ) * grid->nR * grid->nPhi;
+  std::vector<double> sum( nCells, 0. ), sum2( nCells, 0. );
+
+  const unsigned int      nSamples = m_gridSamples;
+  const Gaudi::XYZVector  line( 0, 0, m_gridZRange[1] - m_gridZRange[0] );
+  auto                    cache = createCache();
+  ILVolume::Intersections intersects;
+  try {
+    for ( unsigned ir = 0; ir < grid->nR; ++ir ) {
+      for ( unsigned iphi = 0; iphi < grid->nPhi; ++iphi ) {
+        for ( unsigned sr = 0; sr < nSamples; ++sr ) {
+          for ( unsigned sphi = 0; sphi < nSamples; ++sphi ) {
+            const double r   = ( ir + ( sr + 0.5 ) / nSamples ) * grid->dr;
+            const double phi = -M_PI + ( iphi + ( sphi + 0.5 ) / nSamples ) * grid->dPhi;
+            intersects.clear();
+            intersections_r( Gaudi::XYZPoint( r * std::cos( phi ), r * std::sin( phi ), grid->zMin ), line, 0., 1.,
+                             intersects, cache );
+            // share each interval of material between the z bins it overlaps
+            for ( const auto& [ticks, material] : intersects ) {
+              if ( !material ) { continue; }
+              const double invX0 = 1. / material->radiationLength();
+              const double zA    = ( ticks.first * line.z() ) / grid->dz;
+              const double zB    = ( ticks.second * line.z() ) / grid->dz;
+              const auto   izB   = std::min( unsigned( std::max( zB, 0. ) ), grid->nZ - 1 );
+              for ( auto iz = unsigned( std::max( zA, 0. ) ); iz <= izB; ++iz ) {
+                const double overlap = ( std::min( zB, iz + 1. ) - std::max( zA, double( iz ) ) ) * grid->dz;
+                if ( overlap <= 0 ) { continue; }
+                const auto index = grid->index( iz, ir, iphi );
+                sum[index] += overlap * invX0;
+                sum2[index] += overlap * invX0 * invX0;
+              }
+            }
+          }
+        }
+      }
+    }
+  } catch ( const GaudiException& e ) {
+    error() << "Unable to build the material grid : " << e.message() << endmsg;
+    return StatusCode::FAILURE;
+  }
+
+  // average inverse radiation length and its spread, per cell
+  grid->invX0.resize( nCells );
+  const double length = double( nSamples ) * nSamples * grid->dz;
+  std::size_t  nExact = 0;
+  for ( std::size_t i = 0; i < nCells; ++i ) {
+    const double mean = sum[i] / length;
+    const double rms  = std::sqrt( std::max( sum2[i] / length - mean * mean, 0. ) );
+    if ( rms * grid->dz > m_gridPrecision ) {
+      grid->invX0[i] = -1;
+      ++nExact;
+    } else {
+      grid->invX0[i] = mean;
+    }
+  }
+  info() << "Material grid built with " << nCells << " cells, " << nExact
+         << " of them requiring the exact geometry" << endmsg;
+
+  // the previous grid is freed by the last thread using it
+  std::atomic_store( &m_materialGrid, std::shared_ptr<const MaterialGrid>( std::move( grid ) ) );
+  return StatusCode::SUCCESS;
+}
+// ============================================================================
+std::size_t TransportSvc::i_registerAlignments( IGeometryInfo* gi ) {
+  if ( !gi ) { return 0; }
+  std::size_t n = 0;
+  // the geometry info is updated whenever its alignment condition changes
+  if ( gi->alignmentCondition() ) {
+    m_updMgrSvc->registerCondition( this, gi, &TransportSvc::i_buildMaterialGrid );
+    ++n;
+  }
+  for ( auto child = gi->childBegin(); child != gi->childEnd(); ++child ) { n += i_registerAlignments( *child ); }
+  return n;
+}
+// ============================================================================
+std::optional<double> TransportSvc::gridDistanceInRadUnits( const MaterialGrid& grid, const Gaudi::XYZPoint& point1,
+                                                            const Gaudi::XYZPoint& point2 ) {
+  const Gaudi::XYZVector vect   = point2 - point1;
+  const double           length = std::sqrt( vect.mag2() );
+  const unsigned         nSteps = std::max( 1u, unsigned( std::ceil( length / grid.step ) ) );
+  double                 sum    = 0;
+  for ( unsigned i = 0; i < nSteps; ++i ) {
+    const auto   point = point1 + ( ( i + 0.5 ) / nSteps ) * vect;
+    const double z     = ( point.z() - grid.zMin ) / grid.dz;
+    const double r     = std::hypot( point.x(), point.y() ) / grid.dr;
+    if ( !( z >= 0 && z < grid.nZ && r < grid.nR ) ) { return std::nullopt; }
+    const double phi   = ( std::atan2( point.y(), point.x() ) + M_PI ) / grid.dPhi;
+    const auto   index = grid.index( unsigned( z ), unsigned( r ), std::min( unsigned( phi ), grid.nPhi - 1 ) );
+    if ( grid.invX0[index] < 0 ) { return std::nullopt; }
+    sum += grid.invX0[index];
+  }
+  return sum * length / nSteps;
+}
+// ============================================================================
+// The End
+// ============================================================================
+#endif // __DETDESC_TRANSPORTSVC_TRANSPORTSVCMATERIALGRID_H__
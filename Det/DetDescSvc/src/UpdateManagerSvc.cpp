@@ -10,7 +10,11 @@
 \*****************************************************************************/
 // Include files
 
+#include "Gaudi/Sequence.h"
 #include "GaudiKernel/GaudiException.h"
+#include "GaudiKernel/IAlgManager.h"
+#include "GaudiKernel/IAlgorithm.h"
+#include "GaudiKernel/IDataHandleHolder.h"
 #include "GaudiKernel/IDataManagerSvc.h"
 #include "GaudiKernel/IDataProviderSvc.h"
 #include "GaudiKernel/IDetDataSvc.h"
@@ -25,8 +29,10 @@
 
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <set>
 #include <sstream>
+#include <typeinfo>
 
 // local
 #include "UpdateManagerSvc.h"
@@ -142,10 +148,40 @@ StatusCode UpdateManagerSvc::initialize() {
     if ( msgLevel( MSG::DEBUG ) )
       debug() << "Added condition: " << name << "\n" << dest->second->printParams() << endmsg;
   }
+
+  // the slots cannot be moved (they count their users atomically)
+  if ( m_nIOVSlots > 1 ) m_slots = std::vector<IOVSlot>( m_nIOVSlots );
   return StatusCode::SUCCESS;
 }
 
 StatusCode UpdateManagerSvc::start() {
+  if ( !m_slots.empty() ) {
+    // the algorithms reading objects of the transient store through data handles see
+    // the in-place updates, so the events must not overlap with an update
+    auto algMgr = serviceLocator()->as<IAlgManager>();
+    for ( const auto* alg : algMgr->getAlgorithms() ) {
+      // sequences only run their members
+      if ( dynamic_cast<const Gaudi::Sequence*>( alg ) ) continue;
+      // neither must the algorithms which may keep pointers in the transient store (e.g. detector
+      // elements from getDet in initialize), unless declared to use only ConditionAccessors
+      if ( std::find( m_slotAlgorithms.begin(), m_slotAlgorithms.end(), alg->name() ) == m_slotAlgorithms.end() ) {
+        info() << alg->name() << " is not in " << m_slotAlgorithms.name() << ": all the events will have"
+               << " to complete before the conditions are updated" << endmsg;
+        std::lock_guard guard{m_slotsMutex};
+        m_detStoreReaders = true;
+      }
+      const auto* holder = dynamic_cast<const IDataHandleHolder*>( alg );
+      if ( !holder ) continue;
+      for ( const auto& id : holder->inputDataObjs() ) {
+        if ( id.key().compare( 0, m_dataProviderRootName.size(), m_dataProviderRootName ) == 0 ) {
+          info() << alg->name() << " reads " << id.key() << " from the transient store: all the events will have"
+                 << " to complete before the conditions are updated" << endmsg;
+          std::lock_guard guard{m_slotsMutex};
+          m_detStoreReaders = true;
+        }
+      }
+    }
+  }
   if ( m_withoutBeginEvent ) {
     return newEvent();
   } else {
@@ -263,6 +299,7 @@ void              UpdateManagerSvc::i_registerCondition( const std::string& cond
       if ( cond_item->isHead() ) removeFromHead( cond_item );
     }
     link( mf_item, mf, cond_item );
+    countConsumer( mf );
   } else {
     // this is usually done inside Item::addChild (called by "link")
     auto mfIt = mf_item->find( mf );
@@ -314,6 +351,7 @@ void UpdateManagerSvc::i_registerCondition( void* obj, BaseObjectMemberFunction*
                             StatusCode::FAILURE );
   }
   link( mf_item, mf, cond_item );
+  countConsumer( mf );
   // a new item means that we need an update
   m_head_since = 1;
   m_head_until = 0;
@@ -510,6 +548,11 @@ void UpdateManagerSvc::i_unregister( void* instance ) {
 
   if ( msgLevel( MSG::VERBOSE ) ) { verbose() << "Unregister object at " << instance << endmsg; }
 
+  if ( !m_slots.empty() ) {
+    std::lock_guard guard{m_slotsMutex};
+    m_consumers.erase( instance );
+  }
+
   Item* item = findItem( instance );
   if ( item ) {
 
@@ -747,6 +790,7 @@ namespace {
 } // namespace
 
 ICondIOVResource::IOVLock UpdateManagerSvc::reserve( const Gaudi::Time& eventTime ) const {
+  if ( !m_slots.empty() ) return reserveSlot( eventTime );
   // take a read lock on the IOV resource. This secures the reading of m_head_since/until
   // by preventing any update of it
   std::shared_lock reading{m_IOVresource};
@@ -785,6 +829,166 @@ ICondIOVResource::IOVLock UpdateManagerSvc::reserve( const Gaudi::Time& eventTim
   return ICondIOVResource::IOVLock{std::make_unique<UMSLockManager>( std::move( reading ) )};
 }
 
+/**
+ * Lock on an IOV slot, giving access to the copies of the conditions valid for the event.
+ */
+struct UpdateManagerSvc::SlotLockManager : public ICondIOVResource::IOVLock::LockManager {
+  SlotLockManager( const UpdateManagerSvc& ums, IOVSlot& slot ) : m_ums( ums ), m_slot( slot ) {}
+  ~SlotLockManager() override {
+    // the waiting events count themselves before looking at the users (see reserveSlot), so
+    // either they see this release, or it sees them and wakes them up once they are waiting
+    if ( --m_slot.users == 0 && m_ums.m_waiting > 0 ) {
+      { std::lock_guard guard{m_ums.m_slotsMutex}; }
+      m_ums.m_slotsChanged.notify_all();
+    }
+  }
+  const ParamValidDataObject* condition( std::size_t index ) const override {
+    return index < m_slot.conditions.size() ? m_slot.conditions[index].get() : nullptr;
+  }
+  const UpdateManagerSvc& m_ums;
+  IOVSlot&                m_slot;
+};
+
+ICondIOVResource::IOVLock UpdateManagerSvc::reserveSlot( const Gaudi::Time& eventTime ) const {
+  const auto contains = [&eventTime]( const IOVSlot& slot ) {
+    return slot.since <= eventTime && eventTime < slot.until;
+  };
+  const auto unused = []( const IOVSlot& slot ) { return slot.users == 0; };
+
+  std::unique_lock guard{m_slotsMutex};
+  auto             slot = std::find_if( m_slots.begin(), m_slots.end(), contains );
+  // count the events waiting for a slot, for the releases of the slots to wake them up
+  struct Waiting {
+    Waiting( std::atomic<std::size_t>& n ) : count( n ) { ++count; }
+    ~Waiting() { --count; }
+    Waiting( const Waiting& ) = delete;
+    Waiting& operator=( const Waiting& ) = delete;
+    std::atomic<std::size_t>& count;
+  };
+  std::optional<Waiting> waiting;
+  if ( slot == m_slots.end() ) waiting.emplace( m_waiting );
+  while ( slot == m_slots.end() ) {
+    // Only one slot is filled at a time, and it may be the one we need. Otherwise we can
+    // recycle a slot which is not in use, or all of them if some events may read the
+    // transient store directly (which is updated in place).
+    const bool drain = drainBeforeUpdate();
+    auto       free  = std::find_if( m_slots.begin(), m_slots.end(), unused );
+    if ( m_fillingSlot || free == m_slots.end() ||
+         ( drain && !std::all_of( m_slots.begin(), m_slots.end(), unused ) ) ) {
+      m_slotsChanged.wait( guard );
+    } else {
+      if ( msgLevel( MSG::DEBUG ) )
+        debug() << "reserve(): filling IOV slot " << std::distance( m_slots.begin(), free ) << " for " << eventTime
+                << endmsg;
+      // unless draining, the events of the other slots keep running while this one is
+      // filled, as they only access the copies of the conditions held in their slot
+      free->since   = 1;
+      free->until   = 0;
+      m_fillingSlot = true;
+      const auto paths{drain ? std::vector<std::string>{} : m_slotPaths};
+      guard.unlock();
+      bool copied = false;
+      try {
+        copied = const_cast<UpdateManagerSvc*>( this )->fillSlot( *free, eventTime, paths );
+      } catch ( ... ) {
+        guard.lock();
+        m_fillingSlot = false;
+        m_slotsChanged.notify_all();
+        throw;
+      }
+      guard.lock();
+      m_fillingSlot = false;
+      if ( !copied ) {
+        // the conditions cannot be copied: try again waiting for all the events to complete
+        m_slotted = false;
+        m_slotsChanged.notify_all();
+        continue;
+      }
+      if ( drain ) {
+        for ( auto& other : m_slots ) {
+          other.since = 1;
+          other.until = 0;
+        }
+      }
+      free->since = m_head_since;
+      free->until = m_head_until;
+      m_slotsChanged.notify_all();
+    }
+    slot = std::find_if( m_slots.begin(), m_slots.end(), contains );
+  }
+  ++slot->users;
+  return ICondIOVResource::IOVLock{std::make_unique<SlotLockManager>( *this, *slot )};
+}
+
+void UpdateManagerSvc::countConsumer( BaseObjectMemberFunction* mf ) {
+  if ( m_slots.empty() ) return;
+  // objects of the transient store are updated before the slots are filled, and the outputs of
+  // the ConditionDerivations are copied in the slots, any other object reads the transient store
+  if ( mf->castToDataObject() || mf->type() == typeid( LHCb::DetDesc::ConditionDerivation ) ) return;
+  std::lock_guard guard{m_slotsMutex};
+  ++m_consumers[mf->castToVoid()];
+}
+
+bool UpdateManagerSvc::drainBeforeUpdate() const {
+  if ( !m_slotted || m_detStoreReaders ) return true;
+  return std::any_of( m_consumers.begin(), m_consumers.end(), []( const auto& c ) { return c.second > 0; } );
+}
+
+bool UpdateManagerSvc::fillSlot( IOVSlot& slot, const Gaudi::Time& eventTime, const std::vector<std::string>& paths ) {
+  slot.conditions.clear();
+  // detector elements cannot be copied, they are updated in place
+  const auto copyable = [this]( const std::string& path, bool loaded ) {
+    const Item* item = findItem( path );
+    if ( !item || !item->vdo ) return !loaded;
+    const auto* cond = dynamic_cast<const Condition*>( item->vdo );
+    return cond && typeid( *cond ) == typeid( Condition );
+  };
+  const auto cannotCopy = [this]( const std::string& path ) {
+    warning() << "cannot copy " << path << " in an IOV slot: all the events will have to complete"
+              << " before the conditions are updated" << endmsg;
+    return false;
+  };
+  // check the objects already loaded before touching the transient store
+  for ( const auto& path : paths ) {
+    if ( !copyable( path, false ) ) return cannotCopy( path );
+  }
+
+  detDataSvc()->setEventTime( eventTime );
+  if ( !newEvent( eventTime ).isSuccess() ) {
+    throw GaudiException{"failure updating conditions", name() + "::reserve", StatusCode::FAILURE};
+  }
+
+  slot.conditions.reserve( paths.size() );
+  for ( const auto& path : paths ) {
+    if ( !copyable( path, true ) ) {
+      slot.conditions.clear();
+      return cannotCopy( path );
+    }
+    const auto& cond = static_cast<const Condition&>( *findItem( path )->vdo );
+    auto        copy = std::make_unique<Condition>( cond );
+    // the copy constructor does not copy the payload (e.g. the output of a ConditionDerivation)
+    copy->payload = cond.payload;
+    slot.conditions.push_back( std::move( copy ) );
+  }
+  return true;
+}
+
+std::size_t UpdateManagerSvc::slotIndex( const std::string& path, const void* consumer ) {
+  if ( m_nIOVSlots <= 1 ) return NoSlotIndex;
+  // remove the root name if present
+  std::string cond_path( path );
+  if ( !cond_path.empty() && cond_path[0] == '/' &&
+       cond_path.compare( 0, m_dataProviderRootName.size(), m_dataProviderRootName ) == 0 ) {
+    cond_path.erase( 0, m_dataProviderRootName.size() );
+  }
+  std::lock_guard guard{m_slotsMutex};
+  // the registration of the consumer for this condition goes through its IOVLock
+  if ( auto c = m_consumers.find( consumer ); c != m_consumers.end() && c->second > 0 ) --c->second;
+  auto i = std::find( m_slotPaths.begin(), m_slotPaths.end(), cond_path );
+  if ( i == m_slotPaths.end() ) i = m_slotPaths.insert( i, std::move( cond_path ) );
+  return std::distance( m_slotPaths.begin(), i );
+}
+
 using namespace LHCb::DetDesc;
 IConditionDerivationMgr::DerivationId UpdateManagerSvc::add( LHCb::span<const ConditionKey> inputs, ConditionKey output,
                                                              ConditionCallbackFunction func ) {
@@ -29,10 +29,14 @@
 #include "GaudiKernel/UpdateManagerException.h"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <exception>
 #include <map>
+#include <memory>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 // Forward declarations
 template <class TYPE>
@@ -103,6 +107,8 @@ public:
 
   ICondIOVResource::IOVLock reserve( const Gaudi::Time& eventTime ) const override;
 
+  std::size_t slotIndex( const std::string& path, const void* consumer ) override;
+
   //@{
   DerivationId add( LHCb::span<const LHCb::DetDesc::ConditionKey> inputs, LHCb::DetDesc::ConditionKey output,
                     LHCb::DetDesc::ConditionCallbackFunction func ) override;
@@ -161,6 +167,30 @@ private:
   /// Removes an item from the list of head items.
   inline void removeFromHead( Item* item );
 
+  /// Conditions of an IOV, accessed through the IOVLock of the events (see property IOVSlots).
+  struct IOVSlot {
+    Gaudi::Time              since{1}, until{0}; ///< IOV of the slot, empty while the slot is being filled
+    std::atomic<std::size_t> users{0};           ///< number of events using the slot
+    std::vector<std::unique_ptr<const Condition>> conditions; ///< copies of the conditions, by slot index
+  };
+
+  /// IOVLock::LockManager of the events using an IOV slot.
+  struct SlotLockManager;
+
+  /// Implementation of reserve() with IOV slots.
+  ICondIOVResource::IOVLock reserveSlot( const Gaudi::Time& eventTime ) const;
+
+  /// Update the conditions for the given event time and copy them in the slot.
+  /// Returns false, without updating if possible, when a condition cannot be copied.
+  bool fillSlot( IOVSlot& slot, const Gaudi::Time& eventTime, const std::vector<std::string>& paths );
+
+  /// Keep track of the objects reading the conditions from the transient store.
+  void countConsumer( BaseObjectMemberFunction* mf );
+
+  /// Whether the events of all the slots must complete before an update of the transient store
+  /// (some events may read it directly). To be called with m_slotsMutex held.
+  bool drainBeforeUpdate() const;
+
   // Properties
   Gaudi::Property<std::string> m_dataProviderName{this, "DataProviderSvc", "DetectorDataSvc",
                                                   "Name of the Data Provider"};
@@ -178,6 +208,23 @@ private:
       this, "ConditionsOverride", {}, "List of condition definitions to override the ones in the transient store"};
   Gaudi::Property<std::string> m_dotDumpFile{this, "DotDumpFile", "",
                                              "Name of the dot (graphviz) file into which write the dump"};
+  Gaudi::Property<unsigned int> m_nIOVSlots{
+      this, "IOVSlots", 1,
+      "Number of IOVs which can be in use at the same time. With more than one, the conditions accessed through "
+      "ConditionAccessors (including the ConditionDerivation outputs) are copied for each IOV, so that the events "
+      "of the old IOV do not have to complete before the conditions are updated for a new one. The transient store "
+      "is updated in place, so all the events still have to complete before an update if a detector element is "
+      "accessed through a ConditionAccessor, or if the transient store is read otherwise (objects registered to "
+      "this service, e.g. the magnetic field service, or algorithms with data handles in the transient store). "
+      "Pointers kept by the algorithms (e.g. detector elements from getDet in initialize) cannot be seen by this "
+      "service: only the algorithms listed in IOVSlotAlgorithms may run during an update"};
+  Gaudi::Property<std::vector<std::string>> m_slotAlgorithms{
+      this,
+      "IOVSlotAlgorithms",
+      {},
+      "Names of the algorithms reading the conditions only through ConditionAccessors (or not at all), so that "
+      "their events can overlap with an update of the transient store. If any other algorithm (sequences apart) "
+      "is used, all the events have to complete before the conditions are updated, as with one IOV slot"};
 
   // ---------- data members ----------
   /// Handle to the Data Provider (where to find conditions).
@@ -215,6 +262,25 @@ private:
   mutable std::shared_timed_mutex m_IOVresource;
   mutable std::mutex              m_IOVreserve_mutex;
 
+  /// IOV slots, used if more than one is requested.
+  mutable std::vector<IOVSlot> m_slots;
+  /// Guard of the IOV slots.
+  mutable std::mutex m_slotsMutex;
+  /// Notified when a slot is filled, or released while events are waiting.
+  mutable std::condition_variable m_slotsChanged;
+  /// Number of events waiting for a slot.
+  mutable std::atomic<std::size_t> m_waiting{0};
+  /// Whether a slot is being filled.
+  mutable bool m_fillingSlot = false;
+  /// Whether the conditions can be copied in the slots (only plain Condition objects can).
+  mutable bool m_slotted = true;
+  /// Paths of the conditions held in the slots, by slot index.
+  std::vector<std::string> m_slotPaths;
+  /// Number of registrations of each object for conditions it does not access through its IOVLock.
+  std::map<const void*, std::size_t> m_consumers;
+  /// Whether some algorithms may read objects of the transient store directly.
+  bool m_detStoreReaders = false;
+
   std::map<DerivationId, std::unique_ptr<LHCb::DetDesc::ConditionDerivation>> m_derivations;
   DerivationId                                                                m_nextDerivationId = 0;
 };
@@ -102,6 +102,7 @@ void MagneticFieldGridReader::fillConstantField( const Gaudi::XYZVector& /* fiel
   grid.m_Nxyz_V    = {2, 2, 2};
   grid.m_Q_V.clear();
   grid.m_Q_V.resize( grid.m_Nxyz_V[0] * grid.m_Nxyz_V[1] * grid.m_Nxyz_V[2], Vec4f( 0, 0, 0, 0 ) );
+  grid.fillSOA();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -193,6 +194,7 @@ void MagneticFieldGridReader::fillGridFromQuadrants( GridQuadrant* quadrants, LH
   // grid.m_min_FL[2] = quadrants[0].zOffset ;
   grid.m_min_FL_V =
       Vec4f( -( ( Nxquad - 1 ) * grid.m_Dxyz_V[0] ), -( ( Nyquad - 1 ) * grid.m_Dxyz_V[1] ), quadrants[0].zOffset, 0 );
+  grid.fillSOA();
 
   if ( UNLIKELY( m_msg.level() <= MSG::DEBUG ) ) {
     m_msg << MSG::DEBUG << "Field grid , nbins x,y,z  : (" << grid.m_Nxyz_V[0] << "," << grid.m_Nxyz_V[1] << ","
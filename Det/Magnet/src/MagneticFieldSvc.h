@@ -62,6 +62,12 @@ public:
    */
   Gaudi::XYZVector fieldVector( const Gaudi::XYZPoint& xyz ) const override;
 
+  /// Batched field vectors and gradients, interpolated on the grid with SIMD instructions
+  void fieldVectors( const std::array<LHCb::span<const float>, 3>& xyz, const std::array<LHCb::span<float>, 3>& field,
+                     LHCb::span<float> gradient = {} ) const override {
+    m_magFieldGrid.fieldVectors( xyz, field, gradient );
+  }
+
   /// Returns the field grid
   const LHCb::MagneticFieldGrid* fieldGrid() const override { return &m_magFieldGrid; }
 
@@ -0,0 +1,188 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+// Include files
+#include "Event/HltDecReport.h"
+#include "Event/HltDecReports.h"
+#include "GaudiKernel/DataObject.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace LHCb {
+
+  // Class ID definition
+  static const CLID CLID_HltDecisions = 7522;
+
+  // Namespace for locations in TDS
+  namespace HltDecisionsLocation {
+    inline const std::string Default     = "Hlt/Decisions";
+    inline const std::string Hlt1Default = "Hlt1/Decisions";
+    inline const std::string Hlt2Default = "Hlt2/Decisions";
+  } // namespace HltDecisionsLocation
+
+  /** @class HltDecisions HltDecisions.h
+   *
+   * Compact container of Hlt Trigger Decision Reports, the counterpart of HltDecReports
+   * without strings.
+   *
+   * The lines of a TCK are numbered once (HltDecisions::Lines, shared by all the events
+   * with the same TCK), and the reports of an event are stored in a flat array indexed
+   * by line number, with one bit per line telling whether the line was present in the raw
+   * bank and one bit per line holding its decision. Lookup by line number is O(1); the
+   * line number of a decision ID (from ANNSvc) is also found in O(1), and that of a line
+   * name with a binary search, so clients are expected to resolve their lines once per
+   * TCK (see Lines::tck) rather than per event.
+   *
+   * The string API of HltDecReports (decReport, hasDecisionName, decisionNames) is kept,
+   * and toHltDecReports converts to the original container.
+   */
+  class HltDecisions : public DataObject {
+  public:
+    /// Line number, i.e. index of a line in the line table
+    using LineIndex = unsigned int;
+
+    /// Line number of the unknown lines
+    static constexpr LineIndex NoLine = ~0u;
+
+    /** @class Lines HltDecisions.h
+     *
+     *  The lines of a TCK, numbered in order of increasing decision ID
+     */
+    class Lines final {
+    public:
+      /// Build from the decision IDs and names of the lines of the given TCK
+      Lines( unsigned int tck, std::vector<std::pair<unsigned int, std::string>> idsAndNames );
+
+      /// The TCK of the lines
+      unsigned int tck() const { return m_tck; }
+
+      /// Number of lines
+      std::size_t size() const { return m_ids.size(); }
+
+      /// Line number of the given decision ID, NoLine if unknown
+      LineIndex index( unsigned int intDecisionID ) const {
+        return intDecisionID < m_indexOfID.size() ? m_indexOfID[intDecisionID] : NoLine;
+      }
+
+      /// Line number of the given line name, NoLine if unknown
+      LineIndex index( std::string_view name ) const;
+
+      /// Decision ID of the given line
+      unsigned int id( LineIndex line ) const { return m_ids[line]; }
+
+      /// Name of the given line
+      const std::string& name( LineIndex line ) const { return m_names[line]; }
+
+    private:
+      unsigned int              m_tck = 0;
+      std::vector<unsigned int> m_ids;       ///< decision IDs, by line number
+      std::vector<std::string>  m_names;     ///< line names, by line number
+      std::vector<LineIndex>    m_indexOfID; ///< line numbers, by decision ID
+      std::vector<LineIndex>    m_byName;    ///< line numbers, sorted by line name
+    };
+
+    /// Default Constructor
+    HltDecisions() = default;
+
+    /// Constructor from the lines of the TCK
+    explicit HltDecisions( std::shared_ptr<const Lines> lines );
+
+    // Retrieve pointer to class definition structure
+    const CLID&        clID() const override { return HltDecisions::classID(); }
+    static const CLID& classID() { return CLID_HltDecisions; }
+
+    /// The lines of the TCK
+    const Lines& lines() const { return *m_lines; }
+
+    /// Shared pointer to the lines of the TCK
+    const std::shared_ptr<const Lines>& sharedLines() const { return m_lines; }
+
+    /// Store the report of the given line, returns false if the line is unknown or already has one
+    bool setReport( LineIndex line, HltDecReport report ) {
+      if ( line >= m_reports.size() || present( line ) ) return false;
+      m_reports[line] = report;
+      m_bits[word( line )] |= bit( line );
+      if ( report.decision() ) m_bits[m_nWords + word( line )] |= bit( line );
+      return true;
+    }
+
+    /// Whether the given line has a report
+    bool present( LineIndex line ) const { return line < m_reports.size() && ( m_bits[word( line )] & bit( line ) ); }
+
+    /// Decision of the given line, false if it has no report
+    bool decision( LineIndex line ) const {
+      return line < m_reports.size() && ( m_bits[m_nWords + word( line )] & bit( line ) );
+    }
+
+    /// Report of the given line (a zero report if it has none or is unknown)
+    HltDecReport report( LineIndex line ) const { return line < m_reports.size() ? m_reports[line] : HltDecReport{}; }
+
+    /// Whether any line has a positive decision
+    bool anyDecision() const;
+
+    /// Number of lines with a positive decision
+    std::size_t nDecisions() const;
+
+    /// Number of lines with a report
+    std::size_t size() const;
+
+    /// return pointer to Hlt Decision Report for given trigger decision name (==0 if not found)
+    const LHCb::HltDecReport* decReport( std::string_view decisionName ) const {
+      const auto line = m_lines ? m_lines->index( decisionName ) : NoLine;
+      return present( line ) ? &m_reports[line] : nullptr;
+    }
+
+    /// check if the trigger decision name is present in the container
+    bool hasDecisionName( std::string_view decisionName ) const { return decReport( decisionName ) != nullptr; }
+
+    /// return names of the decisions stored in the container
+    std::vector<std::string> decisionNames() const;
+
+    /// convert to the string keyed container
+    LHCb::HltDecReports toHltDecReports() const;
+
+    /// intelligent printout
+    std::ostream& fillStream( std::ostream& s ) const override;
+
+    /// Retrieve const  Trigger Configuration Key used for Configuration
+    unsigned int configuredTCK() const { return m_configuredTCK; }
+
+    /// Update  Trigger Configuration Key used for Configuration
+    void setConfiguredTCK( unsigned int value ) { m_configuredTCK = value; }
+
+    /// Retrieve const  Reserved for online Task / Node ID
+    unsigned int taskID() const { return m_taskID; }
+
+    /// Update  Reserved for online Task / Node ID
+    void setTaskID( unsigned int value ) { m_taskID = value; }
+
+    friend std::ostream& operator<<( std::ostream& str, const HltDecisions& obj ) { return obj.fillStream( str ); }
+
+  private:
+    static std::size_t   word( LineIndex line ) { return line / 64; }
+    static std::uint64_t bit( LineIndex line ) { return std::uint64_t{1} << ( line % 64 ); }
+
+    unsigned int                 m_configuredTCK = 0; ///< Trigger Configuration Key used for Configuration
+    unsigned int                 m_taskID        = 0; ///< Reserved for online Task / Node ID
+    std::shared_ptr<const Lines> m_lines;             ///< lines of the TCK
+    std::vector<HltDecReport>    m_reports;           ///< reports, by line number
+    std::size_t                  m_nWords = 0;        ///< number of 64 bit words of each bitset
+    std::vector<std::uint64_t>   m_bits;              ///< presence bits, then decision bits, by line number
+
+  }; // class HltDecisions
+
+} // namespace LHCb
@@ -0,0 +1,100 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Include files
+#include <algorithm>
+#include <bitset>
+#include <numeric>
+
+// local
+#include "Event/HltDecisions.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : HltDecisions
+//-----------------------------------------------------------------------------
+
+LHCb::HltDecisions::Lines::Lines( unsigned int tck, std::vector<std::pair<unsigned int, std::string>> idsAndNames )
+    : m_tck( tck ) {
+  std::sort( idsAndNames.begin(), idsAndNames.end(),
+             []( const auto& a, const auto& b ) { return a.first < b.first; } );
+  idsAndNames.erase( std::unique( idsAndNames.begin(), idsAndNames.end(),
+                                  []( const auto& a, const auto& b ) { return a.first == b.first; } ),
+                     idsAndNames.end() );
+
+  m_ids.reserve( idsAndNames.size() );
+  m_names.reserve( idsAndNames.size() );
+  for ( auto& [id, name] : idsAndNames ) {
+    m_ids.push_back( id );
+    m_names.push_back( std::move( name ) );
+  }
+  // decision IDs are small integers, hence a dense table
+  m_indexOfID.assign( m_ids.empty() ? 0 : m_ids.back() + 1, NoLine );
+  for ( LineIndex line = 0; line < m_ids.size(); ++line ) m_indexOfID[m_ids[line]] = line;
+
+  m_byName.resize( m_ids.size() );
+  std::iota( m_byName.begin(), m_byName.end(), 0 );
+  std::sort( m_byName.begin(), m_byName.end(), [&]( LineIndex a, LineIndex b ) { return m_names[a] < m_names[b]; } );
+}
+
+LHCb::HltDecisions::LineIndex LHCb::HltDecisions::Lines::index( std::string_view name ) const {
+  const auto i = std::lower_bound( m_byName.begin(), m_byName.end(), name,
+                                   [&]( LineIndex line, std::string_view n ) { return m_names[line] < n; } );
+  return ( i != m_byName.end() && m_names[*i] == name ) ? *i : NoLine;
+}
+
+LHCb::HltDecisions::HltDecisions( std::shared_ptr<const Lines> lines )
+    : m_lines( std::move( lines ) )
+    , m_reports( m_lines->size() )
+    , m_nWords( ( m_lines->size() + 63 ) / 64 )
+    , m_bits( 2 * m_nWords, 0 ) {}
+
+bool LHCb::HltDecisions::anyDecision() const {
+  return std::any_of( m_bits.begin() + m_nWords, m_bits.end(), []( std::uint64_t w ) { return w != 0; } );
+}
+
+std::size_t LHCb::HltDecisions::nDecisions() const {
+  return std::accumulate( m_bits.begin() + m_nWords, m_bits.end(), std::size_t{0},
+                          []( std::size_t n, std::uint64_t w ) { return n + std::bitset<64>( w ).count(); } );
+}
+
+std::size_t LHCb::HltDecisions::size() const {
+  return std::accumulate( m_bits.begin(), m_bits.begin() + m_nWords, std::size_t{0},
+                          []( std::size_t n, std::uint64_t w ) { return n + std::bitset<64>( w ).count(); } );
+}
+
+std::vector<std::string> LHCb::HltDecisions::decisionNames() const {
+  std::vector<std::string> names;
+  names.reserve( size() );
+  for ( LineIndex line = 0; line < m_reports.size(); ++line ) {
+    if ( present( line ) ) names.push_back( m_lines->name( line ) );
+  }
+  return names;
+}
+
+LHCb::HltDecReports LHCb::HltDecisions::toHltDecReports() const {
+  LHCb::HltDecReports reports;
+  reports.setConfiguredTCK( m_configuredTCK );
+  reports.setTaskID( m_taskID );
+  reports.reserve( size() );
+  for ( LineIndex line = 0; line < m_reports.size(); ++line ) {
+    if ( present( line ) ) reports.insert( m_lines->name( line ), m_reports[line] ).ignore();
+  }
+  return reports;
+}
+
+std::ostream& LHCb::HltDecisions::fillStream( std::ostream& s ) const {
+  s << " HltDecisions : configuredTCK=" << m_configuredTCK << " {\n";
+  for ( LineIndex line = 0; line < m_reports.size(); ++line ) {
+    if ( !present( line ) ) continue;
+    s << " decisionName :	" << m_lines->name( line ) << " HltDecReport :	" << m_reports[line] << "\n";
+  }
+  s << " }" << std::endl;
+  return s;
+}
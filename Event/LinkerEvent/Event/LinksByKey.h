@@ -16,6 +16,7 @@
 #include "Kernel/STLExtensions.h"
 
 #include "GaudiKernel/DataObject.h"
+#include "GaudiKernel/GaudiException.h"
 #include "GaudiKernel/IDataProviderSvc.h"
 #include "GaudiKernel/KeyedObject.h"
 #include "GaudiKernel/SerializeSTL.h"
@@ -108,6 +109,27 @@ namespace LHCb {
 
     friend std::ostream& operator<<( std::ostream& str, const LinksByKey& obj ) { return obj.fillStream( str ); }
 
+    /// The targets and weights of the links of a source, in the order of the references
+    struct Links {
+      LHCb::span<const unsigned int> targets; ///< indices of the target objects
+      LHCb::span<const float>        weights; ///< weights of the links
+    };
+
+    /**
+     * Copies the links, once filled, in compressed sparse row form: the links of the
+     * sources, in the order of m_keyIndex, are stored contiguously, so that applyToLinks,
+     * applyToAllLinks, getAllLinks and links read them without following the chains
+     * of references. Any later modification drops the compressed form.
+     * The compressed form is transient, it has to be rebuilt after reading from file.
+     */
+    void freeze();
+
+    /// Whether the compressed form of the links is built
+    bool isFrozen() const { return !m_csrOffsets.empty(); }
+
+    /// The links of the given source, empty if none. Requires the compressed form, see freeze(), throws otherwise
+    Links links( unsigned int srcIndex ) const;
+
     /**
      * applies a given function to all links of the LinksByKey object
      * Function must have the following signature :
@@ -186,12 +208,22 @@ namespace LHCb {
     template <typename Function>
     void internalApply( unsigned int srcIndex, int refIndex, Function&& func ) const;
 
+    /// Drop the compressed form of the links
+    void unfreeze() {
+      m_csrOffsets.clear();
+      m_csrTargets.clear();
+      m_csrWeights.clear();
+    }
+
   private:
     bool                             m_increasing;    ///< Type of ordering
     std::vector<std::pair<int, int>> m_keyIndex;      ///< List of linked objects
     std::vector<LHCb::LinkReference> m_linkReference; ///< List of references
     unsigned int                     m_sourceClassID; ///< Class ID of the source of the Link
     unsigned int                     m_targetClassID; ///< Class ID of the target of the Link
+    std::vector<unsigned int>        m_csrOffsets;    //! Transient: offsets of the links of each key of m_keyIndex
+    std::vector<unsigned int>        m_csrTargets;    //! Transient: indices of the targets of all links
+    std::vector<float>               m_csrWeights;    //! Transient: weights of all links
 
   }; // class LinksByKey
 
@@ -247,6 +279,19 @@ inline void LHCb::LinksByKey::setDecreasing() { m_increasing = false; }
 inline void LHCb::LinksByKey::reset() {
   m_keyIndex.clear();
   m_linkReference.clear();
+  unfreeze();
+}
+
+inline LHCb::LinksByKey::Links LHCb::LinksByKey::links( unsigned int srcIndex ) const {
+  if ( !isFrozen() ) {
+    throw GaudiException( "links() requires the compressed form, see freeze()", "LHCb::LinksByKey",
+                          StatusCode::FAILURE );
+  }
+  int key;
+  if ( !findIndex( srcIndex, key ) ) return {};
+  const auto first = m_csrOffsets[key], last = m_csrOffsets[key + 1];
+  return {{m_csrTargets.data() + first, m_csrTargets.data() + last},
+          {m_csrWeights.data() + first, m_csrWeights.data() + last}};
 }
 
 template <typename Function>
@@ -260,11 +305,24 @@ void LHCb::LinksByKey::internalApply( unsigned int srcIndex, int refIndex, Funct
 
 template <typename Function>
 void LHCb::LinksByKey::applyToAllLinks( Function&& func ) const {
+  if ( isFrozen() ) {
+    for ( std::size_t key = 0; key < m_keyIndex.size(); ++key ) {
+      for ( auto i = m_csrOffsets[key]; i != m_csrOffsets[key + 1]; ++i ) {
+        func( (unsigned int)m_keyIndex[key].first, m_csrTargets[i], m_csrWeights[i] );
+      }
+    }
+    return;
+  }
   for ( auto [srcIndex, refIndex] : m_keyIndex ) { internalApply( srcIndex, refIndex, func ); }
 }
 
 template <typename Function>
 void LHCb::LinksByKey::applyToLinks( unsigned int srcIndex, Function&& func ) const {
+  if ( isFrozen() ) {
+    const auto l = links( srcIndex );
+    for ( std::size_t i = 0; i < l.targets.size(); ++i ) { func( srcIndex, l.targets[i], l.weights[i] ); }
+    return;
+  }
   int key;
   if ( findIndex( srcIndex, key ) ) { internalApply( srcIndex, m_keyIndex[key].second, func ); }
 }
@@ -297,6 +355,12 @@ template <typename T>
 std::vector<T const*> const LHCb::LinksByKey::getAllLinks( unsigned int        srcIndex,
                                                            LHCb::span<const T> container ) const {
   std::vector<T const*> res;
+  if ( isFrozen() ) {
+    const auto targets = links( srcIndex ).targets;
+    res.reserve( targets.size() );
+    for ( const auto tgtIndex : targets ) res.push_back( &container[tgtIndex] );
+    return res;
+  }
   applyToLinks( srcIndex, [&res, &container]( unsigned int, unsigned int tgtIndex, float ) {
     res.push_back( &container[tgtIndex] );
   } );
@@ -307,6 +371,7 @@ template <typename T>
 std::vector<T const*> const LHCb::LinksByKey::getAllLinks( unsigned int             srcIndex,
                                                            KeyedContainer<T> const& container ) const {
   std::vector<T const*> res;
+  if ( isFrozen() ) res.reserve( links( srcIndex ).targets.size() );
   applyToLinks( srcIndex, [&res, &container]( unsigned int, unsigned int tgtIndex, float ) {
     const T* tgtObj = static_cast<T*>( container.containedObject( tgtIndex ) );
     if ( tgtObj != nullptr ) {
@@ -42,6 +42,9 @@ void LHCb::LinksByKey::resolveLinks( IDataProviderSvc* eventSvc ) {
 //=========================================================================
 void LHCb::LinksByKey::addReference( int srcKey, int srcLinkID, int destKey, int destLinkID, double weight ) {
 
+  //== The compressed form is no longer valid
+  unfreeze();
+
   //== Create the LinkReference, and push it in the vector
 
   LHCb::LinkReference temp( srcLinkID, destLinkID, destKey, -1, float( weight ) );
@@ -130,6 +133,24 @@ void LHCb::LinksByKey::addReference( int srcKey, int srcLinkID, int destKey, int
     }
   }
 }
+//=========================================================================
+//  Copy the chains of references in compressed sparse row form
+//=========================================================================
+void LHCb::LinksByKey::freeze() {
+  unfreeze();
+  m_csrOffsets.reserve( m_keyIndex.size() + 1 );
+  m_csrTargets.reserve( m_linkReference.size() );
+  m_csrWeights.reserve( m_linkReference.size() );
+  m_csrOffsets.push_back( 0 );
+  for ( const auto& [key, first] : m_keyIndex ) {
+    for ( int refIndex = first; 0 <= refIndex; refIndex = m_linkReference[refIndex].nextIndex() ) {
+      m_csrTargets.push_back( m_linkReference[refIndex].objectKey() );
+      m_csrWeights.push_back( m_linkReference[refIndex].weight() );
+    }
+    m_csrOffsets.push_back( m_csrTargets.size() );
+  }
+}
+
 //=========================================================================
 //  Returns the first reference for the given key
 //=========================================================================
@@ -0,0 +1,103 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_LinksByKey
+#include <boost/test/unit_test.hpp>
+
+#include "Event/LinksByKey.h"
+
+#include <array>
+#include <tuple>
+#include <vector>
+
+namespace {
+  using Link = std::tuple<unsigned int, unsigned int, float>;
+
+  /// all the links, through applyToAllLinks
+  std::vector<Link> allLinks( const LHCb::LinksByKey& links ) {
+    std::vector<Link> all;
+    links.applyToAllLinks( [&all]( unsigned int src, unsigned int tgt, float weight ) {
+      all.emplace_back( src, tgt, weight );
+    } );
+    return all;
+  }
+
+  /// the targets of each source, through getAllLinks
+  std::vector<std::vector<const int*>> allTargets( const LHCb::LinksByKey& links, LHCb::span<const int> targets ) {
+    std::vector<std::vector<const int*>> all;
+    for ( unsigned int src = 0; src < 6; ++src ) all.push_back( links.getAllLinks( src, targets ) );
+    return all;
+  }
+
+  /// the links of each source, through applyToLinks
+  std::vector<Link> linksOfEachSource( const LHCb::LinksByKey& links ) {
+    std::vector<Link> all;
+    for ( unsigned int src = 0; src < 6; ++src ) {
+      links.applyToLinks( src, [&all]( unsigned int src, unsigned int tgt, float weight ) {
+        all.emplace_back( src, tgt, weight );
+      } );
+    }
+    return all;
+  }
+} // namespace
+
+BOOST_AUTO_TEST_CASE( freeze ) {
+  const std::array<int, 8> targets{10, 11, 12, 13, 14, 15, 16, 17};
+
+  LHCb::LinksByKey links;
+  links.setDecreasing();
+  // sources and references not in order, with a source without links (0) and an updated weight
+  links.addReference( 4, 0, 1, 0, 0.5 );
+  links.addReference( 1, 0, 7, 0, 0.2 );
+  links.addReference( 4, 0, 3, 0, 0.9 );
+  links.addReference( 2, 0, 0, 0, 1.0 );
+  links.addReference( 4, 0, 6, 0, 0.7 );
+  links.addReference( 1, 0, 7, 0, 0.4 );
+
+  BOOST_CHECK( !links.isFrozen() );
+  BOOST_CHECK_THROW( links.links( 4 ), GaudiException );
+  const auto all     = allLinks( links );
+  const auto bySrc   = linksOfEachSource( links );
+  const auto tgtPtrs = allTargets( links, targets );
+  // ordered by source, then by decreasing weight
+  BOOST_CHECK( ( all == std::vector<Link>{{1, 7, 0.4f}, {2, 0, 1.0f}, {4, 3, 0.9f}, {4, 6, 0.7f}, {4, 1, 0.5f}} ) );
+  BOOST_CHECK( bySrc == all );
+  BOOST_CHECK( tgtPtrs[4] == ( std::vector<const int*>{&targets[3], &targets[6], &targets[1]} ) );
+  BOOST_CHECK( tgtPtrs[0].empty() && tgtPtrs[5].empty() );
+
+  // same links from the compressed form
+  links.freeze();
+  BOOST_CHECK( links.isFrozen() );
+  BOOST_CHECK( allLinks( links ) == all );
+  BOOST_CHECK( linksOfEachSource( links ) == all );
+  BOOST_CHECK( allTargets( links, targets ) == tgtPtrs );
+  const auto l4 = links.links( 4 );
+  BOOST_CHECK( ( std::vector<unsigned int>( l4.targets.begin(), l4.targets.end() ) ==
+                 std::vector<unsigned int>{3, 6, 1} ) );
+  BOOST_CHECK( ( std::vector<float>( l4.weights.begin(), l4.weights.end() ) == std::vector<float>{0.9f, 0.7f, 0.5f} ) );
+  BOOST_CHECK( links.links( 0 ).targets.empty() );
+
+  // a later reference drops the compressed form, and is seen by all the accessors
+  links.addReference( 4, 0, 2, 0, 0.8 );
+  BOOST_CHECK( !links.isFrozen() );
+  BOOST_CHECK_THROW( links.links( 4 ), GaudiException );
+  const std::vector<Link> updated{{1, 7, 0.4f}, {2, 0, 1.0f}, {4, 3, 0.9f}, {4, 2, 0.8f}, {4, 6, 0.7f}, {4, 1, 0.5f}};
+  BOOST_CHECK( allLinks( links ) == updated );
+  BOOST_CHECK( linksOfEachSource( links ) == updated );
+  BOOST_CHECK( allTargets( links, targets )[4] ==
+               ( std::vector<const int*>{&targets[3], &targets[2], &targets[6], &targets[1]} ) );
+
+  // and frozen again
+  links.freeze();
+  BOOST_CHECK( allLinks( links ) == updated );
+  BOOST_CHECK( linksOfEachSource( links ) == updated );
+  BOOST_CHECK_EQUAL( links.links( 4 ).targets.size(), 4u );
+}
@@ -10,6 +10,7 @@
 \*****************************************************************************/
 
 #pragma once
+#include "Event/PrSOAStorage.h"
 #include "Event/PrUpstreamTracks.h"
 #include "Event/PrVeloTracks.h"
 
@@ -26,34 +27,31 @@
  */
 
 namespace LHCb::Pr::Forward {
-  class Tracks {
-
+  class Tracks : public SOAStorage {
   public:
-    constexpr static int max_tracks = align_size( 1024 );
-    constexpr static int max_hits   = 40;
+    constexpr static int default_capacity = 64;
+    constexpr static int max_hits         = 40;
+
+  private:
+    constexpr static int n_columns = max_hits + 9;
 
+  public:
     Tracks( Velo::Tracks const* velo_ancestors, Upstream::Tracks const* upstream_ancestors,
-            Zipping::ZipFamilyNumber zipIdentifier = Zipping::generateZipIdentifier() )
-        : m_velo_ancestors{velo_ancestors}, m_upstream_ancestors{upstream_ancestors}, m_zipIdentifier{zipIdentifier} {
-      const size_t size = max_tracks * ( max_hits + 9 );
-      m_data            = static_cast<data_t*>( std::aligned_alloc( 64, size * sizeof( int ) ) );
-    }
+            Zipping::ZipFamilyNumber zipIdentifier = Zipping::generateZipIdentifier(), int capacity = default_capacity,
+            SOAAllocator allocator = {} )
+        : SOAStorage{n_columns, capacity, allocator}
+        , m_velo_ancestors{velo_ancestors}
+        , m_upstream_ancestors{upstream_ancestors}
+        , m_zipIdentifier{zipIdentifier} {}
 
     // Special constructor for zipping machinery
     Tracks( Zipping::ZipFamilyNumber zipIdentifier, Tracks const& tracks )
-        : Tracks( tracks.getVeloAncestors(), tracks.getUpstreamAncestors(), zipIdentifier ) {}
+        : Tracks( tracks.getVeloAncestors(), tracks.getUpstreamAncestors(), zipIdentifier, tracks.capacity(),
+                  tracks.allocator() ) {}
 
     Tracks( const Tracks& ) = delete;
 
-    Tracks( Tracks&& other )
-        : m_data{std::exchange( other.m_data, nullptr )}
-        , m_size{other.m_size}
-        , m_velo_ancestors{other.m_velo_ancestors}
-        , m_upstream_ancestors{other.m_upstream_ancestors}
-        , m_zipIdentifier{other.m_zipIdentifier} {}
-
-    [[nodiscard]] int size() const { return m_size; }
-    int&              size() { return m_size; }
+    Tracks( Tracks&& ) = default;
 
     // Return pointer to ancestor container
     [[nodiscard]] Velo::Tracks const*     getVeloAncestors() const { return m_velo_ancestors; };
@@ -64,25 +62,24 @@ namespace LHCb::Pr::Forward {
     [[nodiscard]] Zipping::ZipFamilyNumber zipIdentifier() const { return m_zipIdentifier; }
 
     // Index in TracksVP container of the track's ancestor
-    SOA_ACCESSOR( trackVP, &( m_data->i ) )
+    SOA_CHECKED_ACCESSOR( trackVP, &( column( 0 )->i ) )
 
     // Index in TracksUT container of the track's ancestor
-    SOA_ACCESSOR( trackUT, &( m_data[max_tracks].i ) )
+    SOA_CHECKED_ACCESSOR( trackUT, &( column( 1 )->i ) )
 
     // QoP estimate from FT
-    SOA_ACCESSOR( stateQoP, &( m_data[2 * max_tracks].f ) )
+    SOA_CHECKED_ACCESSOR( stateQoP, &( column( 2 )->f ) )
 
     // Hits (for now LHCBid) in FT (or UT)
     // TODO: replace LHCbids by index in FT hit container
-    SOA_ACCESSOR( nHits, &( m_data[3 * max_tracks].i ) )
-    SOA_ACCESSOR_VAR( hit, &( m_data[( hit + 4 ) * max_tracks].i ), int hit )
+    SOA_CHECKED_ACCESSOR( nHits, &( column( 3 )->i ) )
+    SOA_CHECKED_ACCESSOR_VAR( hit, &( column( hit + 4 )->i ), int hit )
 
-    VEC3_SOA_ACCESSOR( statePos, &( m_data[( max_hits + 4 ) * max_tracks].f ),
-                       &( m_data[( max_hits + 4 + 1 ) * max_tracks].f ),
-                       &( m_data[( max_hits + 4 + 2 ) * max_tracks].f ) )
+    VEC3_SOA_CHECKED_ACCESSOR( statePos, &( column( max_hits + 4 )->f ), &( column( max_hits + 4 + 1 )->f ),
+                               &( column( max_hits + 4 + 2 )->f ) )
 
-    VEC3_XY_SOA_ACCESSOR( stateDir, &( m_data[( max_hits + 4 + 3 ) * max_tracks].f ),
-                          &( m_data[( max_hits + 4 + 4 ) * max_tracks].f ), 1.f )
+    VEC3_XY_SOA_CHECKED_ACCESSOR( stateDir, &( column( max_hits + 4 + 3 )->f ), &( column( max_hits + 4 + 4 )->f ),
+                                  1.f )
 
     /// Retrieve the momentum
     template <typename T>
@@ -94,10 +91,11 @@ namespace LHCb::Pr::Forward {
     template <typename simd, typename maskT>
     void copy_back( const Tracks& from, int at, maskT mask ) {
       using intT = typename simd::int_v;
-      for ( int i = 0; i < ( max_hits + 9 ); i++ ) {
-        intT( &( from.m_data[i * max_tracks + at].i ) ).compressstore( mask, &( m_data[i * max_tracks + m_size].i ) );
+      reserve( size() + simd::size );
+      for ( int i = 0; i < n_columns; i++ ) {
+        intT( &( from.column( i )[at].i ) ).compressstore( mask, &( column( i )[size()].i ) );
       }
-      m_size += simd::popcount( mask );
+      size() += simd::popcount( mask );
     }
 
     // These can be LHCbIDs from FT and UT. The latter only if the Forward was run with Velo tracks as input.
@@ -113,15 +111,7 @@ namespace LHCb::Pr::Forward {
       return ids;
     }
 
-    ~Tracks() { std::free( m_data ); }
-
   private:
-    using data_t = union {
-      float f;
-      int   i;
-    };
-    alignas( 64 ) data_t* m_data;
-    int                      m_size               = 0;
     Velo::Tracks const*      m_velo_ancestors     = nullptr;
     Upstream::Tracks const*  m_upstream_ancestors = nullptr;
     Zipping::ZipFamilyNumber m_zipIdentifier;
@@ -0,0 +1,341 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include "LHCbMath/SIMDWrapper.h"
+#include "LHCbMath/Vec3.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Storage shared by the SOA containers of the pattern recognition (hits and tracks)
+ */
+
+namespace LHCb::Pr {
+
+  /**
+   * Type erased allocator for the SOA containers, so that their memory can come from
+   * e.g. a per event LHCb::Allocators::ArenaAllocator without changing their type.
+   * The default one uses std::aligned_alloc.
+   * Only small allocators, which can be copied bytewise, are supported (typically stateless or a
+   * pointer to an arena).
+   * Their memory is over-allocated to provide SOAAllocator::alignment bytes aligned blocks
+   */
+  class SOAAllocator {
+  public:
+    static constexpr std::size_t alignment = 64;
+
+    SOAAllocator() = default;
+
+    template <typename Allocator, typename = std::enable_if_t<!std::is_same_v<Allocator, SOAAllocator>>>
+    SOAAllocator( Allocator const& allocator ) {
+      using ByteAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::byte>;
+      static_assert( sizeof( ByteAllocator ) <= sizeof( State ) && alignof( ByteAllocator ) <= alignof( State ),
+                     "allocator too large to be used for SOA containers" );
+      new ( &m_state ) ByteAllocator( allocator );
+      // the offset to the start of the block is kept in the byte before the aligned pointer
+      m_allocate = []( State const& state, std::size_t bytes ) {
+        auto  alloc   = *reinterpret_cast<ByteAllocator const*>( &state );
+        auto* p       = std::allocator_traits<ByteAllocator>::allocate( alloc, bytes + alignment );
+        auto  offset  = alignment - reinterpret_cast<std::uintptr_t>( p ) % alignment;
+        auto* aligned = p + offset;
+        aligned[-1]   = static_cast<std::byte>( offset - 1 );
+        return aligned;
+      };
+      m_deallocate = []( State const& state, std::byte* aligned, std::size_t bytes ) noexcept {
+        auto alloc = *reinterpret_cast<ByteAllocator const*>( &state );
+        std::allocator_traits<ByteAllocator>::deallocate(
+            alloc, aligned - std::to_integer<std::size_t>( aligned[-1] ) - 1, bytes + alignment );
+      };
+    }
+
+    /// allocate the given number of bytes, a multiple of alignment
+    std::byte* allocate( std::size_t bytes ) const { return m_allocate( m_state, bytes ); }
+    void       deallocate( std::byte* p, std::size_t bytes ) const noexcept { m_deallocate( m_state, p, bytes ); }
+
+  private:
+    using State = std::aligned_storage_t<2 * sizeof( void* ), alignof( void* )>;
+
+    static std::byte* defaultAllocate( State const&, std::size_t bytes ) {
+      auto* p = static_cast<std::byte*>( std::aligned_alloc( alignment, bytes ) );
+      if ( !p ) throw std::bad_alloc();
+      return p;
+    }
+    static void defaultDeallocate( State const&, std::byte* p, std::size_t ) noexcept { std::free( p ); }
+
+    State m_state;
+    std::byte* ( *m_allocate )( State const&, std::size_t )                   = &defaultAllocate;
+    void ( *m_deallocate )( State const&, std::byte*, std::size_t ) noexcept = &defaultDeallocate;
+  };
+
+  /**
+   * Columns of 32 bits values (float or int) of a SOA container.
+   * All columns have the same capacity and are stored contiguously in a single block, each
+   * of them starting on a 64 bytes boundary. There is always room for a full (AVX512) vector
+   * to be written after the last entry, and reserve grows the capacity geometrically,
+   * moving the existing entries
+   */
+  class SOAStorage {
+  public:
+    using data_t = union {
+      float f;
+      int   i;
+    };
+
+    SOAStorage( int nColumns, int capacity, SOAAllocator allocator = {} )
+        : m_allocator{allocator}, m_nColumns{nColumns}, m_stride{stride( capacity )} {
+      m_data = allocate( m_stride );
+    }
+
+    SOAStorage( const SOAStorage& ) = delete;
+    SOAStorage& operator=( const SOAStorage& ) = delete;
+
+    SOAStorage( SOAStorage&& other ) noexcept
+        : m_data{std::exchange( other.m_data, nullptr )}
+        , m_allocator{other.m_allocator}
+        , m_nColumns{other.m_nColumns}
+        , m_stride{std::exchange( other.m_stride, 0 )}
+        , m_size{std::exchange( other.m_size, 0 )} {}
+
+    ~SOAStorage() { release(); }
+
+    [[nodiscard]] int  size() const { return m_size; }
+    int&               size() { return m_size; }
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+    /// number of entries that can be stored without reallocation
+    [[nodiscard]] int capacity() const { return std::max( m_stride - 16, 0 ); }
+    /// number of bytes allocated
+    [[nodiscard]] std::size_t allocatedBytes() const { return bytes( m_stride ); }
+    [[nodiscard]] SOAAllocator const& allocator() const { return m_allocator; }
+
+    /// make sure that n entries can be stored, growing the capacity at least by a factor 2 if needed
+    void reserve( int n ) {
+      if ( n > capacity() ) grow( n, m_size );
+    }
+
+    /**
+     * make sure that a vector can be stored at the given index, used by the checked stores of
+     * SOA_CHECKED_ACCESSOR. The entries already stored below the index are kept, even if
+     * the size was not updated yet
+     */
+    void reserveForStore( int key ) {
+      if ( key > capacity() ) grow( key + 1, std::max( key, m_size ) );
+    }
+
+  protected:
+    // as for a plain pointer member, the constness of the container does not propagate to the data
+    data_t* column( int c ) const { return m_data + c * m_stride; }
+
+  private:
+    /// reallocate for at least n entries, moving the first nCopy ones
+    void grow( int n, int nCopy ) {
+      auto const newStride = stride( std::max( n, 2 * capacity() ) );
+      auto*      newData   = allocate( newStride );
+      if ( m_data ) {
+        for ( int c = 0; c < m_nColumns; ++c ) {
+          std::memcpy( newData + c * newStride, m_data + c * m_stride, nCopy * sizeof( data_t ) );
+        }
+      }
+      release();
+      m_data   = newData;
+      m_stride = newStride;
+    }
+
+    /// distance between columns for the given capacity, with padding for a full vector
+    static int  stride( int capacity ) { return ( std::max( capacity, 0 ) + 15 ) / 16 * 16 + 16; }
+    std::size_t bytes( int stride ) const { return std::size_t( m_nColumns ) * stride * sizeof( data_t ); }
+    data_t*     allocate( int stride ) const {
+      return reinterpret_cast<data_t*>( m_allocator.allocate( bytes( stride ) ) );
+    }
+    void release() {
+      if ( m_data ) m_allocator.deallocate( reinterpret_cast<std::byte*>( m_data ), bytes( m_stride ) );
+      m_data = nullptr;
+    }
+
+    data_t*      m_data = nullptr;
+    SOAAllocator m_allocator;
+    int          m_nColumns = 0;
+    int          m_stride   = 0;
+    int          m_size     = 0;
+  };
+
+} // namespace LHCb::Pr
+
+// As SOA_ACCESSOR, VEC3_SOA_ACCESSOR and their XY and variadic versions, for containers deriving
+// from LHCb::Pr::SOAStorage: the stores grow the storage when the index is beyond its capacity, so that producers which
+// do not know the number of entries beforehand cannot write past the end of the columns.
+// The location must be evaluated after the growth, i.e. be given in terms of column().
+#define SOA_CHECKED_ACCESSOR( name, location )                                                                         \
+  template <typename T>                                                                                                \
+  inline auto name( const int key ) const {                                                                            \
+    return T( location + key );                                                                                        \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline auto gather_##name( const T& key ) const {                                                                    \
+    return gather( location, key );                                                                                    \
+  }                                                                                                                    \
+  template <typename T, typename KeyT, typename MaskT>                                                                 \
+  inline auto maskgather_##name( const KeyT& key, const MaskT& mask, const T& src ) const {                            \
+    return maskgather( location, key, mask, src );                                                                     \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline auto store_##name( const int key, const T& v ) {                                                              \
+    reserveForStore( key );                                                                                            \
+    v.store( location + key );                                                                                         \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline auto compressstore_##name( const int key, const MaskT& mask, const T& v ) {                                   \
+    reserveForStore( key );                                                                                            \
+    v.compressstore( mask, location + key );                                                                           \
+  }
+
+#define VEC3_SOA_CHECKED_ACCESSOR( name, locX, locY, locZ )                                                            \
+  template <typename T>                                                                                                \
+  inline Vec3<T> name( const int key ) const {                                                                         \
+    return {locX + key, locY + key, locZ + key};                                                                       \
+  }                                                                                                                    \
+  template <typename T, typename I>                                                                                    \
+  inline Vec3<T> gather_##name( const I& key ) const {                                                                 \
+    return {gather( locX, key ), gather( locY, key ), gather( locZ, key )};                                            \
+  }                                                                                                                    \
+  template <typename T, typename I, typename MaskT>                                                                    \
+  inline Vec3<T> maskgather_##name( const I& key, const MaskT& mask, const T& src ) const {                            \
+    return {maskgather( locX, key, mask, src ), maskgather( locY, key, mask, src ),                                    \
+            maskgather( locZ, key, mask, src )};                                                                       \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline void store_##name( const int key, const Vec3<T>& v ) {                                                        \
+    reserveForStore( key );                                                                                            \
+    v.x.store( locX + key );                                                                                           \
+    v.y.store( locY + key );                                                                                           \
+    v.z.store( locZ + key );                                                                                           \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline void compressstore_##name( const int key, MaskT mask, const Vec3<T>& v ) {                                    \
+    reserveForStore( key );                                                                                            \
+    v.x.compressstore( mask, locX + key );                                                                             \
+    v.y.compressstore( mask, locY + key );                                                                             \
+    v.z.compressstore( mask, locZ + key );                                                                             \
+  }
+
+#define VEC3_XY_SOA_CHECKED_ACCESSOR( name, locX, locY, valZ )                                                         \
+  template <typename T>                                                                                                \
+  inline Vec3<T> name( const int key ) const {                                                                         \
+    return {locX + key, locY + key, valZ};                                                                             \
+  }                                                                                                                    \
+  template <typename T, typename I>                                                                                    \
+  inline Vec3<T> gather_##name( const I& key ) const {                                                                 \
+    return {gather( locX, key ), gather( locY, key ), valZ};                                                           \
+  }                                                                                                                    \
+  template <typename T, typename I, typename MaskT>                                                                    \
+  inline Vec3<T> maskgather_##name( const I& key, const MaskT& mask, const T& src ) const {                            \
+    return {maskgather( locX, key, mask, src ), maskgather( locY, key, mask, src ), valZ};                             \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline void store_##name( const int key, const Vec3<T>& v ) {                                                        \
+    reserveForStore( key );                                                                                            \
+    v.x.store( locX + key );                                                                                           \
+    v.y.store( locY + key );                                                                                           \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline void compressstore_##name( const int key, MaskT mask, const Vec3<T>& v ) {                                    \
+    reserveForStore( key );                                                                                            \
+    v.x.compressstore( mask, locX + key );                                                                             \
+    v.y.compressstore( mask, locY + key );                                                                             \
+  }
+
+// With variadic parameters:
+#define SOA_CHECKED_ACCESSOR_VAR( name, location, ... )                                                                \
+  template <typename T>                                                                                                \
+  inline auto name( const int key, __VA_ARGS__ ) const {                                                               \
+    return T( location + key );                                                                                        \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline auto gather_##name( const T& key, __VA_ARGS__ ) const {                                                       \
+    return gather( location, key );                                                                                    \
+  }                                                                                                                    \
+  template <typename T, typename KeyT, typename MaskT>                                                                 \
+  inline auto maskgather_##name( const T& key, const MaskT& mask, const T& src, __VA_ARGS__ ) const {                  \
+    return maskgather( location, key, mask, src );                                                                     \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline auto store_##name( const int key, __VA_ARGS__, const T& v ) {                                                 \
+    reserveForStore( key );                                                                                            \
+    v.store( location + key );                                                                                         \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline auto compressstore_##name( const int key, __VA_ARGS__, MaskT mask, const T& v ) {                             \
+    reserveForStore( key );                                                                                            \
+    v.compressstore( mask, location + key );                                                                           \
+  }
+
+#define VEC3_SOA_CHECKED_ACCESSOR_VAR( name, locX, locY, locZ, ... )                                                   \
+  template <typename T>                                                                                                \
+  inline Vec3<T> name( const int key, __VA_ARGS__ ) const {                                                            \
+    return {locX + key, locY + key, locZ + key};                                                                       \
+  }                                                                                                                    \
+  template <typename T, typename I>                                                                                    \
+  inline Vec3<T> gather_##name( const I& key, __VA_ARGS__ ) const {                                                    \
+    return {gather( locX, key ), gather( locY, key ), gather( locZ, key )};                                            \
+  }                                                                                                                    \
+  template <typename T, typename I, typename MaskT>                                                                    \
+  inline Vec3<T> maskgather_##name( const I& key, const MaskT& mask, const T& src, __VA_ARGS__ ) const {               \
+    return {maskgather( locX, key, mask, src ), maskgather( locY, key, mask, src ),                                    \
+            maskgather( locZ, key, mask, src )};                                                                       \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline void store_##name( const int key, __VA_ARGS__, const Vec3<T>& v ) {                                           \
+    reserveForStore( key );                                                                                            \
+    v.x.store( locX + key );                                                                                           \
+    v.y.store( locY + key );                                                                                           \
+    v.z.store( locZ + key );                                                                                           \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline void compressstore_##name( const int key, __VA_ARGS__, MaskT mask, const Vec3<T>& v ) {                       \
+    reserveForStore( key );                                                                                            \
+    v.x.compressstore( mask, locX + key );                                                                             \
+    v.y.compressstore( mask, locY + key );                                                                             \
+    v.z.compressstore( mask, locZ + key );                                                                             \
+  }
+
+#define VEC3_XY_SOA_CHECKED_ACCESSOR_VAR( name, locX, locY, valZ, ... )                                                \
+  template <typename T>                                                                                                \
+  inline Vec3<T> name( const int key, __VA_ARGS__ ) const {                                                            \
+    return {locX + key, locY + key, valZ};                                                                             \
+  }                                                                                                                    \
+  template <typename T, typename I>                                                                                    \
+  inline Vec3<T> gather_##name( const I& key, __VA_ARGS__ ) const {                                                    \
+    return {gather( locX, key ), gather( locY, key ), valZ};                                                           \
+  }                                                                                                                    \
+  template <typename T, typename I, typename MaskT>                                                                    \
+  inline Vec3<T> maskgather_##name( const I& key, const MaskT& mask, const T& src, __VA_ARGS__ ) const {               \
+    return {maskgather( locX, key, mask, src ), maskgather( locY, key, mask, src ), valZ};                             \
+  }                                                                                                                    \
+  template <typename T>                                                                                                \
+  inline void store_##name( const int key, __VA_ARGS__, const Vec3<T>& v ) {                                           \
+    reserveForStore( key );                                                                                            \
+    v.x.store( locX + key );                                                                                           \
+    v.y.store( locY + key );                                                                                           \
+  }                                                                                                                    \
+  template <typename T, typename MaskT>                                                                                \
+  inline void compressstore_##name( const int key, __VA_ARGS__, MaskT mask, const Vec3<T>& v ) {                       \
+    reserveForStore( key );                                                                                            \
+    v.x.compressstore( mask, locX + key );                                                                             \
+    v.y.compressstore( mask, locY + key );                                                                             \
+  }
@@ -12,6 +12,7 @@
 #define EVENT_PRUTHITS_H 1
 
 // Include files
+#include "Event/PrSOAStorage.h"
 #include "LHCbMath/SIMDWrapper.h"
 
 /** @class PrUTHits PrUTHits.h
@@ -22,39 +23,26 @@
 
 namespace LHCb::Pr::UT {
 
-  class Hits {
-    constexpr static int max_hits = align_size( 10000 );
+  class Hits : public SOAStorage {
+    // the stores grow the storage, producers knowing the number of hits can give it as capacity
+    constexpr static int default_capacity = 256;
+    constexpr static int n_columns        = 8;
 
   public:
-    Hits() {
-      const size_t size = max_hits * 8;
-      m_data            = static_cast<data_t*>( std::aligned_alloc( 64, size * sizeof( int ) ) );
-    }
+    explicit Hits( int capacity = default_capacity, SOAAllocator allocator = {} )
+        : SOAStorage{n_columns, capacity, allocator} {}
 
     Hits( const Hits& ) = delete;
-
-    Hits( Hits&& other ) : m_data{std::exchange( other.m_data, nullptr )}, m_size{other.m_size} {}
-    int  size() const { return m_size; }
-    int& size() { return m_size; }
-
-    SOA_ACCESSOR( channelID, &m_data[0 * max_hits].i )
-    SOA_ACCESSOR( weight, &m_data[1 * max_hits].f )
-    SOA_ACCESSOR( xAtYEq0, &m_data[2 * max_hits].f )
-    SOA_ACCESSOR( yBegin, &m_data[3 * max_hits].f )
-    SOA_ACCESSOR( yEnd, &m_data[4 * max_hits].f )
-    SOA_ACCESSOR( zAtYEq0, &m_data[5 * max_hits].f )
-    SOA_ACCESSOR( dxDy, &m_data[6 * max_hits].f )
-    SOA_ACCESSOR( cos, &m_data[7 * max_hits].f )
-
-    ~Hits() { std::free( m_data ); }
-
-  private:
-    using data_t = union {
-      float f;
-      int   i;
-    };
-    alignas( 64 ) data_t* m_data;
-    int m_size = 0;
+    Hits( Hits&& )      = default;
+
+    SOA_CHECKED_ACCESSOR( channelID, &column( 0 )->i )
+    SOA_CHECKED_ACCESSOR( weight, &column( 1 )->f )
+    SOA_CHECKED_ACCESSOR( xAtYEq0, &column( 2 )->f )
+    SOA_CHECKED_ACCESSOR( yBegin, &column( 3 )->f )
+    SOA_CHECKED_ACCESSOR( yEnd, &column( 4 )->f )
+    SOA_CHECKED_ACCESSOR( zAtYEq0, &column( 5 )->f )
+    SOA_CHECKED_ACCESSOR( dxDy, &column( 6 )->f )
+    SOA_CHECKED_ACCESSOR( cos, &column( 7 )->f )
   };
 } // namespace LHCb::Pr::UT
 
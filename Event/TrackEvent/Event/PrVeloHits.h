@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "Event/PrSOAStorage.h"
 #include "LHCbMath/SIMDWrapper.h"
 #include "LHCbMath/Vec3.h"
 
@@ -21,38 +22,20 @@
  */
 
 namespace LHCb::Pr::Velo {
-  class Hits {
-    constexpr static int max_hits = align_size( 10000 );
+  class Hits : public SOAStorage {
+    // the stores grow the storage, producers knowing the number of hits can give it as capacity
+    constexpr static int default_capacity = 256;
+    constexpr static int n_columns        = 4;
 
   public:
-    Hits() {
-      const size_t size = max_hits * 4;
-      m_data            = static_cast<data_t*>( std::aligned_alloc( 64, size * sizeof( int ) ) );
-    }
+    explicit Hits( int capacity = default_capacity, SOAAllocator allocator = {} )
+        : SOAStorage{n_columns, capacity, allocator} {}
 
     Hits( const Hits& ) = delete;
+    Hits( Hits&& )      = default;
 
-    Hits( Hits&& other ) {
-      m_data       = other.m_data;
-      other.m_data = nullptr;
-      m_size       = other.m_size;
-    }
+    VEC3_SOA_CHECKED_ACCESSOR( pos, &( column( 0 )->f ), &( column( 1 )->f ), &( column( 2 )->f ) )
 
-    [[nodiscard]] int size() const { return m_size; }
-    int&              size() { return m_size; }
-
-    VEC3_SOA_ACCESSOR( pos, &( m_data->f ), &( m_data[max_hits].f ), &( m_data[2 * max_hits].f ) )
-
-    SOA_ACCESSOR( ChannelId, &m_data[3 * max_hits].i )
-
-    ~Hits() { std::free( m_data ); }
-
-  private:
-    using data_t = union {
-      float f;
-      int   i;
-    };
-    alignas( 64 ) data_t* m_data;
-    int m_size = 0;
+    SOA_CHECKED_ACCESSOR( ChannelId, &column( 3 )->i )
   };
 } // namespace LHCb::Pr::Velo
@@ -10,6 +10,7 @@
 \*****************************************************************************/
 
 #pragma once
+#include "Event/PrSOAStorage.h"
 #include "Event/PrVeloHits.h"
 #include "Kernel/LHCbID.h"
 #include "Kernel/VPChannelID.h"
@@ -24,59 +25,54 @@
  */
 
 namespace LHCb::Pr::Velo {
-  class Tracks {
-    constexpr static int max_tracks       = align_size( 1024 );
+  class Tracks : public SOAStorage {
+    constexpr static int default_capacity = 64;
     constexpr static int max_hits         = 26;
     constexpr static int max_states       = 2;
     constexpr static int params_per_state = 11;
     constexpr static int other_params     = 1;
+    constexpr static int n_columns        = max_hits + max_states * params_per_state + other_params;
 
   public:
-    Tracks( Zipping::ZipFamilyNumber zipIdentifier = Zipping::generateZipIdentifier() )
-        : m_zipIdentifier{zipIdentifier} {
-      const size_t size = max_tracks * ( max_hits + max_states * params_per_state + other_params );
-      m_data            = static_cast<data_t*>( std::aligned_alloc( 64, size * sizeof( int ) ) );
-    }
+    Tracks( Zipping::ZipFamilyNumber zipIdentifier = Zipping::generateZipIdentifier(), int capacity = default_capacity,
+            SOAAllocator allocator = {} )
+        : SOAStorage{n_columns, capacity, allocator}, m_zipIdentifier{zipIdentifier} {}
 
     Tracks( const Tracks& ) = delete;
 
     // Special constructor for zipping machinery
-    Tracks( Zipping::ZipFamilyNumber zipIdentifier, Tracks const& ) : Tracks( zipIdentifier ) {}
+    Tracks( Zipping::ZipFamilyNumber zipIdentifier, Tracks const& tracks )
+        : Tracks( zipIdentifier, tracks.capacity(), tracks.allocator() ) {}
 
-    Tracks( Tracks&& other )
-        : m_data{std::exchange( other.m_data, nullptr )}
-        , m_size{other.m_size}
-        , m_zipIdentifier{other.m_zipIdentifier} {}
+    Tracks( Tracks&& ) = default;
 
-    [[nodiscard]] int                      size() const { return m_size; }
-    int&                                   size() { return m_size; }
-    [[nodiscard]] bool                     empty() const { return m_size == 0; }
     [[nodiscard]] Zipping::ZipFamilyNumber zipIdentifier() const { return m_zipIdentifier; }
 
-    SOA_ACCESSOR( nHits, &( m_data->i ) )
-    SOA_ACCESSOR_VAR( hit, &( m_data[( hit + other_params ) * max_tracks].i ), int hit )
+    SOA_CHECKED_ACCESSOR( nHits, &( column( 0 )->i ) )
+    SOA_CHECKED_ACCESSOR_VAR( hit, &( column( hit + other_params )->i ), int hit )
 
-    VEC3_SOA_ACCESSOR_VAR( statePos, &( m_data[( max_hits + other_params + state * params_per_state ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 1 ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 2 ) * max_tracks].f ),
-                           int state )
+    VEC3_SOA_CHECKED_ACCESSOR_VAR( statePos,
+                                   &( column( max_hits + other_params + state * params_per_state )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 1 )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 2 )->f ),
+                                   int state )
 
-    VEC3_XY_SOA_ACCESSOR_VAR( stateDir,
-                              &( m_data[( max_hits + other_params + state * params_per_state + 3 ) * max_tracks].f ),
-                              &( m_data[( max_hits + other_params + state * params_per_state + 4 ) * max_tracks].f ),
-                              1.f, int state )
+    VEC3_XY_SOA_CHECKED_ACCESSOR_VAR( stateDir,
+                                      &( column( max_hits + other_params + state * params_per_state + 3 )->f ),
+                                      &( column( max_hits + other_params + state * params_per_state + 4 )->f ),
+                                      1.f, int state )
 
-    VEC3_SOA_ACCESSOR_VAR( stateCovX,
-                           &( m_data[( max_hits + other_params + state * params_per_state + 5 ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 6 ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 7 ) * max_tracks].f ),
-                           int state )
+    VEC3_SOA_CHECKED_ACCESSOR_VAR( stateCovX,
+                                   &( column( max_hits + other_params + state * params_per_state + 5 )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 6 )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 7 )->f ),
+                                   int state )
 
-    VEC3_SOA_ACCESSOR_VAR( stateCovY,
-                           &( m_data[( max_hits + other_params + state * params_per_state + 8 ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 9 ) * max_tracks].f ),
-                           &( m_data[( max_hits + other_params + state * params_per_state + 10 ) * max_tracks].f ),
-                           int state )
+    VEC3_SOA_CHECKED_ACCESSOR_VAR( stateCovY,
+                                   &( column( max_hits + other_params + state * params_per_state + 8 )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 9 )->f ),
+                                   &( column( max_hits + other_params + state * params_per_state + 10 )->f ),
+                                   int state )
 
     /// Retrieve the pseudorapidity at the first state
     template <typename T>
@@ -93,10 +89,11 @@ namespace LHCb::Pr::Velo {
     template <typename simd, typename maskT>
     void copy_back( const Tracks& from, int at, maskT mask ) {
       using intT = typename simd::int_v;
-      for ( int i = 0; i < max_hits + max_states * params_per_state + other_params; i++ ) {
-        intT( &( from.m_data[i * max_tracks + at].i ) ).compressstore( mask, &( m_data[i * max_tracks + m_size].i ) );
+      reserve( size() + simd::size );
+      for ( int i = 0; i < n_columns; i++ ) {
+        intT( &( from.column( i )[at].i ) ).compressstore( mask, &( column( i )[size()].i ) );
       }
-      m_size += simd::popcount( mask );
+      size() += simd::popcount( mask );
     }
 
     /// Retrieve the (sorted) set of LHCbIDs
@@ -122,15 +119,7 @@ namespace LHCb::Pr::Velo {
       return ids;
     }
 
-    ~Tracks() { std::free( m_data ); }
-
   private:
-    using data_t = union {
-      float f;
-      int   i;
-    };
-    alignas( 64 ) data_t* m_data;
-    int                      m_size = 0;
     Zipping::ZipFamilyNumber m_zipIdentifier;
   };
 } // namespace LHCb::Pr::Velo
@@ -0,0 +1,83 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Benchmark of the storage of the Pr SOA containers, using LHCb::Pr::Velo::Hits.
+// For several hit multiplicities, compares the time to create and fill a container, and its memory
+// footprint, between the former fixed layout (10000 hits allocated for every event), the growable
+// storage sized for the expected multiplicity, and the growable storage starting small and growing.
+//
+// usage: benchmark_PrSOAStorage [nEvents]
+#include "Event/PrVeloHits.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using simd  = SIMDWrapper::best::types;
+
+  /// the former layout of LHCb::Pr::Velo::Hits, with a fixed capacity
+  class FixedHits {
+  public:
+    constexpr static int max_hits = align_size( 10000 );
+    FixedHits() { m_data = static_cast<float*>( std::aligned_alloc( 64, max_hits * 4 * sizeof( float ) ) ); }
+    FixedHits( const FixedHits& ) = delete;
+    ~FixedHits() { std::free( m_data ); }
+    int&                      size() { return m_size; }
+    static constexpr std::size_t allocatedBytes() { return max_hits * 4 * sizeof( float ); }
+    VEC3_SOA_ACCESSOR( pos, m_data, m_data + max_hits, m_data + 2 * max_hits )
+    SOA_ACCESSOR( ChannelId, reinterpret_cast<int*>( m_data + 3 * max_hits ) )
+
+  private:
+    float* m_data;
+    int    m_size = 0;
+  };
+
+  template <typename HitsT>
+  void fill( HitsT& hits, int n ) {
+    for ( int i = 0; i < n; i += simd::size ) {
+      if constexpr ( !std::is_same_v<HitsT, FixedHits> ) hits.reserve( i + simd::size );
+      simd::float_v const x = simd::float_v( float( i ) );
+      hits.store_pos( i, Vec3<simd::float_v>( x, x, x ) );
+      hits.store_ChannelId( i, simd::int_v( i ) );
+    }
+    hits.size() = n;
+  }
+
+  template <typename Make>
+  void run( const char* name, int nEvents, int nHits, Make make ) {
+    std::size_t bytes = 0;
+    float       check = 0;
+    auto const  start = Clock::now();
+    for ( int evt = 0; evt < nEvents; ++evt ) {
+      auto hits = make();
+      fill( *hits, nHits );
+      bytes = hits->allocatedBytes();
+      check += hits->template pos<SIMDWrapper::scalar::float_v>( nHits - 1 ).x.cast();
+    }
+    double const time = std::chrono::duration<double, std::micro>( Clock::now() - start ).count() / nEvents;
+    std::printf( "%7d | %-14s | %10.2f | %10.1f%s\n", nHits, name, time, bytes / 1024., check < 0 ? " !" : "" );
+  }
+} // namespace
+
+int main( int argc, char* argv[] ) {
+  int const nEvents = argc > 1 ? std::atoi( argv[1] ) : 10000;
+  std::printf( "%7s | %-14s | %10s | %10s\n", "Hits", "Storage", "us/event", "kB" );
+  for ( int nHits : {100, 1000, 5000, 10000} ) {
+    run( "fixed", nEvents, nHits, [] { return std::make_unique<FixedHits>(); } );
+    run( "reserved", nEvents, nHits, [nHits] { return std::make_unique<LHCb::Pr::Velo::Hits>( nHits ); } );
+    run( "growing", nEvents, nHits, [] { return std::make_unique<LHCb::Pr::Velo::Hits>( 64 ); } );
+  }
+  // beyond the former limit, only the growable storage works
+  run( "growing", nEvents / 10, 50000, [] { return std::make_unique<LHCb::Pr::Velo::Hits>( 64 ); } );
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utestPrSOAStorage
+#include <boost/test/unit_test.hpp>
+
+#include "Event/PrForwardTracks.h"
+#include "Event/PrUTHits.h"
+#include "Event/PrVeloHits.h"
+#include "Event/PrVeloTracks.h"
+#include "Kernel/ArenaAllocator.h"
+
+using LHCb::Pr::Velo::Hits;
+using simd = SIMDWrapper::scalar::types;
+
+namespace {
+  void fill( Hits& hits, int n ) {
+    for ( int i = 0; i < n; ++i ) {
+      hits.reserve( hits.size() + 1 );
+      hits.store_pos( hits.size(), Vec3<simd::float_v>( i, 2.f * i, 3.f * i ) );
+      hits.store_ChannelId( hits.size(), simd::int_v( i ) );
+      ++hits.size();
+    }
+  }
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_grow ) {
+  Hits hits{10};
+  BOOST_CHECK_GE( hits.capacity(), 10 );
+  fill( hits, 1000 );
+  BOOST_CHECK_EQUAL( hits.size(), 1000 );
+  BOOST_CHECK_GE( hits.capacity(), 1000 );
+  // geometric growth: less than twice the needed size
+  BOOST_CHECK_LT( hits.capacity(), 2 * 1000 + 16 );
+  for ( int i = 0; i < hits.size(); ++i ) {
+    BOOST_CHECK_EQUAL( hits.pos<simd::float_v>( i ).z.cast(), 3.f * i );
+    BOOST_CHECK_EQUAL( hits.ChannelId<simd::int_v>( i ).cast(), i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_checked_store ) {
+  // no reserve: the stores grow the storage, keeping the entries of the row being written
+  Hits hits{0};
+  for ( int i = 0; i < 1000; ++i ) {
+    hits.store_ChannelId( hits.size(), simd::int_v( i ) );
+    hits.store_pos( hits.size(), Vec3<simd::float_v>( i, 2.f * i, 3.f * i ) );
+    ++hits.size();
+  }
+  BOOST_CHECK_GE( hits.capacity(), 1000 );
+  for ( int i = 0; i < hits.size(); ++i ) {
+    BOOST_CHECK_EQUAL( hits.pos<simd::float_v>( i ).x.cast(), float( i ) );
+    BOOST_CHECK_EQUAL( hits.ChannelId<simd::int_v>( i ).cast(), i );
+  }
+
+  // entries stored before the size is updated are kept as well
+  LHCb::Pr::UT::Hits ut{16};
+  for ( int i = 0; i < 100; ++i ) {
+    ut.compressstore_channelID( i, simd::mask_v( true ), simd::int_v( i ) );
+    ut.store_weight( i, simd::float_v( 0.5f * i ) );
+  }
+  ut.size() = 100;
+  BOOST_CHECK_GE( ut.capacity(), 100 );
+  for ( int i = 0; i < ut.size(); ++i ) {
+    BOOST_CHECK_EQUAL( ut.channelID<simd::int_v>( i ).cast(), i );
+    BOOST_CHECK_EQUAL( ut.weight<simd::float_v>( i ).cast(), 0.5f * i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_checked_track_stores ) {
+  // more tracks than the default capacity, filled without reserve
+  LHCb::Pr::Velo::Tracks velo;
+  for ( int t = 0; t < 3000; ++t ) {
+    velo.store_nHits( t, simd::int_v( t % 26 ) );
+    velo.store_hit( t, 25, simd::int_v( t ) );
+    velo.store_statePos( t, 1, Vec3<simd::float_v>( t, 2.f * t, 3.f * t ) );
+    velo.store_stateDir( t, 1, Vec3<simd::float_v>( 0.5f * t, t, 1.f ) );
+    velo.store_stateCovY( t, 1, Vec3<simd::float_v>( t, t, 4.f * t ) );
+    ++velo.size();
+  }
+  BOOST_CHECK_GE( velo.capacity(), 3000 );
+  for ( int t = 0; t < velo.size(); ++t ) {
+    BOOST_CHECK_EQUAL( velo.nHits<simd::int_v>( t ).cast(), t % 26 );
+    BOOST_CHECK_EQUAL( velo.hit<simd::int_v>( t, 25 ).cast(), t );
+    BOOST_CHECK_EQUAL( velo.statePos<simd::float_v>( t, 1 ).z.cast(), 3.f * t );
+    BOOST_CHECK_EQUAL( velo.stateDir<simd::float_v>( t, 1 ).x.cast(), 0.5f * t );
+    BOOST_CHECK_EQUAL( velo.stateCovY<simd::float_v>( t, 1 ).z.cast(), 4.f * t );
+  }
+
+  LHCb::Pr::Forward::Tracks forward{&velo, nullptr};
+  for ( int t = 0; t < 2000; ++t ) {
+    forward.store_trackVP( t, simd::int_v( t ) );
+    forward.store_hit( t, 39, simd::int_v( 2 * t ) );
+    forward.store_statePos( t, Vec3<simd::float_v>( t, t, 5.f * t ) );
+    forward.store_stateDir( t, Vec3<simd::float_v>( 0.25f * t, t, 1.f ) );
+    ++forward.size();
+  }
+  BOOST_CHECK_GE( forward.capacity(), 2000 );
+  for ( int t = 0; t < forward.size(); ++t ) {
+    BOOST_CHECK_EQUAL( forward.trackVP<simd::int_v>( t ).cast(), t );
+    BOOST_CHECK_EQUAL( forward.hit<simd::int_v>( t, 39 ).cast(), 2 * t );
+    BOOST_CHECK_EQUAL( forward.statePos<simd::float_v>( t ).z.cast(), 5.f * t );
+    BOOST_CHECK_EQUAL( forward.stateDir<simd::float_v>( t ).x.cast(), 0.25f * t );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_reserve_and_move ) {
+  Hits hits{0};
+  hits.reserve( 100 );
+  auto const capacity = hits.capacity();
+  BOOST_CHECK_GE( capacity, 100 );
+  fill( hits, 100 );
+  BOOST_CHECK_EQUAL( hits.capacity(), capacity );
+  Hits moved{std::move( hits )};
+  BOOST_CHECK_EQUAL( moved.size(), 100 );
+  BOOST_CHECK_EQUAL( moved.ChannelId<simd::int_v>( 99 ).cast(), 99 );
+  BOOST_CHECK_EQUAL( hits.size(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_allocators ) {
+  // the arena only guarantees 16 bytes alignment, the columns must be realigned
+  using Arena = LHCb::Allocators::DynamicArena<16>;
+  auto arena  = Arena::create( 1 << 20 );
+  arena->allocate<16>( 16 );
+  {
+    Hits hits{64, LHCb::Allocators::DynamicArenaAllocator<std::byte, 16>{arena.get()}};
+    BOOST_CHECK_GE( arena->used(), 16 + hits.allocatedBytes() );
+    fill( hits, 5000 );
+    BOOST_CHECK_EQUAL( hits.ChannelId<simd::int_v>( 4999 ).cast(), 4999 );
+    BOOST_CHECK_EQUAL( hits.pos<simd::float_v>( 4999 ).y.cast(), 2.f * 4999 );
+  }
+
+  Hits hits{100, std::allocator<float>{}};
+  fill( hits, 200 );
+  BOOST_CHECK_EQUAL( hits.ChannelId<simd::int_v>( 199 ).cast(), 199 );
+}
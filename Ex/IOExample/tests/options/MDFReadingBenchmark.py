@@ -0,0 +1,57 @@
+###############################################################################
+# (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      #
+#                                                                             #
+# This software is distributed under the terms of the GNU General Public      #
+# Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   #
+#                                                                             #
+# In applying this licence, CERN does not waive the privileges and immunities #
+# granted to it by virtue of its status as an Intergovernmental Organization  #
+# or submit itself to any jurisdiction.                                       #
+###############################################################################
+# Throughput comparison of the IOSvc implementations, only reading events.
+# The implementation and the number of threads are taken from the environment,
+# the event rate is printed by the HLTControlFlowMgr at finalization, e.g. :
+#   for svc in MM FileRead Uring; do
+#     for n in 1 4 16; do
+#       IOSVC=$svc THREADS=$n gaudirun.py MDFReadingBenchmark.py | grep "Evts/s"
+#     done
+#   done
+# Note that for a fair comparison of cold reads the page cache has to be dropped
+# between runs (echo 3 > /proc/sys/vm/drop_caches), as IOSvcUring bypasses it by default
+from Gaudi.Configuration import ApplicationMgr
+from Configurables import (HiveWhiteBoard, HLTControlFlowMgr,
+                           HiveDataBrokerSvc, LHCb__MDF__IOAlg)
+import Configurables
+import os
+
+implementation = os.environ.get("IOSVC", "MM")
+nThreads = int(os.environ.get("THREADS", "4"))
+nCopies = int(os.environ.get("NCOPIES", "10"))
+
+# setup core Gaudi, no conditions needed to only read events
+whiteboard = HiveWhiteBoard(
+    "EventDataSvc", EventSlots=nThreads + 1, ForceLeaves=True)
+eventloopmgr = HLTControlFlowMgr(
+    "HLTControlFlowMgr",
+    CompositeCFNodes=[('moore', 'LAZY_AND', [], True)],
+    ThreadPoolSize=nThreads)
+appMgr = ApplicationMgr(
+    'ApplicationMgr', EventLoop=eventloopmgr, EvtMax=-1, EvtSel='NONE')
+appMgr.ExtSvc.insert(0, whiteboard)
+hiveDataBroker = HiveDataBrokerSvc('HiveDataBrokerSvc')
+
+path = "/tmp/00067189.mdf"
+if not os.path.isfile(path):
+    os.system(
+        "xrdcp -s root://eoslhcb.cern.ch//eos/lhcb/grid/prod/lhcb/swtest/lhcb/swtest/MiniBrunel/00067189.mdf %s"
+        % path)
+files = [path] * nCopies
+
+svcName = 'LHCb::MDF::IOSvc' + implementation
+mdfioSvc = getattr(Configurables, 'LHCb__MDF__IOSvc' + implementation)(
+    svcName, Input=files)
+fetchData = LHCb__MDF__IOAlg(
+    'ReadMDFInput', RawEventLocation="/Event/DAQ/RawEvent", IOSvc=svcName)
+hiveDataBroker.DataProducers.append(fetchData)
+appMgr.TopAlg.append(fetchData)
+appMgr.EventLoop.CompositeCFNodes[0][2].extend([fetchData.name()])
@@ -0,0 +1,29 @@
+###############################################################################
+# (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      #
+#                                                                             #
+# This software is distributed under the terms of the GNU General Public      #
+# Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   #
+#                                                                             #
+# In applying this licence, CERN does not waive the privileges and immunities #
+# granted to it by virtue of its status as an Intergovernmental Organization  #
+# or submit itself to any jurisdiction.                                       #
+###############################################################################
+# Compares enqueue-to-start latency and throughput of the thread pools that
+# HLTControlFlowMgr can use (tbb::task::enqueue, ThreadPool, WorkStealingPool).
+#
+# usage: python benchmark_ThreadPools.py [nTasks]
+# needs the HLTScheduler.benchmark_ThreadPools executable (built with tests) in the PATH
+import subprocess
+import sys
+
+#configuration
+nTasks = int(sys.argv[1]) if len(sys.argv) > 1 else 1000000
+threads = [1, 2, 4, 8, 16, 32, 64]
+
+subprocess.check_call(['HLTScheduler.benchmark_ThreadPools',
+                       str(nTasks)] + [str(t) for t in threads])
+
+# For the full application, the equivalent of the benchmark_HLTControlFlowMgr.py
+# configuration with the work-stealing pool is obtained with
+#   gaudirun.py benchmark_HLTControlFlowMgr.py --option \
+#     "from Configurables import HLTControlFlowMgr; HLTControlFlowMgr().UseWorkStealingPool = True"
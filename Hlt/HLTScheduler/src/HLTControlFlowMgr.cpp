@@ -11,6 +11,7 @@
 #include "HLTControlFlowMgr.h"
 #include "GaudiKernel/IDataSelector.h"
 #include "GaudiKernel/SerializeSTL.h"
+#include "Kernel/NUMATopology.h"
 #include <thread>
 #include <x86intrin.h>
 
@@ -96,6 +97,18 @@ namespace {
 
     void on_scheduler_exit( bool ) override { m_thread_count--; }
   };
+
+  // pin the threads of an arena to the CPUs of a NUMA node
+  struct numa_pinning_observer final : public tbb::task_scheduler_observer {
+    std::size_t m_node;
+
+    numa_pinning_observer( tbb::task_arena& arena, std::size_t node )
+        : tbb::task_scheduler_observer( arena ), m_node( node ) {
+      observe( true );
+    }
+
+    void on_scheduler_entry( bool ) override { LHCb::NUMA::bindCurrentThreadToNode( m_node ); }
+  };
 } // namespace
 
 StatusCode HLTControlFlowMgr::initialize() {
@@ -263,6 +276,12 @@ StatusCode HLTControlFlowMgr::finalize() {
       info() << boost::format{"| %15u"} % static_cast<double>( ctr.nEntries() ) << '\n';
     }
   }
+  if ( !m_timedEvtPerNode.empty() && m_timedMilliSeconds > 0 ) {
+    info() << "\n | NUMA node | Timed Events    | Evts/s          |\n";
+    for ( auto const& [node, evts] : Gaudi::Functional::details::zip::range( m_numaNodeIDs, m_timedEvtPerNode ) ) {
+      info() << boost::format{" | %9u | %15u | %15.1f |\n"} % node % evts % ( evts / m_timedMilliSeconds * 1e3 );
+    }
+  }
   info() << endmsg;
 
   // print the counters
@@ -339,6 +358,8 @@ StatusCode HLTControlFlowMgr::executeEvent( EventContext&& evtContext ) {
   if ( UNLIKELY( msgLevel( MSG::VERBOSE ) ) )
     verbose() << "Event " << evtContext.evt() << " submitting in slot " << evtContext.slot() << endmsg;
 
+  auto const numaNode = m_numaArenas.empty() ? 0 : numaNodeOfSlot( evtContext.slot() );
+
   auto event_task = [evt_root_ptr, evtContext = std::move( evtContext ), this]() mutable {
     auto sc = m_whiteboard->selectStore( evtContext.slot() );
     if ( sc.isFailure() ) {
@@ -383,18 +404,22 @@ StatusCode HLTControlFlowMgr::executeEvent( EventContext&& evtContext ) {
       }
     }
 
-    for ( gsl::not_null<VNode*> execNode : m_orderedNodesVec ) {
-
-      std::visit( overload{[&, ns = std::ref( NodeStates ), as = std::ref( AlgStates ),
-                            ts = std::ref( m_TimingCounters )]( BasicNode& bNode ) {
-                             if ( bNode.requested( ns.get() ) ) {
-                               bNode.execute( ns.get(), as.get(), ts.get(), m_createTimingTable, evtContext,
-                                              m_algExecStateSvc, appmgr );
-                               bNode.notifyParents( ns.get() );
-                             }
-                           },
-                           []( ... ) {}},
-                  *execNode );
+    if ( m_intraEventParallelism ) {
+      executeNodesConcurrently( evtContext, NodeStates, AlgStates, appmgr );
+    } else {
+      for ( gsl::not_null<VNode*> execNode : m_orderedNodesVec ) {
+
+        std::visit( overload{[&, ns = std::ref( NodeStates ), as = std::ref( AlgStates ),
+                              ts = std::ref( m_TimingCounters )]( BasicNode& bNode ) {
+                               if ( bNode.requested( ns.get() ) ) {
+                                 bNode.execute( ns.get(), as.get(), ts.get(), m_createTimingTable, evtContext,
+                                                m_algExecStateSvc, appmgr );
+                                 bNode.notifyParents( ns.get() );
+                               }
+                             },
+                             []( ... ) {}},
+                    *execNode );
+      }
     }
     m_algExecStateSvc->updateEventStatus( false, evtContext );
 
@@ -417,7 +442,13 @@ StatusCode HLTControlFlowMgr::executeEvent( EventContext&& evtContext ) {
   if constexpr ( use_debuggable_threadpool ) {
     m_debug_pool->enqueue( std::move( event_task ) );
   } else {
-    enqueue( std::move( event_task ) );
+    if ( m_workstealing_pool ) {
+      m_workstealing_pool->enqueue( std::move( event_task ) );
+    } else if ( !m_numaArenas.empty() ) {
+      m_numaArenas[numaNode]->enqueue( std::move( event_task ) );
+    } else {
+      enqueue( std::move( event_task ) );
+    }
   }
 
   return StatusCode::SUCCESS;
@@ -453,14 +484,35 @@ StatusCode HLTControlFlowMgr::nextEvent( int maxevt ) {
 
   if constexpr ( use_debuggable_threadpool ) {
     m_debug_pool = std::make_unique<ThreadPool>( m_threadPoolSize.value() );
+  } else {
+    if ( m_useWorkStealingPool ) {
+      if ( m_threadPoolSize.value() < 1 ) {
+        fatal() << "UseWorkStealingPool requires an explicit ThreadPoolSize > 0" << endmsg;
+        return StatusCode::FAILURE;
+      }
+      // only the event tasks go through the pool (the intra event parallelism uses a tbb::task_group), at most one
+      // per event slot. A task frees its event slot before its pool slot, hence some margin not to wait in enqueue
+      m_workstealing_pool = std::make_unique<WorkStealingPool>( m_threadPoolSize.value(),
+                                                                4 * m_whiteboard->getNumberOfStores() );
+    }
   }
   // create th tbb thread pool
   tbb::task_scheduler_init tbbSchedInit( m_threadPoolSize.value() + 1 );
   task_observer            taskObsv{};
+  if ( m_numaAware ) {
+    if ( m_workstealing_pool ) {
+      warning() << "NUMAAware is not supported together with UseWorkStealingPool, ignoring it" << endmsg;
+    } else {
+      createNUMAArenas();
+    }
+  }
 
   auto shutdown_threadpool = [&]() {
     if constexpr ( !use_debuggable_threadpool ) {
-      tbbSchedInit.terminate();             // non blocking
+      m_workstealing_pool.reset(); // blocking, runs the remaining tasks and joins
+      m_numaObservers.clear();
+      m_numaArenas.clear();
+      tbbSchedInit.terminate();    // non blocking
       while ( taskObsv.m_thread_count > 0 ) // this is our "threads.join()" alternative
         std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
     }
@@ -533,8 +585,13 @@ StatusCode HLTControlFlowMgr::nextEvent( int maxevt ) {
       if ( UNLIKELY( static_cast<unsigned int>( m_stopTimeAtEvt ) < m_finishedEvt && !endTime && m_finishedEvt > 0 ) ) {
         m_stopTimeAtEvt = m_finishedEvt;
         endTime         = Clock::now();
+        for ( std::size_t i = 0; i < m_timedEvtPerNode.size(); ++i )
+          m_timedEvtPerNode[i] = m_finishedEvtPerNode[i] - m_timedEvtPerNode[i];
+      }
+      if ( UNLIKELY( m_startTimeAtEvt == m_nextevt ) ) {
+        startTime = Clock::now();
+        for ( std::size_t i = 0; i < m_timedEvtPerNode.size(); ++i ) m_timedEvtPerNode[i] = m_finishedEvtPerNode[i];
       }
-      if ( UNLIKELY( m_startTimeAtEvt == m_nextevt ) ) startTime = Clock::now();
 
       auto       evtContext = createEventContext();
       StatusCode sc         = executeEvent( std::move( evtContext ) );
@@ -551,6 +608,8 @@ StatusCode HLTControlFlowMgr::nextEvent( int maxevt ) {
   if ( !endTime ) {
     endTime         = Clock::now();
     m_stopTimeAtEvt = m_finishedEvt;
+    for ( std::size_t i = 0; i < m_timedEvtPerNode.size(); ++i )
+      m_timedEvtPerNode[i] = m_finishedEvtPerNode[i] - m_timedEvtPerNode[i];
   }
 
   shutdown_threadpool();
@@ -563,6 +622,7 @@ StatusCode HLTControlFlowMgr::nextEvent( int maxevt ) {
            << endmsg;
   } else {
     auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>( *endTime - *startTime ).count();
+    m_timedMilliSeconds = totalTime;
 
     info() << "---> Loop over " << m_finishedEvt << " Events Finished - "
            << " WSS " << System::mappedMemory( System::MemoryUnit::kByte ) * 1. / 1024. << ", timed "
@@ -624,6 +684,8 @@ void HLTControlFlowMgr::promoteToExecuted( EventContext&& eventContext ) const {
   if ( msgLevel( MSG::VERBOSE ) )
     verbose() << "Clearing slot " << si << " (event " << eventContext.evt() << ") of the whiteboard" << endmsg;
 
+  if ( !m_finishedEvtPerNode.empty() ) ++m_finishedEvtPerNode[si % m_finishedEvtPerNode.size()];
+
   auto sc = m_whiteboard->clearStore( si );
   if ( !sc.isSuccess() ) warning() << "Clear of Event data store failed" << endmsg;
   sc = m_whiteboard->freeStore( si );
@@ -632,6 +694,34 @@ void HLTControlFlowMgr::promoteToExecuted( EventContext&& eventContext ) const {
   m_createEventCond.notify_all();
 }
 
+void HLTControlFlowMgr::createNUMAArenas() {
+  auto const& nodeCPUs = LHCb::NUMA::nodeCPUs();
+  m_numaNodeIDs.clear();
+  for ( std::size_t node = 0; node < nodeCPUs.size(); ++node ) {
+    if ( !nodeCPUs[node].empty() ) m_numaNodeIDs.push_back( node ); // skip memory only nodes
+  }
+  auto const nNodes   = m_numaNodeIDs.size();
+  auto const nThreads = std::max<std::size_t>( m_threadPoolSize.value() > 0 ? m_threadPoolSize.value() : 1, nNodes );
+
+  // split the threads as evenly as possible between the nodes
+  for ( std::size_t i = 0; i < nNodes; ++i ) {
+    auto const concurrency = nThreads / nNodes + ( i < nThreads % nNodes ? 1 : 0 );
+    // no slot reserved for an application thread: the events are only enqueued, never executed from
+    // the main thread, so all the slots must go to worker threads (an arena of 1 would run nothing)
+    auto& arena = m_numaArenas.emplace_back( std::make_unique<tbb::task_arena>( concurrency, 0 ) );
+    arena->initialize();
+    m_numaObservers.emplace_back( std::make_unique<numa_pinning_observer>( *arena, m_numaNodeIDs[i] ) );
+    info() << "NUMA node " << m_numaNodeIDs[i] << ": " << concurrency << " threads" << endmsg;
+  }
+
+  if ( m_whiteboard->getNumberOfStores() % nNodes != 0 ) {
+    warning() << "Number of event slots (" << m_whiteboard->getNumberOfStores()
+              << ") is not a multiple of the number of NUMA nodes (" << nNodes << ")" << endmsg;
+  }
+  m_finishedEvtPerNode = std::vector<std::atomic<uint32_t>>( nNodes );
+  m_timedEvtPerNode.assign( nNodes, 0 );
+}
+
 // scheduling functionality----------------------------------------------------
 
 void HLTControlFlowMgr::buildLines() { // here lines are configured, filled into the node vector m_allVNodes and
@@ -806,6 +896,142 @@ void HLTControlFlowMgr::configureScheduling() {
 
   // print out the order
   if ( msgLevel( MSG::DEBUG ) ) debug() << "ordered nodes: " << m_orderedNodesVec << endmsg;
+
+  if ( m_intraEventParallelism ) buildNodeDependencyGraph( allEdges );
+}
+
+// Builds the graph that is used to execute basic nodes concurrently within an event. Node j has to wait for node i if
+// there is a control flow edge i -> j or if both nodes share a required algorithm (which covers all data dependencies,
+// as the producers of a node's input are part of its m_RequiredAlgs). The latter also guarantees that no algorithm is
+// ever executed twice or concurrently within an event. As m_orderedNodesVec respects all these constraints, every edge
+// points forward in that vector, so the graph is acyclic by construction.
+void HLTControlFlowMgr::buildNodeDependencyGraph(
+    std::set<std::vector<std::set<gsl::not_null<VNode*>>>> const& allEdges ) {
+  auto const nNodes = m_orderedNodesVec.size();
+  if ( nNodes > std::numeric_limits<uint16_t>::max() ) {
+    throw GaudiException( "Too many basic nodes for intra event parallelism", __func__, StatusCode::FAILURE );
+  }
+
+  auto position = [&]( VNode const* vnode ) {
+    auto it = std::find_if( begin( m_orderedNodesVec ), end( m_orderedNodesVec ),
+                            [vnode]( VNode const* ordered ) { return ordered == vnode; } );
+    assert( it != end( m_orderedNodesVec ) );
+    return static_cast<uint16_t>( std::distance( begin( m_orderedNodesVec ), it ) );
+  };
+
+  std::vector<std::set<uint16_t>> successors( nNodes );
+
+  // control flow dependencies
+  for ( auto const& edge : allEdges ) {
+    for ( VNode const* from : edge[0] ) {
+      for ( VNode const* to : edge[1] ) { successors[position( from )].insert( position( to ) ); }
+    }
+  }
+
+  // data dependencies, i.e. shared required algorithms
+  std::vector<std::vector<uint16_t>> requiredAlgIndices( nNodes );
+  for ( std::size_t i = 0; i != nNodes; ++i ) {
+    std::visit( overload{[&]( BasicNode const& node ) {
+                           for ( AlgWrapper const& alg : node.m_RequiredAlgs )
+                             requiredAlgIndices[i].push_back( alg.m_executedIndex );
+                           std::sort( begin( requiredAlgIndices[i] ), end( requiredAlgIndices[i] ) );
+                         },
+                         []( ... ) {}},
+                *m_orderedNodesVec[i] );
+  }
+  for ( std::size_t i = 0; i != nNodes; ++i ) {
+    for ( std::size_t j = i + 1; j != nNodes; ++j ) {
+      auto const& a = requiredAlgIndices[i];
+      auto const& b = requiredAlgIndices[j];
+      for ( auto ia = begin( a ), ib = begin( b ); ia != end( a ) && ib != end( b ); ) {
+        if ( *ia < *ib ) {
+          ++ia;
+        } else if ( *ib < *ia ) {
+          ++ib;
+        } else {
+          successors[i].insert( static_cast<uint16_t>( j ) );
+          break;
+        }
+      }
+    }
+  }
+
+  m_nodeSuccessors.assign( nNodes, {} );
+  m_nodePredecessorCount.assign( nNodes, 0 );
+  for ( std::size_t i = 0; i != nNodes; ++i ) {
+    for ( uint16_t j : successors[i] ) {
+      assert( j > i );
+      m_nodeSuccessors[i].push_back( j );
+      ++m_nodePredecessorCount[j];
+    }
+  }
+
+  auto const nRoots = std::count( begin( m_nodePredecessorCount ), end( m_nodePredecessorCount ), 0 );
+  info() << "Intra event parallelism enabled: " << nRoots << " out of " << nNodes
+         << " basic nodes can start immediately" << endmsg;
+}
+
+// Executes the basic nodes of one event as a task graph. A node is spawned as soon as all nodes it depends on are
+// finished. Whether it is still requested is only decided at that point, so the lazy semantics of ordered composite
+// nodes are the same as in the sequential mode. Children of an unordered lazy composite may run concurrently, hence
+// some of them can be executed although a sibling already decided the outcome, just like any execution order is
+// allowed for them in the sequential mode. All accesses to NodeStates that travel through the tree (requested and
+// notifyParents) are serialised by a per-event mutex, the algorithms themselves run outside of it.
+void HLTControlFlowMgr::executeNodesConcurrently( EventContext& evtContext, std::vector<NodeState>& NodeStates,
+                                                  std::vector<AlgState>& AlgStates,
+                                                  SmartIF<IProperty>&    appmgr ) {
+  auto const nNodes = m_orderedNodesVec.size();
+  auto       pendingPredecessors = std::make_unique<std::atomic<uint16_t>[]>( nNodes );
+  for ( std::size_t i = 0; i != nNodes; ++i ) pendingPredecessors[i] = m_nodePredecessorCount[i];
+
+  std::mutex      stateMutex;
+  tbb::task_group group;
+
+  // executes a node, releases its successors and continues with the first released one in this very task
+  auto run_from = [&]( uint16_t index, auto& itself ) -> void {
+    // the whiteboard slot and the context are thread local, so they need to be set in every task
+    Gaudi::Hive::setCurrentContext( evtContext );
+
+    for ( std::optional<uint16_t> current = index; current; ) {
+      std::visit( overload{[&]( BasicNode const& bNode ) {
+                             bool isRequested;
+                             {
+                               std::lock_guard<std::mutex> lock{stateMutex};
+                               isRequested = bNode.requested( NodeStates );
+                             }
+                             if ( isRequested ) {
+                               bNode.execute( NodeStates, AlgStates, m_TimingCounters, m_createTimingTable,
+                                              evtContext, m_algExecStateSvc, appmgr );
+                               std::lock_guard<std::mutex> lock{stateMutex};
+                               bNode.notifyParents( NodeStates );
+                             }
+                           },
+                           []( ... ) {}},
+                  *m_orderedNodesVec[*current] );
+
+      std::optional<uint16_t> next;
+      for ( uint16_t successor : m_nodeSuccessors[*current] ) {
+        if ( --pendingPredecessors[successor] == 0 ) {
+          if ( !next ) {
+            next = successor;
+          } else {
+            group.run( [&itself, successor] { itself( successor, itself ); } );
+          }
+        }
+      }
+      current = next;
+    }
+  };
+
+  for ( std::size_t i = 0; i != nNodes; ++i ) {
+    if ( m_nodePredecessorCount[i] == 0 ) {
+      group.run( [&run_from, i] { run_from( static_cast<uint16_t>( i ), run_from ); } );
+    }
+  }
+  group.wait();
+
+  // the helper tasks may have changed the current context of this thread
+  Gaudi::Hive::setCurrentContext( evtContext );
 }
 
 void HLTControlFlowMgr::buildNodeStates() {
@@ -16,6 +16,7 @@
 // which means very early on in the compilation unit.
 #include "CFNodePropertiesParse.h"
 #include "ThreadPool.h"
+#include "WorkStealingPool.h"
 // FW includes
 #include "GaudiAlg/FunctionalDetails.h"
 #include "GaudiKernel/Algorithm.h"
@@ -41,12 +42,15 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
 // tbb
 #include "tbb/task.h"
+#include "tbb/task_arena.h"
+#include "tbb/task_group.h"
 #include "tbb/task_scheduler_init.h"
 #include "tbb/task_scheduler_observer.h"
 
@@ -92,6 +96,11 @@ private:
   void configureScheduling();
   // build per-thread state-vector
   void buildNodeStates();
+  // build the dependency graph between the ordered basic nodes for intra-event parallelism
+  void buildNodeDependencyGraph( std::set<std::vector<std::set<gsl::not_null<VNode*>>>> const& allEdges );
+  // execute the ordered basic nodes of one event as a graph of concurrent tasks
+  void executeNodesConcurrently( EventContext& evtContext, std::vector<NodeState>& NodeStates,
+                                 std::vector<AlgState>& AlgStates, SmartIF<IProperty>& appmgr );
 
   // helper to release context
   inline StatusCode releaseEvtSelContext() {
@@ -118,6 +127,11 @@ private:
     return sc;
   }
 
+  // create one TBB arena per NUMA node, with its threads pinned to the node
+  void createNUMAArenas();
+  // NUMA node (index in m_numaArenas) a whiteboard slot is bound to
+  std::size_t numaNodeOfSlot( std::size_t slot ) const { return slot % m_numaArenas.size(); }
+
   // functions to create m_printableDependencyTree
   void registerStructuredTree();
   void registerTreePrintWidth();
@@ -128,12 +142,20 @@ private:
   mutable std::atomic<uint16_t> m_failed_evts_detected = 0;
   mutable bool                  m_shutdown_now         = false;
 
-  std::unique_ptr<ThreadPool> m_debug_pool = nullptr;
+  std::unique_ptr<ThreadPool>       m_debug_pool         = nullptr;
+  std::unique_ptr<WorkStealingPool> m_workstealing_pool = nullptr;
 
 private:
   Gaudi::Property<std::string> m_histPersName{this, "HistogramPersistency", "", ""};
   Gaudi::Property<std::string> m_evtsel{this, "EvtSel", "", ""};
   Gaudi::Property<int> m_threadPoolSize{this, "ThreadPoolSize", -1, "Size of the threadpool initialised by TBB"};
+  Gaudi::Property<bool> m_numaAware{
+      this, "NUMAAware", false,
+      "Bind event slots to NUMA nodes. Events in a given slot are always processed in the TBB arena of the slot's node, "
+      "whose threads are pinned to that node"};
+  Gaudi::Property<bool> m_useWorkStealingPool{
+      this, "UseWorkStealingPool", false,
+      "Run the event tasks on a WorkStealingPool of ThreadPoolSize threads instead of enqueueing them to TBB"};
   Gaudi::Property<int> m_printFreq{this, "PrintFreq", 1, "Print Frequency for the full algorithm tree"};
   Gaudi::Property<std::vector<NodeDefinition>> m_compositeCFProperties{
       this, "CompositeCFNodes", {}, "Specification of composite CF nodes"};
@@ -169,6 +191,11 @@ private:
   Gaudi::Property<bool> m_EnableLegacyMode{
       this, "EnableLegacyMode", false,
       "Call SysExecute of an algorithm. If false algorithms will be called via execute which is faster."};
+  // intra-event parallelism lowers the latency of single events, which helps when there are fewer events in flight
+  // than threads. It only pays off if the independent branches are reasonably expensive.
+  Gaudi::Property<bool> m_intraEventParallelism{
+      this, "IntraEventParallelism", false,
+      "Execute basic nodes without control flow or data dependencies between them as concurrent tasks within an event"};
 
   /// Reference to the Event Data Service's IDataManagerSvc interface
   IDataManagerSvc* m_evtDataMgrSvc = nullptr;
@@ -187,6 +214,15 @@ private:
 
   /// atomic count of the number of finished events
   mutable std::atomic<uint32_t> m_finishedEvt{0};
+  /// in NUMAAware mode, one arena per NUMA node (with CPUs) and the observers pinning their threads
+  std::vector<std::unique_ptr<tbb::task_arena>>            m_numaArenas;
+  std::vector<std::unique_ptr<tbb::task_scheduler_observer>> m_numaObservers;
+  /// in NUMAAware mode, kernel ids of the nodes used and number of finished events per node
+  std::vector<std::size_t>                    m_numaNodeIDs;
+  mutable std::vector<std::atomic<uint32_t>> m_finishedEvtPerNode;
+  /// in NUMAAware mode, events finished per node during the timed part of the loop, and its duration
+  std::vector<uint32_t> m_timedEvtPerNode;
+  double                m_timedMilliSeconds{0};
   /// condition variable to wake up main thread when we need to create a new event
   mutable std::condition_variable m_createEventCond;
   /// mutex assoiciated with m_createEventCond condition variable
@@ -209,6 +245,10 @@ private:
   std::vector<VNode> m_allVNodes;
   // all nodes to execute in ordered manner
   std::vector<gsl::not_null<VNode*>> m_orderedNodesVec;
+  // for intra-event parallelism: indices (into m_orderedNodesVec) of the nodes that have to wait for each node
+  std::vector<std::vector<uint16_t>> m_nodeSuccessors;
+  // for intra-event parallelism: number of nodes each node has to wait for
+  std::vector<uint16_t> m_nodePredecessorCount;
   // highest node
   VNode* m_motherOfAllNodes = nullptr;
 
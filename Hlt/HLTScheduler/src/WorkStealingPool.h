@@ -0,0 +1,363 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** @class WorkStealingPool WorkStealingPool.h
+ *
+ *  Thread pool with one work-stealing deque per worker, meant as a lightweight alternative to
+ *  ThreadPool and to tbb::task::enqueue.
+ *
+ *  - tasks are stored in a fixed number of preallocated slots with inline storage of
+ *    task_capacity bytes, so enqueueing never allocates. A lock-free free list hands out the slots.
+ *  - a worker pushes tasks it creates itself on the bottom of its own (Chase-Lev) deque and pops
+ *    them from there, idle workers steal from the top of the deques of others.
+ *  - tasks enqueued from outside of the pool (e.g. by the event loop) go through a bounded
+ *    lock-free MPMC injection queue.
+ *  - workers only fall back to a condition variable after spinning for a while without finding
+ *    work, and the enqueueing side only touches the mutex when somebody is actually asleep.
+ *
+ *  Contrary to ThreadPool::enqueue, no std::future is returned: the callables are expected to
+ *  report back through their own means (as the event tasks of HLTControlFlowMgr do).
+ *  If all slots are in use, enqueue waits for one to be released, or, when called from a worker,
+ *  runs the callable directly.
+ */
+class WorkStealingPool final {
+public:
+  /// maximal size of a callable that can be enqueued
+  static constexpr std::size_t task_capacity = 256;
+
+  WorkStealingPool( std::size_t nThreads, std::size_t maxQueuedTasks = 4096 );
+  WorkStealingPool( WorkStealingPool const& ) = delete;
+  WorkStealingPool& operator=( WorkStealingPool const& ) = delete;
+  /// runs all tasks still queued, then joins the workers
+  ~WorkStealingPool();
+
+  template <typename F>
+  void enqueue( F&& f );
+
+  std::size_t size() const { return m_workers.size(); }
+
+private:
+  static constexpr uint32_t    s_invalid   = ~uint32_t{0};
+  static constexpr std::size_t s_cacheLine = 64;
+  static constexpr int         s_spinCount = 1024;
+
+  /// type erased callable with inline storage, never moved once constructed
+  class Task final {
+    alignas( std::max_align_t ) std::byte m_storage[task_capacity];
+    void ( *m_invoke )( void* )  = nullptr;
+    void ( *m_destroy )( void* ) = nullptr;
+
+  public:
+    template <typename F>
+    void emplace( F&& f ) {
+      using Fn = std::decay_t<F>;
+      static_assert( sizeof( Fn ) <= task_capacity, "callable too large for WorkStealingPool::task_capacity" );
+      static_assert( alignof( Fn ) <= alignof( std::max_align_t ), "callable over-aligned for WorkStealingPool" );
+      new ( m_storage ) Fn( std::forward<F>( f ) );
+      m_invoke  = []( void* p ) { ( *static_cast<Fn*>( p ) )(); };
+      m_destroy = []( void* p ) { static_cast<Fn*>( p )->~Fn(); };
+    }
+    void run() {
+      assert( m_invoke );
+      m_invoke( m_storage );
+    }
+    void reset() {
+      if ( m_destroy ) m_destroy( m_storage );
+      m_invoke  = nullptr;
+      m_destroy = nullptr;
+    }
+    ~Task() { reset(); }
+  };
+
+  /// Chase-Lev deque of slot indices (see Le et al., PPoPP 2013, for the memory orderings).
+  /// The capacity equals the number of slots, so it can never overflow.
+  class Deque final {
+    alignas( s_cacheLine ) std::atomic<int64_t> m_top{0};
+    alignas( s_cacheLine ) std::atomic<int64_t> m_bottom{0};
+    std::unique_ptr<std::atomic<uint32_t>[]> m_buffer;
+    int64_t                                  m_mask = 0;
+
+  public:
+    void resize( std::size_t capacity ) {
+      m_buffer = std::make_unique<std::atomic<uint32_t>[]>( capacity );
+      m_mask   = static_cast<int64_t>( capacity ) - 1;
+    }
+    // owner only
+    void push( uint32_t index ) {
+      auto const b = m_bottom.load( std::memory_order_relaxed );
+      m_buffer[b & m_mask].store( index, std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_release );
+      m_bottom.store( b + 1, std::memory_order_relaxed );
+    }
+    // owner only
+    uint32_t pop() {
+      auto const b = m_bottom.load( std::memory_order_relaxed ) - 1;
+      m_bottom.store( b, std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      auto t = m_top.load( std::memory_order_relaxed );
+      if ( t > b ) {
+        m_bottom.store( b + 1, std::memory_order_relaxed );
+        return s_invalid;
+      }
+      auto index = m_buffer[b & m_mask].load( std::memory_order_relaxed );
+      if ( t == b ) { // last element, race against the thieves
+        if ( !m_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+          index = s_invalid;
+        m_bottom.store( b + 1, std::memory_order_relaxed );
+      }
+      return index;
+    }
+    // any thread
+    uint32_t steal() {
+      auto t = m_top.load( std::memory_order_acquire );
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      auto const b = m_bottom.load( std::memory_order_acquire );
+      if ( t >= b ) return s_invalid;
+      auto const index = m_buffer[t & m_mask].load( std::memory_order_relaxed );
+      if ( !m_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+        return s_invalid;
+      return index;
+    }
+  };
+
+  /// bounded MPMC queue of slot indices (D. Vyukov's algorithm), for submissions from outside the pool
+  class InjectionQueue final {
+    struct Cell {
+      std::atomic<std::size_t> sequence{0};
+      uint32_t                 index{s_invalid};
+    };
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t             m_mask = 0;
+    alignas( s_cacheLine ) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas( s_cacheLine ) std::atomic<std::size_t> m_dequeuePos{0};
+
+  public:
+    void resize( std::size_t capacity ) {
+      m_cells = std::make_unique<Cell[]>( capacity );
+      m_mask  = capacity - 1;
+      for ( std::size_t i = 0; i != capacity; ++i ) m_cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+    bool push( uint32_t index ) {
+      auto  pos  = m_enqueuePos.load( std::memory_order_relaxed );
+      Cell* cell = nullptr;
+      for ( ;; ) {
+        cell             = &m_cells[pos & m_mask];
+        auto const seq   = cell->sequence.load( std::memory_order_acquire );
+        auto const delta = static_cast<std::intptr_t>( seq ) - static_cast<std::intptr_t>( pos );
+        if ( delta == 0 ) {
+          if ( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) break;
+        } else if ( delta < 0 ) {
+          return false;
+        } else {
+          pos = m_enqueuePos.load( std::memory_order_relaxed );
+        }
+      }
+      cell->index = index;
+      cell->sequence.store( pos + 1, std::memory_order_release );
+      return true;
+    }
+    uint32_t pop() {
+      auto  pos  = m_dequeuePos.load( std::memory_order_relaxed );
+      Cell* cell = nullptr;
+      for ( ;; ) {
+        cell             = &m_cells[pos & m_mask];
+        auto const seq   = cell->sequence.load( std::memory_order_acquire );
+        auto const delta = static_cast<std::intptr_t>( seq ) - static_cast<std::intptr_t>( pos + 1 );
+        if ( delta == 0 ) {
+          if ( m_dequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) break;
+        } else if ( delta < 0 ) {
+          return s_invalid;
+        } else {
+          pos = m_dequeuePos.load( std::memory_order_relaxed );
+        }
+      }
+      auto const index = cell->index;
+      cell->sequence.store( pos + m_mask + 1, std::memory_order_release );
+      return index;
+    }
+  };
+
+  struct alignas( s_cacheLine ) Worker {
+    Deque       deque;
+    std::thread thread;
+    uint64_t    rng = 0;
+  };
+
+  struct CurrentWorker {
+    WorkStealingPool* pool;
+    std::size_t       index;
+  };
+  static inline thread_local CurrentWorker tl_current{nullptr, 0};
+
+  // slot management, lock-free stack with an ABA tag in the upper 32 bits of the head
+  uint32_t acquireSlot() {
+    auto head = m_freeHead.load( std::memory_order_acquire );
+    for ( ;; ) {
+      auto const index = static_cast<uint32_t>( head );
+      if ( index == s_invalid ) return s_invalid;
+      auto const next    = m_nextFree[index].load( std::memory_order_relaxed );
+      auto const newHead = ( ( head >> 32 ) + 1 ) << 32 | next;
+      if ( m_freeHead.compare_exchange_weak( head, newHead, std::memory_order_acq_rel, std::memory_order_acquire ) )
+        return index;
+    }
+  }
+  void releaseSlot( uint32_t index ) {
+    auto head = m_freeHead.load( std::memory_order_relaxed );
+    for ( ;; ) {
+      m_nextFree[index].store( static_cast<uint32_t>( head ), std::memory_order_relaxed );
+      auto const newHead = ( ( head >> 32 ) + 1 ) << 32 | index;
+      if ( m_freeHead.compare_exchange_weak( head, newHead, std::memory_order_release, std::memory_order_relaxed ) )
+        return;
+    }
+  }
+
+  uint32_t findTask( std::size_t self );
+  void     runWorker( std::size_t self );
+  void     wakeOne();
+
+  std::unique_ptr<Task[]>                  m_tasks;
+  std::unique_ptr<std::atomic<uint32_t>[]> m_nextFree;
+  alignas( s_cacheLine ) std::atomic<uint64_t> m_freeHead{s_invalid};
+  InjectionQueue      m_injection;
+  std::vector<Worker> m_workers;
+
+  alignas( s_cacheLine ) std::atomic<int64_t> m_nQueued{0};
+  std::atomic<int>        m_nSleeping{0};
+  std::atomic<bool>       m_stop{false};
+  std::mutex              m_sleepMutex;
+  std::condition_variable m_sleepCond;
+};
+
+inline WorkStealingPool::WorkStealingPool( std::size_t nThreads, std::size_t maxQueuedTasks ) : m_workers( nThreads ) {
+  if ( nThreads == 0 ) throw std::invalid_argument( "WorkStealingPool needs at least one thread" );
+  // round up to a power of two for the ring buffers
+  std::size_t capacity = 1;
+  while ( capacity < maxQueuedTasks ) capacity <<= 1;
+
+  m_tasks    = std::make_unique<Task[]>( capacity );
+  m_nextFree = std::make_unique<std::atomic<uint32_t>[]>( capacity );
+  for ( std::size_t i = 0; i != capacity; ++i )
+    m_nextFree[i].store( i + 1 == capacity ? s_invalid : static_cast<uint32_t>( i + 1 ), std::memory_order_relaxed );
+  m_freeHead.store( 0, std::memory_order_relaxed );
+  m_injection.resize( capacity );
+
+  for ( std::size_t i = 0; i != nThreads; ++i ) {
+    m_workers[i].deque.resize( capacity );
+    m_workers[i].rng = 0x9E3779B97F4A7C15ull * ( i + 1 );
+  }
+  for ( std::size_t i = 0; i != nThreads; ++i ) m_workers[i].thread = std::thread{[this, i] { runWorker( i ); }};
+}
+
+inline WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock{m_sleepMutex};
+    m_stop.store( true );
+  }
+  m_sleepCond.notify_all();
+  for ( auto& worker : m_workers ) worker.thread.join();
+}
+
+template <typename F>
+void WorkStealingPool::enqueue( F&& f ) {
+  // tasks still being drained by the destructor may enqueue follow-up work
+  if ( m_stop.load( std::memory_order_relaxed ) && tl_current.pool != this )
+    throw std::runtime_error( "enqueue on stopped WorkStealingPool" );
+
+  auto slot = acquireSlot();
+  if ( slot == s_invalid && tl_current.pool == this ) {
+    // all slots in use and only workers release them, so waiting here could deadlock: run it right away
+    std::forward<F>( f )();
+    return;
+  }
+  while ( slot == s_invalid ) { // all slots in use: wait until a task finished
+    std::this_thread::yield();
+    slot = acquireSlot();
+  }
+  m_tasks[slot].emplace( std::forward<F>( f ) );
+
+  m_nQueued.fetch_add( 1 );
+  if ( tl_current.pool == this ) {
+    m_workers[tl_current.index].deque.push( slot );
+  } else {
+    // there are at most as many queued indices as slots, so this can only fail transiently while
+    // a consumer has claimed a cell but not yet released it
+    while ( !m_injection.push( slot ) ) std::this_thread::yield();
+  }
+  if ( m_nSleeping.load() > 0 ) wakeOne();
+}
+
+inline void WorkStealingPool::wakeOne() {
+  std::lock_guard<std::mutex> lock{m_sleepMutex};
+  m_sleepCond.notify_one();
+}
+
+inline uint32_t WorkStealingPool::findTask( std::size_t self ) {
+  auto& me = m_workers[self];
+  if ( auto index = me.deque.pop(); index != s_invalid ) return index;
+  if ( auto index = m_injection.pop(); index != s_invalid ) return index;
+  auto const n = m_workers.size();
+  if ( n == 1 ) return s_invalid;
+  // xorshift for a random first victim, then go round
+  me.rng ^= me.rng << 13;
+  me.rng ^= me.rng >> 7;
+  me.rng ^= me.rng << 17;
+  auto const first = me.rng % n;
+  for ( std::size_t i = 0; i != n; ++i ) {
+    auto const victim = ( first + i ) % n;
+    if ( victim == self ) continue;
+    if ( auto index = m_workers[victim].deque.steal(); index != s_invalid ) return index;
+  }
+  return s_invalid;
+}
+
+inline void WorkStealingPool::runWorker( std::size_t self ) {
+  tl_current = {this, self};
+  for ( int idle = 0;; ) {
+    auto const index = findTask( self );
+    if ( index != s_invalid ) {
+      idle = 0;
+      m_nQueued.fetch_sub( 1, std::memory_order_relaxed );
+      m_tasks[index].run();
+      m_tasks[index].reset();
+      releaseSlot( index );
+      continue;
+    }
+    if ( ++idle < s_spinCount ) {
+      if ( idle % 64 == 0 ) std::this_thread::yield();
+      continue;
+    }
+    // nothing to do for a while, go to sleep. The seq_cst increment of m_nSleeping followed by the
+    // check of m_nQueued pairs with the increment of m_nQueued followed by the check of m_nSleeping
+    // in enqueue, so either we see the new task or the enqueuer sees us sleeping.
+    std::unique_lock<std::mutex> lock{m_sleepMutex};
+    m_nSleeping.fetch_add( 1 );
+    while ( m_nQueued.load() == 0 && !m_stop.load() ) m_sleepCond.wait( lock );
+    m_nSleeping.fetch_sub( 1 );
+    if ( m_stop.load() && m_nQueued.load() == 0 ) break;
+    idle = 0;
+  }
+  tl_current = {nullptr, 0};
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Micro benchmark of the thread pools usable by HLTControlFlowMgr:
+//  - tbb::task::enqueue, as used by default
+//  - ThreadPool, the debug pool
+//  - WorkStealingPool
+// For each of them and each requested number of threads it measures the throughput of (almost) empty tasks and the
+// latency between the enqueue call and the start of the task, when tasks are submitted from a single thread (as the
+// event loop does).
+//
+// usage: benchmark_ThreadPools [nTasks] [nThreads...]
+#include "../../src/ThreadPool.h"
+#include "../../src/WorkStealingPool.h"
+
+#include "tbb/task.h"
+#include "tbb/task_scheduler_init.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  template <typename fun>
+  class Wrapper final : public tbb::task {
+    fun m_f;
+
+  public:
+    Wrapper( fun f ) : m_f( std::move( f ) ) {}
+    tbb::task* execute() override {
+      m_f();
+      return nullptr;
+    }
+  };
+
+  struct Result {
+    double throughput; // tasks per second
+    double latencyMean;
+    double latencyP50;
+    double latencyP99;
+  };
+
+  // runs nTasks through `submit`, each task records its enqueue-to-start latency in ns
+  template <typename Submit>
+  Result run( std::size_t nTasks, Submit&& submit ) {
+    std::vector<double>      latencies( nTasks );
+    std::atomic<std::size_t> done{0};
+
+    auto const start = Clock::now();
+    for ( std::size_t i = 0; i != nTasks; ++i ) {
+      submit( [&latencies, &done, i, enqueued = Clock::now()] {
+        latencies[i] = std::chrono::duration<double, std::nano>( Clock::now() - enqueued ).count();
+        done.fetch_add( 1, std::memory_order_release );
+      } );
+    }
+    while ( done.load( std::memory_order_acquire ) != nTasks ) std::this_thread::yield();
+    auto const elapsed = std::chrono::duration<double>( Clock::now() - start ).count();
+
+    std::sort( latencies.begin(), latencies.end() );
+    double sum = 0;
+    for ( auto l : latencies ) sum += l;
+    return {nTasks / elapsed, sum / nTasks, latencies[nTasks / 2], latencies[nTasks * 99 / 100]};
+  }
+
+  void print( char const* pool, int nThreads, Result const& r ) {
+    std::printf( "%-18s %8d %16.0f %16.1f %16.1f %16.1f\n", pool, nThreads, r.throughput, r.latencyMean, r.latencyP50,
+                 r.latencyP99 );
+  }
+} // namespace
+
+int main( int argc, char* argv[] ) {
+  std::size_t      nTasks = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 1000000;
+  std::vector<int> threadCounts;
+  for ( int i = 2; i < argc; ++i ) threadCounts.push_back( std::atoi( argv[i] ) );
+  if ( threadCounts.empty() ) threadCounts = {1, 2, 4, 8, 16, 32, 64};
+
+  std::printf( "%-18s %8s %16s %16s %16s %16s\n", "Pool", "Threads", "Tasks / s", "Mean lat. / ns",
+               "Median lat. / ns", "99% lat. / ns" );
+
+  for ( int nThreads : threadCounts ) {
+    {
+      tbb::task_scheduler_init init( nThreads + 1 );
+      print( "tbb::enqueue", nThreads, run( nTasks, []( auto&& f ) {
+               tbb::task::enqueue( *new ( tbb::task::allocate_root() ) Wrapper{std::move( f )} );
+             } ) );
+    }
+    {
+      ThreadPool pool( nThreads );
+      print( "ThreadPool", nThreads, run( nTasks, [&pool]( auto&& f ) { pool.enqueue( std::move( f ) ); } ) );
+    }
+    {
+      WorkStealingPool pool( nThreads );
+      print( "WorkStealingPool", nThreads, run( nTasks, [&pool]( auto&& f ) { pool.enqueue( std::move( f ) ); } ) );
+    }
+  }
+  return 0;
+}
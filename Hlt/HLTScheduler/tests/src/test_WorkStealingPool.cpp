@@ -0,0 +1,118 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utestWorkStealingPool
+#include <boost/test/unit_test.hpp>
+
+#include "../../src/WorkStealingPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace {
+  using namespace std::chrono_literals;
+
+  /// spins until the condition is true or the timeout expires, returns the condition
+  template <typename Condition>
+  bool waitFor( Condition&& condition, std::chrono::seconds timeout = 10s ) {
+    auto const end = std::chrono::steady_clock::now() + timeout;
+    while ( !condition() ) {
+      if ( std::chrono::steady_clock::now() > end ) return false;
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  /// enqueues two children down to the given depth, counting all the tasks run
+  void spawn( WorkStealingPool& pool, std::atomic<int>& count, int depth ) {
+    ++count;
+    if ( depth == 0 ) return;
+    for ( int i = 0; i != 2; ++i ) pool.enqueue( [&pool, &count, depth] { spawn( pool, count, depth - 1 ); } );
+  }
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_stealing ) {
+  // the children of a task go to the deque of its worker, which is busy waiting for them:
+  // they can only be run by the other workers stealing them
+  const int                 nChildren = 64;
+  std::atomic<int>          done{0};
+  std::atomic<bool>         allDone{false};
+  std::thread::id           parent;
+  std::set<std::thread::id> runners;
+  std::mutex                mutex;
+  {
+    WorkStealingPool pool( 4 );
+    pool.enqueue( [&] {
+      parent = std::this_thread::get_id();
+      for ( int i = 0; i != nChildren; ++i )
+        pool.enqueue( [&] {
+          {
+            std::lock_guard<std::mutex> lock{mutex};
+            runners.insert( std::this_thread::get_id() );
+          }
+          std::this_thread::sleep_for( 100us );
+          ++done;
+        } );
+      allDone = waitFor( [&] { return done.load() == nChildren; } );
+    } );
+  }
+  BOOST_CHECK( allDone.load() );
+  BOOST_CHECK_EQUAL( done.load(), nChildren );
+  BOOST_CHECK_EQUAL( runners.count( parent ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( test_tasks_enqueuing_tasks ) {
+  // binary trees of tasks, also with fewer pool slots than tasks alive at some point, in which case
+  // the workers run the children directly
+  for ( std::size_t maxQueuedTasks : {8u, 4096u} ) {
+    for ( std::size_t nThreads : {1u, 2u, 4u} ) {
+      std::atomic<int> count{0};
+      {
+        WorkStealingPool pool( nThreads, maxQueuedTasks );
+        BOOST_CHECK_EQUAL( pool.size(), nThreads );
+        for ( int i = 0; i != 4; ++i ) pool.enqueue( [&] { spawn( pool, count, 10 ); } );
+      }
+      BOOST_CHECK_EQUAL( count.load(), 4 * ( ( 1 << 11 ) - 1 ) );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_shutdown_with_queued_tasks ) {
+  // the destructor runs the tasks still queued, including the ones they enqueue, before joining
+  const int         nTasks = 1000;
+  std::atomic<int>  count{0};
+  std::atomic<int>  followUps{0};
+  std::atomic<bool> release{false};
+  // only let the workers go once the destructor waits for them
+  std::thread releaser{[&] {
+    std::this_thread::sleep_for( 50ms );
+    release = true;
+  }};
+  {
+    WorkStealingPool pool( 2, 2 * nTasks );
+    // keep both workers busy so that everything else stays queued
+    for ( int i = 0; i != 2; ++i ) pool.enqueue( [&] { waitFor( [&] { return release.load(); } ); } );
+    for ( int i = 0; i != nTasks; ++i )
+      pool.enqueue( [&, i] {
+        ++count;
+        if ( i % 10 == 0 ) pool.enqueue( [&] { ++followUps; } );
+      } );
+    BOOST_CHECK( !release.load() );
+  }
+  releaser.join();
+  BOOST_CHECK_EQUAL( count.load(), nTasks );
+  BOOST_CHECK_EQUAL( followUps.load(), nTasks / 10 );
+}
+
+BOOST_AUTO_TEST_CASE( test_no_thread ) { BOOST_CHECK_THROW( WorkStealingPool( 0 ), std::invalid_argument ); }
@@ -0,0 +1,55 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef HLTDECREPORTSCONVERTERS_H
+#define HLTDECREPORTSCONVERTERS_H 1
+
+// Include files
+#include "Event/HltDecReport.h"
+#include <algorithm>
+
+/** Conversion of the words of the HltDecReports raw bank into HltDecReport,
+ *  shared by HltDecReportsDecoder and HltDecisionsDecoder
+ */
+namespace HltDecReportsConverters {
+
+  // version 1 layout:
+  // decision:  0x        1                      x
+  // error:     0x        e                   xxx0
+  // #cand:     0x       f0              xxxx 0000
+  // stage:     0x     ff00    xxxx xxxx 0000 0000
+  // id:        0xffff 0000
+  // version 0 layout:
+  // decision:  0x        1                      x
+  // error:     0x       70              0xxx 0000
+  // #cand:     0x     ff80    xxxx xxxx x000 0000
+  // stage:     0x        e                   xxx0
+  // id:        0xffff 0000
+  struct v0_v1 {
+    LHCb::HltDecReport convert( unsigned int x ) const {
+      // ID & decision stay the same
+      unsigned int temp = ( x & 0xffff0001 );
+      // stage needs to be moved left
+      temp |= ( x & 0xe ) << 7;
+      // number of candidates -- move & truncate
+      unsigned int nc = std::min( ( x >> 7 ) & 0x1ff, 0xfu );
+      temp |= nc << 4;
+      // error just moves to the right
+      temp |= ( x & 0x70 ) >> 3;
+      return LHCb::HltDecReport( temp );
+    }
+  };
+
+  struct vx_vx {
+    LHCb::HltDecReport convert( unsigned int x ) const { return LHCb::HltDecReport( x ); }
+  };
+
+} // namespace HltDecReportsConverters
+#endif // HLTDECREPORTSCONVERTERS_H
@@ -14,6 +14,7 @@
 #include "Event/HltDecReports.h"
 
 // local
+#include "HltDecReportsConverters.h"
 #include "HltDecReportsDecoder.h"
 #include "HltDecReportsWriter.h"
 
@@ -27,41 +28,7 @@
 DECLARE_COMPONENT( HltDecReportsDecoder )
 
 using namespace LHCb;
-
-namespace {
-
-  // version 1 layout:
-  // decision:  0x        1                      x
-  // error:     0x        e                   xxx0
-  // #cand:     0x       f0              xxxx 0000
-  // stage:     0x     ff00    xxxx xxxx 0000 0000
-  // id:        0xffff 0000
-  // version 0 layout:
-  // decision:  0x        1                      x
-  // error:     0x       70              0xxx 0000
-  // #cand:     0x     ff80    xxxx xxxx x000 0000
-  // stage:     0x        e                   xxx0
-  // id:        0xffff 0000
-  struct v0_v1 {
-    HltDecReport convert( unsigned int x ) const {
-      // ID & decision stay the same
-      unsigned int temp = ( x & 0xffff0001 );
-      // stage needs to be moved left
-      temp |= ( x & 0xe ) << 7;
-      // number of candidates -- move & truncate
-      unsigned int nc = std::min( ( x >> 7 ) & 0x1ff, 0xfu );
-      temp |= nc << 4;
-      // error just moves to the right
-      temp |= ( x & 0x70 ) >> 3;
-      return HltDecReport( temp );
-    }
-  };
-
-  struct vx_vx {
-    HltDecReport convert( unsigned int x ) const { return HltDecReport( x ); }
-  };
-
-} // namespace
+using namespace HltDecReportsConverters;
 
 //=============================================================================
 // Standard constructor, initializes variables
@@ -0,0 +1,143 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Include files
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// local
+#include "HltDecReportsConverters.h"
+#include "HltDecisionsDecoder.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : HltDecisionsDecoder
+//-----------------------------------------------------------------------------
+
+// Declaration of the Algorithm Factory
+DECLARE_COMPONENT( HltDecisionsDecoder )
+
+using namespace LHCb;
+using namespace HltDecReportsConverters;
+
+//=============================================================================
+// Standard constructor, initializes variables
+//=============================================================================
+HltDecisionsDecoder::HltDecisionsDecoder( const std::string& name, ISvcLocator* pSvcLocator )
+    : HltRawBankDecoder<LHCb::HltDecisions>(
+          name, pSvcLocator,
+          KeyValue{"RawEventLocations", Gaudi::Functional::concat_alternatives( LHCb::RawEventLocation::Trigger,
+                                                                                LHCb::RawEventLocation::Copied,
+                                                                                LHCb::RawEventLocation::Default )},
+          KeyValue{"OutputHltDecisionsLocation", LHCb::HltDecisionsLocation::Default} ) {}
+
+//=============================================================================
+// Line table of a TCK, from the lines to be decoded (called with m_linesMutex held)
+//=============================================================================
+HltDecisionsDecoder::LinesTable_t::const_iterator HltDecisionsDecoder::fetch_lines( unsigned int tck ) const {
+  auto                                              tckLines = std::make_shared<TCKLines>();
+  std::vector<std::pair<unsigned int, std::string>> idsAndNames;
+  for ( const auto& [id, element] : id2string( tck ) ) {
+    tckLines->known.push_back( id );
+    if ( element ) idsAndNames.emplace_back( id, element.str() );
+  }
+  std::sort( tckLines->known.begin(), tckLines->known.end() );
+  tckLines->lines = std::make_shared<const Lines>( tck, std::move( idsAndNames ) );
+  if ( msgLevel( MSG::DEBUG ) )
+    debug() << "TCK " << tck << " : " << tckLines->lines->size() << " lines to decode" << endmsg;
+  return m_lines.insert( tck, std::move( tckLines ) ).first;
+}
+
+//=============================================================================
+// Main execution
+//=============================================================================
+LHCb::HltDecisions HltDecisionsDecoder::operator()( const LHCb::RawEvent& rawEvent ) const {
+
+  auto hltdecreportsRawBanks = selectRawBanks( rawEvent.banks( RawBank::HltDecReports ) );
+  if ( hltdecreportsRawBanks.empty() ) {
+    throw GaudiException( " No HltDecReports RawBank -- continuing, but not producing HltDecisions", name(),
+                          StatusCode::SUCCESS );
+  }
+  if ( hltdecreportsRawBanks.size() != 1 ) {
+    Warning(
+        " More then one HltDecReports RawBanks for requested SourceID in RawEvent. Will only process the first one. ",
+        StatusCode::SUCCESS, 20 )
+        .ignore();
+  }
+  const RawBank* hltdecreportsRawBank = hltdecreportsRawBanks.front();
+  if ( hltdecreportsRawBank->magic() != RawBank::MagicPattern ) {
+    throw GaudiException( " HltDecReports RawBank has wrong magic number. Return without decoding.", name(),
+                          StatusCode::FAILURE );
+  }
+  if ( hltdecreportsRawBank->version() > kVersionNumber ) {
+    throw GaudiException(
+        " HltDecReports RawBank version # is larger then the known ones.... cannot decode, use newer version.", name(),
+        StatusCode::FAILURE );
+  }
+
+  // version 0 has only decreps, version 1 has TCK, taskID, then decreps...
+  const unsigned int* content       = hltdecreportsRawBank->begin<unsigned int>();
+  unsigned int        configuredTCK = 0, taskID = 0;
+  if ( hltdecreportsRawBank->version() > 0 ) {
+    configuredTCK = *content++;
+    taskID        = *content++;
+  }
+
+  const auto   tckLines = lines( configuredTCK );
+  HltDecisions output{tckLines->lines};
+  output.setConfiguredTCK( configuredTCK );
+  output.setTaskID( taskID );
+
+  int err = 0;
+  switch ( hltdecreportsRawBank->version() ) {
+  case 0:
+    err += decodeHDR<v0_v1>( content, hltdecreportsRawBank->end<unsigned int>(), *tckLines, output );
+    break;
+  case 1:
+  case 2:
+    err += decodeHDR<vx_vx>( content, hltdecreportsRawBank->end<unsigned int>(), *tckLines, output );
+    break;
+  }
+
+  if ( msgLevel( MSG::VERBOSE ) ) {
+    verbose() << " ====== HltDecisions container size=" << output.size() << endmsg;
+    verbose() << output << endmsg;
+  }
+  if ( err != 0 ) {
+    throw GaudiException( " HltDecReports RawBank error during decoding.", name(), StatusCode::FAILURE );
+  }
+  return output;
+}
+
+template <typename HDRConverter, typename I>
+int HltDecisionsDecoder::decodeHDR( I i, I end, const TCKLines& tckLines, HltDecisions& output ) const {
+  int                ret = 0;
+  const HDRConverter converter{};
+  const auto&        lines = *tckLines.lines;
+  while ( i != end ) {
+    auto       dec  = converter.convert( *i++ );
+    const auto line = lines.index( dec.intDecisionID() );
+    if ( UNLIKELY( line == HltDecisions::NoLine ) ) {
+      // either not to be decoded, or missing
+      if ( !std::binary_search( tckLines.known.begin(), tckLines.known.end(), dec.intDecisionID() ) ) {
+        Error( " No string key found for trigger decision in storage id = " + std::to_string( dec.intDecisionID() ),
+               StatusCode::FAILURE, 50 )
+            .ignore();
+        ++ret;
+      }
+    } else if ( !output.setReport( line, dec ) ) {
+      Error( " Duplicate decision report in storage " + lines.name( line ), StatusCode::FAILURE, 20 ).ignore();
+      ++ret;
+    }
+  }
+  return ret;
+}
+//=============================================================================
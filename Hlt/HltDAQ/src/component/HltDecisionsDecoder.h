@@ -0,0 +1,71 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef HLTDECISIONSDECODER_H
+#define HLTDECISIONSDECODER_H 1
+
+// Include files
+#include "Event/HltDecisions.h"
+#include "HltRawBankDecoderBase.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/** @class HltDecisionsDecoder HltDecisionsDecoder.h
+ *
+ *  Algorithm to read the HltDecReports raw bank into the compact LHCb::HltDecisions
+ *  container, without creating a string per decision.
+ *
+ *  The line table of each TCK is built once from the ANNSvc, and shared by all the
+ *  events with this TCK. The table of the last TCK is found without locking.
+ */
+class HltDecisionsDecoder : public HltRawBankDecoder<LHCb::HltDecisions> {
+public:
+  /// Standard constructor
+  HltDecisionsDecoder( const std::string& name, ISvcLocator* pSvcLocator );
+
+  ///< Algorithm execution
+  LHCb::HltDecisions operator()( const LHCb::RawEvent& ) const override;
+
+private:
+  enum HeaderIDs { kVersionNumber = 2 };
+
+  using Lines = LHCb::HltDecisions::Lines;
+
+  /// what is needed to decode the reports of a TCK
+  struct TCKLines {
+    std::shared_ptr<const Lines> lines; ///< the lines to be decoded
+    std::vector<unsigned int>    known; ///< decision IDs of all the lines of the TCK, sorted
+  };
+
+  /// the line table of the given TCK, built on first use
+  std::shared_ptr<const TCKLines> lines( unsigned int tck ) const {
+    // the events usually have the TCK of the previous one: no lock needed
+    auto last = std::atomic_load_explicit( &m_lastLines, std::memory_order_acquire );
+    if ( LIKELY( last && last->lines->tck() == tck ) ) return last;
+    std::lock_guard<std::mutex> lock{m_linesMutex};
+    auto                        itbl = m_lines.find( tck );
+    if ( UNLIKELY( itbl == std::end( m_lines ) ) ) itbl = fetch_lines( tck );
+    std::atomic_store_explicit( &m_lastLines, itbl->second, std::memory_order_release );
+    return itbl->second;
+  }
+
+  using LinesTable_t = GaudiUtils::VectorMap<unsigned int, std::shared_ptr<const TCKLines>>;
+  mutable std::mutex                      m_linesMutex; ///< protects m_lines, filled by the events with a new TCK
+  mutable LinesTable_t                    m_lines;
+  mutable std::shared_ptr<const TCKLines> m_lastLines; ///< the table last used, only accessed atomically
+  LinesTable_t::const_iterator            fetch_lines( unsigned int tck ) const;
+
+  template <typename HDRConverter, typename I>
+  int decodeHDR( I i, I end, const TCKLines& tckLines, LHCb::HltDecisions& output ) const;
+};
+#endif // HLTDECISIONSDECODER_H
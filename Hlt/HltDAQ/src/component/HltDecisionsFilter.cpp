@@ -0,0 +1,114 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Include files
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// from Gaudi
+#include "Event/HltDecisions.h"
+#include "GaudiAlg/FilterPredicate.h"
+#include "GaudiKernel/VectorMap.h"
+
+/** @class HltDecisionsFilter
+ *
+ *  Accept the events for which any of the given lines has a positive decision.
+ *
+ *  The line names are resolved into line numbers once per TCK, after which the
+ *  decisions are tested bit by bit, without any string comparison. The line numbers
+ *  of the last TCK are found without locking.
+ */
+class HltDecisionsFilter : public Gaudi::Functional::FilterPredicate<bool( const LHCb::HltDecisions& )> {
+public:
+  HltDecisionsFilter( const std::string& name, ISvcLocator* pSvcLocator );
+  bool operator()( const LHCb::HltDecisions& ) const override; ///< Algorithm execution
+
+private:
+  using LineIndex = LHCb::HltDecisions::LineIndex;
+
+  /// the line numbers of the requested lines for a TCK
+  struct Resolved {
+    unsigned int           tck = 0;
+    std::vector<LineIndex> indices;
+  };
+
+  using LineIndices = std::shared_ptr<const Resolved>;
+
+  /// the line numbers of the requested lines in the given line table
+  LineIndices resolve( const LHCb::HltDecisions::Lines& lines ) const;
+
+  Gaudi::Property<std::vector<std::string>> m_lines{this, "Lines", {}, "Accept if any of these lines is positive"};
+
+  mutable std::mutex                                       m_resolvedMutex; ///< protects m_resolved
+  mutable GaudiUtils::VectorMap<unsigned int, LineIndices> m_resolved;      ///< line numbers, by TCK
+  mutable LineIndices                                      m_lastResolved;  ///< last used, only accessed atomically
+
+  mutable Gaudi::Accumulators::Counter<>         m_unknownTCK{this, "#events without line table"};
+  mutable Gaudi::Accumulators::BinomialCounter<> m_accept{this, "#accept"};
+};
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : HltDecisionsFilter
+//-----------------------------------------------------------------------------
+
+// Declaration of the Algorithm Factory
+DECLARE_COMPONENT( HltDecisionsFilter )
+
+//=============================================================================
+// Standard constructor, initializes variables
+//=============================================================================
+HltDecisionsFilter::HltDecisionsFilter( const std::string& name, ISvcLocator* pSvcLocator )
+    : FilterPredicate( name, pSvcLocator, KeyValue{"HltDecisionsLocation", LHCb::HltDecisionsLocation::Default} ) {}
+
+//=============================================================================
+// Line numbers of the requested lines
+//=============================================================================
+HltDecisionsFilter::LineIndices HltDecisionsFilter::resolve( const LHCb::HltDecisions::Lines& lines ) const {
+  // the events usually have the TCK of the previous one: no lock needed
+  auto last = std::atomic_load_explicit( &m_lastResolved, std::memory_order_acquire );
+  if ( LIKELY( last && last->tck == lines.tck() ) ) return last;
+  std::lock_guard<std::mutex> lock{m_resolvedMutex};
+  auto                        i = m_resolved.find( lines.tck() );
+  if ( UNLIKELY( i == std::end( m_resolved ) ) ) {
+    auto resolved = std::make_shared<Resolved>();
+    resolved->tck = lines.tck();
+    for ( const auto& name : m_lines.value() ) {
+      const auto line = lines.index( name );
+      if ( line != LHCb::HltDecisions::NoLine ) {
+        resolved->indices.push_back( line );
+      } else if ( msgLevel( MSG::DEBUG ) ) {
+        debug() << "Line " << name << " not decoded for TCK " << lines.tck() << endmsg;
+      }
+    }
+    i = m_resolved.insert( lines.tck(), std::move( resolved ) ).first;
+  }
+  std::atomic_store_explicit( &m_lastResolved, i->second, std::memory_order_release );
+  return i->second;
+}
+
+//=============================================================================
+// Main execution
+//=============================================================================
+bool HltDecisionsFilter::operator()( const LHCb::HltDecisions& decisions ) const {
+  if ( !decisions.sharedLines() ) {
+    ++m_unknownTCK;
+    m_accept += false;
+    return false;
+  }
+  const auto lines  = resolve( decisions.lines() );
+  const bool accept = std::any_of( lines->indices.begin(), lines->indices.end(),
+                                   [&]( LineIndex line ) { return decisions.decision( line ); } );
+  m_accept += accept;
+  return accept;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utestHltDecisions
+#include <boost/test/unit_test.hpp>
+
+#include "Event/HltDecReports.h"
+#include "Event/HltDecisions.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using LHCb::HltDecisions;
+
+// Three lines, given out of order of decision ID
+std::shared_ptr<const HltDecisions::Lines> makeLines() {
+  return std::make_shared<const HltDecisions::Lines>(
+      0x1234u, std::vector<std::pair<unsigned int, std::string>>{
+                   {70, "Hlt1TrackMVADecision"}, {3, "Hlt1GlobalDecision"}, {100, "Hlt1DiMuonDecision"}} );
+}
+
+BOOST_AUTO_TEST_CASE( lines ) {
+  const auto lines = makeLines();
+  BOOST_CHECK_EQUAL( lines->tck(), 0x1234u );
+  BOOST_CHECK_EQUAL( lines->size(), 3u );
+  // numbered by decision ID
+  BOOST_CHECK_EQUAL( lines->index( 3u ), 0u );
+  BOOST_CHECK_EQUAL( lines->index( 70u ), 1u );
+  BOOST_CHECK_EQUAL( lines->index( 100u ), 2u );
+  BOOST_CHECK_EQUAL( lines->index( 4u ), HltDecisions::NoLine );
+  BOOST_CHECK_EQUAL( lines->index( 1000u ), HltDecisions::NoLine );
+  BOOST_CHECK_EQUAL( lines->index( std::string_view{"Hlt1DiMuonDecision"} ), 2u );
+  BOOST_CHECK_EQUAL( lines->index( std::string_view{"Hlt1Unknown"} ), HltDecisions::NoLine );
+  BOOST_CHECK_EQUAL( lines->id( 1 ), 70u );
+  BOOST_CHECK_EQUAL( lines->name( 1 ), "Hlt1TrackMVADecision" );
+}
+
+BOOST_AUTO_TEST_CASE( decisions ) {
+  HltDecisions decisions{makeLines()};
+  BOOST_CHECK( !decisions.anyDecision() );
+  BOOST_CHECK_EQUAL( decisions.size(), 0u );
+
+  BOOST_CHECK( decisions.setReport( 0, LHCb::HltDecReport( true, 0, 0, 2, 3 ) ) );
+  BOOST_CHECK( !decisions.setReport( 0, LHCb::HltDecReport( true, 0, 0, 2, 3 ) ) ); // duplicate
+  BOOST_CHECK( decisions.setReport( 2, LHCb::HltDecReport( false, 1, 0, 0, 100 ) ) );
+
+  BOOST_CHECK_EQUAL( decisions.size(), 2u );
+  BOOST_CHECK_EQUAL( decisions.nDecisions(), 1u );
+  BOOST_CHECK( decisions.anyDecision() );
+  BOOST_CHECK( decisions.present( 0 ) && decisions.decision( 0 ) );
+  BOOST_CHECK( !decisions.present( 1 ) && !decisions.decision( 1 ) );
+  BOOST_CHECK( decisions.present( 2 ) && !decisions.decision( 2 ) );
+  BOOST_CHECK( !decisions.present( HltDecisions::NoLine ) );
+  // unknown lines
+  BOOST_CHECK( !decisions.setReport( 3, LHCb::HltDecReport( true, 0, 0, 2, 3 ) ) );
+  BOOST_CHECK( !decisions.setReport( HltDecisions::NoLine, LHCb::HltDecReport( true, 0, 0, 2, 3 ) ) );
+  BOOST_CHECK_EQUAL( decisions.report( 3 ).decReport(), 0u );
+  BOOST_CHECK_EQUAL( decisions.report( HltDecisions::NoLine ).decReport(), 0u );
+  BOOST_CHECK_EQUAL( decisions.report( 0 ).numberOfCandidates(), 2u );
+  BOOST_CHECK_EQUAL( decisions.report( 2 ).executionStage(), 1u );
+
+  // string API
+  BOOST_CHECK( decisions.hasDecisionName( "Hlt1GlobalDecision" ) );
+  BOOST_CHECK( !decisions.hasDecisionName( "Hlt1TrackMVADecision" ) );
+  BOOST_CHECK( decisions.decReport( "Hlt1DiMuonDecision" ) );
+  BOOST_CHECK( ( decisions.decisionNames() == std::vector<std::string>{"Hlt1GlobalDecision", "Hlt1DiMuonDecision"} ) );
+
+  // conversion
+  const auto reports = decisions.toHltDecReports();
+  BOOST_CHECK_EQUAL( reports.size(), 2u );
+  BOOST_REQUIRE( reports.decReport( "Hlt1GlobalDecision" ) );
+  BOOST_CHECK_EQUAL( reports.decReport( "Hlt1GlobalDecision" )->decReport(), decisions.report( 0 ).decReport() );
+  BOOST_CHECK( !reports.hasDecisionName( "Hlt1TrackMVADecision" ) );
+}
+
+BOOST_AUTO_TEST_CASE( many_lines ) {
+  std::vector<std::pair<unsigned int, std::string>> idsAndNames;
+  for ( unsigned int id = 1; id <= 200; ++id ) idsAndNames.emplace_back( id, "Line" + std::to_string( id ) );
+  HltDecisions decisions{std::make_shared<const HltDecisions::Lines>( 0u, std::move( idsAndNames ) )};
+  for ( HltDecisions::LineIndex line = 0; line < 200; line += 3 ) {
+    BOOST_CHECK( decisions.setReport( line, LHCb::HltDecReport( line % 2 == 0, 0, 0, 1, line + 1 ) ) );
+  }
+  BOOST_CHECK_EQUAL( decisions.size(), 67u );
+  BOOST_CHECK_EQUAL( decisions.nDecisions(), 34u );
+  BOOST_CHECK( decisions.decision( 198 ) && !decisions.decision( 197 ) && !decisions.decision( 195 ) );
+}
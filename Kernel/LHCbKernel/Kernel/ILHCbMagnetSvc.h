@@ -13,15 +13,19 @@
 
 // Include files
 // from STL
+#include <array>
 #include <string>
 
 // from Gaudi
 #include "GaudiKernel/IAlgTool.h"
 #include "GaudiKernel/IMagneticFieldSvc.h"
 
+#include "GaudiKernel/GaudiException.h"
 #include "GaudiKernel/Point3DTypes.h"
 #include "GaudiKernel/Vector3DTypes.h"
 
+#include "Kernel/STLExtensions.h"
+
 namespace LHCb {
   class MagneticFieldGrid;
 }
@@ -33,7 +37,7 @@ namespace LHCb {
  *  @date   2008-07-18
  */
 struct ILHCbMagnetSvc : extend_interfaces<IMagneticFieldSvc> {
-  DeclareInterfaceID( ILHCbMagnetSvc, 2, 0 );
+  DeclareInterfaceID( ILHCbMagnetSvc, 3, 0 );
 
   [[nodiscard]] virtual bool   useRealMap() const            = 0; ///< True if using measured map
   [[nodiscard]] virtual bool   isDown() const                = 0; ///< True if the down polarity map is loaded
@@ -55,6 +59,34 @@ struct ILHCbMagnetSvc : extend_interfaces<IMagneticFieldSvc> {
    */
   [[nodiscard]] virtual ROOT::Math::XYZVector fieldVector( const ROOT::Math::XYZPoint& xyz ) const = 0;
 
+  /** Field vectors, at float precision, for a batch of points given in SoA layout, e.g. as
+   * stored from SIMDWrapper float_v. All spans must have the same size, except gradient which
+   * is either empty or 9 times larger : it is then filled with the field gradients, the
+   * element ( row, col ) of point n being at gradient[( 3 * row + col ) * nPoints + n].
+   * The default implementation calls fieldVector for each point, without gradient support.
+   * @param[in]  xyz      x, y and z of the points
+   * @param[out] field    x, y and z components of the field vectors
+   * @param[out] gradient field gradients, if not empty
+   */
+  virtual void fieldVectors( const std::array<LHCb::span<const float>, 3>& xyz,
+                             const std::array<LHCb::span<float>, 3>& field, LHCb::span<float> gradient = {} ) const {
+    if ( !gradient.empty() ) {
+      throw GaudiException( "Field gradients are not supported", "ILHCbMagnetSvc::fieldVectors", StatusCode::FAILURE );
+    }
+    const auto n = xyz[0].size();
+    if ( xyz[1].size() != n || xyz[2].size() != n || field[0].size() != n || field[1].size() != n ||
+         field[2].size() != n ) {
+      throw GaudiException( "Inconsistent sizes of the points and field", "ILHCbMagnetSvc::fieldVectors",
+                            StatusCode::FAILURE );
+    }
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const auto b = fieldVector( ROOT::Math::XYZPoint{xyz[0][i], xyz[1][i], xyz[2][i]} );
+      field[0][i]  = b.x();
+      field[1][i]  = b.y();
+      field[2][i]  = b.z();
+    }
+  }
+
   /// Get direct access to the field grid
   [[nodiscard]] virtual const LHCb::MagneticFieldGrid* fieldGrid() const = 0;
 };
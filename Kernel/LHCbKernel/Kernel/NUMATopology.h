@@ -0,0 +1,34 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace LHCb::NUMA {
+  /**
+   Minimal description of the NUMA layout of the host, as found in
+   `/sys/devices/system/node`. If that information is not available, the host is
+   described as a single node holding all CPUs.
+  */
+
+  /// CPUs belonging to each NUMA node, indexed by node
+  [[nodiscard]] std::vector<std::vector<int>> const& nodeCPUs();
+
+  /// number of NUMA nodes of the host (at least one)
+  [[nodiscard]] inline std::size_t nNodes() { return nodeCPUs().size(); }
+
+  /// NUMA node of the CPU the calling thread is currently running on
+  [[nodiscard]] std::size_t currentNode();
+
+  /// pin the calling thread to the CPUs of the given node, returns false on failure
+  bool bindCurrentThreadToNode( std::size_t node );
+} // namespace LHCb::NUMA
@@ -0,0 +1,88 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "Kernel/NUMATopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+  // parses the kernel cpulist format, e.g. "0-19,40-59"
+  std::vector<int> parseCPUList( std::string const& list ) {
+    std::vector<int>   cpus;
+    std::istringstream ss{list};
+    std::string        range;
+    while ( std::getline( ss, range, ',' ) ) {
+      if ( range.empty() || range == "\n" ) continue;
+      auto const dash  = range.find( '-' );
+      auto const first = std::stoi( range.substr( 0, dash ) );
+      auto const last  = dash == std::string::npos ? first : std::stoi( range.substr( dash + 1 ) );
+      for ( int cpu = first; cpu <= last; ++cpu ) cpus.push_back( cpu );
+    }
+    return cpus;
+  }
+
+  std::vector<std::vector<int>> readTopology() {
+    std::vector<std::vector<int>> nodes;
+    for ( int node = 0;; ++node ) {
+      std::ifstream f{"/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist"};
+      if ( !f ) break;
+      std::string list;
+      std::getline( f, list );
+      // memory-only nodes have no CPUs, keep them anyway so that indices match the kernel numbering
+      nodes.push_back( parseCPUList( list ) );
+    }
+    if ( nodes.empty() ) {
+      std::vector<int> all( std::max( 1u, std::thread::hardware_concurrency() ) );
+      for ( std::size_t i = 0; i < all.size(); ++i ) all[i] = i;
+      nodes.push_back( std::move( all ) );
+    }
+    return nodes;
+  }
+
+  std::vector<int> buildCPUToNodeMap( std::vector<std::vector<int>> const& nodes ) {
+    int maxCPU = 0;
+    for ( auto const& cpus : nodes )
+      for ( int cpu : cpus ) maxCPU = std::max( maxCPU, cpu );
+    std::vector<int> map( maxCPU + 1, 0 );
+    for ( std::size_t node = 0; node < nodes.size(); ++node )
+      for ( int cpu : nodes[node] ) map[cpu] = node;
+    return map;
+  }
+
+  std::vector<int> const& cpuToNode() {
+    static const auto map = buildCPUToNodeMap( LHCb::NUMA::nodeCPUs() );
+    return map;
+  }
+} // namespace
+
+std::vector<std::vector<int>> const& LHCb::NUMA::nodeCPUs() {
+  static const auto topology = readTopology();
+  return topology;
+}
+
+std::size_t LHCb::NUMA::currentNode() {
+  auto const  cpu = sched_getcpu();
+  auto const& map = cpuToNode();
+  return ( cpu < 0 || static_cast<std::size_t>( cpu ) >= map.size() ) ? 0 : map[cpu];
+}
+
+bool LHCb::NUMA::bindCurrentThreadToNode( std::size_t node ) {
+  auto const& nodes = nodeCPUs();
+  if ( node >= nodes.size() || nodes[node].empty() ) return false;
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  for ( int cpu : nodes[node] ) CPU_SET( cpu, &set );
+  return sched_setaffinity( 0, sizeof( cpu_set_t ), &set ) == 0;
+}
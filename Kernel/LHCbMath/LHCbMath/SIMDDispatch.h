@@ -0,0 +1,139 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+
+#pragma once
+
+#include "LHCbMath/SIMDWrapper.h"
+
+#include "GaudiKernel/GaudiException.h"
+
+#include <string>
+#include <utility>
+
+/** @file
+ *  Runtime selection of the instruction set used by SIMDWrapper based kernels.
+ *
+ *  The SIMDWrapper types available in a translation unit depend on the flags it is compiled
+ *  with, so a kernel written against them runs with the instruction set chosen at build time.
+ *  To ship a single binary running the best available code on any CPU, a kernel is written
+ *  as a class template taking the SIMDWrapper types as parameter, with a static apply method
+ *  whose signature does not depend on them, e.g.
+ *
+ *  @code
+ *  template <typename simd>
+ *  struct SumKernel {
+ *    static float apply( LHCb::span<const float> data ) { ... uses simd::float_v ... }
+ *  };
+ *  @endcode
+ *
+ *  It is then instantiated once per instruction set, each time in a dedicated source file
+ *  compiled with the matching flags (SSE_BUILD_FLAGS, AVX2_BUILD_FLAGS, and for both AVX256
+ *  and AVX512 SIMDWRAPPER_AVX512_BUILD_FLAGS, see Kernel/LHCbMath/CMakeLists.txt) :
+ *
+ *  @code
+ *  // SumKernel_AVX2.cpp
+ *  #include "SumKernel.h"
+ *  SIMDWRAPPER_INSTANTIATE_KERNEL( SumKernel, AVX2 )
+ *  @endcode
+ *
+ *  and the implementation to use is picked once, typically in initialize(), with
+ *  SIMDWrapper::selectKernel<SumKernel>(). The choice honours the CPU capabilities and the
+ *  LHCBMATH_DISABLE_{AVX512,AVX2,SSE4} environment variables, as LHCb::CPU::dispatch does.
+ *
+ *  Note that the instantiations should stay in their own source files : nothing else from
+ *  these should be called from code built with different flags.
+ */
+
+namespace SIMDWrapper {
+
+  /// Signature of the apply method of a kernel
+  template <template <typename> class Kernel>
+  using KernelFn = decltype( &Kernel<scalar::types>::apply );
+
+  /// Implementation of a kernel for a given instruction set, with the instruction set it was actually built for
+  template <template <typename> class Kernel>
+  using KernelImpl = std::pair<InstructionSet, KernelFn<Kernel>>;
+
+  /**
+   * Implementation of a kernel for the given instruction set.
+   * Only declared here so that it is never instantiated with the default flags : it is
+   * explicitly instantiated by SIMDWRAPPER_INSTANTIATE_KERNEL in a source file compiled
+   * with the flags matching ISA
+   */
+  template <template <typename> class Kernel, InstructionSet ISA>
+  KernelImpl<Kernel> kernelImpl();
+
+  /**
+   * Widest instruction set among Scalar, SSE, AVX2 and AVX512 usable on the current CPU,
+   * taking into account the LHCBMATH_DISABLE_* environment variables
+   */
+  InstructionSet runtimeInstructionSet();
+
+  /// Instruction set matching the given name (as returned by instructionSetName), EndOfList if unknown
+  InstructionSet instructionSetFromName( std::string const& name );
+
+  /**
+   * Select the implementation of a kernel to be used on this machine.
+   * Best gives the widest instruction set available at runtime. An explicit request
+   * is honoured if the CPU supports it, otherwise a GaudiException is thrown.
+   * AVX256 (AVX512 instructions on 256 bits wide vectors) is only used when explicitly requested
+   */
+  template <template <typename> class Kernel>
+  KernelImpl<Kernel> selectKernel( InstructionSet requested = Best ) {
+    auto const available = runtimeInstructionSet();
+    if ( requested == Best ) requested = available;
+    if ( requested > available ) {
+      throw GaudiException( "Instruction set " + instructionSetName( requested ) +
+                                " is not available, best supported is " + instructionSetName( available ),
+                            "SIMDWrapper::selectKernel", StatusCode::FAILURE );
+    }
+    switch ( requested ) {
+    case AVX512:
+      return kernelImpl<Kernel, AVX512>();
+    case AVX256:
+      return kernelImpl<Kernel, AVX256>();
+    case AVX2:
+      return kernelImpl<Kernel, AVX2>();
+    case SSE:
+      return kernelImpl<Kernel, SSE>();
+    case Scalar:
+      return kernelImpl<Kernel, Scalar>();
+    default:
+      throw GaudiException( "Invalid instruction set " + instructionSetName( requested ), "SIMDWrapper::selectKernel",
+                            StatusCode::FAILURE );
+    }
+  }
+
+  /// Select the implementation of a kernel from the name of the instruction set, see above
+  template <template <typename> class Kernel>
+  KernelImpl<Kernel> selectKernel( std::string const& requested ) {
+    auto const set = instructionSetFromName( requested );
+    if ( set == EndOfList ) {
+      throw GaudiException( "Unknown instruction set " + requested, "SIMDWrapper::selectKernel", StatusCode::FAILURE );
+    }
+    return selectKernel<Kernel>( set );
+  }
+
+} // namespace SIMDWrapper
+
+/**
+ * Provide the implementation of a kernel for the given instruction set (one of Scalar, SSE,
+ * AVX2, AVX256 and AVX512). To be used once per source file.
+ * The reported instruction set is the one the kernel was actually compiled for, which is
+ * lower than the requested one if the source file lacks the right flags
+ */
+#define SIMDWRAPPER_INSTANTIATE_KERNEL( Kernel, ISA )                                                                  \
+  template <template <typename> class K, SIMDWrapper::InstructionSet I>                                                \
+  SIMDWrapper::KernelImpl<K> SIMDWrapper::kernelImpl() {                                                               \
+    using map = SIMDWrapper::type_map<I>;                                                                              \
+    return {map::instructionSet(), &K<typename map::type>::apply};                                                     \
+  }                                                                                                                    \
+  template SIMDWrapper::KernelImpl<Kernel> SIMDWrapper::kernelImpl<Kernel, SIMDWrapper::ISA>();
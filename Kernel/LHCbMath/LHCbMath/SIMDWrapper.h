@@ -826,6 +826,9 @@ namespace SIMDWrapper {
       friend int_v operator&( const int_v& lhs, const int_v& rhs ) { return _mm256_and_si256( lhs, rhs ); }
       friend int_v operator|( const int_v& lhs, const int_v& rhs ) { return _mm256_or_si256( lhs, rhs ); }
 
+      friend int_v operator<<( const int_v& lhs, const int rhs ) { return _mm256_slli_epi32( lhs, rhs ); }
+      friend int_v operator>>( const int_v& lhs, const int rhs ) { return _mm256_srli_epi32( lhs, rhs ); }
+
       friend int_v operator<<( const int_v& lhs, const int_v& rhs ) { return _mm256_sllv_epi32( lhs, rhs ); }
       friend int_v operator>>( const int_v& lhs, const int_v& rhs ) { return _mm256_srlv_epi32( lhs, rhs ); }
 
@@ -1092,6 +1095,12 @@ namespace SIMDWrapper {
       friend int_v operator&( const int_v& lhs, const int_v& rhs ) { return _mm256_and_si256( lhs, rhs ); }
       friend int_v operator|( const int_v& lhs, const int_v& rhs ) { return _mm256_or_si256( lhs, rhs ); }
 
+      friend int_v operator<<( const int_v& lhs, const int rhs ) { return _mm256_slli_epi32( lhs, rhs ); }
+      friend int_v operator>>( const int_v& lhs, const int rhs ) { return _mm256_srli_epi32( lhs, rhs ); }
+
+      friend int_v operator<<( const int_v& lhs, const int_v& rhs ) { return _mm256_sllv_epi32( lhs, rhs ); }
+      friend int_v operator>>( const int_v& lhs, const int_v& rhs ) { return _mm256_srlv_epi32( lhs, rhs ); }
+
       friend int_v signselect( const float_v& s, const int_v& a, const int_v& b ) {
         return _mm256_mask_mov_epi32( a, s < float_v( 0.f ), b );
       }
@@ -1290,6 +1299,12 @@ namespace SIMDWrapper {
       friend int_v operator&( const int_v& lhs, const int_v& rhs ) { return _mm512_and_si512( lhs, rhs ); }
       friend int_v operator|( const int_v& lhs, const int_v& rhs ) { return _mm512_or_si512( lhs, rhs ); }
 
+      friend int_v operator<<( const int_v& lhs, const int rhs ) { return _mm512_slli_epi32( lhs, rhs ); }
+      friend int_v operator>>( const int_v& lhs, const int rhs ) { return _mm512_srli_epi32( lhs, rhs ); }
+
+      friend int_v operator<<( const int_v& lhs, const int_v& rhs ) { return _mm512_sllv_epi32( lhs, rhs ); }
+      friend int_v operator>>( const int_v& lhs, const int_v& rhs ) { return _mm512_srlv_epi32( lhs, rhs ); }
+
       friend int_v signselect( const float_v& s, const int_v& a, const int_v& b ) {
         return _mm512_mask_mov_epi32( a, s < float_v( 0.f ), b );
       }
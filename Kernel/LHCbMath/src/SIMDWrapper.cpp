@@ -9,6 +9,11 @@
 * or submit itself to any jurisdiction.                                       *
 \*****************************************************************************/
 #include "LHCbMath/SIMDWrapper.h"
+#include "LHCbMath/CPUDispatch.h"
+#include "LHCbMath/SIMDDispatch.h"
+
+#include <utility>
+
 namespace SIMDWrapper {
   InstructionSet type_map<InstructionSet::Scalar>::stackInstructionSet() { return scalar::instructionSet(); }
   InstructionSet type_map<InstructionSet::SSE>::stackInstructionSet() { return sse::instructionSet(); }
@@ -16,4 +21,18 @@ namespace SIMDWrapper {
   InstructionSet type_map<InstructionSet::AVX256>::stackInstructionSet() { return avx256::instructionSet(); }
   InstructionSet type_map<InstructionSet::AVX512>::stackInstructionSet() { return avx512::instructionSet(); }
   InstructionSet type_map<InstructionSet::Best>::stackInstructionSet() { return best::instructionSet(); }
+
+  InstructionSet runtimeInstructionSet() {
+    // the AVX512 types of SIMDWrapper need AVX512VL/BW/DQ, the SSE ones SSE4.2
+    auto vtbl = {std::pair{LHCb::CPU::AVX512BWDQ, AVX512}, std::pair{LHCb::CPU::AVX2, AVX2},
+                 std::pair{LHCb::CPU::SSE4, SSE}, std::pair{LHCb::CPU::GENERIC, Scalar}};
+    return LHCb::CPU::dispatch( vtbl );
+  }
+
+  InstructionSet instructionSetFromName( std::string const& name ) {
+    for ( auto set : {Best, Scalar, SSE, AVX2, AVX256, AVX512} ) {
+      if ( instructionSetName( set ) == name ) return set;
+    }
+    return EndOfList;
+  }
 } // namespace SIMDWrapper
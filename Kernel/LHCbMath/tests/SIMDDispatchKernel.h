@@ -0,0 +1,40 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+
+#include "LHCbMath/SIMDDispatch.h"
+
+/// Sum of x^2+y^2 for the points inside the circle of radius^2 r2max, the number of such points being put in count
+template <typename simd>
+struct SumSquaresKernel {
+  static float apply( const float* x, const float* y, int n, float r2max, int& count ) {
+    using F = typename simd::float_v;
+    F   sum{0.f};
+    int i = 0;
+    count = 0;
+    for ( ; i + int( simd::size ) <= n; i += simd::size ) {
+      F const    vx{x + i}, vy{y + i};
+      F const    r2   = vx * vx + vy * vy;
+      auto const mask = r2 < F{r2max};
+      sum             = sum + select( mask, r2, F{0.f} );
+      count += simd::popcount( mask );
+    }
+    float tail = 0.f;
+    for ( ; i < n; ++i ) {
+      float const r2 = x[i] * x[i] + y[i] * y[i];
+      if ( r2 < r2max ) {
+        tail += r2;
+        ++count;
+      }
+    }
+    return sum.hadd() + tail;
+  }
+};
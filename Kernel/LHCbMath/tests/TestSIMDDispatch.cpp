@@ -0,0 +1,67 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "SIMDDispatchKernel.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+// ============================================================================
+/** @file
+ *  Test the runtime selection of SIMDWrapper kernels : every implementation
+ *  supported by the CPU must give the same result as the scalar one
+ */
+// ============================================================================
+int main() {
+  // coordinates are multiples of 1/4 so that all sums are exact whatever the order
+  std::default_random_engine         gen;
+  std::uniform_int_distribution<int> coord( -16, 16 );
+  const int                          n = 1001;
+  std::vector<float>                 x( n ), y( n );
+  for ( int i = 0; i < n; ++i ) {
+    x[i] = coord( gen ) / 4.f;
+    y[i] = coord( gen ) / 4.f;
+  }
+  const float r2max = 9.f;
+
+  int         refCount = 0;
+  const float refSum   = SIMDWrapper::kernelImpl<SumSquaresKernel, SIMDWrapper::Scalar>().second(
+      x.data(), y.data(), n, r2max, refCount );
+
+  const auto available = SIMDWrapper::runtimeInstructionSet();
+  std::cout << "Runtime instruction set : " << SIMDWrapper::instructionSetName( available ) << std::endl;
+  const auto best = SIMDWrapper::selectKernel<SumSquaresKernel>();
+  std::cout << "Best kernel : " << SIMDWrapper::instructionSetName( best.first ) << std::endl;
+
+  int status = 0;
+  for ( auto set : {SIMDWrapper::Scalar, SIMDWrapper::SSE, SIMDWrapper::AVX2, SIMDWrapper::AVX256,
+                    SIMDWrapper::AVX512} ) {
+    if ( set > available ) {
+      try {
+        SIMDWrapper::selectKernel<SumSquaresKernel>( set );
+        std::cout << "ERROR " << SIMDWrapper::instructionSetName( set ) << " selected although not available"
+                  << std::endl;
+        status = 1;
+      } catch ( const GaudiException& ) {}
+      continue;
+    }
+    const auto name               = SIMDWrapper::instructionSetName( set );
+    const auto [compiled, kernel] = SIMDWrapper::selectKernel<SumSquaresKernel>( name );
+    int        count              = 0;
+    const auto sum                = kernel( x.data(), y.data(), n, r2max, count );
+    const bool ok                 = ( count == refCount && sum == refSum );
+    std::cout << ( ok ? "" : "ERROR " ) << name << " (compiled for "
+              << SIMDWrapper::instructionSetName( compiled ) << ") : count " << count << " sum " << sum
+              << ", expected " << refCount << " " << refSum << std::endl;
+    if ( !ok ) status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,146 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+#ifndef RELATIONS_HASHINDEX_H
+#define RELATIONS_HASHINDEX_H 1
+// ============================================================================
+// Include files
+// ============================================================================
+// STD & STL
+// ============================================================================
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+// ============================================================================
+// GaudiKernel
+// ============================================================================
+#include "GaudiKernel/SmartRef.h"
+#include "GaudiKernel/detected.h"
+// ============================================================================
+// Relations
+// ============================================================================
+#include "Relations/Pointer.h"
+// ============================================================================
+namespace Relations {
+  // ==========================================================================
+  /** the key of the "from" objects in the hash index, consistent with
+   *  their ordering: the pointer for pointers and references to objects,
+   *  the value for integers and strings
+   */
+  template <class TYPE>
+  const TYPE* indexKey( const Pointer<TYPE>& object ) {
+    return object.get();
+  }
+  template <class TYPE>
+  const TYPE* indexKey( const SmartRef<TYPE>& object ) {
+    return object.target();
+  }
+  template <class TYPE, typename = std::enable_if_t<std::is_integral_v<TYPE>>>
+  TYPE indexKey( const TYPE object ) {
+    return object;
+  }
+  inline const std::string& indexKey( const std::string& object ) { return object; }
+  // ==========================================================================
+  namespace detail {
+    template <class TYPE>
+    using IndexKey_t = decltype( indexKey( std::declval<const TYPE&>() ) );
+  }
+  /// can the "from" objects of the given type be indexed?
+  template <class TYPE>
+  inline constexpr bool isIndexable_v = Gaudi::cpp17::is_detected_v<detail::IndexKey_t, TYPE>;
+  // ==========================================================================
+  /** @class HashIndex Relations/HashIndex.h
+   *
+   *  Open-addressing (linear probing) hash index of the ranges of entries
+   *  with the same "from" object in a container sorted by "from" object,
+   *  so that the relations from an object are found in constant time
+   *  instead of a binary search.
+   *
+   *  The slots hold the range of entries of a "from" object, whose key is
+   *  read from the first entry of the range, so the index is only valid as
+   *  long as the container is not modified.
+   */
+  class HashIndex {
+  public:
+    // ========================================================================
+    /// range of entries, as indices in the container
+    using Range = std::pair<std::uint32_t, std::uint32_t>;
+    // ========================================================================
+  public:
+    // ========================================================================
+    /// is the index built?
+    bool valid() const { return !m_slots.empty(); }
+    /// drop the index
+    void clear() { m_slots.clear(); }
+    // ========================================================================
+    /** build the index
+     *  @param entries the entries, sorted by "from" object
+     *  @param key     the key of the "from" object of an entry
+     */
+    template <class ENTRIES, class KEY>
+    void build( const ENTRIES& entries, KEY key ) {
+      m_slots.clear();
+      // number of distinct "from" objects
+      std::size_t n = 0;
+      for ( std::size_t i = 0; i < entries.size(); ++i ) {
+        if ( 0 == i || !( key( entries[i] ) == key( entries[i - 1] ) ) ) { ++n; }
+      }
+      // at most half full
+      m_shift = 64;
+      do { --m_shift; } while ( ( std::size_t{1} << ( 64 - m_shift ) ) < 2 * n );
+      m_slots.assign( std::size_t{1} << ( 64 - m_shift ), Range{0, 0} );
+      // insert the ranges
+      std::uint32_t first = 0;
+      for ( std::uint32_t i = 1; i <= entries.size(); ++i ) {
+        if ( i < entries.size() && key( entries[i] ) == key( entries[first] ) ) { continue; }
+        auto slot = this->slot( key( entries[first] ) );
+        while ( !empty( m_slots[slot] ) ) { slot = ( slot + 1 ) & ( m_slots.size() - 1 ); }
+        m_slots[slot] = {first, i};
+        first         = i;
+      }
+    }
+    // ========================================================================
+    /** find the range of entries of the "from" object with the given key
+     *  @return the range, empty if there is none
+     */
+    template <class ENTRIES, class KEY, class K>
+    Range find( const ENTRIES& entries, KEY key, const K& k ) const {
+      for ( auto slot = this->slot( k );; slot = ( slot + 1 ) & ( m_slots.size() - 1 ) ) {
+        const auto& range = m_slots[slot];
+        if ( empty( range ) ) { return range; }
+        if ( key( entries[range.first] ) == k ) { return range; }
+      }
+    }
+    // ========================================================================
+  private:
+    // ========================================================================
+    static bool empty( const Range& range ) { return range.first == range.second; }
+    /// Fibonacci hashing of the key
+    template <class K>
+    std::size_t slot( const K& k ) const {
+      return ( std::uint64_t( std::hash<K>{}( k ) ) * 0x9E3779B97F4A7C15ull ) >> m_shift;
+    }
+    // ========================================================================
+  private:
+    // ========================================================================
+    std::vector<Range> m_slots;      ///< the slots, empty ranges for free slots
+    unsigned int       m_shift = 64; ///< shift of the hash, 64 - log2(number of slots)
+    // ========================================================================
+  };
+  // ==========================================================================
+} // end of namespace Relations
+// ============================================================================
+// The END
+// ============================================================================
+#endif // RELATIONS_HASHINDEX_H
@@ -167,6 +167,12 @@ namespace LHCb {
      *   mandatory to use after i_push
      */
     void i_sort() { m_base.i_sort(); }
+    /** (re)sort the table, removing the duplicated relations
+     *   to be used after i_push instead of i_sort for bulk building
+     */
+    void i_sortUnique( const bool parallel = false ) { m_base.i_sortUnique( parallel ); }
+    /// build the hash index of the table, until the next modification
+    void i_buildIndex() { m_base.i_buildIndex(); }
     // ========================================================================
   public: // merge
     // ========================================================================
@@ -168,6 +168,12 @@ namespace Relations {
      *   mandatory to use after i_push
      */
     inline void i_sort() { m_direct.i_sort(); }
+    /** (re)sort the table, removing the duplicated relations
+     *   to be used after i_push instead of i_sort for bulk building
+     */
+    inline void i_sortUnique( const bool parallel = false ) { m_direct.i_sortUnique( parallel ); }
+    /// build the hash index of the table, until the next modification
+    inline void i_buildIndex() { m_direct.i_buildIndex(); }
     // ========================================================================
   public: // merge
     // ========================================================================
@@ -18,6 +18,9 @@
 // ============================================================================
 #include <algorithm>
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 // ============================================================================
 // GaudiKernel
 // ============================================================================
@@ -26,9 +29,11 @@
 // ============================================================================
 // Relation
 // ============================================================================
+#include "Relations/HashIndex.h"
 #include "Relations/IRelation.h"
 #include "Relations/RelationTypeTraits.h"
 #include "Relations/Reserve.h"
+#include "Relations/StableSort.h"
 // ============================================================================
 namespace Relations {
   // ==========================================================================
@@ -88,6 +93,12 @@ namespace Relations {
     auto i_relations() const { return std::pair{m_entries.begin(), m_entries.end()}; }
     /// retrive all relations from the object
     auto i_relations( From_ object ) const {
+      if constexpr ( s_indexable ) {
+        if ( m_index.valid() ) {
+          const auto r = m_index.find( m_entries, s_key, s_key( Entry( object ) ) );
+          return std::pair{m_entries.begin() + r.first, m_entries.begin() + r.second};
+        }
+      }
       return std::equal_range( m_entries.begin(), m_entries.end(), Entry( object ), Less1() );
     }
     /// make the relation between 2 objects
@@ -104,6 +115,7 @@ namespace Relations {
       // the relation does exist !
       if ( m_entries.end() != it && !_less_( entry, *it ) ) { return StatusCode( StatusCode::FAILURE, true ); }
       // insert new relation !
+      m_index.clear();
       m_entries.insert( it, entry );
       return StatusCode::SUCCESS;
     }
@@ -116,6 +128,7 @@ namespace Relations {
       // the relation does not exist !
       if ( m_entries.end() == it || _less( ent, *it ) ) { return StatusCode( StatusCode::FAILURE, true ); }
       // remove existing relation
+      m_index.clear();
       m_entries.erase( it );
       return StatusCode::SUCCESS;
     }
@@ -126,6 +139,7 @@ namespace Relations {
       // there are no relations
       if ( ip.second == ip.first ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // erase relations
+      m_index.clear();
       m_entries.erase( ip.first, ip.second );
       return StatusCode::SUCCESS;
     }
@@ -140,11 +154,13 @@ namespace Relations {
       // no relations are found!
       if ( m_entries.end() == it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // erase the relations
+      m_index.clear();
       m_entries.erase( it, m_entries.end() );
       return StatusCode::SUCCESS;
     }
     /// remove ALL relations from ALL  object to ALL objects
     StatusCode i_clear() {
+      m_index.clear();
       m_entries.clear();
       return StatusCode::SUCCESS;
     }
@@ -154,11 +170,39 @@ namespace Relations {
       return StatusCode::SUCCESS;
     }
     /// make the relation between 2 objects
-    void i_push( From_ object1, To_ object2 ) { m_entries.push_back( Entry( object1, object2 ) ); }
+    void i_push( From_ object1, To_ object2 ) {
+      m_index.clear();
+      m_entries.push_back( Entry( object1, object2 ) );
+    }
     /** (re)sort the whole underlying container
      *  Call for this method is MANDATORY after usage of i_push
      */
-    void i_sort() { std::stable_sort( m_entries.begin(), m_entries.end(), Less() ); }
+    void i_sort() {
+      m_index.clear();
+      std::stable_sort( m_entries.begin(), m_entries.end(), Less() );
+    }
+    /** (re)sort the whole underlying container and remove the duplicated
+     *  relations, keeping the first one pushed, i.e. the table is the one
+     *  i_relate would have built, but in O(n log n) rather than O(n^2)
+     *  Call for this method (or i_sort) is MANDATORY after usage of i_push
+     *  @param parallel sort large tables with several threads
+     */
+    void i_sortUnique( const bool parallel = false ) {
+      static const Less _less = Less();
+      m_index.clear();
+      stableSort( m_entries, _less, parallel );
+      m_entries.erase( std::unique( m_entries.begin(), m_entries.end(),
+                                    []( const Entry& e1, const Entry& e2 ) { return !_less( e1, e2 ); } ),
+                       m_entries.end() );
+    }
+    /** build the hash index of the "from" objects, so that the relations from
+     *  an object are found in constant time, until the next modification of
+     *  the table (no-op for the types of "from" objects which cannot be hashed)
+     *  @attention the table must be sorted
+     */
+    void i_buildIndex() {
+      if constexpr ( s_indexable ) { m_index.build( m_entries, s_key ); }
+    }
     /// Access the number of relations
     std::size_t size() const { return m_entries.size(); }
     // ========================================================================
@@ -237,6 +281,7 @@ namespace Relations {
           Entries tmp( m_entries.size() + range.size() );
           std::merge( m_entries.begin(), m_entries.end(), range.begin(), range.end(), tmp.begin(), Less() );
           // use std::swap instead of assignement
+          m_index.clear();
           std::swap( m_entries, tmp );
         } else {
           for ( const auto& entry : range ) this->i_add( entry ).ignore();
@@ -303,10 +348,19 @@ namespace Relations {
      */
     RelationBase& operator+=( const Range& range ) { return merge( range ); }
     //
+  private:
+    // ========================================================================
+    /// can the "from" objects be indexed ?
+    static constexpr bool s_indexable = isIndexable_v<std::decay_t<decltype( std::declval<const Entry&>().m_from )>>;
+    /// the key of the "from" object of an entry in the index
+    static constexpr auto s_key = []( const auto& entry ) -> decltype( auto ) { return indexKey( entry.m_from ); };
+    // ========================================================================
   private:
     // ========================================================================
     /// the actual storage of relation links
     mutable Entries m_entries; // the actual storage of relation links
+    /// index of the "from" objects, empty if not built (transient)
+    HashIndex m_index; //! index of the "from" objects
     // ========================================================================
   };
   // ==========================================================================
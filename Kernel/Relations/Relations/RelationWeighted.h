@@ -202,6 +202,21 @@ namespace Relations {
       m_direct.i_sort();
       if ( 0 != m_inverse_aux ) { m_inverse_aux->i_sort(); }
     }
+    /** (re)sort of the table, removing the duplicated relations
+     *   to be used after i_push instead of i_sort for bulk building
+     *   @param parallel sort large tables with several threads
+     */
+    void i_sortUnique( const bool parallel = false ) {
+      m_direct.i_sortUnique( parallel );
+      if ( 0 != m_inverse_aux ) { m_inverse_aux->i_sortUnique( parallel ); }
+    }
+    /** build the hash index of the table, for constant time lookup
+     *   of the relations from an object, until the next modification
+     */
+    void i_buildIndex() {
+      m_direct.i_buildIndex();
+      if ( 0 != m_inverse_aux ) { m_inverse_aux->i_buildIndex(); }
+    }
     // ========================================================================
   public: // "merge"
     // ========================================================================
@@ -17,15 +17,19 @@
 // STD & STL
 // ============================================================================
 #include <algorithm>
+#include <type_traits>
+#include <utility>
 #include <vector>
 // ============================================================================
 #include "GaudiKernel/detected.h"
 // ============================================================================
 // Relations
 // ============================================================================
+#include "Relations/HashIndex.h"
 #include "Relations/IRelationWeighted.h"
 #include "Relations/RelationWeightedTypeTraits.h"
 #include "Relations/Reserve.h"
+#include "Relations/StableSort.h"
 // ============================================================================
 namespace Relations {
   // ==========================================================================
@@ -127,6 +131,12 @@ namespace Relations {
     // ========================================================================
     /// retrive all relations from the given object
     auto i_relations( From_ object ) const {
+      if constexpr ( s_indexable ) {
+        if ( m_index.valid() ) {
+          const auto r = m_index.find( m_entries, s_key, s_key( Entry( object ) ) );
+          return std::pair{m_entries.begin() + r.first, m_entries.begin() + r.second};
+        }
+      }
       return std::equal_range( m_entries.begin(), m_entries.end(), Entry( object ), Less1() );
     };
     /// retrive ALL relations from the ALL objects
@@ -171,8 +181,11 @@ namespace Relations {
       // does the given relation between object1 and object2 exist ?
       auto it = std::find_if( ip.first, ip.second, [&]( const Entry& lhs ) { return Equal()( lhs, entry ); } );
       if ( ip.second != it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
+      // the empty range from the index is not at the place of the object
+      if ( ip.second == ip.first ) { ip = std::equal_range( m_entries.begin(), m_entries.end(), entry, Less1() ); }
       // find the place where to insert the relation and insert it!
       it = std::lower_bound( ip.first, ip.second, entry, Less2() );
+      m_index.clear();
       m_entries.insert( it, entry );
       return StatusCode::SUCCESS;
     }
@@ -186,6 +199,7 @@ namespace Relations {
       } );
       if ( ip.second == it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // remove the relation
+      m_index.clear();
       m_entries.erase( it );
       return StatusCode::SUCCESS;
     }
@@ -196,6 +210,7 @@ namespace Relations {
       // no relations are found !!!
       if ( ip.second == ip.first ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // remove relations
+      m_index.clear();
       m_entries.erase( ip.first, ip.second );
       return StatusCode::SUCCESS;
     }
@@ -209,6 +224,7 @@ namespace Relations {
       // no relations are found!
       if ( m_entries.end() == it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!
       // remove relations
+      m_index.clear();
       m_entries.erase( it, m_entries.end() );
       return StatusCode::SUCCESS;
     }
@@ -221,6 +237,7 @@ namespace Relations {
       // no relations are found!
       if ( ip.second == ip.first ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // erase relations
+      m_index.clear();
       m_entries.erase( ip.first, ip.second );
       return StatusCode::SUCCESS;
     }
@@ -239,6 +256,7 @@ namespace Relations {
       // nothing to be removed
       if ( m_entries.end() == it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN !!!
       // erase the relations
+      m_index.clear();
       m_entries.erase( it, m_entries.end() );
       return StatusCode::SUCCESS;
     }
@@ -256,11 +274,13 @@ namespace Relations {
       // nothing to be removed
       if ( m_entries.end() == it ) { return StatusCode( StatusCode::FAILURE, true ); } // RETURN
       // erase the relations
+      m_index.clear();
       m_entries.erase( it, m_entries.end() );
       return StatusCode::SUCCESS;
     }
     /// remove ALL relations from ALL objects to ALL objects
     StatusCode i_clear() {
+      m_index.clear();
       m_entries.clear();
       return StatusCode::SUCCESS;
     }
@@ -283,12 +303,56 @@ namespace Relations {
      *  @param  weight  weigth for the relation
      */
     void i_push( From_ object1, To_ object2, Weight_ weight ) {
+      m_index.clear();
       m_entries.push_back( Entry( object1, object2, weight ) );
     }
     /** (re)sort the whole underlying container
      *  Call for this method is MANDATORY after usage of i_push
      */
-    void i_sort() { std::stable_sort( m_entries.begin(), m_entries.end(), Less() ); }
+    void i_sort() {
+      m_index.clear();
+      std::stable_sort( m_entries.begin(), m_entries.end(), Less() );
+    }
+    /** (re)sort the whole underlying container and remove the duplicated
+     *  relations, keeping the first one pushed between two objects, i.e. the
+     *  table is the one i_relate would have built: the relations from an
+     *  object are ordered by weight, the last one pushed first for equal
+     *  weights. It takes O(n log n) rather than O(n^2), as long as the number
+     *  of relations from an object stays small
+     *  Call for this method (or i_sort) is MANDATORY after usage of i_push
+     *  @param parallel sort large tables with several threads
+     */
+    void i_sortUnique( const bool parallel = false ) {
+      static const Less1 _less1 = Less1();
+      m_index.clear();
+      // group the relations by "from" object, in the order they were pushed
+      stableSort( m_entries, _less1, parallel );
+      auto out = m_entries.begin();
+      for ( auto first = m_entries.begin(); m_entries.end() != first; ) {
+        const auto last  = std::upper_bound( first, m_entries.end(), *first, _less1 );
+        const auto group = out;
+        // keep the first relation to each "to" object
+        for ( ; last != first; ++first ) {
+          if ( std::any_of( group, out, [&]( const Entry& entry ) { return Equal()( entry, *first ); } ) ) {
+            continue;
+          }
+          if ( out != first ) { *out = *first; }
+          ++out;
+        }
+        // i_add inserts a relation before the ones with the same weight
+        std::reverse( group, out );
+        std::stable_sort( group, out, Less2() );
+      }
+      m_entries.erase( out, m_entries.end() );
+    }
+    /** build the hash index of the "from" objects, so that the relations from
+     *  an object are found in constant time, until the next modification of
+     *  the table (no-op for the types of "from" objects which cannot be hashed)
+     *  @attention the table must be sorted
+     */
+    void i_buildIndex() {
+      if constexpr ( s_indexable ) { m_index.build( m_entries, s_key ); }
+    }
     /// standard/default constructor
     RelationWeightedBase( const size_t reserve = 0 ) : BaseWeightedTable(), m_entries() {
       if ( 0 < reserve ) { i_reserve( reserve ).ignore(); }
@@ -361,6 +425,7 @@ namespace Relations {
           Entries tmp( m_entries.size() + range.size() );
           std::merge( m_entries.begin(), m_entries.end(), range.begin(), range.end(), tmp.begin(), Less() );
           // use std::swap instead of assignement
+          m_index.clear();
           std::swap( m_entries, tmp );
         } else {
           for ( const auto& entry : range ) this->i_add( entry ).ignore();
@@ -427,10 +492,19 @@ namespace Relations {
      */
     RelationWeightedBase& operator+=( const Range& range ) { return merge( range ); }
     // ========================================================================
+  private:
+    // ========================================================================
+    /// can the "from" objects be indexed ?
+    static constexpr bool s_indexable = isIndexable_v<std::decay_t<decltype( std::declval<const Entry&>().m_from )>>;
+    /// the key of the "from" object of an entry in the index
+    static constexpr auto s_key = []( const auto& entry ) -> decltype( auto ) { return indexKey( entry.m_from ); };
+    // ========================================================================
   private:
     // ========================================================================
     /// the actual storage of relation links
     mutable Entries m_entries; // the actual storage of relation links
+    /// index of the "from" objects, empty if not built (transient)
+    HashIndex m_index; //! index of the "from" objects
     // ========================================================================
   };
   // ==========================================================================
@@ -0,0 +1,66 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+#ifndef RELATIONS_STABLESORT_H
+#define RELATIONS_STABLESORT_H 1
+// ============================================================================
+// Include files
+// ============================================================================
+// STD & STL
+// ============================================================================
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+// ============================================================================
+namespace Relations {
+  // ==========================================================================
+  /// minimal number of entries for the parallel sort
+  inline constexpr std::size_t s_minParallelSort = 1 << 16;
+  // ==========================================================================
+  /** stable sort of the entries of a relation table
+   *  @param entries  the entries
+   *  @param less     the ordering criteria
+   *  @param parallel sort large tables in chunks on several threads, then
+   *                  merge the chunks pairwise (the sort stays stable)
+   */
+  template <class ENTRIES, class LESS>
+  void stableSort( ENTRIES& entries, const LESS& less, const bool parallel ) {
+    const std::size_t nChunks =
+        parallel && s_minParallelSort <= entries.size() ? std::max( 1u, std::thread::hardware_concurrency() ) : 1;
+    if ( 1 == nChunks ) {
+      std::stable_sort( entries.begin(), entries.end(), less );
+      return;
+    }
+    // sort the chunks in parallel, then merge them pairwise (stable)
+    std::vector<std::size_t> bounds;
+    for ( std::size_t i = 0; i <= nChunks; ++i ) { bounds.push_back( i * entries.size() / nChunks ); }
+    std::vector<std::future<void>> sorts;
+    for ( std::size_t i = 0; i < nChunks; ++i ) {
+      sorts.push_back( std::async( std::launch::async, [&entries, &less, b = bounds[i], e = bounds[i + 1]] {
+        std::stable_sort( entries.begin() + b, entries.begin() + e, less );
+      } ) );
+    }
+    for ( auto& sort : sorts ) { sort.get(); }
+    for ( std::size_t step = 1; step < nChunks; step *= 2 ) {
+      for ( std::size_t i = 0; i + step < nChunks; i += 2 * step ) {
+        std::inplace_merge( entries.begin() + bounds[i], entries.begin() + bounds[i + step],
+                            entries.begin() + bounds[std::min( i + 2 * step, nChunks )], less );
+      }
+    }
+  }
+  // ==========================================================================
+} // end of namespace Relations
+// ============================================================================
+// The END
+// ============================================================================
+#endif // RELATIONS_STABLESORT_H
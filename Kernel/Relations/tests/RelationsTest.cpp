@@ -13,7 +13,10 @@
 // ============================================================================
 // STD&STL
 // ============================================================================
+#include <algorithm>
 #include <iostream>
+#include <tuple>
+#include <vector>
 // ============================================================================
 // Relations
 // ============================================================================
@@ -55,6 +58,88 @@ int main() {
   std::cout << " Table size: "
             << " t1 " << t1.relations().size() << " t2 " << t2.relations().size() << " t3 " << t3.relations().size()
             << " t4 " << t4.relations().size() << std::endl;
+
+  // bulk build, with duplicated relations, must give the same table as relate
+  LHCb::Relation1D<int, float> t5;
+  for ( int i = 2; 0 <= i; --i ) {
+    t5.i_push( i, float( i ) );
+    t5.i_push( i, float( i ) );
+  }
+  t5.i_sortUnique();
+  t5.i_buildIndex();
+
+  const auto r1 = t1.relations();
+  const auto r5 = t5.relations();
+  if ( !std::equal( r1.begin(), r1.end(), r5.begin(), r5.end(),
+                    []( const auto& e1, const auto& e5 ) { return e1.from() == e5.from() && e1.to() == e5.to(); } ) ) {
+    std::cout << " Bulk built table differs" << std::endl;
+    return 1;
+  }
+  for ( int i = 0; i < 4; ++i ) {
+    if ( t1.relations( i ).size() != t5.relations( i ).size() ) {
+      std::cout << " Indexed relations from " << i << " differ" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << " Bulk built table size: " << r5.size() << std::endl;
+
+  // same with pointers, the usual "from" objects, and weighted tables, whose
+  // relations from an object are ordered by weight (the last one first for
+  // equal weights)
+  struct Hit {};
+  Hit                                         hits[4];
+  LHCb::Relation1D<Hit*, int>                 t6, t7;
+  LHCb::RelationWeighted2D<Hit*, int, double> t8, t9;
+
+  const std::vector<std::tuple<int, int, double>> links = {{2, 0, 1.0}, {0, 1, 0.5}, {2, 1, 1.0}, {0, 1, 0.2},
+                                                           {1, 2, 0.3}, {2, 0, 0.1}, {0, 2, 0.5}, {2, 2, 0.7}};
+  for ( const auto& [h, i, w] : links ) {
+    t6.relate( &hits[h], i );
+    t7.i_push( &hits[h], i );
+    t8.relate( &hits[h], i, w );
+    t9.i_push( &hits[h], i, w );
+  }
+  t7.i_sortUnique();
+  t7.i_buildIndex();
+  t9.i_sortUnique();
+  t9.i_buildIndex();
+
+  const auto same = []( const auto& ra, const auto& rb ) {
+    return std::equal( ra.begin(), ra.end(), rb.begin(), rb.end(), []( const auto& ea, const auto& eb ) {
+      return ea.from() == eb.from() && ea.to() == eb.to();
+    } );
+  };
+  const auto sameW = []( const auto& ra, const auto& rb ) {
+    return std::equal( ra.begin(), ra.end(), rb.begin(), rb.end(), []( const auto& ea, const auto& eb ) {
+      return ea.from() == eb.from() && ea.to() == eb.to() && ea.weight() == eb.weight();
+    } );
+  };
+  if ( !same( t6.relations(), t7.relations() ) || !sameW( t8.relations(), t9.relations() ) ||
+       !sameW( t8.inverse()->relations(), t9.inverse()->relations() ) ) {
+    std::cout << " Bulk built pointer table differs" << std::endl;
+    return 1;
+  }
+  // the last hit has no relations
+  for ( auto& hit : hits ) {
+    if ( !same( t6.relations( &hit ), t7.relations( &hit ) ) || !sameW( t8.relations( &hit ), t9.relations( &hit ) ) ||
+         !sameW( t8.relations( &hit, 0.5, true ), t9.relations( &hit, 0.5, true ) ) ) {
+      std::cout << " Indexed relations from hit " << &hit - hits << " differ" << std::endl;
+      return 1;
+    }
+  }
+  // any modification drops the index
+  t8.relate( &hits[3], 0, 0.4 );
+  t9.relate( &hits[3], 0, 0.4 );
+  t8.removeFrom( &hits[0] );
+  t9.removeFrom( &hits[0] );
+  for ( auto& hit : hits ) {
+    if ( !sameW( t8.relations( &hit ), t9.relations( &hit ) ) ) {
+      std::cout << " Relations from hit " << &hit - hits << " differ after modification" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << " Bulk built pointer table sizes: " << t7.relations().size() << " " << t9.relations().size()
+            << std::endl;
 }
 // ============================================================================
 // The END
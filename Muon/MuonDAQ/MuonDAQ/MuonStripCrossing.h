@@ -0,0 +1,113 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#pragma once
+#include "Kernel/MuonTileID.h"
+#include "Kernel/STLExtensions.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace LHCb::Muon::DAQ {
+
+  /** @class StripCrossing MuonStripCrossing.h
+   *  Crossing of the horizontal and vertical logical strips of one region and quarter
+   *  into pads, as done by MuonRawToHits.
+   *
+   *  A horizontal strip (one) and a vertical strip (two) cross if the grid coordinates of
+   *  the first, expressed in the layout of the second, match those of the second:
+   *    one.nX() * otherGridX / thisGridX == two.nX() and two.nY() * thisGridY / otherGridY == one.nY()
+   *  Rather than testing all pairs, the vertical strips are bucketed by these common
+   *  coordinates with a counting sort, and each horizontal strip is joined with its bucket,
+   *  which takes a time linear in the number of strips and crossings. The crossings come
+   *  out in the order of the nested loop (by strip one, then strip two), so that the hits
+   *  are unchanged.
+   *
+   *  The buffers are kept from one call to the next, so one instance should be reused
+   *  for all the quarters of an event.
+   */
+  class StripCrossing final {
+  public:
+    /// A crossing, given by the indices of the horizontal and vertical strips
+    struct Crossing {
+      std::uint32_t one;
+      std::uint32_t two;
+    };
+
+    /// Cross the given horizontal and vertical strips, which have a `tile` data member
+    template <typename Digit>
+    void cross( span<Digit> digitsOne, span<Digit> digitsTwo ) {
+      m_crossings.clear();
+      m_usedOne.assign( digitsOne.size(), false );
+      m_usedTwo.assign( digitsTwo.size(), false );
+      if ( digitsOne.empty() || digitsTwo.empty() ) return;
+
+      const auto thisGridX  = digitsOne[0].tile.layout().xGrid();
+      const auto thisGridY  = digitsOne[0].tile.layout().yGrid();
+      const auto otherGridX = digitsTwo[0].tile.layout().xGrid();
+      const auto otherGridY = digitsTwo[0].tile.layout().yGrid();
+
+      // grid coordinates of the vertical strips, and their range
+      m_keys.clear();
+      unsigned int nX = 0, nY = 0;
+      for ( const auto& digit : digitsTwo ) {
+        const unsigned int x = digit.tile.nX(), y = digit.tile.nY() * thisGridY / otherGridY;
+        m_keys.push_back( {x, y} );
+        nX = std::max( nX, x + 1 );
+        nY = std::max( nY, y + 1 );
+      }
+
+      // bucket the vertical strips (counting sort, keeping their order in each bucket)
+      m_offsets.assign( nX * nY + 1, 0 );
+      for ( const auto& [x, y] : m_keys ) ++m_offsets[x * nY + y + 1];
+      for ( std::size_t b = 1; b < m_offsets.size(); ++b ) m_offsets[b] += m_offsets[b - 1];
+      m_bucketed.resize( m_keys.size() );
+      m_fill.assign( m_offsets.begin(), m_offsets.end() - 1 );
+      for ( std::uint32_t j = 0; j < m_keys.size(); ++j ) {
+        m_bucketed[m_fill[m_keys[j].first * nY + m_keys[j].second]++] = j;
+      }
+
+      // join each horizontal strip with its bucket
+      std::uint32_t i = 0;
+      for ( const auto& digit : digitsOne ) {
+        const unsigned int x = digit.tile.nX() * otherGridX / thisGridX, y = digit.tile.nY();
+        if ( x < nX && y < nY ) {
+          const auto bucket = x * nY + y;
+          for ( auto b = m_offsets[bucket]; b != m_offsets[bucket + 1]; ++b ) {
+            m_crossings.push_back( {i, m_bucketed[b]} );
+            m_usedOne[i] = m_usedTwo[m_bucketed[b]] = true;
+          }
+        }
+        ++i;
+      }
+    }
+
+    /// The crossings found by the last call to cross
+    span<const Crossing> crossings() const { return m_crossings; }
+
+    /// Whether the given horizontal strip crosses a vertical one
+    bool usedOne( std::size_t i ) const { return m_usedOne[i]; }
+
+    /// Whether the given vertical strip crosses a horizontal one
+    bool usedTwo( std::size_t j ) const { return m_usedTwo[j]; }
+
+  private:
+    std::vector<std::pair<unsigned int, unsigned int>> m_keys;     ///< Grid coordinates of the vertical strips
+    std::vector<std::uint32_t>                         m_offsets;  ///< Start of each bucket in m_bucketed
+    std::vector<std::uint32_t>                         m_fill;     ///< Fill position of each bucket
+    std::vector<std::uint32_t>                         m_bucketed; ///< Vertical strips, by bucket
+    std::vector<Crossing>                              m_crossings;
+    std::vector<bool>                                  m_usedOne;
+    std::vector<bool>                                  m_usedTwo;
+  };
+
+} // namespace LHCb::Muon::DAQ
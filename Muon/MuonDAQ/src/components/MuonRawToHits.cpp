@@ -16,6 +16,7 @@
 #include "GaudiAlg/Transformer.h"
 #include "GaudiKernel/ToolHandle.h"
 #include "MuonDAQ/MuonHitContainer.h"
+#include "MuonDAQ/MuonStripCrossing.h"
 #include "MuonDet/DeMuonDetector.h"
 #include "MuonDet/MuonTilePosition.h"
 #include <array>
@@ -113,8 +114,8 @@ namespace LHCb::Muon::DAQ {
   private:
     std::array<std::vector<Digit>, 4> decodeTileAndTDC( span<const RawBank*>, const DeMuonDetector& ) const;
     template <typename Iterator>
-    Iterator addCoordsCrossingMap( Iterator, Iterator, CommonMuonHits&, const ComputeTilePosition&,
-                                   size_t nStations ) const;
+    Iterator addCoordsCrossingMap( Iterator, Iterator, CommonMuonHits&, const ComputeTilePosition&, size_t nStations,
+                                   StripCrossing& ) const;
   };
 
   DECLARE_COMPONENT_WITH_ID( RawToHits, "MuonRawToHits" )
@@ -169,11 +170,12 @@ namespace LHCb::Muon::DAQ {
                  [&]( const Digit& a, const Digit& b ) { return regionAndQuarter( a ) < regionAndQuarter( b ); } );
     }
 
-    auto addCrossings = [&]( auto f, auto l, auto& dest ) {
+    StripCrossing crossing;
+    auto          addCrossings = [&]( auto f, auto l, auto& dest ) {
       auto next = std::find_if( std::next( f ), l, [=, rq = regionAndQuarter( *f )]( const auto& k ) {
         return regionAndQuarter( k ) != rq;
       } );
-      return addCoordsCrossingMap( f, next, dest, compute, nStations );
+      return addCoordsCrossingMap( f, next, dest, compute, nStations, crossing );
     };
 
     unsigned station = 0;
@@ -194,13 +196,10 @@ namespace LHCb::Muon::DAQ {
 
   template <typename Iterator>
   Iterator RawToHits::addCoordsCrossingMap( Iterator first, Iterator last, CommonMuonHits& commonHits,
-                                            const ComputeTilePosition& compute, size_t nStations ) const {
+                                            const ComputeTilePosition& compute, size_t nStations,
+                                            StripCrossing& crossing ) const {
     // need to calculate the shape of the horizontal and vertical logical strips
 
-    // used flags
-    assert( std::distance( first, last ) < 400 );
-    std::bitset<400> used; // (to be updated with new readout) the maximum # of channels per quadrant is currently 384
-                           // (from M2R2)
     // partition into the two directions of digits
     // vertical and horizontal stripes
     const auto mid = std::partition( first, last, []( const Digit& digit ) { return digit.tile.isHorizontal(); } );
@@ -209,53 +208,42 @@ namespace LHCb::Muon::DAQ {
     auto digitsTwo = make_span( mid, last );
 
     // check how many cross
-    if ( first != mid && mid != last ) {
-      auto thisGridX = first->tile.layout().xGrid();
-      auto thisGridY = first->tile.layout().yGrid();
-
-      auto otherGridX = mid->tile.layout().xGrid();
-      auto otherGridY = mid->tile.layout().yGrid();
-
-      unsigned i = 0;
-      for ( const Digit& one : digitsOne ) {
-        unsigned int calcX = one.tile.nX() * otherGridX / thisGridX;
-        unsigned     j     = mid - first;
-        for ( const Digit& two : digitsTwo ) {
-          unsigned int calcY = two.tile.nY() * thisGridY / otherGridY;
-          if ( calcX == two.tile.nX() && calcY == one.tile.nY() ) {
-            MuonTileID pad( one.tile );
-            pad.setY( two.tile.nY() );
-            pad.setLayout( {thisGridX, otherGridY} );
-            auto&& [pos, dx, dy] = compute.tilePosition( pad );
-            commonHits.emplace_back( std::move( pad ), one.tile, two.tile, pos.X(), dx, pos.Y(), dy, pos.Z(), 0,
-                                     one.tdc, one.tdc - two.tdc, 0 );
-            used[i] = used[j] = true;
-          }
-          ++j;
-        }
-        ++i;
+    // no reserve here: the caller reserves the hits of the whole station
+    crossing.cross( digitsOne, digitsTwo );
+
+    if ( !crossing.crossings().empty() ) {
+      const auto thisGridX  = first->tile.layout().xGrid();
+      const auto otherGridY = mid->tile.layout().yGrid();
+      for ( const auto [i, j] : crossing.crossings() ) {
+        const Digit& one = digitsOne[i];
+        const Digit& two = digitsTwo[j];
+        MuonTileID   pad( one.tile );
+        pad.setY( two.tile.nY() );
+        pad.setLayout( {thisGridX, otherGridY} );
+        auto&& [pos, dx, dy] = compute.tilePosition( pad );
+        commonHits.emplace_back( std::move( pad ), one.tile, two.tile, pos.X(), dx, pos.Y(), dy, pos.Z(), 0, one.tdc,
+                                 one.tdc - two.tdc, 0 );
       }
     }
 
     // copy over "uncrossed" digits
-    unsigned m = 0;
-    for ( const Digit& digit : digitsOne ) {
-      if ( !used[m++] ) {
-        auto pos = ( ( digit.tile.station() > ( nStations - 3 ) && digit.tile.region() == 0 )
+    for ( std::size_t m = 0; m < digitsOne.size(); ++m ) {
+      if ( crossing.usedOne( m ) ) continue;
+      const Digit& digit = digitsOne[m];
+      auto         pos   = ( ( digit.tile.station() > ( nStations - 3 ) && digit.tile.region() == 0 )
                          ? compute.tilePosition( digit.tile )
                          : compute.stripXPosition( digit.tile ) );
-        commonHits.emplace_back( digit.tile, pos.p.X(), pos.dX, pos.p.Y(), pos.dY, pos.p.Z(), 0., 1, digit.tdc,
-                                 digit.tdc );
-      }
+      commonHits.emplace_back( digit.tile, pos.p.X(), pos.dX, pos.p.Y(), pos.dY, pos.p.Z(), 0., 1, digit.tdc,
+                               digit.tdc );
     }
-    for ( const Digit& digit : digitsTwo ) {
-      if ( !used[m++] ) {
-        auto pos = ( ( digit.tile.station() > ( nStations - 3 ) && digit.tile.region() == 0 )
+    for ( std::size_t m = 0; m < digitsTwo.size(); ++m ) {
+      if ( crossing.usedTwo( m ) ) continue;
+      const Digit& digit = digitsTwo[m];
+      auto         pos   = ( ( digit.tile.station() > ( nStations - 3 ) && digit.tile.region() == 0 )
                          ? compute.tilePosition( digit.tile )
                          : compute.stripYPosition( digit.tile ) );
-        commonHits.emplace_back( digit.tile, pos.p.X(), pos.dX, pos.p.Y(), pos.dY, pos.p.Z(), 0., 1, digit.tdc,
-                                 digit.tdc );
-      }
+      commonHits.emplace_back( digit.tile, pos.p.X(), pos.dX, pos.p.Y(), pos.dY, pos.p.Z(), 0., 1, digit.tdc,
+                               digit.tdc );
     }
     return last;
   }
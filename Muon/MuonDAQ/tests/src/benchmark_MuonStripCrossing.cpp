@@ -0,0 +1,134 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Benchmark of the crossing of the Muon logical strips into pads, as done by MuonRawToHits.
+// For a range of occupancies, random pads of one quarter of M2R1 (pad layout 48x8, horizontal
+// strips 48x1, vertical strips 8x8) are fired, converted into the corresponding horizontal and
+// vertical strips, and the strips are crossed both with the original nested loop and with
+// LHCb::Muon::DAQ::StripCrossing. The crossings found are checked to be the same, and the time
+// per quarter is reported for both methods.
+//
+// usage: benchmark_MuonStripCrossing [nQuarters] [seed]
+#include "MuonDAQ/MuonStripCrossing.h"
+
+#include "Kernel/MuonLayout.h"
+#include "Kernel/MuonTileID.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using LHCb::MuonTileID;
+  using LHCb::Muon::DAQ::StripCrossing;
+
+  struct Digit {
+    MuonTileID   tile;
+    unsigned int tdc;
+  };
+
+  const MuonLayout s_padLayout{48, 8};
+  const MuonLayout s_horizontalLayout{48, 1};
+  const MuonLayout s_verticalLayout{8, 8};
+
+  /// the strips of nPads random pads of one quarter, horizontal first
+  std::pair<std::vector<Digit>, std::vector<Digit>> makeQuarter( std::mt19937& rng, unsigned nPads ) {
+    std::uniform_int_distribution<unsigned> x( 0, 2 * s_padLayout.xGrid() - 1 ), y( 0, 2 * s_padLayout.yGrid() - 1 );
+    std::uniform_int_distribution<unsigned> tdc( 0, 15 );
+    std::set<std::pair<unsigned, unsigned>> horizontal, vertical;
+    for ( unsigned i = 0; i < nPads; ++i ) {
+      const auto px = x( rng ), py = y( rng );
+      horizontal.emplace( px * s_horizontalLayout.xGrid() / s_padLayout.xGrid(),
+                          py * s_horizontalLayout.yGrid() / s_padLayout.yGrid() );
+      vertical.emplace( px * s_verticalLayout.xGrid() / s_padLayout.xGrid(),
+                        py * s_verticalLayout.yGrid() / s_padLayout.yGrid() );
+    }
+    std::pair<std::vector<Digit>, std::vector<Digit>> strips;
+    for ( const auto& [sx, sy] : horizontal ) {
+      strips.first.push_back( {MuonTileID( 1, s_horizontalLayout, 0, 0, sx, sy ), tdc( rng )} );
+    }
+    for ( const auto& [sx, sy] : vertical ) {
+      strips.second.push_back( {MuonTileID( 1, s_verticalLayout, 0, 0, sx, sy ), tdc( rng )} );
+    }
+    std::shuffle( strips.first.begin(), strips.first.end(), rng );
+    std::shuffle( strips.second.begin(), strips.second.end(), rng );
+    return strips;
+  }
+
+  /// the nested loop of the original MuonRawToHits
+  void nestedLoop( const std::vector<Digit>& digitsOne, const std::vector<Digit>& digitsTwo,
+                   std::vector<StripCrossing::Crossing>& crossings ) {
+    crossings.clear();
+    if ( digitsOne.empty() || digitsTwo.empty() ) return;
+    const auto thisGridX  = digitsOne[0].tile.layout().xGrid();
+    const auto thisGridY  = digitsOne[0].tile.layout().yGrid();
+    const auto otherGridX = digitsTwo[0].tile.layout().xGrid();
+    const auto otherGridY = digitsTwo[0].tile.layout().yGrid();
+    for ( std::uint32_t i = 0; i < digitsOne.size(); ++i ) {
+      const unsigned int calcX = digitsOne[i].tile.nX() * otherGridX / thisGridX;
+      for ( std::uint32_t j = 0; j < digitsTwo.size(); ++j ) {
+        const unsigned int calcY = digitsTwo[j].tile.nY() * thisGridY / otherGridY;
+        if ( calcX == digitsTwo[j].tile.nX() && calcY == digitsOne[i].tile.nY() ) crossings.push_back( {i, j} );
+      }
+    }
+  }
+} // namespace
+
+int main( int argc, char* argv[] ) {
+  const unsigned nQuarters = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 1000;
+  const unsigned seed      = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 42;
+  std::mt19937   rng( seed );
+
+  std::printf( "%8s | %8s | %8s | %14s | %14s | %8s\n", "pads", "strips", "crossed", "nested (us)", "buckets (us)",
+               "speed-up" );
+  // up to a fully fired quarter, beyond the upgrade occupancies of the inner regions
+  for ( unsigned nPads : {4u, 8u, 16u, 32u, 64u, 128u, 256u, 512u, 1024u} ) {
+    std::vector<std::pair<std::vector<Digit>, std::vector<Digit>>> quarters;
+    std::size_t                                                    nStrips = 0;
+    for ( unsigned i = 0; i < nQuarters; ++i ) {
+      quarters.push_back( makeQuarter( rng, nPads ) );
+      nStrips += quarters.back().first.size() + quarters.back().second.size();
+    }
+
+    // check
+    std::vector<StripCrossing::Crossing> reference;
+    StripCrossing                        crossing;
+    std::size_t                          nCrossed = 0;
+    for ( auto& [one, two] : quarters ) {
+      nestedLoop( one, two, reference );
+      crossing.cross( LHCb::make_span( one ), LHCb::make_span( two ) );
+      const auto found = crossing.crossings();
+      if ( !std::equal( reference.begin(), reference.end(), found.begin(), found.end(),
+                        []( const auto& a, const auto& b ) { return a.one == b.one && a.two == b.two; } ) ) {
+        std::fprintf( stderr, "%u pads : crossings differ from the nested loop\n", nPads );
+        return 1;
+      }
+      nCrossed += reference.size();
+    }
+
+    // time
+    auto start = Clock::now();
+    for ( auto& [one, two] : quarters ) nestedLoop( one, two, reference );
+    const double nested = std::chrono::duration<double, std::micro>( Clock::now() - start ).count() / nQuarters;
+    start               = Clock::now();
+    for ( auto& [one, two] : quarters ) crossing.cross( LHCb::make_span( one ), LHCb::make_span( two ) );
+    const double buckets = std::chrono::duration<double, std::micro>( Clock::now() - start ).count() / nQuarters;
+
+    std::printf( "%8u | %8.1f | %8.1f | %14.3f | %14.3f | %8.2f\n", nPads, double( nStrips ) / nQuarters,
+                 double( nCrossed ) / nQuarters, nested, buckets, nested / buckets );
+  }
+  return 0;
+}
@@ -50,7 +50,7 @@ namespace LoKi {
     GAUDI_API std::ostream& makeCode( std::ostream& stream, const std::string& type, const std::string& cppcode,
                                       const std::string& pycode, const std::string& pytype );
     // ========================================================================
-    /** calculate the hash for the code flagment
+    /** calculate the hash for the code flagment, the first 32 bits of its MD5 digest (stable across builds)
      *  @param code  the code
      *  @return hash-value
      *  @author Vanya BELYAEV Ivan.Belyaev@itep.ru
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <climits>
 #include <optional>
+#include <type_traits>
 // ============================================================================
 // GaudiKernel
 // ============================================================================
@@ -105,8 +106,17 @@ namespace LoKi {
       std::vector<TYPE> operator()( const std::vector<TYPE>& a ) const override {
         std::vector<TYPE> r;
         r.reserve( a.size() );
-        std::copy_if( a.begin(), a.end(), std::back_inserter( r ),
-                      [&]( const TYPE& arg ) { return LoKi::apply( m_predicate.func(), arg ); } );
+        if constexpr ( std::is_same_v<TYPE, TYPE2> ) {
+          // evaluate the predicate for the whole container in one go
+          LoKi::V2::details::BatchBuffer<bool> accept{a.size()};
+          m_predicate.func().batch( a, accept.span() );
+          for ( std::size_t i = 0; i < a.size(); ++i ) {
+            if ( accept[i] ) r.push_back( a[i] );
+          }
+        } else {
+          std::copy_if( a.begin(), a.end(), std::back_inserter( r ),
+                        [&]( const TYPE& arg ) { return LoKi::apply( m_predicate.func(), arg ); } );
+        }
         return r;
       }
       /// OPTIONAL: the basic printout method
@@ -154,10 +164,18 @@ namespace LoKi {
       Yields* clone() const override { return new Yields( *this ); }
       /// MANDATORY: the only one essential method
       std::vector<TYPE1> operator()( const std::vector<TYPE>& a ) const override {
-        std::vector<TYPE1> out;
-        out.reserve( a.size() );
-        LoKi::apply( a.begin(), a.end(), m_functor.func(), std::back_inserter( out ) );
-        return out;
+        if constexpr ( std::is_same_v<TYPE, TYPE2> && !std::is_same_v<TYPE1, bool> &&
+                       std::is_default_constructible_v<TYPE1> ) {
+          // evaluate the functor for the whole container in one go
+          std::vector<TYPE1> out( a.size() );
+          m_functor.func().batch( a, out );
+          return out;
+        } else {
+          std::vector<TYPE1> out;
+          out.reserve( a.size() );
+          LoKi::apply( a.begin(), a.end(), m_functor.func(), std::back_inserter( out ) );
+          return out;
+        }
       }
       /// OPTIONAL: the basic printout method
       std::ostream& fillStream( std::ostream& s ) const override { return s << "yields(" << m_functor << ")"; };
@@ -502,7 +520,15 @@ namespace LoKi {
       Count* clone() const override { return new Count( *this ); }
       /// MANDATORY: the only one essential method:
       double operator()( const std::vector<TYPE>& a ) const override {
-        return std::count_if( a.begin(), a.end(), LoKi::Apply( m_cut.func() ) );
+        if constexpr ( std::is_same_v<TYPE, TYPE1> && std::is_same_v<TYPE2, bool> ) {
+          // evaluate the predicate for the whole container in one go
+          LoKi::V2::details::BatchBuffer<bool> accept{a.size()};
+          m_cut.func().batch( a, accept.span() );
+          const auto flags = accept.span();
+          return std::count( flags.begin(), flags.end(), true );
+        } else {
+          return std::count_if( a.begin(), a.end(), LoKi::Apply( m_cut.func() ) );
+        }
       }
       /// OPTIONAL: the basic printout method
       std::ostream& fillStream( std::ostream& s ) const override { return s << "count(" << m_cut << ")"; }
@@ -16,12 +16,17 @@
 // ============================================================================
 // STD & STL
 // ============================================================================
+#include <algorithm>
 #include <memory>
 // ============================================================================
 // GaudiKernel
 // ============================================================================
 #include "GaudiKernel/ToStream.h"
 // ============================================================================
+// LHCbKernel
+// ============================================================================
+#include "Kernel/STLExtensions.h"
+// ============================================================================
 // LoKi
 // ============================================================================
 #include "LoKi/AuxFunBase.h"
@@ -75,6 +80,16 @@ namespace LoKi {
     TYPE2 evaluate( argument a ) const { return ( *this )( a ); }
     /// the only one essential method ("function")
     TYPE2 eval( argument a ) const { return ( *this )( a ); }
+    /** evaluate the function for a batch of arguments
+     *  The default implementation calls the function for each argument in turn;
+     *  the compositions of LoKi/Primitives.h override it to evaluate each of
+     *  their children for the whole batch before moving to the next one.
+     *  @param args    the arguments
+     *  @param results the results, one per argument
+     */
+    virtual void batch( LHCb::span<const TYPE> args, LHCb::span<TYPE2> results ) const {
+      std::transform( args.begin(), args.end(), results.begin(), [this]( argument a ) { return ( *this )( a ); } );
+    }
     /// clone method
     virtual Functor* clone() const = 0;
     /// virtual destructor
@@ -139,6 +154,10 @@ namespace LoKi {
     /// MANDATORY: the only one essential method
     TYPE2
     operator()( typename functor::argument a ) const override { return fun( a ); }
+    /// OPTIONAL: batch evaluation, delegate to the underlying object
+    void batch( LHCb::span<const TYPE> args, LHCb::span<TYPE2> results ) const override {
+      m_fun->batch( args, results );
+    }
     /// OPTIONAL: the basic printout method, delegate to the underlying object
     std::ostream& fillStream( std::ostream& s ) const override { return m_fun->fillStream( s ); };
     /// OPTIONAL: unique function ID, delegate to the underlying objects
@@ -199,6 +218,10 @@ namespace LoKi {
     virtual TYPE2 evaluate() const { return ( *this )(); }
     /// the only one essential method ("function")
     virtual TYPE2 eval() const { return ( *this )(); }
+    /// evaluate the function once per result, see Functor<TYPE,TYPE2>::batch
+    virtual void batch( LHCb::span<TYPE2> results ) const {
+      std::generate( results.begin(), results.end(), [this]() { return ( *this )(); } );
+    }
     /// clone method
     virtual Functor* clone() const = 0;
     /// virtual destructor
@@ -259,6 +282,8 @@ namespace LoKi {
     FunctorFromFunctor* clone() const override { return new FunctorFromFunctor( *this ); }
     /// MANDATORY: the only one essential method
     TYPE2 operator()() const override { return fun(); }
+    /// OPTIONAL: batch evaluation, delegate to the underlying object
+    void batch( LHCb::span<TYPE2> results ) const override { m_fun->batch( results ); }
     /// OPTIONAL: the basic printout method, delegate to the underlying object
     std::ostream& fillStream( std::ostream& s ) const override { return m_fun->fillStream( s ); };
     /// OPTIONAL: unique function ID, delegate to the underlying objects
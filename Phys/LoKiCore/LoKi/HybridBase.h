@@ -30,6 +30,7 @@
 #include "LoKi/CacheFactory.h"
 #include "LoKi/Context.h"
 #include "LoKi/FunctorCache.h"
+#include "LoKi/JITCache.h"
 // ============================================================================
 namespace LoKi {
   // ==========================================================================
@@ -115,6 +116,9 @@ namespace LoKi {
       /// write C++ code
       void writeCpp() const;
       // ======================================================================
+      /// compile the C++ code of the created functors into the JIT cache
+      void compileJIT();
+      // ======================================================================
     private:
       // ======================================================================
       // copy constructor is disabled
@@ -139,6 +143,8 @@ namespace LoKi {
       bool m_use_python; // use python as factory for LoKi-functors ?
       /// use LoKi functor cache
       bool m_use_cache; // use LoKi functor cache ?
+      /// use JIT-compiled functors
+      bool m_use_jit; // use JIT-compiled functors ?
       // ======================================================================
     protected: // some stuff to deal with generation of C++ code
       // ======================================================================
@@ -152,6 +158,17 @@ namespace LoKi {
       // information about the created functors
       typedef std::map<std::string, std::pair<std::string, std::string>> FUNCTIONS;
       std::map<std::string, FUNCTIONS>                                   m_allfuncs;
+      ///
+      // directory of the JIT cache
+      std::string m_jitdir; ///< directory of the JIT cache
+      // compiler for JIT
+      std::string m_jitcompiler; ///< compiler for JIT
+      // compiler flags for JIT
+      std::string m_jitflags; ///< compiler flags for JIT
+      // number of functors per JIT-compiled library
+      unsigned int m_jitsplit; ///< number of functors per JIT-compiled library
+      // the JIT cache
+      LoKi::Hybrid::JITCache m_jit; ///< the JIT cache
 
       mutable Gaudi::Accumulators::Counter<> m_pyInitCnt{this, "Python is initialized!"};
       // ======================================================================
@@ -194,9 +211,9 @@ inline StatusCode LoKi::Hybrid::Base::_get_( const std::string&
   // 2') look for cached functors:
   typedef LoKi::CacheFactory<LoKi::Functor<TYPE1, TYPE2>> cache_t;
   if ( !this->m_use_cache ) { local.reset( nullptr ); }
+  const auto hash = LoKi::Cache::makeHash( code );
   {
     const LoKi::Context cntx = this->make_context();
-    const auto          hash = LoKi::Cache::makeHash( code );
     local.reset( cache_t::Factory::create( cache_t::id( hash ), cntx ) );
   }
   //
@@ -207,6 +224,19 @@ inline StatusCode LoKi::Hybrid::Base::_get_( const std::string&
     return StatusCode::SUCCESS; // RETURN
   }
   //
+  // 2'') look for JIT-compiled functors: once loaded, they are in the plugin service as the cached ones
+  const std::string funtype = System::typeinfoName( typeid( LoKi::Functor<TYPE1, TYPE2> ) );
+  if ( this->m_use_jit && m_jit.load( m_jit.key( funtype, code ) ) ) {
+    const LoKi::Context cntx = this->make_context();
+    local.reset( cache_t::Factory::create( cache_t::id( hash ), cntx ) );
+    if ( local ) {
+      output = *local;
+      this->counter( "# loaded from JIT" ) += 1;
+      local.reset();
+      return StatusCode::SUCCESS; // RETURN
+    }
+  }
+  //
   if ( !this->m_use_python ) { return StatusCode::FAILURE; }
   //
   // 2") execute the code
@@ -223,8 +253,7 @@ inline StatusCode LoKi::Hybrid::Base::_get_( const std::string&
   //
   local.reset();
   //
-  if ( this->m_makeCpp ) {
-    const std::string funtype = System::typeinfoName( typeid( LoKi::Functor<TYPE1, TYPE2> ) );
+  if ( this->m_makeCpp || this->m_use_jit ) {
     const std::string cppcode = Gaudi::Utils::toCpp( output );
     const std::string pytype  = Gaudi::Utils::toString( output );
     m_allfuncs[funtype][code] = {cppcode, pytype};
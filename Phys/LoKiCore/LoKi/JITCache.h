@@ -0,0 +1,114 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+#ifndef LOKI_JITCACHE_H
+#define LOKI_JITCACHE_H 1
+// ============================================================================
+// Include files
+// ============================================================================
+// STD&STL
+// ============================================================================
+#include <future>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+// ============================================================================
+// GaudiKernel
+// ============================================================================
+#include "GaudiKernel/Kernel.h"
+// ============================================================================
+namespace LoKi {
+  // ==========================================================================
+  namespace Hybrid {
+    // ========================================================================
+    /** @class JITCache LoKi/JITCache.h
+     *
+     *  Persistent on-disk cache of the C++ functors of a hybrid tool, compiled
+     *  "just in time" rather than at build time as for the functor cache.
+     *
+     *  A functor is identified by a key, the MD5 digest of the platform, the
+     *  include path and the LoKi headers found in it, the compiler and its
+     *  flags, the functor type and the python code, i.e. of everything the
+     *  compiled functor depends on. The C++ code generated by
+     *  LoKi::Cache::makeCode is compiled with a local compiler in shared
+     *  libraries, which register the functors in the plugin service just like
+     *  the functor cache does. The index file of the tool maps each key to the
+     *  library holding it, so that the libraries of the next jobs are loaded,
+     *  in the background, as soon as the tool is initialized. The jobs sharing
+     *  a cache directory update its index under a lock.
+     *
+     *  The include path of the compiler is taken from ROOT_INCLUDE_PATH, as set
+     *  by the runtime environment of the application.
+     */
+    class GAUDI_API JITCache {
+    public:
+      // ======================================================================
+      /// C++ code of a library: the keys of its functors and the full source
+      typedef std::pair<std::vector<std::string>, std::string> Source;
+      // ======================================================================
+    public:
+      // ======================================================================
+      /** set up the cache
+       *  @param directory the cache directory, created if needed
+       *  @param index     the name of the index file of the tool
+       *  @param compiler  the compiler command
+       *  @param flags     the compiler flags
+       *  @return false if the cache directory cannot be created
+       */
+      bool setup( std::string directory, std::string index, std::string compiler, std::string flags );
+      // ======================================================================
+      /// the key of the functor of the given type made from the given python code
+      std::string key( const std::string& type, const std::string& pycode ) const;
+      // ======================================================================
+      /** read the index and start loading, in the background, the libraries
+       *  @return the number of functors in the index
+       */
+      std::size_t preload();
+      // ======================================================================
+      /** make the functor with the given key available to the plugin service
+       *  @return false if the functor is not in the cache
+       */
+      bool load( const std::string& key );
+      // ======================================================================
+      /** compile the given libraries, in parallel, and add them to the index
+       *  @param sources the C++ code of the libraries
+       *  @return the number of libraries which failed to compile
+       */
+      std::size_t compile( const std::vector<Source>& sources );
+      // ======================================================================
+      /// the cache directory
+      const std::string& directory() const { return m_directory; }
+      // ======================================================================
+    private:
+      // ======================================================================
+      /// read the index file
+      std::map<std::string, std::string> readIndex() const;
+      // ======================================================================
+    private:
+      // ======================================================================
+      std::string                                     m_directory; ///< cache directory
+      std::string                                     m_index;     ///< index file
+      std::string                                     m_compiler;  ///< compiler command
+      std::string                                     m_flags;     ///< compiler flags
+      std::string                                     m_includes;  ///< digest of the include path and LoKi headers
+      std::map<std::string, std::string>              m_libOfKey;  ///< library of each functor
+      std::map<std::string, std::shared_future<bool>> m_libs;      ///< libraries being loaded
+      // ======================================================================
+    };
+    // ========================================================================
+  } // namespace Hybrid
+  // ==========================================================================
+} //                                                      end of namespace LoKi
+// ============================================================================
+// The END
+// ============================================================================
+#endif // LOKI_JITCACHE_H
@@ -18,8 +18,10 @@
 // ============================================================================
 #include "GaudiKernel/SerializeSTL.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 // ============================================================================
 // LHCb
@@ -116,6 +118,93 @@ namespace LoKi {
 
     namespace details {
 
+      // =======================================================================
+      // helpers for the batch evaluation of the compositions
+      // =======================================================================
+      /** @class BatchBuffer
+       *  heap buffer for the results of a functor over a whole container
+       */
+      template <typename T>
+      class BatchBuffer final {
+      public:
+        explicit BatchBuffer( std::size_t n ) : m_size{n}, m_data{new T[n]} {}
+        LHCb::span<T> span() { return {m_data.get(), m_data.get() + m_size}; }
+        const T&      operator[]( std::size_t i ) const { return m_data[i]; }
+
+      private:
+        std::size_t          m_size;
+        std::unique_ptr<T[]> m_data;
+      };
+
+      /** number of arguments evaluated in one go by the compositions, such that the
+       *  intermediate results of their children stay on the stack and in the cache
+       */
+      inline constexpr std::size_t BatchChunk = 256;
+
+      /// call f( first, size ) for the consecutive chunks of a batch of n arguments
+      template <typename F>
+      void forEachChunk( const std::size_t n, F&& f ) {
+        for ( std::size_t first = 0; first < n; first += BatchChunk ) f( first, std::min( BatchChunk, n - first ) );
+      }
+
+      /// can the results of the children be buffered?
+      template <typename T>
+      inline constexpr bool batch_buffer_v = std::is_default_constructible_v<T> && !std::is_reference_v<T>;
+
+      /// does the unary trait provide the operation on the value, Traits_::op( value ) ?
+      template <typename Traits_, typename V, typename = void>
+      inline constexpr bool has_unary_value_op_v = false;
+      template <typename Traits_, typename V>
+      inline constexpr bool
+          has_unary_value_op_v<Traits_, V, std::void_t<decltype( Traits_::op( std::declval<const V&>() ) )>> = true;
+
+      /// does the binary trait provide the operation on the values, Traits_::op( value1, value2 ) ?
+      template <typename Traits_, typename V, typename = void>
+      inline constexpr bool has_binary_value_op_v = false;
+      template <typename Traits_, typename V>
+      using binary_value_op_t = decltype( Traits_::op( std::declval<const V&>(), std::declval<const V&>() ) );
+      template <typename Traits_, typename V>
+      inline constexpr bool has_binary_value_op_v<Traits_, V, std::void_t<binary_value_op_t<Traits_, V>>> = true;
+
+      /// does the binary trait only evaluate the second functor for some results of the first one (And, Or) ?
+      template <typename Traits_, typename = void>
+      inline constexpr bool has_short_circuit_v = false;
+      template <typename Traits_>
+      inline constexpr bool has_short_circuit_v<Traits_, std::void_t<decltype( Traits_::evaluateSecondIf )>> = true;
+
+      /** evaluate the predicate for the elements of the batch for which the result is
+       *  equal to the given value, and store it in place of this result, e.g. for the
+       *  second predicate of a logical AND
+       *  The predicate is evaluated for the selected arguments only, exactly as in
+       *  the short-circuit evaluation of each argument in turn.
+       */
+      template <typename F, typename... Args>
+      void batchWhere( const F& f, const bool value, LHCb::span<bool> results, LHCb::span<const Args>... args ) {
+        const std::size_t                   n = results.size();
+        std::array<std::size_t, BatchChunk> selected;
+        std::size_t                         nSelected = 0;
+        for ( std::size_t i = 0; i < n; ++i ) {
+          if ( results[i] == value ) selected[nSelected++] = i;
+        }
+        if ( nSelected == 0 ) return;
+        if ( nSelected == n ) return f.batch( args..., results );
+        if constexpr ( sizeof...( Args ) == 1 && ( ( std::is_trivially_copyable_v<Args> &&
+                                                      !std::is_same_v<Args, bool> ) && ... ) ) {
+          // gather the selected arguments, evaluate, and scatter back
+          ( [&]( LHCb::span<const Args> arg ) {
+            std::array<Args, BatchChunk> gathered;
+            std::array<bool, BatchChunk> gatheredResults;
+            for ( std::size_t k = 0; k < nSelected; ++k ) gathered[k] = arg[selected[k]];
+            f.batch( LHCb::span<const Args>{gathered.data(), gathered.data() + nSelected},
+                     LHCb::span<bool>{gatheredResults.data(), gatheredResults.data() + nSelected} );
+            for ( std::size_t k = 0; k < nSelected; ++k ) results[selected[k]] = gatheredResults[k];
+          }( args ),
+            ... );
+        } else {
+          for ( std::size_t k = 0; k < nSelected; ++k ) results[selected[k]] = f( args[selected[k]]... );
+        }
+      }
+
       // =======================================================================
       /** @class UnaryOp
        *  The helper function to implement Unary operation of one function
@@ -137,6 +226,19 @@ namespace LoKi {
         /// the only one essential method ("function") -- either withour argument
         Result operator()( Param_t<TYPE>... a ) const override { return Traits_::unaryOp( this->m_fun.func(), a... ); }
 
+        /// batch evaluation: evaluate the functor for a chunk of arguments, then the operation
+        void batch( LHCb::span<const TYPE>... a, LHCb::span<Result> r ) const override {
+          if constexpr ( has_unary_value_op_v<Traits_, TYPE2> && batch_buffer_v<TYPE2> ) {
+            forEachChunk( r.size(), [&]( std::size_t first, std::size_t size ) {
+              std::array<TYPE2, BatchChunk> v;
+              this->m_fun.func().batch( a.subspan( first, size )..., LHCb::span<TYPE2>{v.data(), v.data() + size} );
+              for ( std::size_t i = 0; i < size; ++i ) r[first + i] = Traits_::op( v[i] );
+            } );
+          } else {
+            Functor<Result( TYPE... )>::batch( a..., r );
+          }
+        }
+
         /// the basic printout method
         std::ostream& fillStream( std::ostream& s ) const override { return Traits_::fillStream( s, this->m_fun ); }
         // =====================================================================
@@ -153,6 +255,10 @@ namespace LoKi {
         static auto unaryOp( const F& f, const Args&... args ) -> decltype( auto ) {
           return Op{}( f( args... ) );
         }
+        template <typename V>
+        static auto op( const V& v ) -> decltype( auto ) {
+          return Op{}( v );
+        }
         template <typename F>
         static std::ostream& fillStream( std::ostream& os, const F& f ) {
           return os << " (" << Prefix::name() << f << ") ";
@@ -251,6 +357,26 @@ namespace LoKi {
           return Traits_::binaryOp( m_two.func1(), m_two.func2(), a... );
         }
 
+        /// batch evaluation: evaluate the first functor for a chunk of arguments, then the second one
+        void batch( LHCb::span<const TYPE>... a, LHCb::span<Result> r ) const override {
+          if constexpr ( has_short_circuit_v<Traits_> ) {
+            forEachChunk( r.size(), [&]( std::size_t first, std::size_t size ) {
+              const auto rc = r.subspan( first, size );
+              m_two.func1().batch( a.subspan( first, size )..., rc );
+              batchWhere( m_two.func2(), Traits_::evaluateSecondIf, rc, a.subspan( first, size )... );
+            } );
+          } else if constexpr ( has_binary_value_op_v<Traits_, TYPE2> && batch_buffer_v<TYPE2> ) {
+            forEachChunk( r.size(), [&]( std::size_t first, std::size_t size ) {
+              std::array<TYPE2, BatchChunk> v1, v2;
+              m_two.func1().batch( a.subspan( first, size )..., LHCb::span<TYPE2>{v1.data(), v1.data() + size} );
+              m_two.func2().batch( a.subspan( first, size )..., LHCb::span<TYPE2>{v2.data(), v2.data() + size} );
+              for ( std::size_t i = 0; i < size; ++i ) r[first + i] = Traits_::op( v1[i], v2[i] );
+            } );
+          } else {
+            Functor<Result( TYPE... )>::batch( a..., r );
+          }
+        }
+
         /// the basic printout method
         std::ostream& fillStream( std::ostream& s ) const override {
           return Traits_::fillStream( s, m_two.func1(), m_two.func2() );
@@ -269,6 +395,10 @@ namespace LoKi {
         static auto binaryOp( const F1& f1, const F2& f2, const Args&... args ) -> decltype( auto ) {
           return Op{}( f1( args... ), f2( args... ) );
         }
+        template <typename V1, typename V2>
+        static auto op( const V1& v1, const V2& v2 ) -> decltype( auto ) {
+          return Op{}( v1, v2 );
+        }
 
         template <typename F1, typename F2>
         static std::ostream& fillStream( std::ostream& os, const F1& f1, const F2& f2 ) {
@@ -307,6 +437,9 @@ namespace LoKi {
 
     namespace Traits {
       struct And {
+        /// the second predicate is only evaluated if the first one is true
+        static constexpr bool evaluateSecondIf = true;
+
         template <typename F1, typename F2, typename... Args>
         static bool binaryOp( const F1& f1, const F2& f2, const Args&... args ) {
           return f1( args... ) && f2( args... );
@@ -352,6 +485,9 @@ namespace LoKi {
 
     namespace Traits {
       struct Or {
+        /// the second predicate is only evaluated if the first one is false
+        static constexpr bool evaluateSecondIf = false;
+
         template <typename F1, typename F2, typename... Args>
         static bool binaryOp( const F1& f1, const F2& f2, const Args&... args ) {
           return f1( args... ) || f2( args... );
@@ -505,8 +641,12 @@ namespace LoKi {
       struct NotEqual {
         template <typename F1, typename F2, typename... Args>
         static bool binaryOp( const F1& f1, const F2& f2, const Args&... args ) {
-          LHCb::Math::Equal_To<TYPE2> op{};
-          return !op( f1( args... ), f2( args... ) );
+          return op( f1( args... ), f2( args... ) );
+        }
+        template <typename V1, typename V2>
+        static bool op( const V1& v1, const V2& v2 ) {
+          LHCb::Math::Equal_To<TYPE2> equal{};
+          return !equal( v1, v2 );
         }
         template <typename F1, typename F2>
         static std::ostream& fillStream( std::ostream& os, const F1& f1, const F2& f2 ) {
@@ -692,6 +832,10 @@ namespace LoKi {
         static auto binaryOp( const F1& f1, const F2& f2, const Args&... args ) {
           return std::min( f1( args... ), f2( args... ) );
         }
+        template <typename V>
+        static auto op( const V& v1, const V& v2 ) {
+          return std::min( v1, v2 );
+        }
 
         template <typename F1, typename F2>
         static std::ostream& fillStream( std::ostream& os, const F1& f1, const F2& f2 ) {
@@ -732,6 +876,10 @@ namespace LoKi {
         static auto binaryOp( const F1& f1, const F2& f2, const Args&... args ) {
           return std::max( f1( args... ), f2( args... ) );
         }
+        template <typename V>
+        static auto op( const V& v1, const V& v2 ) {
+          return std::max( v1, v2 );
+        }
 
         template <typename F1, typename F2>
         static std::ostream& fillStream( std::ostream& os, const F1& f1, const F2& f2 ) {
@@ -1195,6 +1343,21 @@ namespace LoKi {
           return Bind::Second_v<Traits_> ? Traits_::binaryOp( this->m_fun.fun( a... ), this->m_val )
                                          : Traits_::binaryOp( this->m_val, this->m_fun.fun( a... ) );
         }
+        /// OPTIONAL: batch evaluation, evaluate the functor for a chunk of arguments, then the operation
+        void batch( LHCb::span<const TYPE>... a, LHCb::span<Result> r ) const override {
+          if constexpr ( batch_buffer_v<TYPE2> ) {
+            forEachChunk( r.size(), [&]( std::size_t first, std::size_t size ) {
+              std::array<TYPE2, BatchChunk> v;
+              this->m_fun.func().batch( a.subspan( first, size )..., LHCb::span<TYPE2>{v.data(), v.data() + size} );
+              for ( std::size_t i = 0; i < size; ++i ) {
+                r[first + i] = Bind::Second_v<Traits_> ? Traits_::binaryOp( v[i], this->m_val )
+                                                       : Traits_::binaryOp( this->m_val, v[i] );
+              }
+            } );
+          } else {
+            Functor<Result( TYPE... )>::batch( a..., r );
+          }
+        }
         /// OPTIONAL: the specific printout
         std::ostream& fillStream( std::ostream& s ) const override {
           return Bind::Second_v<Traits_> ? ( s << " (" << this->m_fun << Traits_::infix() << this->m_val << ") " )
@@ -1845,6 +2008,10 @@ namespace LoKi {
         static double unaryOp( const F& f, const Args&... args ) {
           return LHCb::Math::round( f( args... ) );
         }
+        template <typename V>
+        static double op( const V& v ) {
+          return LHCb::Math::round( v );
+        }
         template <typename F>
         static std::ostream& fillStream( std::ostream& os, const F& f ) {
           return os << " round(" << f << ") ";
@@ -16,6 +16,10 @@
 #include <sstream>
 #include <string>
 // ============================================================================
+// LHCbMath
+// ============================================================================
+#include "LHCbMath/MD5.h"
+// ============================================================================
 // LoKi
 // ============================================================================
 #include "LoKi/CacheFactory.h"
@@ -24,28 +28,18 @@
 // ============================================================================
 #include "boost/format.hpp"
 // ============================================================================
-/* helper function to create the code for CacheFactory
- *  @param  type    the functor type
- *  @param  cppcode the actual C++ code
- *  @param  pycode  the python code (full)
- *  @param  pytype  the python type (from object)
- */
-// ============================================================================
-namespace {
-  const std::hash<std::string> s_hash{};
-}
-// ============================================================================
 /*  calculate the hash for the code flagment
+ *  It is made of the first 32 bits of the MD5 digest of the code, so that it
+ *  does not depend on the build (as std::hash may), since the functors
+ *  compiled at build time or by the JIT cache are looked up with it.
  *  @param code  the code
  *  @return hash-value
  *  @author Vanya BELYAEV Ivan.Belyaev@itep.ru
  *  @date 2015-01-17
- *  @todo replace with sha1
  */
 // ============================================================================
 unsigned int LoKi::Cache::makeHash( const std::string& code ) {
-  // @todo replace with sha1
-  return s_hash( code );
+  return std::stoul( Gaudi::Math::MD5::compute( code ).str().substr( 0, 8 ), nullptr, 16 );
 }
 // ============================================================================
 /*  helper function to create the code for CacheFactory
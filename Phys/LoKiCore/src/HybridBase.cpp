@@ -140,6 +140,24 @@ LoKi::Hybrid::Base::Base( const std::string& type, const std::string& name, cons
   declareProperty( "UseCache", m_use_cache = "UNKNOWN" == System::getEnv( "LOKI_DISABLE_CACHE" ),
                    "Use C++ cache for LoKi-functors " );
   //
+  // JIT-compiled functors, enabled by the definition of the cache directory
+  //
+  m_jitdir = System::getEnv( "LOKI_JIT_CACHE" );
+  declareProperty( "UseJIT", m_use_jit = "UNKNOWN" != m_jitdir, "Use JIT-compiled C++ code for LoKi-functors " );
+  if ( "UNKNOWN" == m_jitdir ) { m_jitdir = "LoKiJITCache"; }
+  declareProperty( "JITCacheDirectory", m_jitdir, "Directory of the cache of JIT-compiled LoKi-functors " );
+  //
+  m_jitcompiler = System::getEnv( "LOKI_JIT_COMPILER" );
+  if ( "UNKNOWN" == m_jitcompiler ) { m_jitcompiler = "c++"; }
+  declareProperty( "JITCompiler", m_jitcompiler, "Compiler for JIT-compiled LoKi-functors " );
+  //
+  m_jitflags = System::getEnv( "LOKI_JIT_FLAGS" );
+  if ( "UNKNOWN" == m_jitflags ) { m_jitflags = "-std=c++17 -O2 -fPIC -shared -w"; }
+  declareProperty( "JITFlags", m_jitflags, "Compiler flags for JIT-compiled LoKi-functors " );
+  //
+  declareProperty( "JITFunctorsPerLibrary", m_jitsplit = 50,
+                   "Number of functors per JIT-compiled library (compiled in parallel)" );
+  //
   // make reasonable default name
   //
   m_cppname = this->name();
@@ -163,9 +181,19 @@ StatusCode LoKi::Hybrid::Base::initialize() {
   // Messages
   if ( !m_use_python ) Print( "Python Functors are DISABLED", sc, MSG::ALWAYS ).ignore();
   if ( !m_use_cache ) Print( "C++ Cache Functors are DISABLED", sc, MSG::ALWAYS ).ignore();
+  // JIT: start loading the libraries of the previous jobs, in the background
+  if ( m_use_jit ) {
+    if ( m_jit.setup( m_jitdir, m_cppname + ".index", m_jitcompiler, m_jitflags ) ) {
+      const auto n = m_jit.preload();
+      if ( msgLevel( MSG::DEBUG ) ) { debug() << n << " functors in JIT cache " << m_jitdir << endmsg; }
+    } else {
+      Warning( "Cannot create JIT cache directory '" + m_jitdir + "', JIT Functors are DISABLED" ).ignore();
+      m_use_jit = false;
+    }
+  }
   // return
   // m_showCode = true ;
-  return ( m_use_python || m_use_cache ? sc : Error( "No Functors enabled" ) );
+  return ( m_use_python || m_use_cache || m_use_jit ? sc : Error( "No Functors enabled" ) );
 }
 // ============================================================================
 // finalization of the tool
@@ -202,6 +230,10 @@ StatusCode LoKi::Hybrid::Base::finalize() {
   //
   if ( m_makeCpp ) { writeCpp(); }
   //
+  // Compile C++ code for the next jobs
+  //
+  if ( m_use_jit ) { compileJIT(); }
+  //
   // finalize the base
   return GaudiTool::finalize();
 }
@@ -491,30 +523,13 @@ namespace {
   const std::vector<std::string> s_emptylines;
   const _ALLFUNCS                s_emptyfuncs;
   // ==========================================================================
-  std::unique_ptr<std::ostream> openFile( std::string namebase, const unsigned short findex,
-                                          const std::vector<std::string>& lines    = s_emptylines,
-                                          const _ALLFUNCS&                allfuncs = s_emptyfuncs ) {
-    //
-    // construct the file name
-    //  1) remove trailing .cpp
-    if ( boost::algorithm::ends_with( namebase, ".cpp" ) ) boost::algorithm::erase_tail( namebase, 4 );
-    //  2) replace blanks  by underscore
-    std::replace( namebase.begin(), namebase.end(), ' ', '_' );
-    //  3) construct the name
-    boost::format fname( "%s_%04d.cpp" );
-    fname % namebase % findex;
-    //
-    auto file = std::make_unique<std::ofstream>( fname.str() );
-    //
-    *file << "/** The file is generated on : " << System::hostName() << '\n'
-          << " *  at : " << Gaudi::Time::current().format( true ) << '\n'
-          << " *  by : " << System::accountName() << '\n'
-          << " */\n";
+  /// write the include directives needed by the functors
+  std::ostream& writeIncludes( std::ostream& file, const std::vector<std::string>& lines, const _ALLFUNCS& allfuncs ) {
     //
     // write the include directives
-    *file << "\n// Explicitly declared include files:\n";
-    for ( const auto& l : lines ) { *file << l << '\n'; }
-    *file << '\n';
+    file << "\n// Explicitly declared include files:\n";
+    for ( const auto& l : lines ) { file << l << '\n'; }
+    file << '\n';
     //
     std::set<std::string> morelines;
     for ( const auto& ifunc : allfuncs ) {
@@ -538,9 +553,34 @@ namespace {
       }
     }
     // additional include files
-    *file << "\n// Additional include files: " << '\n';
-    for ( const auto& l : morelines ) { *file << l << '\n'; }
-    *file << '\n';
+    file << "\n// Additional include files: " << '\n';
+    for ( const auto& l : morelines ) { file << l << '\n'; }
+    file << '\n';
+    //
+    return file;
+  }
+  // ==========================================================================
+  std::unique_ptr<std::ostream> openFile( std::string namebase, const unsigned short findex,
+                                          const std::vector<std::string>& lines    = s_emptylines,
+                                          const _ALLFUNCS&                allfuncs = s_emptyfuncs ) {
+    //
+    // construct the file name
+    //  1) remove trailing .cpp
+    if ( boost::algorithm::ends_with( namebase, ".cpp" ) ) boost::algorithm::erase_tail( namebase, 4 );
+    //  2) replace blanks  by underscore
+    std::replace( namebase.begin(), namebase.end(), ' ', '_' );
+    //  3) construct the name
+    boost::format fname( "%s_%04d.cpp" );
+    fname % namebase % findex;
+    //
+    auto file = std::make_unique<std::ofstream>( fname.str() );
+    //
+    *file << "/** The file is generated on : " << System::hostName() << '\n'
+          << " *  at : " << Gaudi::Time::current().format( true ) << '\n'
+          << " *  by : " << System::accountName() << '\n'
+          << " */\n";
+    //
+    writeIncludes( *file, lines, allfuncs );
     //
     return file;
   }
@@ -610,6 +650,37 @@ void LoKi::Hybrid::Base::writeCpp() const {
   //
 }
 // ============================================================================
+// compile the C++ code of the created functors into the JIT cache
+// ============================================================================
+void LoKi::Hybrid::Base::compileJIT() {
+  //
+  // the functors created by python, by groups of m_jitsplit functors per library
+  std::vector<LoKi::Hybrid::JITCache::Source> sources;
+  std::size_t                                 nFunctors = 0;
+  for ( const auto& ia : m_allfuncs ) {
+    const std::string& cpptype = ia.first;
+    for ( const auto& ic : ia.second ) {
+      if ( sources.empty() || sources.back().first.size() >= std::max( 1u, m_jitsplit ) ) {
+        sources.emplace_back();
+        std::ostringstream header;
+        writeIncludes( header, m_cpplines, m_allfuncs );
+        sources.back().second = header.str();
+      }
+      sources.back().first.push_back( m_jit.key( cpptype, ic.first ) );
+      sources.back().second += LoKi::Cache::makeCode( cpptype, ic.second.first, ic.first, ic.second.second );
+      ++nFunctors;
+    }
+  }
+  if ( sources.empty() ) { return; }
+  //
+  info() << "Compiling " << nFunctors << " functors in " << sources.size() << " libraries of JIT cache " << m_jitdir
+         << endmsg;
+  const auto nFailed = m_jit.compile( sources );
+  if ( 0 < nFailed ) {
+    Warning( std::to_string( nFailed ) + " JIT libraries failed to compile, see the logs in " + m_jitdir ).ignore();
+  }
+}
+// ============================================================================
 // build the universal context
 LoKi::Context LoKi::Hybrid::Base::make_context() const {
   const IAlgContextSvc* cntx = svc<IAlgContextSvc>( "AlgContextSvc", true );
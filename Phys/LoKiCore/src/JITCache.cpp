@@ -0,0 +1,253 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+// Include files
+// ============================================================================
+// STD&STL
+// ============================================================================
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+// ============================================================================
+// dlopen, flock
+// ============================================================================
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+// ============================================================================
+// GaudiKernel
+// ============================================================================
+#include "GaudiKernel/System.h"
+// ============================================================================
+// LHCbMath
+// ============================================================================
+#include "LHCbMath/MD5.h"
+// ============================================================================
+// LoKi
+// ============================================================================
+#include "LoKi/JITCache.h"
+// ============================================================================
+// Boost
+// ============================================================================
+#include "boost/algorithm/string/classification.hpp"
+#include "boost/algorithm/string/split.hpp"
+#include "boost/filesystem/operations.hpp"
+// ============================================================================
+/** @file
+ *  Implementation file for class LoKi::Hybrid::JITCache
+ */
+// ============================================================================
+namespace {
+  // ==========================================================================
+  /// environment variable, empty if not defined
+  std::string getEnv( const char* var ) {
+    const std::string value = System::getEnv( var );
+    return "UNKNOWN" == value ? std::string() : value;
+  }
+  // ==========================================================================
+  /// load the given library, keeping it loaded until the end of the job
+  bool loadLibrary( const std::string& path ) { return nullptr != dlopen( path.c_str(), RTLD_NOW | RTLD_GLOBAL ); }
+  // ==========================================================================
+  /// write the file atomically, i.e. through a temporary file which is renamed
+  bool writeFile( const std::string& path, const std::string& content ) {
+    const std::string tmp = path + ".tmp" + std::to_string( ::getpid() );
+    {
+      std::ofstream file( tmp );
+      if ( !( file << content ) ) { return false; }
+    }
+    return 0 == std::rename( tmp.c_str(), path.c_str() );
+  }
+  // ==========================================================================
+  /// quote the argument for the shell
+  std::string quote( const std::string& arg ) {
+    std::string quoted = "'";
+    for ( const char c : arg ) { quoted += '\'' == c ? std::string( "'\\''" ) : std::string( 1, c ); }
+    return quoted + '\'';
+  }
+  // ==========================================================================
+  /// exclusive lock on a file, held by other jobs updating the same index
+  class FileLock {
+  public:
+    explicit FileLock( const std::string& path ) : m_fd( ::open( path.c_str(), O_RDWR | O_CREAT, 0666 ) ) {
+      if ( m_fd >= 0 && 0 != ::flock( m_fd, LOCK_EX ) ) {
+        ::close( m_fd );
+        m_fd = -1;
+      }
+    }
+    ~FileLock() {
+      if ( m_fd >= 0 ) { ::close( m_fd ); } // releases the lock
+    }
+    FileLock( const FileLock& ) = delete;
+    FileLock& operator=( const FileLock& ) = delete;
+
+    explicit operator bool() const { return m_fd >= 0; }
+
+  private:
+    int m_fd;
+  };
+  // ==========================================================================
+  /** the include path, and the content of the LoKi headers found in it,
+   *  which the compiled functors depend on beyond their own code
+   */
+  std::string includeEnvironment() {
+    std::string              env = getEnv( "ROOT_INCLUDE_PATH" );
+    std::vector<std::string> dirs;
+    boost::algorithm::split( dirs, env, boost::is_any_of( ":" ) );
+    for ( const auto& dir : dirs ) {
+      boost::system::error_code ec;
+      const auto                loki = boost::filesystem::path( dir ) / "LoKi";
+      if ( dir.empty() || !boost::filesystem::is_directory( loki, ec ) ) { continue; }
+      std::vector<boost::filesystem::path> headers;
+      for ( boost::filesystem::directory_iterator i( loki, ec ), end; !ec && i != end; i.increment( ec ) ) {
+        if ( boost::filesystem::is_regular_file( i->path(), ec ) ) { headers.push_back( i->path() ); }
+      }
+      std::sort( headers.begin(), headers.end() );
+      for ( const auto& header : headers ) {
+        std::ifstream     file( header.string() );
+        std::stringstream content;
+        content << file.rdbuf();
+        ( ( env += '\0' ) += header.string() ) += Gaudi::Math::MD5::compute( content.str() ).str();
+      }
+    }
+    return Gaudi::Math::MD5::compute( env ).str();
+  }
+  // ==========================================================================
+} // namespace
+// ============================================================================
+// set up the cache
+// ============================================================================
+bool LoKi::Hybrid::JITCache::setup( std::string directory, std::string index, std::string compiler,
+                                    std::string flags ) {
+  m_directory = std::move( directory );
+  m_index     = m_directory + '/' + std::move( index );
+  m_compiler  = std::move( compiler );
+  m_flags     = std::move( flags );
+  m_includes  = includeEnvironment();
+  boost::system::error_code ec;
+  boost::filesystem::create_directories( m_directory, ec );
+  return boost::filesystem::is_directory( m_directory, ec );
+}
+// ============================================================================
+// the key of a functor
+// ============================================================================
+std::string LoKi::Hybrid::JITCache::key( const std::string& type, const std::string& pycode ) const {
+  std::string all = getEnv( "BINARY_TAG" );
+  for ( const auto* s : {&m_includes, &m_compiler, &m_flags, &type, &pycode} ) { ( all += '\0' ) += *s; }
+  return Gaudi::Math::MD5::compute( all ).str();
+}
+// ============================================================================
+// read the index file: one line per functor, with its key and its library
+// ============================================================================
+std::map<std::string, std::string> LoKi::Hybrid::JITCache::readIndex() const {
+  std::map<std::string, std::string> index;
+  std::ifstream                      file( m_index );
+  std::string                        key, lib;
+  while ( file >> key >> lib ) { index[key] = lib; }
+  return index;
+}
+// ============================================================================
+// read the index and start loading the libraries
+// ============================================================================
+std::size_t LoKi::Hybrid::JITCache::preload() {
+  m_libOfKey = readIndex();
+  for ( const auto& [key, lib] : m_libOfKey ) {
+    auto& loading = m_libs[lib];
+    if ( !loading.valid() ) {
+      loading = std::async( std::launch::async, loadLibrary, m_directory + '/' + lib ).share();
+    }
+  }
+  return m_libOfKey.size();
+}
+// ============================================================================
+// make the functor available to the plugin service
+// ============================================================================
+bool LoKi::Hybrid::JITCache::load( const std::string& key ) {
+  const auto ilib = m_libOfKey.find( key );
+  if ( m_libOfKey.end() == ilib ) { return false; }
+  auto& loading = m_libs[ilib->second];
+  if ( !loading.valid() ) {
+    loading = std::async( std::launch::deferred, loadLibrary, m_directory + '/' + ilib->second ).share();
+  }
+  return loading.get();
+}
+// ============================================================================
+// compile the libraries in parallel and add them to the index
+// ============================================================================
+std::size_t LoKi::Hybrid::JITCache::compile( const std::vector<Source>& sources ) {
+  //
+  // include path of the application
+  std::string includes;
+  {
+    std::vector<std::string> dirs;
+    const std::string        path = getEnv( "ROOT_INCLUDE_PATH" );
+    boost::algorithm::split( dirs, path, boost::is_any_of( ":" ) );
+    for ( const auto& dir : dirs ) {
+      if ( !dir.empty() ) { includes += " -I" + quote( dir ); }
+    }
+  }
+  //
+  // the libraries are named after their content and what it depends on, as the functors, so that
+  // concurrent jobs do not clash and the libraries built with other LoKi headers are not reused
+  std::vector<std::string> libs;
+  libs.reserve( sources.size() );
+  for ( const auto& source : sources ) { libs.push_back( key( "", source.second ) ); }
+  //
+  std::vector<char>        ok( sources.size(), false );
+  std::atomic<std::size_t> next{0};
+  auto                     worker = [&]() {
+    for ( auto i = next++; i < sources.size(); i = next++ ) {
+      const std::string base = m_directory + '/' + libs[i];
+      const std::string lib  = base + ".so";
+      if ( boost::filesystem::exists( lib ) ) {
+        ok[i] = true;
+        continue;
+      }
+      if ( !writeFile( base + ".cpp", sources[i].second ) ) { continue; }
+      // compile in a temporary file, renamed once complete
+      const std::string tmp = lib + ".tmp" + std::to_string( ::getpid() );
+      const std::string cmd = m_compiler + ' ' + m_flags + includes + " -o " + quote( tmp ) + ' ' +
+                              quote( base + ".cpp" ) + " > " + quote( base + ".log" ) + " 2>&1";
+      ok[i] = 0 == std::system( cmd.c_str() ) && 0 == std::rename( tmp.c_str(), lib.c_str() );
+    }
+  };
+  {
+    std::vector<std::thread> threads( std::min<std::size_t>( sources.size(),
+                                                             std::max( 1u, std::thread::hardware_concurrency() ) ) );
+    for ( auto& thread : threads ) { thread = std::thread( worker ); }
+    for ( auto& thread : threads ) { thread.join(); }
+  }
+  //
+  // update the index, keeping the entries written meanwhile by other jobs
+  const FileLock lock( m_index + ".lock" );
+  if ( !lock ) { return sources.size(); }
+  auto        index   = readIndex();
+  std::size_t nFailed = 0;
+  for ( std::size_t i = 0; i < sources.size(); ++i ) {
+    if ( !ok[i] ) {
+      ++nFailed;
+      continue;
+    }
+    for ( const auto& key : sources[i].first ) { index[key] = libs[i] + ".so"; }
+  }
+  std::ostringstream content;
+  for ( const auto& [key, lib] : index ) { content << key << ' ' << lib << '\n'; }
+  if ( !writeFile( m_index, content.str() ) ) { nFailed = sources.size(); }
+  //
+  return nFailed;
+}
+// ============================================================================
+// The END
+// ============================================================================
@@ -0,0 +1,144 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// ============================================================================
+// Include files
+// ============================================================================
+// STD & STL
+// ============================================================================
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+// ============================================================================
+// LoKi
+// ============================================================================
+#include "LoKi/Functor.h"
+#include "LoKi/Operators.h"
+// ============================================================================
+/** @file
+ *  Benchmark of the batch evaluation of composed LoKi functors,
+ *  LoKi::Functor::batch, against their evaluation for each argument in turn.
+ *
+ *  Typical cut strings are built with LoKi operators from simple functors of a toy
+ *  candidate (the leaves keep the default, element by element, batch evaluation,
+ *  as most LoKi functors do), and evaluated for 1k to 100k candidates. The results
+ *  and the number of calls of the leaves are checked to be the same, and the time
+ *  per candidate is reported for both methods.
+ *
+ *  usage: FunctorBatchBenchmark [nRepeat] [seed]
+ */
+// ============================================================================
+namespace {
+  // ==========================================================================
+  using Clock = std::chrono::steady_clock;
+  // ==========================================================================
+  /// toy candidate
+  struct Candidate {
+    double pt, p, chi2, ipchi2;
+  };
+  using Arg  = const Candidate*;
+  using Func = LoKi::Functor<Arg, double>;
+  using Cut  = LoKi::FunctorFromFunctor<Arg, bool>;
+  // ==========================================================================
+  /// number of calls of the leaves
+  unsigned long s_calls = 0;
+  // ==========================================================================
+  /// simple functor returning one member of the candidate
+  template <double Candidate::*Member>
+  class Var final : public Func {
+  public:
+    Var( std::string name ) : m_name( std::move( name ) ) {}
+    Var*          clone() const override { return new Var( *this ); }
+    double        operator()( Arg c ) const override {
+      ++s_calls;
+      return c->*Member;
+    }
+    std::ostream& fillStream( std::ostream& s ) const override { return s << m_name; }
+
+  private:
+    std::string m_name;
+  };
+  // ==========================================================================
+  const Var<&Candidate::pt>     PT{"PT"};
+  const Var<&Candidate::p>      P{"P"};
+  const Var<&Candidate::chi2>   CHI2{"CHI2"};
+  const Var<&Candidate::ipchi2> IPCHI2{"IPCHI2"};
+  // ==========================================================================
+} // namespace
+// ============================================================================
+int main( int argc, char* argv[] ) {
+  const unsigned nRepeat = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 20;
+  const unsigned seed    = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 42;
+  std::mt19937   rng( seed );
+
+  const std::vector<Cut> cuts = {
+      PT > 500,
+      PT > 500 && P > 3000 && CHI2 < 9,
+      PT > 500 && P > 3000 && CHI2 < 9 && ( IPCHI2 > 16 || PT > 2000 ),
+      PT * P > 5.e6 && !( CHI2 > 9 ) && ( IPCHI2 > 16 || PT > 2000 || P > 50000 )};
+
+  std::printf( "%-70s | %8s | %8s | %11s | %11s | %8s\n", "cut", "#cand", "#pass", "scalar (ns)", "batch (ns)",
+               "speed-up" );
+  for ( const auto& cut : cuts ) {
+    for ( const std::size_t n : {1000u, 10000u, 100000u} ) {
+      // candidates
+      std::exponential_distribution<double> pt( 1. / 800 ), p( 1. / 8000 ), chi2( 1. / 5 ), ipchi2( 1. / 20 );
+      std::vector<Candidate>                candidates( n );
+      for ( auto& c : candidates ) c = {pt( rng ), p( rng ), chi2( rng ), ipchi2( rng )};
+      std::vector<Arg> args;
+      args.reserve( n );
+      for ( const auto& c : candidates ) args.push_back( &c );
+
+      // each candidate in turn
+      std::vector<char> scalar( n );
+      s_calls    = 0;
+      auto start = Clock::now();
+      for ( unsigned k = 0; k < nRepeat; ++k ) {
+        for ( std::size_t i = 0; i < n; ++i ) scalar[i] = cut( args[i] );
+      }
+      const double tScalar = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / nRepeat / n;
+      const auto   nScalar = s_calls;
+
+      // batch
+      const auto batch = std::make_unique<bool[]>( n );
+      s_calls          = 0;
+      start            = Clock::now();
+      for ( unsigned k = 0; k < nRepeat; ++k ) cut.batch( args, {batch.get(), batch.get() + n} );
+      const double tBatch = std::chrono::duration<double, std::nano>( Clock::now() - start ).count() / nRepeat / n;
+
+      // check
+      std::size_t nPass = 0;
+      for ( std::size_t i = 0; i < n; ++i ) {
+        if ( bool( scalar[i] ) != batch[i] ) {
+          std::fprintf( stderr, "batch and scalar results differ for candidate %zu\n", i );
+          return 1;
+        }
+        nPass += batch[i];
+      }
+      if ( nScalar != s_calls ) {
+        std::fprintf( stderr, "batch and scalar evaluations call the leaves %lu and %lu times\n", s_calls, nScalar );
+        return 1;
+      }
+
+      std::string name = cut.printOut();
+      if ( name.size() > 70 ) name = name.substr( 0, 67 ) + "...";
+      std::printf( "%-70s | %8zu | %8zu | %11.2f | %11.2f | %8.2f\n", name.c_str(), n, nPass, tScalar, tBatch,
+                   tScalar / tBatch );
+    }
+  }
+  return 0;
+}
+// ============================================================================
+//                                                                      The END
+// ============================================================================
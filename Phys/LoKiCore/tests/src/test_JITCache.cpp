@@ -0,0 +1,119 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE utestJITCache
+#include <boost/test/unit_test.hpp>
+
+#include "LoKi/JITCache.h"
+
+#include "boost/filesystem.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace {
+  const std::string flags = "-std=c++17 -O2 -fPIC -shared -w";
+
+  /// temporary cache directory and include path, with a LoKi header
+  struct Environment {
+    Environment() : top{fs::temp_directory_path() / fs::unique_path( "loki-jit-%%%%-%%%%" )} {
+      fs::create_directories( top / "include" / "LoKi" );
+      setHeader( "#define LOKI_JIT_TEST 1\n" );
+      ::setenv( "ROOT_INCLUDE_PATH", ( top / "include" ).c_str(), 1 );
+    }
+    ~Environment() { fs::remove_all( top ); }
+
+    void setHeader( const std::string& content ) const {
+      std::ofstream( ( top / "include" / "LoKi" / "JITTest.h" ).string() ) << content;
+    }
+    std::string cache() const { return ( top / "cache" ).string(); }
+
+    /// the libraries of the index, by key
+    std::map<std::string, std::string> index() const {
+      std::map<std::string, std::string> libs;
+      std::ifstream                      file( cache() + "/tool.index" );
+      std::string                        key, lib;
+      while ( file >> key >> lib ) { libs[key] = lib; }
+      return libs;
+    }
+
+    fs::path top;
+  };
+
+  /// the source of a library defining the given function, returning LOKI_JIT_TEST times the given value
+  std::string source( const std::string& function, int value ) {
+    return "#include \"LoKi/JITTest.h\"\nextern \"C\" int " + function + "() { return LOKI_JIT_TEST * " +
+           std::to_string( value ) + "; }\n";
+  }
+
+  /// value returned by the given function of the given library (all the loaded ones by default), 0 if not found
+  int call( const std::string& function, void* library = RTLD_DEFAULT ) {
+    auto f = reinterpret_cast<int ( * )()>( ::dlsym( library, function.c_str() ) );
+    return f ? f() : 0;
+  }
+} // namespace
+
+BOOST_AUTO_TEST_CASE( test_miss_hit_and_invalidation ) {
+  const Environment env;
+  //
+  // first job: the functor is not in the cache and is compiled
+  std::string key;
+  {
+    LoKi::Hybrid::JITCache jit;
+    BOOST_REQUIRE( jit.setup( env.cache(), "tool.index", "c++", flags ) );
+    BOOST_CHECK_EQUAL( jit.preload(), 0u );
+    key = jit.key( "LoKi::Functor<void,bool>", "ALL" );
+    BOOST_CHECK( !jit.load( key ) );
+    BOOST_REQUIRE_EQUAL( jit.compile( {{{key}, source( "loki_jit_test_first", 1 )}} ), 0u );
+  }
+  //
+  // second job: the functor is found in the index and its library loaded
+  const auto pid = ::fork();
+  BOOST_REQUIRE( pid >= 0 );
+  if ( 0 == pid ) {
+    LoKi::Hybrid::JITCache jit;
+    const bool ok = jit.setup( env.cache(), "tool.index", "c++", flags ) && 1 == jit.preload() &&
+                    key == jit.key( "LoKi::Functor<void,bool>", "ALL" ) && jit.load( key ) &&
+                    1 == call( "loki_jit_test_first" );
+    ::_exit( ok ? 0 : 1 );
+  }
+  int status = 0;
+  BOOST_REQUIRE_EQUAL( ::waitpid( pid, &status, 0 ), pid );
+  BOOST_CHECK( WIFEXITED( status ) && 0 == WEXITSTATUS( status ) );
+  //
+  // a change of the LoKi headers changes the key, and the same code is compiled again, in another
+  // library, with the new headers
+  env.setHeader( "#define LOKI_JIT_TEST 2\n" );
+  std::string newKey;
+  {
+    LoKi::Hybrid::JITCache jit;
+    BOOST_REQUIRE( jit.setup( env.cache(), "tool.index", "c++", flags ) );
+    BOOST_CHECK_EQUAL( jit.preload(), 1u );
+    newKey = jit.key( "LoKi::Functor<void,bool>", "ALL" );
+    BOOST_CHECK_NE( newKey, key );
+    BOOST_CHECK( !jit.load( newKey ) );
+    BOOST_REQUIRE_EQUAL( jit.compile( {{{newKey}, source( "loki_jit_test_first", 1 )}} ), 0u );
+  }
+  const auto index = env.index();
+  BOOST_REQUIRE_EQUAL( index.size(), 2u );
+  BOOST_CHECK_NE( index.at( key ), index.at( newKey ) );
+  void* library = ::dlopen( ( env.cache() + '/' + index.at( newKey ) ).c_str(), RTLD_NOW | RTLD_LOCAL );
+  BOOST_REQUIRE( library );
+  BOOST_CHECK_EQUAL( call( "loki_jit_test_first", library ), 2 );
+}
@@ -0,0 +1,276 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+
+#pragma once
+
+// STL
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+// Rich Utils
+#include "RichFutureUtils/RichDecodedData.h"
+
+// RICH DAQ Kernel
+#include "RichDAQKernel/RichPDDataBank.h"
+
+namespace Rich::Future::DAQ {
+
+  /** @class L1MapFiller RichDecodedDataFillers.h
+   *
+   *  Fills an L1Map while decoding the L1 banks. Data blocks of the HPD banks come PD by PD,
+   *  their hits being decoded directly into the PDInfo of the current PD. The hits of the flat
+   *  list (MaPMT) banks come in any order, and are added to the entry of their PD, created the
+   *  first time it is seen.
+   */
+  class L1MapFiller final {
+
+  public:
+    /// The type of the filled data
+    using DataType = L1Map;
+
+  public:
+    /// Constructor from the data to fill
+    explicit L1MapFiller( L1Map& data ) : m_data( data ) {}
+
+    /// Access the filled data
+    L1Map& data() noexcept { return m_data; }
+
+    /// Reserve the top level size
+    void reserve( const std::size_t nBanks, const std::size_t /* nWords */ ) { m_data.reserve( nBanks ); }
+
+    /// Start a new L1 board
+    void newL1( const Level1HardwareID L1ID ) {
+      m_data.emplace_back( std::piecewise_construct, std::forward_as_tuple( L1ID ), std::forward_as_tuple() );
+      m_ingressMap = &m_data.back().second;
+      m_ingressMap->reserve( HPD::NumIngressPerL1 );
+      m_pdInfo = nullptr;
+    }
+
+    /// Done with the current L1 board
+    void endL1() noexcept {}
+
+    /// Start a new ingress in the current L1 board, with the given number of active inputs
+    void newIngress( const L1IngressHeader& header, const std::size_t nPDs ) {
+      m_ingressMap->emplace_back( std::piecewise_construct, std::forward_as_tuple( header.ingressID() ),
+                                  std::forward_as_tuple( header ) );
+      m_pdMap = &m_ingressMap->back().second.pdData();
+      m_pdMap->reserve( nPDs );
+    }
+
+    /// Start a new PD in the current ingress, from its data bank
+    void newPD( const HPD::Level1Input input, const Rich::DAQ::PDDataBank& bank ) {
+      if ( !bank.isExtended() ) {
+        m_pdMap->emplace_back( std::piecewise_construct, std::forward_as_tuple( input ),
+                               std::forward_as_tuple( LHCb::RichSmartID(), bank.primaryHeaderWord() ) );
+      } else {
+        m_pdMap->emplace_back( std::piecewise_construct, std::forward_as_tuple( input ),
+                               std::forward_as_tuple( LHCb::RichSmartID(), bank.primaryHeaderWord(),
+                                                      bank.extendedHeaderWords(), bank.footerWords() ) );
+      }
+      m_pdInfo = &m_pdMap->back().second;
+    }
+
+    /// Set the ID of the current PD
+    void setPdID( const LHCb::RichSmartID& id ) { m_pdInfo->setPdID( id ); }
+
+    /// The container to decode the hits of the current PD into
+    LHCb::RichSmartID::Vector& hits() noexcept { return m_pdInfo->smartIDs(); }
+
+    /// Done with the current PD
+    void endPD() noexcept {}
+
+    /// Add a hit of the current L1 board, from a flat list bank. Returns true if it is the first hit of its PD
+    bool addUnsortedHit( const HPD::Level1Input input, const LHCb::RichSmartID id ) {
+      bool       newPD = false;
+      const auto pdID  = id.pdID();
+      // Has PD changed ?
+      if ( !m_pdInfo || pdID != m_lastPDID ) {
+        // Do we have an entry for this Ingress ID ?
+        auto inIt = std::find_if( m_ingressMap->begin(), m_ingressMap->end(),
+                                  [&input]( const auto& i ) { return input.ingressID() == i.first; } );
+        if ( UNLIKELY( inIt == m_ingressMap->end() ) ) {
+          L1IngressHeader iHeader;
+          iHeader.setIngressID( input.ingressID() );
+          m_ingressMap->emplace_back( std::piecewise_construct, std::forward_as_tuple( input.ingressID() ),
+                                      std::forward_as_tuple( iHeader ) );
+          inIt = m_ingressMap->end() - 1;
+          // reserve size (guess as we don't know here...)
+          inIt->second.pdData().reserve( 32 );
+        }
+        // Does this PD have an entry ?
+        auto& pdMap = inIt->second.pdData();
+        auto  pdIt =
+            std::find_if( pdMap.begin(), pdMap.end(), [&input]( const auto& i ) { return input == i.first; } );
+        if ( UNLIKELY( pdIt == pdMap.end() ) ) {
+          pdMap.emplace_back( std::piecewise_construct, std::forward_as_tuple( input ), std::forward_as_tuple() );
+          pdIt = pdMap.end() - 1;
+          pdIt->second.setPdID( pdID );
+          // reserve size (guess) in hit vector
+          pdIt->second.smartIDs().reserve( 16 );
+          newPD = true;
+        }
+        // update the PD cache
+        m_pdInfo   = &pdIt->second;
+        m_lastPDID = pdID;
+      }
+      // add the hit to the list
+      m_pdInfo->smartIDs().emplace_back( id );
+      return newPD;
+    }
+
+  private:
+    L1Map&            m_data;                 ///< The data being filled
+    IngressMap*       m_ingressMap = nullptr; ///< The current L1 board
+    L1InToPDMap*      m_pdMap      = nullptr; ///< The current ingress
+    PDInfo*           m_pdInfo     = nullptr; ///< The current PD
+    LHCb::RichSmartID m_lastPDID;             ///< The ID of the current PD, for flat list banks
+  };
+
+  /** @class FlatDataFiller RichDecodedDataFillers.h
+   *
+   *  Fills a FlatDecodedData while decoding the L1 banks. Data blocks of the HPD banks come PD
+   *  by PD, their hits being decoded into a buffer reused for all PDs and appended to the flat
+   *  hit array once the PD is done with. The hits of the flat list (MaPMT) banks come in any
+   *  order : they are collected for the whole L1 board, then grouped by ingress and PD, in order
+   *  of first appearance as for L1Map, with a counting sort.
+   *  All buffers are kept for the whole event, and only grow when first used, so that events
+   *  with HPD banks only do not pay for the flat list ones.
+   */
+  class FlatDataFiller final {
+
+  public:
+    /// The type of the filled data
+    using DataType = FlatDecodedData;
+
+  public:
+    /// Constructor from the data to fill
+    explicit FlatDataFiller( FlatDecodedData& data ) : m_data( data ) {}
+
+    /// Access the filled data
+    FlatDecodedData& data() noexcept { return m_data; }
+
+    /** Reserve space for the given number of L1 banks and total data size (in 32 bit words).
+     *  Each hit takes at least one word in the flat list formats, and most of them much
+     *  less in the zero suppressed HPD formats, so the hit array may still have to grow.
+     *  The buffer of the flat list hits is only reserved when the first of them comes */
+    void reserve( const std::size_t nBanks, const std::size_t nWords ) {
+      m_data.reserve( nBanks * HPD::NumIngressPerL1, nBanks * HPD::MaxL1Inputs, nWords );
+      m_nWords = nWords;
+    }
+
+    /// Start a new L1 board
+    void newL1( const Level1HardwareID L1ID ) noexcept {
+      m_L1ID = L1ID;
+      m_unsortedPDs.clear();
+      m_unsortedHits.clear();
+      m_ingresses.clear();
+    }
+
+    /// Done with the current L1 board
+    void endL1() {
+      if ( m_unsortedHits.empty() ) return;
+      // offsets of the PDs in the grouped hits, ingress by ingress
+      Index offset = 0;
+      for ( const auto ingress : m_ingresses ) {
+        for ( auto& pd : m_unsortedPDs ) {
+          if ( pd.input.ingressID() != ingress ) continue;
+          pd.offset = offset;
+          offset += pd.nHits;
+        }
+      }
+      // group the hits (after which offsets point to the end of each PD)
+      m_hits.resize( offset );
+      for ( const auto& [id, pd] : m_unsortedHits ) { m_hits[m_unsortedPDs[pd].offset++] = id; }
+      // fill
+      for ( const auto ingress : m_ingresses ) {
+        L1IngressHeader iHeader;
+        iHeader.setIngressID( ingress );
+        m_data.addIngress( m_L1ID, iHeader );
+        for ( const auto& pd : m_unsortedPDs ) {
+          if ( pd.input.ingressID() != ingress ) continue;
+          m_data.addPD( pd.input );
+          m_data.setPdID( pd.pdID );
+          m_data.addHits( m_hits.begin() + ( pd.offset - pd.nHits ), m_hits.begin() + pd.offset );
+        }
+      }
+    }
+
+    /// Start a new ingress in the current L1 board
+    void newIngress( const L1IngressHeader& header, const std::size_t /* nPDs */ ) {
+      m_data.addIngress( m_L1ID, header );
+    }
+
+    /// Start a new PD in the current ingress, from its data bank
+    void newPD( const HPD::Level1Input input, const Rich::DAQ::PDDataBank& bank ) {
+      m_data.addPD( input, bank.primaryHeaderWord() );
+      m_hits.clear();
+    }
+
+    /// Set the ID of the current PD
+    void setPdID( const LHCb::RichSmartID& id ) noexcept { m_data.setPdID( id ); }
+
+    /// The container to decode the hits of the current PD into
+    LHCb::RichSmartID::Vector& hits() noexcept { return m_hits; }
+
+    /// Done with the current PD, append its hits
+    void endPD() { m_data.addHits( m_hits.begin(), m_hits.end() ); }
+
+    /// Add a hit of the current L1 board, from a flat list bank. Returns true if it is the first hit of its PD
+    bool addUnsortedHit( const HPD::Level1Input input, const LHCb::RichSmartID id ) {
+      bool newPD = false;
+      // Has PD changed ?
+      if ( m_unsortedPDs.empty() || id.pdID() != m_unsortedPDs[m_lastPD].pdID ) {
+        const auto pdIt = std::find_if( m_unsortedPDs.begin(), m_unsortedPDs.end(),
+                                        [&input]( const auto& pd ) { return input == pd.input; } );
+        if ( UNLIKELY( pdIt == m_unsortedPDs.end() ) ) {
+          if ( std::find( m_ingresses.begin(), m_ingresses.end(), input.ingressID() ) == m_ingresses.end() ) {
+            m_ingresses.push_back( input.ingressID() );
+          }
+          m_unsortedPDs.push_back( {input, id.pdID()} );
+          m_lastPD = m_unsortedPDs.size() - 1;
+          newPD    = true;
+        } else {
+          m_lastPD = pdIt - m_unsortedPDs.begin();
+        }
+      }
+      // one word per hit, so the total data size is enough for any bank
+      if ( UNLIKELY( m_unsortedHits.capacity() == 0 ) ) { m_unsortedHits.reserve( m_nWords ); }
+      m_unsortedHits.emplace_back( id, m_lastPD );
+      ++m_unsortedPDs[m_lastPD].nHits;
+      return newPD;
+    }
+
+  private:
+    using Index = FlatDecodedData::Index;
+
+    /// A PD of a flat list bank
+    struct UnsortedPD {
+      HPD::Level1Input  input;
+      LHCb::RichSmartID pdID;
+      Index             nHits{0};
+      Index             offset{0};
+    };
+
+    FlatDecodedData&          m_data; ///< The data being filled
+    Level1HardwareID          m_L1ID; ///< The current L1 board
+    LHCb::RichSmartID::Vector m_hits; ///< Buffer for the hits of the current PD
+
+    // flat list banks
+    std::vector<UnsortedPD>                          m_unsortedPDs;  ///< PDs of the current bank
+    std::vector<std::pair<LHCb::RichSmartID, Index>> m_unsortedHits; ///< Hits of the current bank, with their PD
+    std::vector<L1IngressID>                         m_ingresses;    ///< Ingresses of the current bank
+    Index                                            m_lastPD{0};    ///< The last PD seen in the current bank
+    std::size_t                                      m_nWords{0};    ///< Total data size of the event banks
+  };
+
+} // namespace Rich::Future::DAQ
@@ -40,11 +40,18 @@ RawBankDecoder::RawBankDecoder( const std::string& name, ISvcLocator* pSvcLocato
   // setProperty( "OutputLevel", MSG::VERBOSE );
 }
 
+FlatRawBankDecoder::FlatRawBankDecoder( const std::string& name, ISvcLocator* pSvcLocator )
+    : Transformer( name, pSvcLocator,
+                   {KeyValue{"RawEventLocation",
+                             concat_alternatives( {LHCb::RawEventLocation::Rich, LHCb::RawEventLocation::Default} )},
+                    KeyValue{"OdinLocation", LHCb::ODINLocation::Default}},
+                   {KeyValue{"DecodedDataLocation", FlatDecodedDataLocation::Default}} ) {}
+
 //=============================================================================
 
-StatusCode RawBankDecoder::initialize() {
+StatusCode RawBankDecoderBase::initialize() {
   // Initialise base class
-  const auto sc = Transformer::initialize();
+  const auto sc = AlgBase::initialize();
   if ( !sc ) return sc;
 
   // RichDet
@@ -88,15 +95,42 @@ StatusCode RawBankDecoder::initialize() {
 L1Map RawBankDecoder::operator()( const LHCb::RawEvent& rawEvent, //
                                   const LHCb::ODIN&     odin      //
                                   ) const {
-
   // Make the data map to return
-  L1Map decodedData;
+  L1Map       decodedData;
+  L1MapFiller filler( decodedData );
+  decode( rawEvent, odin, filler );
+  // return the fill map
+  return decodedData;
+}
+
+//=============================================================================
+
+FlatDecodedData FlatRawBankDecoder::operator()( const LHCb::RawEvent& rawEvent, //
+                                                const LHCb::ODIN&     odin      //
+                                                ) const {
+  // Make the data to return
+  FlatDecodedData decodedData;
+  FlatDataFiller  filler( decodedData );
+  decode( rawEvent, odin, filler );
+  return decodedData;
+}
+
+//=============================================================================
+
+template <typename FILLER>
+void RawBankDecoderBase::decode( const LHCb::RawEvent& rawEvent, //
+                                 const LHCb::ODIN&     odin,     //
+                                 FILLER&               decodedData ) const {
 
   // Get the banks for the Rich
   const auto& richBanks = rawEvent.banks( LHCb::RawBank::Rich );
 
-  // reserve top level size
-  decodedData.reserve( richBanks.size() );
+  // reserve sizes, from the number of banks and the total data size
+  std::size_t nWords = 0;
+  for ( const auto* bank : richBanks ) {
+    if ( bank ) { nWords += bank->size() / 4; }
+  }
+  decodedData.reserve( richBanks.size(), nWords );
 
   // Bank decoder cache
   PDBanks banks;
@@ -122,18 +156,16 @@ L1Map RawBankDecoder::operator()( const LHCb::RawEvent& rawEvent, //
 
   // do not print if faking HPDID, since smartIDs.size() then has no meaning
   if ( !m_useFakeHPDID ) { _ri_debug << "Decoded in total " << richBanks.size() << " RICH Level1 bank(s)" << endmsg; }
-
-  // return the fill map
-  return decodedData;
 }
 
 //=============================================================================
 
-void RawBankDecoder::decodeToSmartIDs( const LHCb::RawBank& bank,        //
-                                       const LHCb::ODIN&    odin,        //
-                                       L1Map&               decodedData, //
-                                       PDBanks&             banks        //
-                                       ) const {
+template <typename FILLER>
+void RawBankDecoderBase::decodeToSmartIDs( const LHCb::RawBank& bank,        //
+                                           const LHCb::ODIN&    odin,        //
+                                           FILLER&              decodedData, //
+                                           PDBanks&             banks        //
+                                           ) const {
 
   // Check magic code for general data corruption
   if ( UNLIKELY( LHCb::RawBank::MagicPattern != bank.magic() ) ) {
@@ -185,10 +217,10 @@ void RawBankDecoder::decodeToSmartIDs( const LHCb::RawBank& bank,        //
 
 //=============================================================================
 
-const Rich::DAQ::PDDataBank* RawBankDecoder::createDataBank( const LongType*   dataStart, //
-                                                             const BankVersion version,   //
-                                                             PDBanks&          banks      //
-                                                             ) const {
+const Rich::DAQ::PDDataBank* RawBankDecoderBase::createDataBank( const LongType*   dataStart, //
+                                                                 const BankVersion version,   //
+                                                                 PDBanks&          banks      //
+                                                                 ) const {
 
   Rich::DAQ::PDDataBank* dataBank = nullptr;
 
@@ -249,11 +281,12 @@ const Rich::DAQ::PDDataBank* RawBankDecoder::createDataBank( const LongType*   d
 
 //=============================================================================
 
-void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
-                                            const LHCb::ODIN&    odin,        //
-                                            L1Map&               decodedData, //
-                                            PDBanks&             banks        //
-                                            ) const {
+template <typename FILLER>
+void RawBankDecoderBase::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
+                                                const LHCb::ODIN&    odin,        //
+                                                FILLER&              decodedData, //
+                                                PDBanks&             banks        //
+                                                ) const {
 
   using namespace Rich::DAQ::HPD;
 
@@ -279,12 +312,8 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
   // If we have some words to process, start the decoding
   if ( bankSize > 0 ) {
 
-    // Get Ingress map to decode into for this L1 board
-    decodedData.emplace_back( std::piecewise_construct, std::forward_as_tuple( L1ID ), std::forward_as_tuple() );
-    auto& ingressMap = decodedData.back().second;
-
-    // reserve size
-    ingressMap.reserve( NumIngressPerL1 );
+    // Start the data for this L1 board
+    decodedData.newL1( L1ID );
 
     // Loop over bank, find headers and produce a data bank for each
     // Fill data into RichSmartIDs
@@ -295,14 +324,6 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
       const L1IngressHeader ingressWord( bank.data()[lineC++] );
       _ri_debug << " Ingress " << ingressWord << endmsg;
 
-      // Get data for this ingress
-      ingressMap.emplace_back( std::piecewise_construct, std::forward_as_tuple( ingressWord.ingressID() ),
-                               std::forward_as_tuple() );
-      auto& ingressInfo = ingressMap.back().second;
-
-      // Set ingress header in decoded data map
-      ingressInfo.setIngressHeader( ingressWord );
-
       // Compare Ingress header to the ODIN
       _ri_verbo << "ODIN : EventNumber=" << EventID( odin.eventNumber() ) << " BunchID=" << BXID( odin.bunchId() )
                 << endmsg;
@@ -316,13 +337,13 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
       ingressWord.activeHPDInputs( inputs );
       _ri_debug << "  Found " << inputs.size() << " PDs with data blocks : " << inputs << endmsg;
 
+      // Start the data for this ingress
+      decodedData.newIngress( ingressWord, ingressWord.hpdsSuppressed() ? 0 : inputs.size() );
+
       // Check the Ingress supression flag
       if ( !ingressWord.hpdsSuppressed() ) {
         // Ingress is OK, so read HPD data
 
-        // reserve size
-        ingressInfo.pdData().reserve( inputs.size() );
-
         // Loop over active HPDs
         for ( const auto& HPD : inputs ) {
 
@@ -336,18 +357,8 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
           // Is the PD in extended mode
           const bool isExtend = hpdBank->isExtended();
 
-          // Try to add a new HPDInfo to container
-          if ( !isExtend ) {
-            ingressInfo.pdData().emplace_back(
-                std::piecewise_construct, std::forward_as_tuple( ingressWord.ingressID(), HPD ),
-                std::forward_as_tuple( LHCb::RichSmartID(), hpdBank->primaryHeaderWord() ) );
-          } else {
-            ingressInfo.pdData().emplace_back(
-                std::piecewise_construct, std::forward_as_tuple( ingressWord.ingressID(), HPD ),
-                std::forward_as_tuple( LHCb::RichSmartID(), hpdBank->primaryHeaderWord(),
-                                       hpdBank->extendedHeaderWords(), hpdBank->footerWords() ) );
-          }
-          auto& hpdInfo = ingressInfo.pdData().back().second;
+          // Add a new PD to the decoded data
+          decodedData.newPD( Level1Input( ingressWord.ingressID(), HPD ), *hpdBank );
 
           // Only try and decode this HPD if ODIN test was OK
           if ( odinOK && !hpdIsSuppressed ) {
@@ -368,13 +379,13 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
               _ri_debug << "   Decoding HPD " << hpdID << endmsg;
 
               // save HPD ID
-              hpdInfo.setPdID( hpdID );
+              decodedData.setPdID( hpdID );
 
               // local hit count
               unsigned int hpdHitCount( 0 );
 
               // smartIDs
-              auto& newids = hpdInfo.smartIDs();
+              auto& newids = decodedData.hits();
 
               // Compare Event IDs for errors
               bool OK =
@@ -459,6 +470,9 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
 
           } // ODIN OK and not suppressed
 
+          // Done with this PD
+          decodedData.endPD();
+
           // Increment line number to next data block
           lineC += hpdBank->nTotalWords();
 
@@ -471,11 +485,13 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
 
     } // bank while loop
 
+    decodedData.endL1();
+
   } // data bank not empty
 
   // Add to the total number of decoded hits
-  decodedData.addToTotalHits( decodedHits );
-  decodedData.addToActivePDs( nHPDbanks );
+  decodedData.data().addToTotalHits( decodedHits );
+  decodedData.data().addToActivePDs( nHPDbanks );
 
   // debug printout
   _ri_debug << "Decoded " << boost::format( "%2i" ) % ( nHPDbanks[Rich::Rich1] + nHPDbanks[Rich::Rich2] );
@@ -485,7 +501,8 @@ void RawBankDecoder::decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
 
 //=============================================================================
 
-void RawBankDecoder::decodeToSmartIDs_MaPMT0( const LHCb::RawBank& bank, L1Map& decodedData ) const {
+template <typename FILLER>
+void RawBankDecoderBase::decodeToSmartIDs_MaPMT0( const LHCb::RawBank& bank, FILLER& decodedData ) const {
 
   using namespace Rich::DAQ::HPD; // to be changed...
 
@@ -502,16 +519,8 @@ void RawBankDecoder::decodeToSmartIDs_MaPMT0( const LHCb::RawBank& bank, L1Map&
   // If we have some words to process, start the decoding
   if ( bankSize > 0 ) {
 
-    // Get Ingress map to decode into for this L1 board
-    decodedData.emplace_back( std::piecewise_construct, std::forward_as_tuple( L1ID ), std::forward_as_tuple() );
-    auto& ingressMap = decodedData.back().second;
-
-    // reserve size
-    ingressMap.reserve( NumIngressPerL1 );
-
-    // cache the last PD info
-    PDInfo*           last_pdInfo = nullptr;
-    LHCb::RichSmartID last_pdID;
+    // Start the data for this L1 board
+    decodedData.newL1( L1ID );
 
     // Loop over bank, Fill data into RichSmartIDs
     int lineC( 0 );
@@ -530,119 +539,43 @@ void RawBankDecoder::decodeToSmartIDs_MaPMT0( const LHCb::RawBank& bank, L1Map&
       } else {
         _ri_debug << " -> " << id << endmsg;
 
-        // Get the L1 input from the DB
-        const auto l1Input = m_richSys->level1InputNum( id );
-
-        // The ingress info to fill
-        IngressInfo* ingressInfo = nullptr;
-
-        // Do we have an entry for this Ingress ID ?
-        const auto inIt = std::find_if( ingressMap.begin(), ingressMap.end(),
-                                        [&l1Input]( const auto& i ) { return l1Input.ingressID() == i.first; } );
-        if ( UNLIKELY( inIt == ingressMap.end() ) ) {
-          ingressMap.emplace_back( std::piecewise_construct, std::forward_as_tuple( l1Input.ingressID() ),
-                                   std::forward_as_tuple() );
-          ingressInfo = &( ingressMap.back().second );
-          L1IngressHeader iHeader;
-          iHeader.setIngressID( l1Input.ingressID() );
-          ingressInfo->setIngressHeader( iHeader );
-          // reserve size (guess as we don't know here...)
-          ingressInfo->pdData().reserve( 32 );
-        } else {
-          // use existing entry
-          ingressInfo = &( inIt->second );
-        }
-
-        // the PD data map
-        auto& pdMap = ingressInfo->pdData();
-
-        // The PD info object to fill
-        PDInfo* pdInfo = nullptr;
-
-        // The PD ID
-        const auto pdID = id.pdID();
-
         // The RICH
         const auto rich = id.rich();
 
-        // Has PD changed ?
-        if ( pdID != last_pdID || !last_pdInfo ) {
-
-          // Does this PD have an entry ?
-          const auto pdIt =
-              std::find_if( pdMap.begin(), pdMap.end(), [&l1Input]( const auto& i ) { return l1Input == i.first; } );
-          if ( UNLIKELY( pdIt == pdMap.end() ) ) {
-            // make a new entry
-            pdMap.emplace_back( std::piecewise_construct, std::forward_as_tuple( l1Input ), std::forward_as_tuple() );
-            pdInfo = &( pdMap.back().second );
-            // Set the PD ID
-            pdInfo->setPdID( pdID );
-            // set the header
-            // PDInfo::Header header;
-            // CRJ - Comment out until decide what to do about maPMT Level0 IDs ...
-            //           const Level0ID l0id = m_richSys->level0ID(id);
-            //           if ( ! header.setL0ID( l0id ) )
-            //           {
-            //             std::ostringstream mess;
-            //             mess << "Failed to set L0ID " << l0id;
-            //             Warning( mess.str() ).ignore();
-            //           }
-            // pdInfo->setHeader( header );
-            // reserve size (guess) in hit vector
-            pdInfo->smartIDs().reserve( 16 );
-            // Add to active PD count for current rich
-            decodedData.addToActivePDs( rich );
-          } else {
-            // use found entry
-            pdInfo = &( pdIt->second );
-          }
-
-          // update the PD cache
-          last_pdID   = pdID;
-          last_pdInfo = pdInfo;
-        } else {
-          // use last PD cache
-          pdInfo = last_pdInfo;
+        // add the hit to its PD, from the L1 input in the DB
+        // CRJ - No PD header until decide what to do about maPMT Level0 IDs ...
+        if ( decodedData.addUnsortedHit( m_richSys->level1InputNum( id ), id ) ) {
+          // Add to active PD count for current rich
+          decodedData.data().addToActivePDs( rich );
         }
 
-        // add the hit to the list
-        pdInfo->smartIDs().emplace_back( id );
-
         // count the hits
         ++decodedHits[rich];
       }
     }
 
+    decodedData.endL1();
+
   } // bank not empty
 
   // Add to the total number of decoded hits
-  decodedData.addToTotalHits( decodedHits );
+  decodedData.data().addToTotalHits( decodedHits );
 }
 
 //=============================================================================
 
-void RawBankDecoder::suppressHotPixels( const LHCb::RichSmartID&   hpdID, //
-                                        LHCb::RichSmartID::Vector& newids ) const {
+void RawBankDecoderBase::suppressHotPixels( const LHCb::RichSmartID&   hpdID, //
+                                            LHCb::RichSmartID::Vector& newids ) const {
 
   // clean out hot pixels enabled at all ?
   if ( m_pixelsToSuppress ) {
     // Does this HPD have some pixels to suppress
     const auto iHPDSup = m_hotPixels.find( hpdID );
     if ( iHPDSup != m_hotPixels.end() ) {
-      // temporary copy of original hit channels
-      const auto oldids = newids;
-
-      // clear hits before suppression
-      newids.clear();
-
-      // loop over original hits and save only those not supressed
-      for ( const auto& ID : oldids ) {
-        if ( iHPDSup->second.find( ID ) == iHPDSup->second.end() ) {
-          // not suppressed, so keep
-          newids.push_back( ID );
-        }
-      } // loop over pixels
-
+      // remove the suppressed hits, in place, keeping the order of the others
+      newids.erase( std::remove_if( newids.begin(), newids.end(),
+                                    [&iHPDSup]( const auto& ID ) { return iHPDSup->second.count( ID ) > 0; } ),
+                    newids.end() );
     } // this HPD has pixels to suppress
 
   } // hot pixel suppression enabled
@@ -650,7 +583,7 @@ void RawBankDecoder::suppressHotPixels( const LHCb::RichSmartID&   hpdID, //
 
 //=============================================================================
 
-void RawBankDecoder::dumpRawBank( const LHCb::RawBank& bank, MsgStream& os ) const {
+void RawBankDecoderBase::dumpRawBank( const LHCb::RawBank& bank, MsgStream& os ) const {
 
   // Get bank version and ID
   const Level1HardwareID L1ID( bank.sourceID() );
@@ -690,7 +623,8 @@ void RawBankDecoder::dumpRawBank( const LHCb::RawBank& bank, MsgStream& os ) con
 
 //=============================================================================
 
-// Declaration of the Algorithm Factory
+// Declaration of the Algorithm Factories
 DECLARE_COMPONENT( RawBankDecoder )
+DECLARE_COMPONENT( FlatRawBankDecoder )
 
 //=============================================================================
@@ -12,6 +12,7 @@
 #pragma once
 
 // STD
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <set>
@@ -29,6 +30,7 @@
 #include "GaudiAlg/Transformer.h"
 
 // Rich Utils
+#include "RichDecodedDataFillers.h"
 #include "RichFutureUtils/RichDecodedData.h"
 #include "RichUtils/RichHashMap.h"
 #include "RichUtils/RichMap.h"
@@ -55,29 +57,31 @@ namespace Rich::Future {
   // Use the functional framework
   using namespace Gaudi::Functional;
 
-  /** @class RawBankDecoder RichRawBankDecoder.h
+  /** @class RawBankDecoderBase RichRawBankDecoder.h
    *
-   *  RICH Raw bank decoder.
+   *  RICH Raw bank decoding, common to the decoders producing the different
+   *  types of decoded data (L1Map and FlatDecodedData).
    *
    *  @author Chris Jones
    *  @date   2016-09-21
    */
-  class RawBankDecoder final : public Transformer<Rich::Future::DAQ::L1Map( const LHCb::RawEvent&, //
-                                                                            const LHCb::ODIN& ),
-                                                  // Note using GaudiAlgorithm here as Gaudi::Algorithm lacks 'getDet'
-                                                  // Need to eventually fix this
-                                                  Traits::BaseClass_t<AlgBase<GaudiAlgorithm>>> {
+  // Note using GaudiAlgorithm here as Gaudi::Algorithm lacks 'getDet'
+  // Need to eventually fix this
+  class RawBankDecoderBase : public AlgBase<GaudiAlgorithm> {
 
   public:
     /// Standard constructor
-    RawBankDecoder( const std::string& name, ISvcLocator* pSvcLocator );
+    using AlgBase<GaudiAlgorithm>::AlgBase;
 
     /// Initialize
     StatusCode initialize() override;
 
-    /// Algorithm execution via transform
-    Rich::Future::DAQ::L1Map operator()( const LHCb::RawEvent& rawEvent, //
-                                         const LHCb::ODIN&     odin ) const override;
+  protected:
+    /// Decode all the RICH banks of the given event, using the given filler (see RichDecodedDataFillers.h)
+    template <typename FILLER>
+    void decode( const LHCb::RawEvent& rawEvent, //
+                 const LHCb::ODIN&     odin,     //
+                 FILLER&               data ) const;
 
   private:
     /// Returns the RawBank version enum for the given bank
@@ -115,22 +119,25 @@ namespace Rich::Future {
 
   private:
     /// Decode a RawBank into RichSmartID identifiers
-    void decodeToSmartIDs( const LHCb::RawBank&      bank,        //
-                           const LHCb::ODIN&         odin,        //
-                           Rich::Future::DAQ::L1Map& decodedData, //
-                           PDBanks&                  banks ) const;
+    template <typename FILLER>
+    void decodeToSmartIDs( const LHCb::RawBank& bank,        //
+                           const LHCb::ODIN&    odin,        //
+                           FILLER&              decodedData, //
+                           PDBanks&             banks ) const;
 
     /// Decode a RawBank into RichSmartID identifiers
     /// Version compatible with first 2007 "final" L1 firmware
-    void decodeToSmartIDs_2007( const LHCb::RawBank&      bank,        //
-                                const LHCb::ODIN&         odin,        //
-                                Rich::Future::DAQ::L1Map& decodedData, //
-                                PDBanks&                  banks ) const;
+    template <typename FILLER>
+    void decodeToSmartIDs_2007( const LHCb::RawBank& bank,        //
+                                const LHCb::ODIN&    odin,        //
+                                FILLER&              decodedData, //
+                                PDBanks&             banks ) const;
 
     /// Decode a RawBank into RichSmartID identifiers
     /// MaPMT0 version
-    void decodeToSmartIDs_MaPMT0( const LHCb::RawBank&      bank, //
-                                  Rich::Future::DAQ::L1Map& decodedData ) const;
+    template <typename FILLER>
+    void decodeToSmartIDs_MaPMT0( const LHCb::RawBank& bank, //
+                                  FILLER&              decodedData ) const;
 
     /// Check if a given L1 ID should be decoded
     inline bool okToDecode( const Rich::DAQ::Level1HardwareID L1ID ) const {
@@ -287,4 +294,43 @@ namespace Rich::Future {
     mutable ErrorCounter m_pmtSLFlagMismatch{this, "Small/Large PD flag mis-match"};
   };
 
+  /** @class RawBankDecoder RichRawBankDecoder.h
+   *
+   *  RICH Raw bank decoder, producing an L1Map.
+   *
+   *  @author Chris Jones
+   *  @date   2016-09-21
+   */
+  class RawBankDecoder final : public Transformer<Rich::Future::DAQ::L1Map( const LHCb::RawEvent&, //
+                                                                            const LHCb::ODIN& ),
+                                                  Traits::BaseClass_t<RawBankDecoderBase>> {
+
+  public:
+    /// Standard constructor
+    RawBankDecoder( const std::string& name, ISvcLocator* pSvcLocator );
+
+    /// Algorithm execution via transform
+    Rich::Future::DAQ::L1Map operator()( const LHCb::RawEvent& rawEvent, //
+                                         const LHCb::ODIN&     odin ) const override;
+  };
+
+  /** @class FlatRawBankDecoder RichRawBankDecoder.h
+   *
+   *  RICH Raw bank decoder, producing a FlatDecodedData : the same data as RawBankDecoder,
+   *  in a few contiguous arrays filled without per PD allocations.
+   */
+  class FlatRawBankDecoder final
+      : public Transformer<Rich::Future::DAQ::FlatDecodedData( const LHCb::RawEvent&, //
+                                                               const LHCb::ODIN& ),
+                           Traits::BaseClass_t<RawBankDecoderBase>> {
+
+  public:
+    /// Standard constructor
+    FlatRawBankDecoder( const std::string& name, ISvcLocator* pSvcLocator );
+
+    /// Algorithm execution via transform
+    Rich::Future::DAQ::FlatDecodedData operator()( const LHCb::RawEvent& rawEvent, //
+                                                   const LHCb::ODIN&     odin ) const override;
+  };
+
 } // namespace Rich::Future
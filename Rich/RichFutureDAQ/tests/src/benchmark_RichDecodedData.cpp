@@ -0,0 +1,245 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Benchmark of the RICH decoded data containers : L1Map versus FlatDecodedData.
+// The RICH banks of the events of the given MDF file are decoded repeatedly into each container,
+// through the same fillers as used by Rich::Future::RawBankDecoder and FlatRawBankDecoder.
+// The decoding time and the number of heap allocations per event are reported, and the decoded
+// hits of both containers are checked to be the same.
+//
+// Only the HPD banks (LHCb5 and FlatList versions) are decoded, with a fake PD ID as with the
+// UseFakeHPDID option of the decoders, so that no detector description is needed. The data
+// integrity checks and hot pixel suppression, identical for both containers, are not run.
+// The flat list (MaPMT) decoding of both fillers is checked by test_RichDecodedDataFillers.
+//
+// usage: benchmark_RichDecodedData <file.mdf> [maxEvents] [nRepeat]
+#include "RichDecodedDataFillers.h"
+
+#include "RichDAQKernel/RichDAQVersions.h"
+
+#include "Event/RawBank.h"
+#include "MDF/MDFHeader.h"
+#include "MDF/RawEventHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using namespace Rich::Future::DAQ;
+
+  /// number of calls to operator new
+  std::size_t s_nAllocations = 0;
+
+  /// reads the payload of up to maxEvents events from the given file
+  std::vector<std::vector<char>> readEvents( std::string const& fileName, std::size_t maxEvents ) {
+    std::vector<std::vector<char>> events;
+    std::ifstream                  input( fileName, std::ios::binary );
+    std::vector<char>              record;
+    while ( events.size() < maxEvents ) {
+      LHCb::MDFHeader header;
+      if ( !input.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ) break;
+      record.resize( header.recordSize() );
+      std::memcpy( record.data(), &header, sizeof( header ) );
+      if ( !input.read( record.data() + sizeof( header ), header.recordSize() - sizeof( header ) ) ) break;
+      auto const* h        = reinterpret_cast<LHCb::MDFHeader const*>( record.data() );
+      auto const  compress = h->compression() & 0xF;
+      if ( compress == 0 ) {
+        events.emplace_back( h->data(), h->data() + h->size() );
+        continue;
+      }
+      std::vector<char> event( std::size_t{64} * h->size() );
+      std::size_t       len = 0;
+      if ( !LHCb::decompressBuffer( compress, event.data(), event.size(), h->data(), h->size(), len ).isSuccess() ) {
+        std::fprintf( stderr, "unable to decompress event %zu, skipping it\n", events.size() );
+        continue;
+      }
+      event.resize( len );
+      events.push_back( std::move( event ) );
+    }
+    return events;
+  }
+
+  /// the RICH HPD banks of an event
+  std::vector<const LHCb::RawBank*> richBanks( std::vector<char> const& event ) {
+    std::vector<const LHCb::RawBank*> banks;
+    for ( const char *p = event.data(), *end = p + event.size(); p < end; ) {
+      auto const* bank = reinterpret_cast<const LHCb::RawBank*>( p );
+      if ( bank->magic() != LHCb::RawBank::MagicPattern ) break;
+      const auto version = static_cast<Rich::DAQ::BankVersion>( bank->version() );
+      if ( bank->type() == LHCb::RawBank::Rich && ( version == Rich::DAQ::LHCb5 || version == Rich::DAQ::FlatList ) ) {
+        banks.push_back( bank );
+      }
+      p += bank->totalSize();
+    }
+    return banks;
+  }
+
+  /// the PD data bank decoders, as cached by the decoder algorithms
+  struct PDBanks {
+    Rich::DAQ::RichDAQ_LHCb5::ZeroSuppLHCb     lhcb_ZS;
+    Rich::DAQ::RichDAQ_LHCb5::NonZeroSuppLHCb  lhcb_nonZS;
+    Rich::DAQ::RichDAQ_LHCb5::ZeroSuppAlice    alice_ZS;
+    Rich::DAQ::RichDAQ_LHCb5::NonZeroSuppAlice alice_nonZS;
+    Rich::DAQ::RichDAQ_FlatList::Data          flatList;
+
+    Rich::DAQ::PDDataBank& get( const Rich::DAQ::LongType* data, const Rich::DAQ::BankVersion version ) {
+      using Header = Rich::DAQ::RichDAQ_LHCb5::Header;
+      Rich::DAQ::PDDataBank* bank = &flatList;
+      if ( version == Rich::DAQ::LHCb5 ) {
+        if ( Header::zeroSuppressed( data ) ) {
+          bank = Header::aliceMode( data ) ? static_cast<Rich::DAQ::PDDataBank*>( &alice_ZS ) : &lhcb_ZS;
+        } else {
+          bank = Header::aliceMode( data ) ? static_cast<Rich::DAQ::PDDataBank*>( &alice_nonZS ) : &lhcb_nonZS;
+        }
+      }
+      bank->reset( data );
+      return *bank;
+    }
+  };
+
+  /// decode the given banks, as RawBankDecoderBase::decodeToSmartIDs_2007 does
+  template <typename FILLER>
+  void decode( std::vector<const LHCb::RawBank*> const& banks, FILLER& filler, PDBanks& pdBanks ) {
+    static const LHCb::RichSmartID s_fakeHPDID( Rich::Rich1, Rich::top, 0, 0 );
+    std::size_t                    nWords = 0;
+    for ( const auto* bank : banks ) { nWords += bank->size() / 4; }
+    filler.reserve( banks.size(), nWords );
+    Rich::DAQ::L1IngressInputs inputs;
+    for ( const auto* bank : banks ) {
+      const auto version  = static_cast<Rich::DAQ::BankVersion>( bank->version() );
+      const int  bankSize = bank->size() / 4;
+      if ( bankSize == 0 ) continue;
+      filler.newL1( Rich::DAQ::Level1HardwareID( bank->sourceID() ) );
+      int lineC = 0;
+      while ( lineC < bankSize ) {
+        const Rich::DAQ::L1IngressHeader ingressWord( bank->data()[lineC++] );
+        ingressWord.activeHPDInputs( inputs );
+        filler.newIngress( ingressWord, ingressWord.hpdsSuppressed() ? 0 : inputs.size() );
+        if ( !ingressWord.hpdsSuppressed() ) {
+          for ( const auto& input : inputs ) {
+            if ( lineC >= bankSize ) break;
+            auto& pdBank = pdBanks.get( &bank->data()[lineC], version );
+            filler.newPD( Rich::DAQ::HPD::Level1Input( ingressWord.ingressID(), input ), pdBank );
+            if ( !pdBank.suppressed() ) {
+              filler.setPdID( s_fakeHPDID );
+              pdBank.fillRichSmartIDs( filler.hits(), s_fakeHPDID );
+            }
+            filler.endPD();
+            lineC += pdBank.nTotalWords();
+          }
+        }
+        inputs.clear();
+      }
+      filler.endL1();
+    }
+  }
+
+  /// all the hits of an L1Map, in order
+  std::vector<LHCb::RichSmartID> allHits( L1Map const& data ) {
+    std::vector<LHCb::RichSmartID> hits;
+    for ( const auto& l1 : data ) {
+      for ( const auto& ingress : l1.second ) {
+        for ( const auto& pd : ingress.second.pdData() ) {
+          hits.insert( hits.end(), pd.second.smartIDs().begin(), pd.second.smartIDs().end() );
+        }
+      }
+    }
+    return hits;
+  }
+
+  struct Result {
+    double      seconds     = 0;
+    std::size_t allocations = 0;
+  };
+
+  /// decode all events nRepeat times into the given container type
+  template <typename FILLER>
+  Result run( std::vector<std::vector<const LHCb::RawBank*>> const& events, unsigned nRepeat ) {
+    PDBanks    pdBanks;
+    Result     result;
+    const auto allocations = s_nAllocations;
+    const auto start       = Clock::now();
+    for ( unsigned i = 0; i < nRepeat; ++i ) {
+      for ( auto const& banks : events ) {
+        typename FILLER::DataType data;
+        FILLER                    filler( data );
+        decode( banks, filler, pdBanks );
+      }
+    }
+    result.seconds     = std::chrono::duration<double>( Clock::now() - start ).count();
+    result.allocations = s_nAllocations - allocations;
+    return result;
+  }
+} // namespace
+
+// count the heap allocations
+void* operator new( std::size_t size ) {
+  ++s_nAllocations;
+  if ( void* p = std::malloc( size ? size : 1 ) ) return p;
+  throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+
+int main( int argc, char* argv[] ) {
+  if ( argc < 2 ) {
+    std::fprintf( stderr, "usage: %s <file.mdf> [maxEvents] [nRepeat]\n", argv[0] );
+    return 1;
+  }
+  std::size_t const maxEvents = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 10000;
+  unsigned const    nRepeat   = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 10;
+
+  auto const                                     events = readEvents( argv[1], maxEvents );
+  std::vector<std::vector<const LHCb::RawBank*>> banks;
+  std::size_t                                    nBanks = 0;
+  for ( auto const& event : events ) {
+    banks.push_back( richBanks( event ) );
+    nBanks += banks.back().size();
+  }
+  if ( nBanks == 0 ) {
+    std::fprintf( stderr, "no RICH HPD banks found in %s\n", argv[1] );
+    return 1;
+  }
+
+  // check that both containers hold the same hits
+  PDBanks pdBanks;
+  for ( std::size_t i = 0; i < banks.size(); ++i ) {
+    L1Map           l1Map;
+    FlatDecodedData flat;
+    L1MapFiller     l1MapFiller( l1Map );
+    FlatDataFiller  flatFiller( flat );
+    decode( banks[i], l1MapFiller, pdBanks );
+    decode( banks[i], flatFiller, pdBanks );
+    const auto hits = allHits( l1Map );
+    if ( !std::equal( hits.begin(), hits.end(), flat.smartIDs().begin(), flat.smartIDs().end() ) ) {
+      std::fprintf( stderr, "event %zu : decoded hits differ between L1Map and FlatDecodedData\n", i );
+      return 1;
+    }
+  }
+
+  std::printf( "%zu events, %.1f RICH HPD banks per event, %u repetitions\n", events.size(),
+               double( nBanks ) / events.size(), nRepeat );
+  std::printf( "%-16s | %14s | %18s\n", "Container", "us / event", "allocations / event" );
+  const double nDecoded = double( events.size() ) * nRepeat;
+  for ( const auto& [name, result] : {std::pair{"L1Map", run<L1MapFiller>( banks, nRepeat )},
+                                      std::pair{"FlatDecodedData", run<FlatDataFiller>( banks, nRepeat )}} ) {
+    std::printf( "%-16s | %14.2f | %18.1f\n", name, 1e6 * result.seconds / nDecoded, result.allocations / nDecoded );
+  }
+  return 0;
+}
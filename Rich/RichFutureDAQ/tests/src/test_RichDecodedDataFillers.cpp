@@ -0,0 +1,170 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_RichDecodedDataFillers
+#include <boost/test/unit_test.hpp>
+
+#include "RichDecodedDataFillers.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Rich::Future::DAQ;
+
+namespace {
+
+  /// a PD with its hits, as found in the decoded data
+  struct PD {
+    Level1HardwareID               L1ID;
+    L1IngressID                    ingress;
+    HPD::Level1Input               input;
+    LHCb::RichSmartID              pdID;
+    std::vector<LHCb::RichSmartID> hits;
+
+    bool operator==( const PD& other ) const {
+      return L1ID == other.L1ID && ingress == other.ingress && input == other.input && pdID == other.pdID &&
+             hits == other.hits;
+    }
+  };
+
+  std::ostream& operator<<( std::ostream& os, const PD& pd ) {
+    return os << "{L1 " << pd.L1ID << " ingress " << pd.ingress << " input " << pd.input << " " << pd.pdID << " "
+              << pd.hits.size() << " hits}";
+  }
+
+  /// a flat list (MaPMT) bank : the hits of an L1 board, in any order, with the L1 input of their PD
+  struct Bank {
+    Level1HardwareID                                            L1ID;
+    std::vector<std::pair<HPD::Level1Input, LHCb::RichSmartID>> hits;
+  };
+
+  /// random banks, the hits of the PDs of several ingresses being interleaved
+  std::vector<Bank> makeBanks( const std::vector<int>& nHits ) {
+    std::mt19937                       rng( 42 );
+    std::uniform_int_distribution<int> pixel( 0, 7 );
+    std::vector<Bank>                  banks;
+    for ( std::size_t b = 0; b < nHits.size(); ++b ) {
+      Bank bank{Level1HardwareID( 10 + b ), {}};
+      // a few more PDs in each bank, spread over three ingresses, the PD number giving the L1 input
+      std::uniform_int_distribution<int> pd( 0, 3 * HPD::NumL1InputsPerIngress - 1 );
+      for ( int i = 0; i < nHits[b]; ++i ) {
+        const int         n     = pd( rng ) % ( 5 + 3 * b );
+        const auto        input = HPD::Level1Input( L1IngressID( ( n + b ) % 3 ), L1InputWithinIngress( n / 3 ) );
+        const auto        panel = b % 2 ? Rich::bottom : Rich::top;
+        LHCb::RichSmartID id( Rich::Rich1, panel, n, b, pixel( rng ), pixel( rng ), LHCb::RichSmartID::MaPMTID );
+        bank.hits.emplace_back( input, id );
+      }
+      banks.push_back( std::move( bank ) );
+    }
+    return banks;
+  }
+
+  /// decode the given banks as RawBankDecoderBase::decodeToSmartIDs_MaPMT0 does
+  template <typename FILLER>
+  void decode( const std::vector<Bank>& banks, FILLER& filler ) {
+    std::size_t nWords = 0;
+    for ( const auto& bank : banks ) { nWords += bank.hits.size(); }
+    filler.reserve( banks.size(), nWords );
+    for ( const auto& bank : banks ) {
+      if ( bank.hits.empty() ) continue;
+      filler.newL1( bank.L1ID );
+      for ( const auto& [input, id] : bank.hits ) { filler.addUnsortedHit( input, id ); }
+      filler.endL1();
+    }
+  }
+
+  /// the expected PDs : ingresses and PDs in order of first appearance in each bank, hits in bank order
+  std::vector<PD> expected( const std::vector<Bank>& banks ) {
+    std::vector<PD> pds;
+    for ( const auto& bank : banks ) {
+      std::vector<L1IngressID> ingresses;
+      for ( const auto& hit : bank.hits ) {
+        const auto ingress = hit.first.ingressID();
+        if ( std::find( ingresses.begin(), ingresses.end(), ingress ) == ingresses.end() ) {
+          ingresses.push_back( ingress );
+        }
+      }
+      for ( const auto ingress : ingresses ) {
+        const auto first = pds.size();
+        for ( const auto& [input, id] : bank.hits ) {
+          if ( input.ingressID() != ingress ) continue;
+          auto pd = std::find_if( pds.begin() + first, pds.end(), [&]( const auto& p ) { return p.input == input; } );
+          if ( pd == pds.end() ) {
+            pds.push_back( {bank.L1ID, ingress, input, id.pdID(), {}} );
+            pd = pds.end() - 1;
+          }
+          pd->hits.push_back( id );
+        }
+      }
+    }
+    return pds;
+  }
+
+  std::vector<PD> pds( const L1Map& data ) {
+    std::vector<PD> pds;
+    for ( const auto& [L1ID, ingresses] : data ) {
+      for ( const auto& [ingress, info] : ingresses ) {
+        for ( const auto& [input, pd] : info.pdData() ) {
+          pds.push_back( {L1ID, ingress, input, pd.pdID(), pd.smartIDs()} );
+        }
+      }
+    }
+    return pds;
+  }
+
+  std::vector<PD> pds( const FlatDecodedData& data ) {
+    std::vector<PD> pds;
+    for ( FlatDecodedData::Index i = 0; i < data.nIngresses(); ++i ) {
+      for ( auto pd = data.ingressPDOffsets()[i]; pd < data.ingressPDOffsets()[i + 1]; ++pd ) {
+        BOOST_CHECK_EQUAL( data.pdIngress()[pd], i );
+        const auto hits = data.smartIDs( pd );
+        pds.push_back( {data.ingressL1IDs()[i], data.ingressHeaders()[i].ingressID(), data.pdL1Inputs()[pd],
+                        data.pdIDs()[pd], {hits.begin(), hits.end()}} );
+      }
+    }
+    return pds;
+  }
+
+  void check( const std::vector<Bank>& banks ) {
+    L1Map           l1Map;
+    FlatDecodedData flat;
+    L1MapFiller     l1MapFiller( l1Map );
+    FlatDataFiller  flatFiller( flat );
+    decode( banks, l1MapFiller );
+    decode( banks, flatFiller );
+
+    const auto ref       = expected( banks );
+    const auto fromL1Map = pds( l1Map );
+    const auto fromFlat  = pds( flat );
+    BOOST_CHECK_EQUAL_COLLECTIONS( fromL1Map.begin(), fromL1Map.end(), ref.begin(), ref.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( fromFlat.begin(), fromFlat.end(), ref.begin(), ref.end() );
+    BOOST_CHECK_EQUAL( flat.nPDs(), ref.size() );
+    BOOST_CHECK_EQUAL( flat.pdHitOffsets().back(), flat.smartIDs().size() );
+  }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( flat_list_banks ) {
+  // the buffers of the flat filler are reused from bank to bank, whether they have more or fewer hits
+  check( makeBanks( {500, 7, 0, 1, 120, 3000, 40} ) );
+}
+
+BOOST_AUTO_TEST_CASE( single_pd ) {
+  std::vector<Bank> banks{{Level1HardwareID( 1 ), {}}};
+  const auto        input = HPD::Level1Input( L1IngressID( 2 ), L1InputWithinIngress( 5 ) );
+  for ( int i = 0; i < 8; ++i ) {
+    banks[0].hits.emplace_back( input, LHCb::RichSmartID( Rich::Rich2, Rich::left, 3, 4, i, 7 - i,
+                                                          LHCb::RichSmartID::MaPMTID ) );
+  }
+  check( banks );
+  check( {} );
+}
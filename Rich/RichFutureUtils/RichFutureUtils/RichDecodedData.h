@@ -22,9 +22,13 @@
 #pragma once
 
 // STL
+#include <cstdint>
 #include <utility>
 #include <vector>
 
+// Kernel
+#include "Kernel/STLExtensions.h"
+
 // local
 #include "RichUtils/RichDAQDefinitions.h"
 #include "RichUtils/RichDAQHeaderPD_V4.h"
@@ -188,4 +192,141 @@ namespace Rich::Future::DAQ {
     inline const std::string Default = "Raw/Rich/L1Data/RICH1RICH2";
   } // namespace L1MapLocation
 
+  /** @class FlatDecodedData RichFutureUtils/RichDecodedData.h
+   *
+   *  Flat alternative to L1Map, holding the same decoded data in a few contiguous arrays :
+   *
+   *  - the hits of all PDs, as a single RichSmartID array
+   *  - per PD arrays (ID, L1 input, primary header word, ingress index) and the offsets of their hits
+   *  - per ingress arrays (header, L1 board ID) and the offsets of their PDs
+   *
+   *  Ingresses and PDs are stored in the same order as in L1Map, so that loops over L1 boards,
+   *  ingresses and PDs become plain index loops, and the hits of all PDs can be processed in
+   *  a single pass. Only the primary PD header words are kept (no extended header or footer words).
+   */
+  class FlatDecodedData final {
+
+  public:
+    /// Type for indices into the arrays
+    using Index = std::uint32_t;
+    /// The PD primary header word type
+    using PDHeaderWord = PDInfo::Header::WordType;
+
+  public:
+    /// Reserve space for the given numbers of ingresses, PDs and hits
+    void reserve( const std::size_t nIngresses, const std::size_t nPDs, const std::size_t nHits ) {
+      m_ingressHeaders.reserve( nIngresses );
+      m_ingressL1IDs.reserve( nIngresses );
+      m_ingressPDOffsets.reserve( nIngresses + 1 );
+      m_pdIDs.reserve( nPDs );
+      m_pdL1Inputs.reserve( nPDs );
+      m_pdHeaders.reserve( nPDs );
+      m_pdIngress.reserve( nPDs );
+      m_pdHitOffsets.reserve( nPDs + 1 );
+      m_smartIDs.reserve( nHits );
+    }
+
+  public: // filling, in decoding order
+    /// Start a new ingress for the given L1 board
+    void addIngress( const Level1HardwareID L1ID, const L1IngressHeader& header ) {
+      m_ingressHeaders.push_back( header );
+      m_ingressL1IDs.push_back( L1ID );
+      m_ingressPDOffsets.push_back( m_ingressPDOffsets.back() );
+    }
+    /// Start a new PD, with an invalid ID and no hits, in the last ingress
+    void addPD( const HPD::Level1Input input, const PDHeaderWord header = PDHeaderWord( 0 ) ) {
+      m_pdIDs.emplace_back();
+      m_pdL1Inputs.push_back( input );
+      m_pdHeaders.push_back( header );
+      m_pdIngress.push_back( nIngresses() - 1 );
+      m_pdHitOffsets.push_back( m_pdHitOffsets.back() );
+      ++m_ingressPDOffsets.back();
+    }
+    /// Set the ID of the last PD
+    void setPdID( const LHCb::RichSmartID& id ) noexcept { m_pdIDs.back() = id; }
+    /// Append hits to the last PD
+    template <typename ITER>
+    void addHits( ITER begin, ITER end ) {
+      m_smartIDs.insert( m_smartIDs.end(), begin, end );
+      m_pdHitOffsets.back() = m_smartIDs.size();
+    }
+
+  public: // sizes
+    /// Number of ingresses
+    [[nodiscard]] Index nIngresses() const noexcept { return m_ingressHeaders.size(); }
+    /// Number of PDs (including those without hits)
+    [[nodiscard]] Index nPDs() const noexcept { return m_pdIDs.size(); }
+
+  public: // hits
+    /// All the decoded hits, PD after PD
+    [[nodiscard]] LHCb::span<const LHCb::RichSmartID> smartIDs() const noexcept { return m_smartIDs; }
+    /// The hits of the given PD
+    [[nodiscard]] LHCb::span<const LHCb::RichSmartID> smartIDs( const Index pd ) const noexcept {
+      return {m_smartIDs.data() + m_pdHitOffsets[pd], m_pdHitOffsets[pd + 1] - m_pdHitOffsets[pd]};
+    }
+    /// Offsets of the hits of each PD in smartIDs(), of size nPDs() + 1
+    [[nodiscard]] LHCb::span<const Index> pdHitOffsets() const noexcept { return m_pdHitOffsets; }
+
+  public: // per PD data
+    /// The PD IDs. As for PDInfo, invalid if the PD was not decoded
+    [[nodiscard]] LHCb::span<const LHCb::RichSmartID> pdIDs() const noexcept { return m_pdIDs; }
+    /// The PD L1 inputs
+    [[nodiscard]] LHCb::span<const HPD::Level1Input> pdL1Inputs() const noexcept { return m_pdL1Inputs; }
+    /// The PD primary header words
+    [[nodiscard]] LHCb::span<const PDHeaderWord> pdHeaders() const noexcept { return m_pdHeaders; }
+    /// The index of the ingress of each PD
+    [[nodiscard]] LHCb::span<const Index> pdIngress() const noexcept { return m_pdIngress; }
+
+  public: // per ingress data
+    /// The ingress headers
+    [[nodiscard]] LHCb::span<const L1IngressHeader> ingressHeaders() const noexcept { return m_ingressHeaders; }
+    /// The L1 board ID of each ingress
+    [[nodiscard]] LHCb::span<const Level1HardwareID> ingressL1IDs() const noexcept { return m_ingressL1IDs; }
+    /// Offsets of the PDs of each ingress in the per PD arrays, of size nIngresses() + 1
+    [[nodiscard]] LHCb::span<const Index> ingressPDOffsets() const noexcept { return m_ingressPDOffsets; }
+
+  public: // summary counts, as for L1Map
+    /// Returns the total number of RICH hits in the decoded data
+    [[nodiscard]] unsigned int nTotalHits() const noexcept {
+      return m_nTotalHits[Rich::Rich1] + m_nTotalHits[Rich::Rich2];
+    }
+    /// Returns the total number of hits in the decoded data for the given RICH detector
+    [[nodiscard]] unsigned int nTotalHits( const Rich::DetectorType rich ) const noexcept { return m_nTotalHits[rich]; }
+    /// Append to the number of hits for each RICH
+    void addToTotalHits( const DetectorArray<unsigned int>& nHits ) {
+      for ( const auto rich : Rich::detectors() ) { m_nTotalHits[rich] += nHits[rich]; }
+    }
+    /// Returns the total number of active PDs in the decoded data
+    [[nodiscard]] unsigned int nActivePDs() const noexcept {
+      return m_nActivePDs[Rich::Rich1] + m_nActivePDs[Rich::Rich2];
+    }
+    /// Returns the total number of active PDs in the decoded data for the given RICH
+    [[nodiscard]] unsigned int nActivePDs( const Rich::DetectorType rich ) const noexcept { return m_nActivePDs[rich]; }
+    /// Append to the number of active PDs for each RICH
+    void addToActivePDs( const DetectorArray<unsigned int>& nPDs ) {
+      for ( const auto rich : Rich::detectors() ) { m_nActivePDs[rich] += nPDs[rich]; }
+    }
+    /// Append to the number of active PDs for the given RICH detector
+    void addToActivePDs( const Rich::DetectorType rich, const unsigned int nPDs = 1 ) { m_nActivePDs[rich] += nPDs; }
+
+  private:
+    std::vector<LHCb::RichSmartID> m_smartIDs;              ///< The hits of all PDs
+    std::vector<LHCb::RichSmartID> m_pdIDs;                 ///< The ID of each PD
+    std::vector<HPD::Level1Input>  m_pdL1Inputs;            ///< The L1 input of each PD
+    std::vector<PDHeaderWord>      m_pdHeaders;             ///< The primary header word of each PD
+    std::vector<Index>             m_pdIngress;             ///< The ingress of each PD
+    std::vector<Index>             m_pdHitOffsets{0};       ///< The offsets of the hits of each PD
+    std::vector<L1IngressHeader>   m_ingressHeaders;        ///< The header of each ingress
+    std::vector<Level1HardwareID>  m_ingressL1IDs;          ///< The L1 board of each ingress
+    std::vector<Index>             m_ingressPDOffsets{0};   ///< The offsets of the PDs of each ingress
+    DetectorArray<unsigned int>    m_nTotalHits = {{0, 0}}; ///< The total hit count for each RICH detector
+    DetectorArray<unsigned int>    m_nActivePDs = {{0, 0}}; ///< The total active PD count for each RICH detector
+  };
+
+  /// FlatDecodedData data locations
+  namespace FlatDecodedDataLocation {
+    /// Default Location in TES for the flat decoded data
+    inline const std::string Default = "Raw/Rich/L1Data/RICH1RICH2Flat";
+  } // namespace FlatDecodedDataLocation
+
 } // namespace Rich::Future::DAQ
@@ -10,7 +10,10 @@
 ###############################################################################
 
 
-def configureFileStager(keep=False, tmpdir=None, garbageCommand='garbage.exe'):
+def configureFileStager(keep=False,
+                        tmpdir=None,
+                        garbageCommand='garbage.exe',
+                        streams=1):
     import os
     if os.name != 'posix': return
 
@@ -42,6 +45,7 @@ def configureFileStager(keep=False, tmpdir=None, garbageCommand='garbage.exe'):
     svc.KeepFiles = keep
     svc.GarbageCollectorCommand = garbageCommand
     svc.CheckForLocalGarbageCollector = True
+    svc.Streams = streams
 
     # Configure other services to use the correct ones
     RawDataCnvSvc('RawDataCnvSvc').DataManager = mgr.getFullName()
@@ -18,6 +18,8 @@
 #endif
 
 // stdlib
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
@@ -70,6 +72,36 @@ namespace {
   using std::stringstream;
   using std::vector;
   using namespace boost;
+
+  /// copy the given range of bytes of a local file in place into the (existing) destination
+  bool copyChunk( const string& source, const string& destination, uintmax_t offset, uintmax_t length ) {
+    const int in = ::open( source.c_str(), O_RDONLY );
+    if ( in < 0 ) return false;
+    const int out = ::open( destination.c_str(), O_WRONLY );
+    if ( out < 0 ) {
+      ::close( in );
+      return false;
+    }
+    vector<char> buffer( 1 << 20 );
+    bool         ok = true;
+    while ( ok && length > 0 ) {
+      const ssize_t n = ::pread( in, buffer.data(), std::min<uintmax_t>( length, buffer.size() ), offset );
+      if ( n <= 0 ) {
+        ok = ( n < 0 && errno == EINTR );
+        continue;
+      }
+      for ( ssize_t written = 0; ok && written < n; ) {
+        const ssize_t w = ::pwrite( out, buffer.data() + written, n - written, offset + written );
+        if ( w < 0 && errno != EINTR ) ok = false;
+        if ( w > 0 ) written += w;
+      }
+      offset += n;
+      length -= n;
+    }
+    ok = ( ::close( out ) == 0 ) && ok;
+    ::close( in );
+    return ok;
+  }
 } // namespace
 
 extern char** environ;
@@ -180,11 +212,26 @@ StatusCode FileStagerSvc::getLocal( const string& filename, string& local ) {
     lock_guard         fileLock( m_fileMutex );
     filesByOriginal_t& originals = m_files.get<originalTag>();
     openIt                       = originals.find( filename );
-    openFile                     = openIt->file();
     if ( openIt == originals.end() ) {
       debug() << filename << " is not listed to be staged." << endmsg;
       return StatusCode::FAILURE;
-    } else if ( openFile->good() && openFile->staged() ) {
+    }
+    openFile = openIt->file();
+    if ( m_streams > 1 ) {
+      // the job moved to the next file: update the average time it uses a file
+      lock_guard<mutex> lock( m_stagingMutex );
+      if ( m_requested != openFile ) {
+        const auto now = pt::microsec_clock::universal_time();
+        if ( m_requested ) {
+          const double time = ( now - m_requestTime ).total_microseconds() * 1e-6;
+          m_useTime         = ( m_useTime > 0 ) ? 0.7 * m_useTime + 0.3 * time : time;
+        }
+        m_requested   = openFile;
+        m_requestTime = now;
+      }
+      m_stagingCondition.notify_all();
+    }
+    if ( openFile->good() && openFile->staged() ) {
       local = openFile->temporary();
       // remove previous file if necessary
       removePrevious( openIt );
@@ -249,7 +296,8 @@ StatusCode FileStagerSvc::addFiles( const vector<string>& files ) {
   if ( !m_files.empty() ) {
     filesByPosition_t& filesByPosition = m_files.get<listTag>();
     m_stageStart                       = filesByPosition.begin()->original();
-    m_thread                           = std::make_unique<thread>( bind( &FileStagerSvc::stage, this ) );
+    m_thread                           = std::make_unique<thread>(
+        bind( m_streams > 1 ? &FileStagerSvc::stageParallel : &FileStagerSvc::stage, this ) );
   }
 
   if ( outputLevel() <= MSG::DEBUG ) {
@@ -287,48 +335,13 @@ void FileStagerSvc::stage() {
 
   while ( 1 ) {
     try {
-      string   temp;
-      fs::path temporaryPath;
-
-      File* stageFile = nullptr;
-      {
-        // Locate the file that will be staged
-        stageFile     = m_stageIt->file();
-        temporaryPath = stageFile->temporary();
-
-        // Check if file exists
-        bool err = false;
-
-        if ( !stageFile->exists() ) {
-          error() << stageFile->remote() << " does not exists" << endmsg;
-          for ( auto msg : stageFile->errorMessages() ) { error() << msg << endmsg; }
-          err = true;
-        }
+      // Locate the file that will be staged
+      File* stageFile = m_stageIt->file();
 
-        // Check available diskspace if we need it
-        if ( !err && !fs::exists( temporaryPath ) ) {
-          uintmax_t space = diskspace();
-          size_t    tries = 0;
-          while ( space < stageFile->size() + 1 && tries < m_tries ) {
-            warning() << "No enough diskspace in " << m_tmpdir.value() << " sleeping 60 seconds before retrying"
-                      << endmsg;
-            boost::this_thread::sleep( pt::seconds( 60 ) );
-            ++tries;
-          }
-          if ( tries >= m_tries ) {
-            error() << "Still not enough space to stage: " << stageFile->remote() << " after " << tries
-                    << " tries, giving up." << endmsg;
-            err = true;
-          }
-        }
-
-        if ( err ) {
-          // Set correct variables and notify conditions.
-          stageFile->setStaged( true );
-          stageFile->setGood( false );
-          stageFile->openCondition().notify_one();
-          break;
-        }
+      if ( !checkFile( stageFile ) ) {
+        // Set correct variables and notify conditions.
+        setStaged( stageFile, false );
+        break;
       }
 
       const_position_iterator pos;
@@ -356,69 +369,16 @@ void FileStagerSvc::stage() {
 
       info() << "Staging file " << stageFile->remote() << endmsg;
 
-      bool         err   = false;
-      unsigned int tries = 0;
-      while ( tries < m_copyTries ) {
-        ++tries;
-        // If the file is already there, no need to copy
-        fs::path temporary( stageFile->temporary() );
-        if ( fs::exists( temporary ) && fs::file_size( temporary ) / 1024 == stageFile->size() ) break;
-
-        // try to copy a few times
-        FILE*          pipe = 0;
-        vector<string> lines;
-        int            ret = 0;
-        stringstream   command;
-        command << stageFile->command() << " \"" << stageFile->remote() << "\" \"" << stageFile->temporary() << "\"";
-        verbose() << "Calling command: " << command.str() << endmsg;
-        if ( !( pipe = (FILE*)popen( command.str().c_str(), "w" ) ) ) {
-          // problems setting up the shell
-          error() << "Error creating the pipe" << endmsg;
-          err = true;
-        } else {
-          bio::stream_buffer<bio::file_descriptor_source> fpstream( fileno( pipe ), bio::never_close_handle );
-          istream                                         in( &fpstream );
-          string                                          line;
-          while ( in ) {
-            getline( in, line );
-            lines.push_back( line );
-          }
-          ret = pclose( pipe );
-        }
-
-        // Check if the file is actually there.
-
-        if ( ret != 0 ) {
-          error() << "Staging failed error output: " << endmsg;
-          for ( const string& line : lines ) { error() << line; }
-          error() << endmsg;
-          err = true;
-          boost::this_thread::sleep( pt::seconds( 10 ) );
-        } else if ( !fs::exists( temporary ) ) {
-          warning() << "Staging command returned, but the file is not there, retrying." << endmsg;
-          err = true;
-          boost::this_thread::sleep( pt::seconds( 10 ) );
-        } else {
-          err = false;
-          break;
-        }
-      }
-
-      if ( err ) {
+      if ( !copyFile( stageFile ) ) {
         // Handle errors
         lock_guard lock( m_fileMutex );
-        // Set correct variables and notify conditions.
-        stageFile->setStaged( true );
-        stageFile->setGood( false );
-        stageFile->openCondition().notify_one();
+        setStaged( stageFile, false );
         break;
       } else {
         // We're good
         lock_guard lock( m_fileMutex );
         info() << "Staging successful: " << stageFile->remote() << " staged." << endmsg;
-        stageFile->setStaged( true );
-        stageFile->setGood( true );
-        stageFile->openCondition().notify_one();
+        setStaged( stageFile, true );
 
         // Move to next file
         const_position_iterator _pos = m_files.project<listTag>( m_stageIt );
@@ -434,6 +394,296 @@ void FileStagerSvc::stage() {
   }
 }
 
+//=============================================================================
+void FileStagerSvc::stageParallel() {
+  // The files to stage, in order
+  vector<File*> files;
+  {
+    lock_guard               fileLock( m_fileMutex );
+    const filesByPosition_t& filesByPosition = m_files.get<listTag>();
+    auto                     pos = m_files.project<listTag>( m_files.get<originalTag>().find( m_stageStart ) );
+    for ( ; pos != filesByPosition.end(); ++pos ) files.push_back( pos->file() );
+  }
+  {
+    lock_guard lock( m_stagingMutex );
+    m_copyQueue.clear();
+    m_progress.clear();
+    m_stopCopies = false;
+    m_requested  = nullptr;
+    m_lookahead  = m_stageNFiles;
+  }
+
+  thread_group streams;
+  for ( size_t i = 0; i < m_streams; ++i ) streams.create_thread( bind( &FileStagerSvc::copyLoop, this ) );
+
+  try {
+    for ( size_t next = 0; next < files.size(); ++next ) {
+      File* stageFile = files[next];
+
+      // Wait for the file to be in the lookahead window, i.e. close enough to the file in use
+      {
+        unique_lock<mutex> lock( m_stagingMutex );
+        while ( true ) {
+          if ( m_stopCopies ) break;
+          const auto requested = std::find( files.begin(), files.end(), m_requested );
+          const size_t inUse   = ( requested == files.end() ) ? 0 : ( requested - files.begin() ) + 1;
+          const size_t ahead   = lookahead();
+          if ( ahead != m_lookahead ) {
+            debug() << "Staging " << ahead << " files ahead (copy " << m_copyTime << " s, use " << m_useTime
+                    << " s per file)" << endmsg;
+            m_lookahead = ahead;
+          }
+          if ( next < inUse + ahead ) break;
+          m_stagingCondition.wait( lock );
+        }
+        if ( m_stopCopies ) break;
+      }
+
+      if ( !checkFile( stageFile ) ) {
+        setStaged( stageFile, false );
+        break;
+      }
+
+      // Queue the copies of the file: chunks of the local files, else the whole file
+      fs::path               temporary( stageFile->temporary() );
+      const boost::uintmax_t chunk = boost::uintmax_t( m_chunkSize ) * 1024 * 1024;
+      boost::uintmax_t       bytes = 0;
+      const bool chunked = chunk > 0 && m_copyCommand.empty() && ba::starts_with( stageFile->command(), "cp" ) &&
+                           !( fs::exists( temporary ) && fs::file_size( temporary ) / 1024 == stageFile->size() );
+      if ( chunked ) {
+        bytes = fs::file_size( stageFile->remote() );
+        // create the file with its final size, the chunks are written in place
+        const int fd = ::open( stageFile->temporary().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        if ( fd < 0 || ::ftruncate( fd, bytes ) != 0 ) {
+          error() << "Could not create " << stageFile->temporary() << ": " << strerror( errno ) << endmsg;
+          if ( fd >= 0 ) ::close( fd );
+          setStaged( stageFile, false );
+          break;
+        }
+        ::close( fd );
+      }
+
+      info() << "Staging file " << stageFile->remote() << endmsg;
+      {
+        lock_guard lock( m_stagingMutex );
+        Progress&  progress = m_progress[stageFile];
+        progress.start      = pt::microsec_clock::universal_time();
+        // the chunked files are sparse until their chunks are written
+        progress.remaining = chunked ? bytes : boost::uintmax_t( stageFile->size() ) * 1024;
+        if ( chunked && bytes > chunk ) {
+          for ( boost::uintmax_t offset = 0; offset < bytes; offset += chunk ) {
+            m_copyQueue.push_back( {stageFile, offset, std::min( chunk, bytes - offset )} );
+            ++progress.pending;
+          }
+        } else if ( chunked ) {
+          m_copyQueue.push_back( {stageFile, 0, bytes} );
+          progress.pending = 1;
+        } else {
+          m_copyQueue.push_back( {stageFile, 0, 0} );
+          progress.pending = 1;
+        }
+      }
+      m_stagingCondition.notify_all();
+    }
+
+    // Wait for the copies to finish
+    {
+      unique_lock<mutex> lock( m_stagingMutex );
+      while ( !m_stopCopies &&
+              std::any_of( m_progress.begin(), m_progress.end(), []( const auto& p ) { return p.second.pending; } ) ) {
+        m_stagingCondition.wait( lock );
+      }
+      m_stopCopies = true;
+    }
+    m_stagingCondition.notify_all();
+    streams.join_all();
+
+    // the files whose copies were dropped after a failure are not good
+    for ( auto& [file, progress] : m_progress ) {
+      if ( progress.pending ) setStaged( file, false );
+    }
+  } catch ( const thread_interrupted& /* interrupt */ ) {
+    {
+      lock_guard lock( m_stagingMutex );
+      m_stopCopies = true;
+      m_copyQueue.clear();
+    }
+    streams.interrupt_all();
+    streams.join_all();
+  }
+}
+
+//=============================================================================
+void FileStagerSvc::copyLoop() {
+  try {
+    while ( true ) {
+      CopyTask task;
+      {
+        unique_lock<mutex> lock( m_stagingMutex );
+        while ( !m_stopCopies && m_copyQueue.empty() ) m_stagingCondition.wait( lock );
+        if ( m_copyQueue.empty() ) return;
+        task = m_copyQueue.front();
+        m_copyQueue.pop_front();
+        // a chunk of a file which failed is not worth copying
+        if ( m_progress[task.file].failed ) {
+          --m_progress[task.file].pending;
+          m_progress[task.file].remaining -= std::min( task.length, m_progress[task.file].remaining );
+          m_stagingCondition.notify_all();
+          continue;
+        }
+      }
+
+      bool ok = true;
+      if ( task.length == 0 ) {
+        ok = copyFile( task.file );
+      } else {
+        verbose() << "Copying bytes " << task.offset << "-" << task.offset + task.length << " of "
+                  << task.file->remote() << endmsg;
+        unsigned int tries = 0;
+        do {
+          ok = copyChunk( task.file->remote(), task.file->temporary(), task.offset, task.length );
+        } while ( !ok && ++tries < m_copyTries );
+        if ( !ok ) error() << "Copying a chunk of " << task.file->remote() << " failed" << endmsg;
+      }
+
+      bool done = false, good = false;
+      {
+        lock_guard lock( m_stagingMutex );
+        Progress&  progress = m_progress[task.file];
+        progress.failed |= !ok;
+        done = ( --progress.pending == 0 );
+        progress.remaining -= ( task.length == 0 || done ) ? progress.remaining
+                                                           : std::min( task.length, progress.remaining );
+        good = !progress.failed;
+        if ( done && good ) {
+          // update the average time to copy a file
+          const double time = ( pt::microsec_clock::universal_time() - progress.start ).total_microseconds() * 1e-6;
+          m_copyTime        = ( m_copyTime > 0 ) ? 0.7 * m_copyTime + 0.3 * time : time;
+        }
+        // stop at the first failure, as when staging one file at a time
+        if ( done && !good ) {
+          m_stopCopies = true;
+          m_copyQueue.clear();
+        }
+      }
+      if ( done ) {
+        if ( good ) info() << "Staging successful: " << task.file->remote() << " staged." << endmsg;
+        setStaged( task.file, good );
+      }
+      m_stagingCondition.notify_all();
+    }
+  } catch ( const thread_interrupted& /* interrupt */ ) {}
+}
+
+//=============================================================================
+bool FileStagerSvc::checkFile( File* stageFile ) {
+  fs::path temporaryPath = stageFile->temporary();
+
+  // Check if file exists
+  if ( !stageFile->exists() ) {
+    error() << stageFile->remote() << " does not exists" << endmsg;
+    for ( auto msg : stageFile->errorMessages() ) { error() << msg << endmsg; }
+    return false;
+  }
+
+  // Check available diskspace if we need it, leaving the space still to be written by the running copies
+  if ( !fs::exists( temporaryPath ) ) {
+    auto available = [this]() {
+      const uintmax_t space = diskspace(), reserved = toBeWritten();
+      return space > reserved ? space - reserved : 0;
+    };
+    uintmax_t space = available();
+    size_t    tries = 0;
+    while ( space < stageFile->size() + 1 && tries < m_tries ) {
+      warning() << "No enough diskspace in " << m_tmpdir.value() << " sleeping 60 seconds before retrying" << endmsg;
+      boost::this_thread::sleep( pt::seconds( 60 ) );
+      ++tries;
+      space = available();
+    }
+    if ( space < stageFile->size() + 1 ) {
+      error() << "Still not enough space to stage: " << stageFile->remote() << " after " << tries
+              << " tries, giving up." << endmsg;
+      return false;
+    }
+  }
+  return true;
+}
+
+//=============================================================================
+bool FileStagerSvc::copyFile( File* stageFile ) {
+  bool         err   = false;
+  unsigned int tries = 0;
+  while ( tries < m_copyTries ) {
+    ++tries;
+    // If the file is already there, no need to copy
+    fs::path temporary( stageFile->temporary() );
+    if ( fs::exists( temporary ) && fs::file_size( temporary ) / 1024 == stageFile->size() ) break;
+
+    // try to copy a few times
+    FILE*          pipe = 0;
+    vector<string> lines;
+    int            ret = 0;
+    stringstream   command;
+    command << ( m_copyCommand.empty() ? stageFile->command() : m_copyCommand.value() ) << " \""
+            << stageFile->remote() << "\" \"" << stageFile->temporary() << "\"";
+    verbose() << "Calling command: " << command.str() << endmsg;
+    if ( !( pipe = (FILE*)popen( command.str().c_str(), "w" ) ) ) {
+      // problems setting up the shell
+      error() << "Error creating the pipe" << endmsg;
+      err = true;
+    } else {
+      bio::stream_buffer<bio::file_descriptor_source> fpstream( fileno( pipe ), bio::never_close_handle );
+      istream                                         in( &fpstream );
+      string                                          line;
+      while ( in ) {
+        getline( in, line );
+        lines.push_back( line );
+      }
+      ret = pclose( pipe );
+    }
+
+    // Check if the file is actually there.
+
+    if ( ret != 0 ) {
+      error() << "Staging failed error output: " << endmsg;
+      for ( const string& line : lines ) { error() << line; }
+      error() << endmsg;
+      err = true;
+      boost::this_thread::sleep( pt::seconds( 10 ) );
+    } else if ( !fs::exists( temporary ) ) {
+      warning() << "Staging command returned, but the file is not there, retrying." << endmsg;
+      err = true;
+      boost::this_thread::sleep( pt::seconds( 10 ) );
+    } else {
+      err = false;
+      break;
+    }
+  }
+  return !err;
+}
+
+//=============================================================================
+void FileStagerSvc::setStaged( File* file, bool good ) {
+  {
+    // hold the open mutex, so that a waiting getLocal cannot miss the notification
+    lock_guard<mutex> lock( file->openMutex() );
+    file->setStaged( true );
+    file->setGood( good );
+  }
+  file->openCondition().notify_all();
+}
+
+//=============================================================================
+size_t FileStagerSvc::lookahead() const {
+  // stage enough files ahead for the copy of a file to be done while the
+  // previous ones are used
+  size_t ahead = m_stageNFiles;
+  if ( m_useTime > 0 && m_copyTime > 0 ) {
+    ahead = std::max( ahead, size_t( std::ceil( m_copyTime / m_useTime ) ) + 1 );
+  }
+  return std::max<size_t>( 1, std::min<size_t>( ahead, std::max( m_stageNFiles.value(), m_maxStageNFiles.value() ) ) );
+}
+
 //=============================================================================
 boost::uintmax_t FileStagerSvc::diskspace() const {
   fs::path       tmp( m_tmpdir.value() );
@@ -447,6 +697,15 @@ boost::uintmax_t FileStagerSvc::diskspace() const {
   }
 }
 
+//=============================================================================
+boost::uintmax_t FileStagerSvc::toBeWritten() {
+  // in kB, as diskspace
+  lock_guard       lock( m_stagingMutex );
+  boost::uintmax_t bytes = 0;
+  for ( const auto& entry : m_progress ) bytes += entry.second.remaining;
+  return ( bytes + 1023 ) / 1024;
+}
+
 //=============================================================================
 void FileStagerSvc::restartStaging( const string& filename ) {
   if ( m_thread ) {
@@ -459,7 +718,8 @@ void FileStagerSvc::restartStaging( const string& filename ) {
 
   // Restart staging
   m_stageStart = filename;
-  m_thread     = std::make_unique<thread>( bind( &FileStagerSvc::stage, this ) );
+  m_thread     = std::make_unique<thread>(
+      bind( m_streams > 1 ? &FileStagerSvc::stageParallel : &FileStagerSvc::stage, this ) );
 }
 
 //=============================================================================
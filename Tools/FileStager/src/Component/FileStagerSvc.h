@@ -11,12 +11,15 @@
 #ifndef FILESTAGER_H
 #define FILESTAGER_H 1
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 // boost
 #include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -40,6 +43,11 @@
 
 /** @class FileStagerSvc FileStagerSvc.h
  *
+ *  With Streams > 1, several files are copied at the same time, and the files
+ *  accessible as local files (cp) larger than ChunkSize are copied in chunks by
+ *  several streams. The number of files staged ahead of the one in use then
+ *  adapts, between StageNFiles and MaxStageNFiles, to the time needed to copy a
+ *  file compared to the time the job takes to process one.
  *
  *  @author Roel Aaij
  *  @date   2009-11-21
@@ -133,12 +141,64 @@ private:
   Gaudi::Property<bool>        m_checkLocalGarbage{this, "CheckForLocalGarbageCollector", true,
                                             "Check if the garbage collector command is in the local directory."};
   Gaudi::Property<bool>        m_keepFiles{this, "KeepFiles", false, "Keep staged files"};
+  Gaudi::Property<size_t>      m_streams{this, "Streams", 1,
+                                    "The number of copies running at the same time, "
+                                    "1 to stage one file at a time"};
+  Gaudi::Property<size_t>      m_maxStageNFiles{this, "MaxStageNFiles", 10,
+                                           "The maximum number of files to stage ahead with several streams"};
+  Gaudi::Property<size_t>      m_chunkSize{this, "ChunkSize", 256,
+                                      "The size (in MB) of the chunks of the local files copied by "
+                                      "several streams, 0 to copy them whole"};
+  Gaudi::Property<std::string> m_copyCommand{this, "CopyCommand", "",
+                                             "Command used to copy the files instead of the one of their "
+                                             "protocol, called with the source and the destination"};
+
+  /// A copy to be done by one of the streams: a whole file, or a chunk of it.
+  struct CopyTask {
+    File*            file   = nullptr;
+    boost::uintmax_t offset = 0;
+    boost::uintmax_t length = 0; ///< 0 for a whole file, copied by its command
+  };
+
+  /// Progress of a file staged by several streams.
+  struct Progress {
+    boost::posix_time::ptime start;
+    size_t                   pending   = 0; ///< copies not yet done
+    boost::uintmax_t         remaining = 0; ///< bytes not yet written by the queued and running copies
+    bool                     failed    = false;
+  };
+
+  // Parallel staging
+  boost::mutex              m_stagingMutex;
+  boost::condition_variable m_stagingCondition;
+  std::deque<CopyTask>      m_copyQueue;
+  std::map<File*, Progress> m_progress;
+  bool                      m_stopCopies = false;
+  const File*               m_requested  = nullptr; ///< the file in use
+  boost::posix_time::ptime  m_requestTime;
+  double                    m_useTime   = 0; ///< average time (s) the job uses a file
+  double                    m_copyTime  = 0; ///< average time (s) to copy a file
+  size_t                    m_lookahead = 0;
 
   // Helper Methods
   void stage();
 
+  void stageParallel();
+
+  void copyLoop();
+
+  bool checkFile( File* file );
+
+  bool copyFile( File* file );
+
+  void setStaged( File* file, bool good );
+
+  size_t lookahead() const;
+
   boost::uintmax_t diskspace() const;
 
+  boost::uintmax_t toBeWritten();
+
   void restartStaging( const std::string& filename );
 
   void removeFile( const_original_iterator it );
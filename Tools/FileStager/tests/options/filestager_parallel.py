@@ -0,0 +1,53 @@
+###############################################################################
+# (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      #
+#                                                                             #
+# This software is distributed under the terms of the GNU General Public      #
+# Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   #
+#                                                                             #
+# In applying this licence, CERN does not waive the privileges and immunities #
+# granted to it by virtue of its status as an Intergovernmental Organization  #
+# or submit itself to any jurisdiction.                                       #
+###############################################################################
+# Stage several local copies of a file with several streams, copying them with
+# a throttled copy command standing in for the copy of remote files.
+import os
+import subprocess
+import tempfile
+from GaudiConf import IOHelper
+from Configurables import LHCbApp, EventSelector
+from Configurables import ApplicationMgr
+from PRConfig.TestFileDB import test_file_db
+from FileStager.Configuration import configureFileStager
+
+input_file = test_file_db["HltDAQ-routingbits_full"].filenames[0]
+if input_file.startswith('mdf:'):
+    input_file = input_file[4:]
+
+# the "remote" files
+source_dir = tempfile.mkdtemp(prefix='filestager_parallel-')
+source = os.path.join(source_dir, 'input.mdf')
+subprocess.check_call(['xrdcp', '-s', input_file, source])
+sources = [source]
+for i in range(1, 4):
+    sources.append(os.path.join(source_dir, 'input_%d.mdf' % i))
+    os.link(source, sources[-1])
+
+svc = configureFileStager(streams=3)
+svc.StageLocalFiles = True
+svc.StageNFiles = 1
+svc.MaxStageNFiles = 3
+svc.CopyCommand = ('python ' + os.path.join(
+    os.environ['FILESTAGERROOT'], 'tests', 'scripts', 'throttled_cp.py') +
+                   ' --rate 20')
+
+app = LHCbApp()
+app.EvtMax = -1
+app.DataType = '2016'
+app.CondDBtag = 'cond-20160517'
+app.DDDBtag = 'dddb-20150724'
+
+EventSelector().PrintFreq = 1000
+
+ApplicationMgr().TopAlg = []
+
+IOHelper("MDF").inputFiles(['file:' + s for s in sources])
@@ -0,0 +1,46 @@
+#!/usr/bin/env python
+###############################################################################
+# (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      #
+#                                                                             #
+# This software is distributed under the terms of the GNU General Public      #
+# Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   #
+#                                                                             #
+# In applying this licence, CERN does not waive the privileges and immunities #
+# granted to it by virtue of its status as an Intergovernmental Organization  #
+# or submit itself to any jurisdiction.                                       #
+###############################################################################
+'''
+Copy a local file at a limited rate, standing in for the copy of a remote file
+in the tests of FileStagerSvc.
+'''
+import time
+
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser(usage='%prog [options] source destination')
+    parser.add_option(
+        '--rate', type='float', help='rate in MB/s [default: %default]')
+    parser.set_defaults(rate=50.)
+
+    opts, args = parser.parse_args()
+    if len(args) != 2:
+        parser.error('wrong number of arguments')
+
+    block = 1 << 20
+    start = time.time()
+    copied = 0
+    with open(args[0], 'rb') as source, open(args[1], 'wb') as destination:
+        while True:
+            data = source.read(block)
+            if not data:
+                break
+            destination.write(data)
+            copied += len(data)
+            delay = copied / (opts.rate * block) - (time.time() - start)
+            if delay > 0:
+                time.sleep(delay)
+
+
+if __name__ == '__main__':
+    main()
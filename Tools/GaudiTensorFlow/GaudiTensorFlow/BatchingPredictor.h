@@ -0,0 +1,121 @@
+/*****************************************************************************\
+* (c) Copyright 2019 CERN for the benefit of the LHCb Collaboration           *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef _GAUDITENSORFLOW_BATCHINGPREDICTOR_H_
+#define _GAUDITENSORFLOW_BATCHINGPREDICTOR_H_
+
+// Local
+#include "GaudiTensorFlow/Predictor.h"
+#include "GaudiTensorFlow/SmartPointers.h"
+#include "GaudiTensorFlow/TensorAbs.h"
+
+// STL
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace GaudiTensorFlow {
+  //============================================================================
+  //  Evaluation of a model on the requests of several threads at once.
+  //
+  //  The requests are queued, and a worker thread concatenates the queued
+  //  requests along the first dimension of the tensors (the batch dimension)
+  //  to run the session once per batch. A batch is run as soon as it holds
+  //  maxBatchSize rows, or when the oldest request waited for maxLatency.
+  //  The output tensors are split back along the first dimension, so the
+  //  model must map the rows of its inputs to the rows of its outputs.
+  //  Requests with string tensors (TF_STRING) are not batched.
+  //
+  //  With synchronous = true the requests are run straight away on the
+  //  calling thread, as with Predictor::exec, which is faster for models
+  //  so small that the session overhead is negligible.
+  //============================================================================
+  class BatchingPredictor {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+      std::size_t               maxBatchSize = 256;  // rows per session call
+      std::chrono::microseconds maxLatency{200};     // waiting time of the oldest request
+      bool                      synchronous = false; // no batching
+    };
+
+    struct Statistics {
+      std::size_t              nRequests = 0, nBatches = 0, nRows = 0;
+      std::vector<std::size_t> batchSizes;  // batches per number of rows, in bins [2^i, 2^(i+1))
+      Clock::duration          totalLatency{0}, maxLatency{0}; // from submission to session call
+    };
+
+    BatchingPredictor( std::shared_ptr<Predictor> predictor, Options options );
+    BatchingPredictor( std::shared_ptr<Predictor> predictor )
+        : BatchingPredictor( std::move( predictor ), Options{} ) {}
+
+    // Runs the queued requests before returning.
+    ~BatchingPredictor();
+
+    BatchingPredictor( const BatchingPredictor& ) = delete;
+    BatchingPredictor& operator=( const BatchingPredictor& ) = delete;
+
+    // Queues a request. The input tensors are copied, the output tensors must
+    // stay alive until the future is ready. The future holds the exceptions
+    // thrown by the session.
+    std::future<void> submit( std::initializer_list<TensorAbs*>&& input, std::initializer_list<TensorAbs*>&& output );
+
+    // Same interface as Predictor::exec, waiting for the batch to be run.
+    void exec( std::initializer_list<TensorAbs*>&& input, std::initializer_list<TensorAbs*>&& output ) {
+      submit( std::move( input ), std::move( output ) ).get();
+    }
+
+    Statistics statistics() const;
+
+  private:
+    struct Request {
+      std::vector<SmartTensor> inputs;
+      std::vector<TensorAbs*>  outputs;
+      std::int64_t             rows = 0;
+      Clock::time_point        submitted;
+      std::promise<void>       promise;
+    };
+    using Batch = std::vector<std::unique_ptr<Request>>;
+
+    std::shared_ptr<Predictor> m_predictor;
+    Options                    m_options;
+
+    std::deque<std::unique_ptr<Request>> m_queue;
+    std::size_t                          m_queuedRows = 0;
+    bool                                 m_stop       = false;
+    std::mutex                           m_mutex;
+    std::condition_variable              m_wakeUp;
+    std::thread                          m_worker;
+
+    Statistics         m_stats;
+    mutable std::mutex m_statsMutex;
+
+  private: // methods
+    void        workerLoop();
+    Batch       nextBatch();
+    void        runBatch( Batch& batch );
+    void        execute( Batch& batch );
+    void        account( const Batch& batch, Clock::time_point start );
+    static bool compatible( const Request& a, const Request& b );
+  };
+
+  std::ostream& operator<<( std::ostream& os, const BatchingPredictor::Statistics& stats );
+} // namespace GaudiTensorFlow
+
+#endif // _GAUDITENSORFLOW_BATCHINGPREDICTOR_H_
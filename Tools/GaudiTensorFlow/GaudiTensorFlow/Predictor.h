@@ -31,6 +31,10 @@ namespace GaudiTensorFlow {
 
     void exec( std::initializer_list<TensorAbs*>&& input, std::initializer_list<TensorAbs*>&& output );
 
+    // Lower-level access: runs the session on the given input tensors (not
+    // taken over) and returns the output tensors allocated by TensorFlow.
+    std::vector<SmartTensor> run( const std::vector<TF_Tensor*>& input );
+
   private:
     std::string              m_input_dir;
     std::vector<std::string> m_input_tensors, m_output_tensors;
@@ -0,0 +1,285 @@
+/*****************************************************************************\
+* (c) Copyright 2019 CERN for the benefit of the LHCb Collaboration           *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+
+// STL
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Local
+#include "GaudiTensorFlow/BatchingPredictor.h"
+
+namespace GaudiTensorFlow {
+  //============================================================================
+  //   Constructor
+  //============================================================================
+  BatchingPredictor::BatchingPredictor( std::shared_ptr<Predictor> predictor, Options options )
+      : m_predictor( std::move( predictor ) ), m_options( options ) {
+    if ( !m_predictor ) throw std::runtime_error( "BatchingPredictor needs a Predictor." );
+    if ( m_options.maxBatchSize == 0 ) m_options.maxBatchSize = 1;
+    if ( !m_options.synchronous ) m_worker = std::thread( [this] { workerLoop(); } );
+  }
+
+  //============================================================================
+  //   Deleter
+  //============================================================================
+  BatchingPredictor::~BatchingPredictor() {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_stop = true;
+    }
+    m_wakeUp.notify_all();
+    if ( m_worker.joinable() ) m_worker.join();
+  }
+
+  //============================================================================
+  //   Submit
+  //============================================================================
+  std::future<void> BatchingPredictor::submit( std::initializer_list<TensorAbs*>&& inputs,
+                                               std::initializer_list<TensorAbs*>&& outputs ) {
+    if ( inputs.size() == 0 ) throw std::runtime_error( "BatchingPredictor needs at least one input tensor." );
+
+    auto request = std::make_unique<Request>();
+    request->inputs.reserve( inputs.size() );
+    for ( auto& input : inputs ) {
+      request->inputs.push_back( input->get_TF_Tensor() );
+      const TF_Tensor* tensor = request->inputs.back().get();
+      if ( TF_NumDims( tensor ) < 1 )
+        throw std::runtime_error( "Input tensors of a BatchingPredictor need a batch dimension." );
+      if ( request->inputs.size() == 1 )
+        request->rows = TF_Dim( tensor, 0 );
+      else if ( TF_Dim( tensor, 0 ) != request->rows )
+        throw std::runtime_error( "Input tensors have different numbers of rows." );
+    }
+    request->outputs.assign( outputs.begin(), outputs.end() );
+    request->submitted = Clock::now();
+    auto future        = request->promise.get_future();
+
+    if ( request->rows == 0 ) {
+      request->promise.set_value();
+      return future;
+    }
+
+    // requests filling a batch on their own do not wait for the others
+    if ( m_options.synchronous || static_cast<std::size_t>( request->rows ) >= m_options.maxBatchSize ) {
+      Batch batch;
+      batch.push_back( std::move( request ) );
+      runBatch( batch );
+      return future;
+    }
+
+    bool wakeUp = false;
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_queuedRows += request->rows;
+      m_queue.push_back( std::move( request ) );
+      // the worker waits either for a first request or for a full batch
+      wakeUp = m_queue.size() == 1 || m_queuedRows >= m_options.maxBatchSize;
+    }
+    if ( wakeUp ) m_wakeUp.notify_one();
+    return future;
+  }
+
+  //============================================================================
+  //   Statistics
+  //============================================================================
+  BatchingPredictor::Statistics BatchingPredictor::statistics() const {
+    std::lock_guard<std::mutex> lock( m_statsMutex );
+    return m_stats;
+  }
+
+  //============================================================================
+  //  workerLoop (private)
+  //    Runs the batches until the BatchingPredictor is deleted
+  //============================================================================
+  void BatchingPredictor::workerLoop() {
+    for ( auto batch = nextBatch(); !batch.empty(); batch = nextBatch() ) runBatch( batch );
+  }
+
+  //============================================================================
+  //  nextBatch (private)
+  //    Waits for a full batch or for the deadline of the oldest request, and
+  //    takes from the queue the requests compatible with the oldest one.
+  //    Returns an empty batch when stopped with an empty queue.
+  //============================================================================
+  BatchingPredictor::Batch BatchingPredictor::nextBatch() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_wakeUp.wait( lock, [this] { return m_stop || !m_queue.empty(); } );
+    if ( m_queue.empty() ) return {};
+
+    const auto deadline = m_queue.front()->submitted + m_options.maxLatency;
+    m_wakeUp.wait_until( lock, deadline, [this] { return m_stop || m_queuedRows >= m_options.maxBatchSize; } );
+
+    Batch       batch;
+    std::size_t rows = 0;
+    for ( auto it = m_queue.begin(); it != m_queue.end() && rows < m_options.maxBatchSize; ) {
+      const std::size_t n = ( *it )->rows;
+      if ( batch.empty() || ( rows + n <= m_options.maxBatchSize && compatible( *batch.front(), **it ) ) ) {
+        rows += n;
+        batch.push_back( std::move( *it ) );
+        it = m_queue.erase( it );
+      } else
+        ++it;
+    }
+    m_queuedRows -= rows;
+    return batch;
+  }
+
+  //============================================================================
+  //  runBatch (private)
+  //============================================================================
+  void BatchingPredictor::runBatch( Batch& batch ) {
+    account( batch, Clock::now() );
+    execute( batch );
+  }
+
+  //============================================================================
+  //  execute (private)
+  //    Concatenates the inputs, runs the session once and splits the outputs.
+  //    The requests of a batch giving string outputs, which have no fixed size
+  //    per row, are run again one by one.
+  //============================================================================
+  void BatchingPredictor::execute( Batch& batch ) {
+    std::int64_t totalRows = 0;
+    for ( const auto& request : batch ) totalRows += request->rows;
+
+    std::vector<SmartTensor> output_tensors;
+    try {
+      std::vector<SmartTensor> concatenated;
+      std::vector<TF_Tensor*>  input_raw;
+      const auto&              first = *batch.front();
+      if ( batch.size() == 1 ) {
+        for ( const auto& input : first.inputs ) input_raw.push_back( input.get() );
+      } else {
+        for ( std::size_t iIn = 0; iIn < first.inputs.size(); ++iIn ) {
+          const TF_Tensor*          tensor = first.inputs[iIn].get();
+          std::vector<std::int64_t> dims( TF_NumDims( tensor ) );
+          for ( std::size_t iDim = 0; iDim < dims.size(); ++iDim ) dims[iDim] = TF_Dim( tensor, iDim );
+          dims[0] = totalRows;
+
+          std::size_t bytes = 0;
+          for ( const auto& request : batch ) bytes += TF_TensorByteSize( request->inputs[iIn].get() );
+
+          concatenated.emplace_back(
+              TF_AllocateTensor( TF_TensorType( tensor ), dims.data(), static_cast<int>( dims.size() ), bytes ) );
+          auto* data = static_cast<char*>( TF_TensorData( concatenated.back().get() ) );
+          for ( const auto& request : batch ) {
+            const TF_Tensor* input = request->inputs[iIn].get();
+            std::memcpy( data, TF_TensorData( input ), TF_TensorByteSize( input ) );
+            data += TF_TensorByteSize( input );
+          }
+          input_raw.push_back( concatenated.back().get() );
+        }
+      }
+
+      output_tensors = m_predictor->run( input_raw );
+
+      if ( batch.size() > 1 )
+        for ( const auto& output : output_tensors )
+          if ( TF_NumDims( output.get() ) < 1 || TF_Dim( output.get(), 0 ) != totalRows )
+            throw std::runtime_error( "Output tensors are not batched along their first dimension." );
+    } catch ( ... ) {
+      for ( auto& request : batch ) request->promise.set_exception( std::current_exception() );
+      return;
+    }
+
+    if ( batch.size() > 1 &&
+         std::any_of( output_tensors.begin(), output_tensors.end(),
+                      []( const SmartTensor& output ) { return TF_TensorType( output.get() ) == TF_STRING; } ) ) {
+      for ( auto& request : batch ) {
+        Batch single;
+        single.push_back( std::move( request ) );
+        execute( single );
+      }
+      return;
+    }
+
+    // offset of the rows of the current request in the output tensors
+    std::int64_t row = 0;
+    for ( auto& request : batch ) {
+      try {
+        if ( request->outputs.size() != output_tensors.size() )
+          throw std::runtime_error( "Number of output tensors inconsistent with Predictor declaration." );
+
+        std::vector<char*> data;
+        for ( std::size_t iOut = 0; iOut < output_tensors.size(); ++iOut ) {
+          const TF_Tensor*  output   = output_tensors[iOut].get();
+          const std::size_t rowBytes = TF_TensorByteSize( output ) / totalRows;
+          const std::size_t bytes = batch.size() == 1 ? TF_TensorByteSize( output ) : rowBytes * request->rows;
+          if ( request->outputs[iOut]->getAllocatedNumberOfBytes() != bytes )
+            throw std::runtime_error( "Allocated output tensor does not match the number of rows of the input." );
+          data.push_back( static_cast<char*>( TF_TensorData( output ) ) + row * rowBytes );
+        }
+        for ( std::size_t iOut = 0; iOut < data.size(); ++iOut ) request->outputs[iOut]->importData( data[iOut] );
+        request->promise.set_value();
+      } catch ( ... ) { request->promise.set_exception( std::current_exception() ); }
+      row += request->rows;
+    }
+  }
+
+  //============================================================================
+  //  account (private)
+  //    Adds the batch to the statistics
+  //============================================================================
+  void BatchingPredictor::account( const Batch& batch, Clock::time_point start ) {
+    std::size_t rows = 0;
+    for ( const auto& request : batch ) rows += request->rows;
+    std::size_t bin = 0;
+    while ( rows >> ( bin + 1 ) ) ++bin;
+
+    std::lock_guard<std::mutex> lock( m_statsMutex );
+    ++m_stats.nBatches;
+    m_stats.nRequests += batch.size();
+    m_stats.nRows += rows;
+    if ( m_stats.batchSizes.size() <= bin ) m_stats.batchSizes.resize( bin + 1, 0 );
+    ++m_stats.batchSizes[bin];
+    for ( const auto& request : batch ) {
+      const auto latency = start - request->submitted;
+      m_stats.totalLatency += latency;
+      if ( latency > m_stats.maxLatency ) m_stats.maxLatency = latency;
+    }
+  }
+
+  //============================================================================
+  //  compatible (private)
+  //    Can the inputs of the two requests be concatenated? String tensors hold
+  //    offsets into their own data, so their requests are always run alone.
+  //============================================================================
+  bool BatchingPredictor::compatible( const Request& a, const Request& b ) {
+    if ( a.inputs.size() != b.inputs.size() || a.outputs.size() != b.outputs.size() ) return false;
+    for ( std::size_t iIn = 0; iIn < a.inputs.size(); ++iIn ) {
+      const TF_Tensor *ta = a.inputs[iIn].get(), *tb = b.inputs[iIn].get();
+      if ( TF_TensorType( ta ) == TF_STRING || TF_TensorType( ta ) != TF_TensorType( tb ) ||
+           TF_NumDims( ta ) != TF_NumDims( tb ) )
+        return false;
+      for ( int iDim = 1; iDim < TF_NumDims( ta ); ++iDim )
+        if ( TF_Dim( ta, iDim ) != TF_Dim( tb, iDim ) ) return false;
+    }
+    return true;
+  }
+
+  //============================================================================
+  //  Printout of the statistics
+  //============================================================================
+  std::ostream& operator<<( std::ostream& os, const BatchingPredictor::Statistics& stats ) {
+    using us = std::chrono::duration<double, std::micro>;
+    os << stats.nRequests << " requests in " << stats.nBatches << " batches";
+    if ( !stats.nBatches ) return os;
+    os << ", " << double( stats.nRows ) / stats.nBatches << " rows per batch\n"
+       << "queueing latency: mean " << us( stats.totalLatency ).count() / stats.nRequests << " us, max "
+       << us( stats.maxLatency ).count() << " us\n"
+       << "batches per number of rows:";
+    for ( std::size_t bin = 0; bin < stats.batchSizes.size(); ++bin )
+      if ( stats.batchSizes[bin] )
+        os << " [" << ( 1ul << bin ) << "," << ( 2ul << bin ) << "): " << stats.batchSizes[bin];
+    return os;
+  }
+} // namespace GaudiTensorFlow
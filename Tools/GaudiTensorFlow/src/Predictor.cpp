@@ -67,10 +67,6 @@ namespace GaudiTensorFlow {
   //   Execute
   //============================================================================
   void Predictor::exec( std::initializer_list<TensorAbs*>&& inputs, std::initializer_list<TensorAbs*>&& outputs ) {
-    SmartStatus status( TF_NewStatus() );
-
-    if ( inputs.size() != m_input_ops.size() )
-      throw std::runtime_error( "Number of operator() input tensors inconsistent with Predictor declaration." );
     std::vector<SmartTensor> input_tensors;
     input_tensors.reserve( inputs.size() );
     std::vector<TF_Tensor*> input_raw;
@@ -81,31 +77,48 @@ namespace GaudiTensorFlow {
       input_raw.push_back( input_tensors.back().get() );
     }
 
-    std::vector<TF_Tensor*> output_raw( m_output_ops.size(), nullptr );
-
-    TF_SessionRun( m_session.get(), nullptr, m_input_ops.data(), input_raw.data(), m_input_ops.size(),
-                   m_output_ops.data(), output_raw.data(), m_output_ops.size(), nullptr, 0, nullptr, status.get() );
-
-    checkStatus( status );
+    const auto output_tensors = run( input_raw );
 
     int iTensor = 0;
     for ( auto& output : outputs ) {
       const auto shape = output->getShape();
-      BOOST_ASSERT_MSG( static_cast<size_t>( TF_NumDims( output_raw[iTensor] ) ) == shape.size(),
+      BOOST_ASSERT_MSG( static_cast<size_t>( TF_NumDims( output_tensors[iTensor].get() ) ) == shape.size(),
                         "Allocated output tensor has wrong number of dimensions." );
 
       for ( size_t iDim = 0; iDim < shape.size(); ++iDim )
-        BOOST_ASSERT_MSG( static_cast<size_t>( TF_Dim( output_raw[iTensor], iDim ) ) !=
+        BOOST_ASSERT_MSG( static_cast<size_t>( TF_Dim( output_tensors[iTensor].get(), iDim ) ) ==
                               static_cast<size_t>( shape[iDim] ),
                           "Dimensions of the allocated output tensor do not match the graph" );
 
-      output->importData( TF_TensorData( output_raw[iTensor] ) );
-      TF_DeleteTensor( output_raw[iTensor] );
+      output->importData( TF_TensorData( output_tensors[iTensor].get() ) );
 
       iTensor++;
     }
   }
 
+  //============================================================================
+  //   Run
+  //    One call to the session, the output tensors are owned by the caller
+  //============================================================================
+  std::vector<SmartTensor> Predictor::run( const std::vector<TF_Tensor*>& input_raw ) {
+    SmartStatus status( TF_NewStatus() );
+
+    if ( input_raw.size() != m_input_ops.size() )
+      throw std::runtime_error( "Number of operator() input tensors inconsistent with Predictor declaration." );
+
+    std::vector<TF_Tensor*> output_raw( m_output_ops.size(), nullptr );
+
+    TF_SessionRun( m_session.get(), nullptr, m_input_ops.data(), input_raw.data(), m_input_ops.size(),
+                   m_output_ops.data(), output_raw.data(), m_output_ops.size(), nullptr, 0, nullptr, status.get() );
+
+    checkStatus( status );
+
+    std::vector<SmartTensor> output_tensors;
+    output_tensors.reserve( output_raw.size() );
+    for ( auto* output : output_raw ) output_tensors.emplace_back( output );
+    return output_tensors;
+  }
+
   //============================================================================
   //  checkStatus (private)
   //   Throw an exception describing the error in case of any non-success status
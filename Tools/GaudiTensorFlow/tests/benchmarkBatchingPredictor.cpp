@@ -0,0 +1,95 @@
+/*****************************************************************************\
+* (c) Copyright 2019 CERN for the benefit of the LHCb Collaboration           *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "GaudiTensorFlow/BatchingPredictor.h"
+#include "GaudiTensorFlow/Predictor.h"
+#include "GaudiTensorFlow/Tensor.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtf = GaudiTensorFlow;
+
+//==============================================================================
+//  Evaluation of a model on a few rows (candidates) per request from several
+//  threads, through direct calls to Predictor::exec and through a
+//  BatchingPredictor, with and without batching.
+//==============================================================================
+
+// run nRequests requests in each of nThreads threads, returns the time per request in microseconds
+double timeRequests( unsigned int nThreads, unsigned int nRequests, size_t nRows, size_t nInputs, size_t nOutputs,
+                     const std::function<void( gtf::TensorAbs*, gtf::TensorAbs* )>& call ) {
+  const auto               start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for ( unsigned int iThread = 0; iThread < nThreads; ++iThread )
+    threads.emplace_back( [&] {
+      auto input  = gtf::Tensor<float, 2>( {nRows, nInputs} );
+      auto output = gtf::Tensor<float, 2>( {nRows, nOutputs} );
+      for ( size_t iRow = 0; iRow < nRows; ++iRow )
+        for ( size_t iCol = 0; iCol < nInputs; ++iCol ) input[iRow][iCol] = 0.1 * iRow + iCol;
+      for ( unsigned int iRequest = 0; iRequest < nRequests; ++iRequest ) call( &input, &output );
+    } );
+  for ( auto& thread : threads ) thread.join();
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / ( nThreads * nRequests );
+}
+
+int main( int argc, char* argv[] ) {
+  if ( argc < 6 ) {
+    std::cerr << "Usage: " << argv[0]
+              << " <SavedModel_dir> <InputTensorName> <OutputTensorName> <nInputs> <nOutputs>"
+                 " [nThreads=8] [nRequests=10000] [nRows=1] [maxBatchSize=nThreads*nRows] [maxLatency_us=200]\n";
+    return 1;
+  }
+  const size_t       nInputs      = std::atoi( argv[4] );
+  const size_t       nOutputs     = std::atoi( argv[5] );
+  const unsigned int nThreads     = argc > 6 ? std::atoi( argv[6] ) : 8;
+  const unsigned int nRequests    = argc > 7 ? std::atoi( argv[7] ) : 10000;
+  const size_t       nRows        = argc > 8 ? std::atoi( argv[8] ) : 1;
+  const size_t       maxBatchSize = argc > 9 ? std::atoi( argv[9] ) : nThreads * nRows;
+  const long         maxLatency   = argc > 10 ? std::atol( argv[10] ) : 200;
+
+  auto predictor = std::make_shared<gtf::Predictor>( argv[1], std::vector<std::string>{argv[2]},
+                                                     std::vector<std::string>{argv[3]}, nThreads );
+
+  std::cout << nThreads << " threads, " << nRequests << " requests of " << nRows << " rows per thread\n";
+
+  const double direct =
+      timeRequests( nThreads, nRequests, nRows, nInputs, nOutputs,
+                    [&]( gtf::TensorAbs* in, gtf::TensorAbs* out ) { predictor->exec( {in}, {out} ); } );
+  std::cout << "Predictor::exec:                 " << direct << " us per request\n";
+
+  {
+    gtf::BatchingPredictor::Options options;
+    options.synchronous = true;
+    gtf::BatchingPredictor batching( predictor, options );
+    const double           time =
+        timeRequests( nThreads, nRequests, nRows, nInputs, nOutputs,
+                      [&]( gtf::TensorAbs* in, gtf::TensorAbs* out ) { batching.exec( {in}, {out} ); } );
+    std::cout << "BatchingPredictor (synchronous): " << time << " us per request\n";
+  }
+
+  {
+    gtf::BatchingPredictor::Options options;
+    options.maxBatchSize = maxBatchSize;
+    options.maxLatency   = std::chrono::microseconds( maxLatency );
+    gtf::BatchingPredictor batching( predictor, options );
+    const double           time =
+        timeRequests( nThreads, nRequests, nRows, nInputs, nOutputs,
+                      [&]( gtf::TensorAbs* in, gtf::TensorAbs* out ) { batching.exec( {in}, {out} ); } );
+    std::cout << "BatchingPredictor:               " << time << " us per request, speed-up " << direct / time << "\n"
+              << batching.statistics() << std::endl;
+  }
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************\
+* (c) Copyright 2019 CERN for the benefit of the LHCb Collaboration           *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "tensorflow/c/c_api.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+//  Stub of the part of the TensorFlow C API used by GaudiTensorFlow, to test
+//  it without TensorFlow. The session runs a fixed model on a 2D float input
+//  (in[r][]) giving a 2D float output:
+//    out[r][0] = sum of in[r][], out[r][1] = 2 * in[r][0]
+//  and on a 1D string input, whose content is not decoded, a 1D float output
+//  holding the number of rows of the call. Each call takes 50 us.
+//==============================================================================
+
+struct TF_Tensor {
+  TF_DataType               type;
+  std::vector<std::int64_t> dims;
+  std::vector<char>         data;
+};
+struct TF_Status {};
+struct TF_Graph {};
+struct TF_SessionOptions {};
+struct TF_Session {};
+
+// largest number of rows of a session call on a string input
+std::atomic<std::int64_t> stubMaxStringRows{0};
+
+extern "C" {
+TF_Tensor* TF_AllocateTensor( TF_DataType type, const int64_t* dims, int num_dims, size_t len ) {
+  return new TF_Tensor{type, {dims, dims + num_dims}, std::vector<char>( len )};
+}
+void        TF_DeleteTensor( TF_Tensor* tensor ) { delete tensor; }
+TF_DataType TF_TensorType( const TF_Tensor* tensor ) { return tensor->type; }
+int         TF_NumDims( const TF_Tensor* tensor ) { return tensor->dims.size(); }
+int64_t     TF_Dim( const TF_Tensor* tensor, int dim_index ) { return tensor->dims[dim_index]; }
+size_t      TF_TensorByteSize( const TF_Tensor* tensor ) { return tensor->data.size(); }
+void*       TF_TensorData( const TF_Tensor* tensor ) { return const_cast<char*>( tensor->data.data() ); }
+
+TF_Status*  TF_NewStatus() { return new TF_Status; }
+void        TF_DeleteStatus( TF_Status* status ) { delete status; }
+TF_Code     TF_GetCode( const TF_Status* ) { return TF_OK; }
+const char* TF_Message( const TF_Status* ) { return ""; }
+
+TF_Buffer*         TF_NewBuffer() { return new TF_Buffer{}; }
+void               TF_DeleteBuffer( TF_Buffer* buffer ) { delete buffer; }
+TF_Graph*          TF_NewGraph() { return new TF_Graph; }
+void               TF_DeleteGraph( TF_Graph* graph ) { delete graph; }
+TF_Operation*      TF_GraphOperationByName( TF_Graph*, const char* ) { return nullptr; }
+TF_SessionOptions* TF_NewSessionOptions() { return new TF_SessionOptions; }
+void               TF_SetConfig( TF_SessionOptions*, const void*, size_t, TF_Status* ) {}
+void               TF_DeleteSessionOptions( TF_SessionOptions* options ) { delete options; }
+
+TF_Session* TF_LoadSessionFromSavedModel( const TF_SessionOptions*, const TF_Buffer*, const char*, const char* const*,
+                                          int, TF_Graph*, TF_Buffer*, TF_Status* ) {
+  return new TF_Session;
+}
+void TF_CloseSession( TF_Session*, TF_Status* ) {}
+void TF_DeleteSession( TF_Session* session, TF_Status* ) { delete session; }
+
+void TF_SessionRun( TF_Session*, const TF_Buffer*, const TF_Output*, TF_Tensor* const* input_values, int,
+                    const TF_Output*, TF_Tensor** output_values, int, const TF_Operation* const*, int, TF_Buffer*,
+                    TF_Status* ) {
+  std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+  const TF_Tensor*   input = input_values[0];
+  const std::int64_t rows  = input->dims[0];
+
+  if ( input->type == TF_STRING ) {
+    auto max = stubMaxStringRows.load();
+    while ( rows > max && !stubMaxStringRows.compare_exchange_weak( max, rows ) ) {}
+    output_values[0] = TF_AllocateTensor( TF_FLOAT, &rows, 1, rows * sizeof( float ) );
+    std::fill_n( static_cast<float*>( TF_TensorData( output_values[0] ) ), rows, float( rows ) );
+    return;
+  }
+
+  const std::int64_t cols    = input->dims[1];
+  const std::int64_t dims[2] = {rows, 2};
+  output_values[0]           = TF_AllocateTensor( TF_FLOAT, dims, 2, rows * 2 * sizeof( float ) );
+  const auto* in             = static_cast<const float*>( TF_TensorData( input ) );
+  auto*       out            = static_cast<float*>( TF_TensorData( output_values[0] ) );
+  for ( std::int64_t r = 0; r < rows; ++r ) {
+    out[2 * r]     = std::accumulate( in + r * cols, in + ( r + 1 ) * cols, 0.f );
+    out[2 * r + 1] = 2 * in[r * cols];
+  }
+}
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************\
+* (c) Copyright 2019 CERN for the benefit of the LHCb Collaboration           *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#include "GaudiTensorFlow/BatchingPredictor.h"
+#include "GaudiTensorFlow/Predictor.h"
+#include "GaudiTensorFlow/Tensor.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtf = GaudiTensorFlow;
+
+//==============================================================================
+//  Checks that the outputs of a BatchingPredictor used from several threads,
+//  with requests of different numbers of rows, are those of direct calls to
+//  Predictor::exec, and that the requests with string inputs are not batched.
+//  Runs with the stub of the TensorFlow C API in stubTensorFlow.cpp.
+//==============================================================================
+
+// from stubTensorFlow.cpp: largest number of rows of a session call on a string input
+extern std::atomic<std::int64_t> stubMaxStringRows;
+
+namespace {
+  // 1D string tensor, whose content is not used by the stub model
+  class StringTensor : public gtf::TensorAbs {
+  public:
+    explicit StringTensor( std::int64_t rows ) : m_rows( rows ) {}
+    gtf::SmartTensor get_TF_Tensor() override {
+      return gtf::SmartTensor( TF_AllocateTensor( TF_STRING, &m_rows, 1, getAllocatedNumberOfBytes() ) );
+    }
+    void                importData( void* ) override {}
+    TF_DataType         getTfType() const override { return TF_STRING; }
+    size_t              getAllocatedNumberOfBytes() const override { return m_rows * ( sizeof( std::uint64_t ) + 2 ); }
+    std::vector<size_t> getShape() const override { return {static_cast<size_t>( m_rows )}; }
+
+  private:
+    std::int64_t m_rows;
+  };
+} // namespace
+
+int main() {
+  const unsigned int nThreads  = 8;
+  const unsigned int nRequests = 500;
+  const size_t       nInputs   = 3;
+
+  auto predictor = std::make_shared<gtf::Predictor>( "", std::vector<std::string>{"input"},
+                                                     std::vector<std::string>{"output"}, 1 );
+
+  gtf::BatchingPredictor::Options options;
+  options.maxBatchSize = 16;
+  options.maxLatency   = std::chrono::microseconds( 500 );
+
+  std::atomic<unsigned int> nWrong{0};
+  {
+    gtf::BatchingPredictor   batching( predictor, options );
+    std::vector<std::thread> threads;
+    for ( unsigned int iThread = 0; iThread < nThreads; ++iThread )
+      threads.emplace_back( [&, iThread] {
+        for ( unsigned int iRequest = 0; iRequest < nRequests; ++iRequest ) {
+          if ( iRequest % 10 == 0 ) {
+            StringTensor          input( 2 );
+            gtf::Tensor<float, 1> output( {2} );
+            batching.exec( {&input}, {&output} );
+            if ( output[0] != 2 || output[1] != 2 ) ++nWrong;
+            continue;
+          }
+          const size_t          nRows = 1 + ( iThread + iRequest ) % 5;
+          gtf::Tensor<float, 2> input( {nRows, nInputs} );
+          gtf::Tensor<float, 2> batched( {nRows, 2} );
+          gtf::Tensor<float, 2> direct( {nRows, 2} );
+          for ( size_t iRow = 0; iRow < nRows; ++iRow )
+            for ( size_t iCol = 0; iCol < nInputs; ++iCol )
+              input[iRow][iCol] = 1000.f * iThread + iRequest + 0.5f * iRow + 0.25f * iCol;
+          batching.exec( {&input}, {&batched} );
+          predictor->exec( {&input}, {&direct} );
+          for ( size_t iRow = 0; iRow < nRows; ++iRow )
+            for ( size_t iOut = 0; iOut < 2; ++iOut )
+              if ( batched[iRow][iOut] != direct[iRow][iOut] ) ++nWrong;
+        }
+      } );
+    for ( auto& thread : threads ) thread.join();
+    std::cout << batching.statistics() << std::endl;
+  }
+
+  if ( nWrong ) throw std::runtime_error( std::to_string( nWrong ) + " outputs differ from Predictor::exec" );
+  if ( stubMaxStringRows != 2 ) throw std::runtime_error( "Requests with string inputs were batched" );
+  std::cout << "Outputs of the BatchingPredictor match Predictor::exec" << std::endl;
+}
@@ -91,6 +91,62 @@ namespace {
     XMLSize_t      m_size = 0;
   };
 
+  /// Read-only stream buffer over an existing string.
+  struct PayloadBuffer : std::streambuf {
+    PayloadBuffer( const std::string& data ) {
+      auto begin = const_cast<char*>( data.data() );
+      setg( begin, begin, begin + data.size() );
+    }
+    pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which ) override {
+      const off_type base =
+          ( dir == std::ios_base::beg ) ? 0 : ( dir == std::ios_base::cur ) ? gptr() - eback() : egptr() - eback();
+      return seekpos( base + off, which );
+    }
+    pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override {
+      const off_type off = pos;
+      if ( !( which & std::ios_base::in ) || off < 0 || off > egptr() - eback() ) return pos_type( off_type( -1 ) );
+      setg( eback(), eback() + off, egptr() );
+      return pos;
+    }
+  };
+
+  /// Stream reading the shared content of a file, without copying it.
+  class PayloadStream : public std::istream {
+  public:
+    PayloadStream( GitEntityResolver::payload_t payload )
+        : std::istream( nullptr ), m_payload( std::move( payload ) ), m_buffer( *m_payload ) {
+      rdbuf( &m_buffer );
+    }
+    const GitEntityResolver::payload_t& payload() const { return m_payload; }
+
+  private:
+    GitEntityResolver::payload_t m_payload;
+    PayloadBuffer                m_buffer;
+  };
+
+  /// Input source reading the shared content of a file, which it keeps alive.
+  class PayloadInputSource : public ValidInputSource {
+  public:
+    PayloadInputSource( const GitEntityResolver::payload_t& payload, const XMLCh* const bufId )
+        : ValidInputSource( reinterpret_cast<const XMLByte*>( payload->data() ), payload->size(), bufId, false )
+        , m_payload( payload ) {}
+
+  private:
+    GitEntityResolver::payload_t m_payload;
+  };
+
+  /// raw bytes of an object id, used as key of the cache of the contents
+  std::string rawKey( const git_oid& oid ) {
+    return std::string( reinterpret_cast<const char*>( oid.id ), GIT_OID_RAWSZ );
+  }
+
+  /// hexadecimal form of an object id
+  std::string hexId( const git_oid& oid ) {
+    char hex[GIT_OID_HEXSZ + 1] = {0};
+    git_oid_fmt( hex, &oid );
+    return hex;
+  }
+
   /// helper to extract the file name from a full path
   boost::string_ref basename( boost::string_ref path ) {
     // note: if '/' is not found, we get npos and npos + 1 is 0
@@ -213,6 +269,15 @@ StatusCode GitEntityResolver::initialize() {
       oid[8]       = 0;
       m_defaultTag = m_commit.value() + '[' + oid + ']';
     }
+    if ( LIKELY( m_useTreeIndex ) ) {
+      // the index starts from the root tree of the commit, the directories are added when needed
+      auto tree = git_call<git_object_ptr>( name(), "cannot get tree of", m_commit.value(), git_object_peel, obj.get(),
+                                            GIT_OBJ_TREE );
+      std::lock_guard guard{m_indexMutex};
+      m_index.clear();
+      m_treeContent.clear();
+      m_index.emplace( "", Entry{*git_object_id( tree.get() ), true} );
+    }
     if ( UNLIKELY( m_limitToLastCommitTime ) ) {
       // get the time of the requested commit/tag
       m_lastCommitTime = Gaudi::Time( git_commit_time( (git_commit*)obj.get() ), 0 );
@@ -264,6 +329,17 @@ StatusCode GitEntityResolver::finalize() {
   m_repository.reset();
   m_detDataSvc.reset();
 
+  {
+    std::lock_guard guard{m_indexMutex};
+    m_index.clear();
+    m_treeContent.clear();
+  }
+  {
+    std::lock_guard guard{m_payloadsMutex};
+    m_payloads.clear();
+    m_payloadsSize = 0;
+  }
+
   // Finalize the Xerces-C++ XML subsystem
   xercesc::XMLPlatformUtils::Terminate();
 
@@ -271,7 +347,7 @@ StatusCode GitEntityResolver::finalize() {
 }
 
 void GitEntityResolver::handle( const Incident& ) {
-  // disconnect from the repository
+  // disconnect from the repository (the index and the cached contents remain valid)
   m_repository.reset();
 }
 
@@ -281,10 +357,100 @@ const std::vector<std::string>& GitEntityResolver::protocols() const {
   return s_protocols;
 }
 
-git_object_ptr GitEntityResolver::i_getData( boost::string_ref path ) const {
-  std::string rev = m_commit.value() + ":" + normalize( path.to_string() );
-  return git_call<git_object_ptr>( name(), "cannot resolve object", rev, git_revparse_single, m_repository.get(),
-                                   rev.c_str() );
+GitEntityResolver::Entry GitEntityResolver::i_getData( boost::string_ref path ) const {
+  std::string normalized = normalize( path.to_string() );
+  if ( LIKELY( m_useTreeIndex ) ) {
+    auto entry = i_findEntry( normalized );
+    if ( UNLIKELY( !entry ) )
+      throw GaudiException( "cannot resolve object " + m_commit.value() + ":" + normalized + ": path not found",
+                            name(), StatusCode::FAILURE );
+    return *entry;
+  }
+  std::string rev = m_commit.value() + ":" + normalized;
+  auto obj = git_call<git_object_ptr>( name(), "cannot resolve object", rev, git_revparse_single, m_repository.get(),
+                                       rev.c_str() );
+  return {*git_object_id( obj.get() ), Git::Helpers::is_dir( obj )};
+}
+
+GitEntityResolver::payload_t GitEntityResolver::i_getPayload( const Entry& entry ) const {
+  const auto key = rawKey( entry.oid );
+  {
+    std::lock_guard guard{m_payloadsMutex};
+    auto            cached = m_payloads.find( key );
+    if ( cached != m_payloads.end() ) return cached->second;
+  }
+  auto obj = git_call<git_object_ptr>( name(), "cannot read object", hexId( entry.oid ), git_object_lookup,
+                                       m_repository.get(), &entry.oid, GIT_OBJ_BLOB );
+  auto blob    = reinterpret_cast<const git_blob*>( obj.get() );
+  auto payload = std::make_shared<const std::string>( reinterpret_cast<const char*>( git_blob_rawcontent( blob ) ),
+                                                      static_cast<std::size_t>( git_blob_rawsize( blob ) ) );
+  if ( m_blobCacheSize > 0 ) {
+    std::lock_guard guard{m_payloadsMutex};
+    // when full, the cache is simply emptied (the contents in use stay alive)
+    if ( m_payloadsSize + payload->size() > std::size_t{m_blobCacheSize} * 1024 * 1024 ) {
+      DEBUG_MSG << "cache of file contents full, clearing it" << endmsg;
+      m_payloads.clear();
+      m_payloadsSize = 0;
+    }
+    if ( m_payloads.emplace( key, payload ).second ) m_payloadsSize += payload->size();
+  }
+  return payload;
+}
+
+const GitEntityResolver::Entry* GitEntityResolver::i_findEntry( std::string path ) const {
+  // strip trailing "/" and "/." (e.g. from the normalization of "dir/")
+  while ( !path.empty() && ( path.back() == '/' || ( path.back() == '.' && ( path.size() == 1 ||
+                                                                             path[path.size() - 2] == '/' ) ) ) ) {
+    path.pop_back();
+  }
+  std::lock_guard guard{m_indexMutex};
+  return i_findEntryLocked( path );
+}
+
+const GitEntityResolver::Entry* GitEntityResolver::i_findEntryLocked( const std::string& path ) const {
+  auto entry = m_index.find( path );
+  if ( entry != m_index.end() ) return &entry->second;
+  if ( path.empty() ) return nullptr; // no root tree (not initialized)
+
+  const auto        pos    = path.rfind( '/' );
+  const std::string parent = ( pos == std::string::npos ) ? std::string{} : path.substr( 0, pos );
+  // if the parent directory is already indexed, the path does not exist
+  if ( m_treeContent.count( parent ) ) return nullptr;
+  auto parentEntry = i_findEntryLocked( parent );
+  if ( !parentEntry || !parentEntry->dir ) return nullptr;
+  i_indexTree( parent, *parentEntry );
+
+  entry = m_index.find( path );
+  return ( entry != m_index.end() ) ? &entry->second : nullptr;
+}
+
+const GitEntityResolver::tree_content_t& GitEntityResolver::i_treeContent( const std::string& path ) const {
+  std::lock_guard guard{m_indexMutex};
+  auto            content = m_treeContent.find( path );
+  if ( content != m_treeContent.end() ) return content->second;
+  auto entry = i_findEntryLocked( path );
+  if ( UNLIKELY( !entry || !entry->dir ) )
+    throw GaudiException( "cannot list directory " + m_commit.value() + ":" + path, name(), StatusCode::FAILURE );
+  return i_indexTree( path, *entry );
+}
+
+const GitEntityResolver::tree_content_t& GitEntityResolver::i_indexTree( const std::string& path,
+                                                                         const Entry&       entry ) const {
+  VERBOSE_MSG << "indexing directory '" << path << "'" << endmsg;
+  auto obj = git_call<git_object_ptr>( name(), "cannot read tree", path, git_object_lookup, m_repository.get(),
+                                       &entry.oid, GIT_OBJ_TREE );
+  const git_tree*   tree    = reinterpret_cast<const git_tree*>( obj.get() );
+  const std::size_t max_i   = git_tree_entrycount( tree );
+  auto&             content = m_treeContent[path];
+  content.reserve( max_i );
+  for ( std::size_t i = 0; i < max_i; ++i ) {
+    const git_tree_entry* te   = git_tree_entry_byindex( tree, i );
+    const bool            dir  = Git::Helpers::is_dir( te );
+    const char*           name = git_tree_entry_name( te );
+    content.emplace_back( name, dir );
+    m_index.emplace( path.empty() ? std::string{name} : path + '/' + name, Entry{*git_tree_entry_id( te ), dir} );
+  }
+  return content;
 }
 
 GitEntityResolver::IOVInfo GitEntityResolver::i_getIOVInfo( const std::string& url ) {
@@ -336,17 +502,15 @@ GitEntityResolver::open_result_t GitEntityResolver::i_makeIStream<std::string>(
 }
 
 template <>
-GitEntityResolver::open_result_t GitEntityResolver::i_makeIStream<git_object_ptr>( const git_object_ptr& obj ) const {
-  auto        blob = reinterpret_cast<const git_blob*>( obj.get() );
-  std::string str{reinterpret_cast<const char*>( git_blob_rawcontent( blob ) ),
-                  static_cast<std::size_t>( git_blob_rawsize( blob ) )};
-  return open_result_t( new std::istringstream( str ) );
+GitEntityResolver::open_result_t GitEntityResolver::i_makeIStream<GitEntityResolver::Entry>( const Entry& obj ) const {
+  return open_result_t( new PayloadStream( i_getPayload( obj ) ) );
 }
 
 template <>
 GitEntityResolver::open_result_t GitEntityResolver::i_makeIStream<GitEntityResolver::dir_content>(
     const GitEntityResolver::dir_content& dirlist ) const {
-  return open_result_t( new std::istringstream( generateXMLCatalog( dirlist.root, dirlist.dirs, dirlist.files ) ) );
+  return open_result_t( new PayloadStream(
+      std::make_shared<const std::string>( generateXMLCatalog( dirlist.root, dirlist.dirs, dirlist.files ) ) ) );
 }
 
 std::pair<GitEntityResolver::open_result_t, GitEntityResolver::IOVInfo>
@@ -366,6 +530,8 @@ bool GitEntityResolver::i_exists( const std::string& url ) const {
   auto path   = strip_prefix( url );
   if ( UNLIKELY( m_useFiles ) )
     result = boost::filesystem::exists( m_pathToRepository.value() + "/" + path.to_string() );
+  else if ( LIKELY( m_useTreeIndex ) )
+    result = i_findEntry( normalize( path.to_string() ) );
   else {
     git_object* tmp = nullptr;
     git_revparse_single( &tmp, m_repository.get(), ( m_commit.value() + ":" + normalize( path.to_string() ) ).c_str() );
@@ -399,10 +565,15 @@ xercesc::InputSource* GitEntityResolver::resolveEntity( const XMLCh* const, cons
   auto data = i_open( url.to_string() );
   if ( UNLIKELY( !data.first ) ) return nullptr;
 
-  Blob       blob{std::move( data.first )};
-  const auto buff_size = blob.size(); // must be done here because "adopt" set the size to 0
-
-  std::unique_ptr<ValidInputSource> src{new ValidInputSource{blob.adopt(), buff_size, systemId, true}};
+  std::unique_ptr<ValidInputSource> src;
+  if ( auto stream = dynamic_cast<const PayloadStream*>( data.first.get() ) ) {
+    // the input source shares the content of the file, instead of copying it
+    src.reset( new PayloadInputSource{stream->payload(), systemId} );
+  } else {
+    Blob       blob{std::move( data.first )};
+    const auto buff_size = blob.size(); // must be done here because "adopt" set the size to 0
+    src.reset( new ValidInputSource{blob.adopt(), buff_size, systemId, true} );
+  }
   src->setValidity( data.second.since, data.second.until );
   return src.release();
 }
@@ -425,20 +596,29 @@ GitEntityResolver::dir_content GitEntityResolver::i_listdir( const std::string&
   return entries;
 }
 
-GitEntityResolver::dir_content GitEntityResolver::i_listdir( const git_object_ptr& obj, const std::string& url ) const {
+GitEntityResolver::dir_content GitEntityResolver::i_listdir( const Entry& obj, const std::string& url ) const {
   dir_content entries;
-  entries.root                = url;
-  const git_tree*       tree  = reinterpret_cast<const git_tree*>( obj.get() );
-  std::size_t           max_i = git_tree_entrycount( tree );
-  const git_tree_entry* te    = nullptr;
-  std::string           te_url;
+  entries.root = url;
+  std::string te_url;
 
-  for ( std::size_t i = 0; i < max_i; ++i ) {
-    te     = git_tree_entry_byindex( tree, i );
-    te_url = url + "/" + git_tree_entry_name( te );
-    //
-    ( ( Git::Helpers::is_dir( te ) && !i_exists( te_url + "/IOVs" ) ) ? entries.dirs : entries.files )
-        .emplace_back( std::move( te_url ) );
+  auto add = [&]( const char* name, bool dir ) {
+    te_url = url + "/" + name;
+    ( ( dir && !i_exists( te_url + "/IOVs" ) ) ? entries.dirs : entries.files ).emplace_back( std::move( te_url ) );
+  };
+
+  if ( LIKELY( m_useTreeIndex ) ) {
+    for ( const auto& te : i_treeContent( normalize( strip_prefix( url ).to_string() ) ) ) {
+      add( te.first.c_str(), te.second );
+    }
+  } else {
+    auto tree_obj = git_call<git_object_ptr>( name(), "cannot read tree", url, git_object_lookup, m_repository.get(),
+                                              &obj.oid, GIT_OBJ_TREE );
+    const git_tree*   tree  = reinterpret_cast<const git_tree*>( tree_obj.get() );
+    const std::size_t max_i = git_tree_entrycount( tree );
+    for ( std::size_t i = 0; i < max_i; ++i ) {
+      const git_tree_entry* te = git_tree_entry_byindex( tree, i );
+      add( git_tree_entry_name( te ), Git::Helpers::is_dir( te ) );
+    }
   }
   return entries;
 }
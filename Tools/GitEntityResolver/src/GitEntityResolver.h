@@ -24,8 +24,14 @@
 
 #include <algorithm>
 #include <iosfwd>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <boost/utility/string_ref.hpp>
 
@@ -48,6 +54,11 @@ namespace Gaudi {
  *  This tool implements the Gaudi IFileAccess interface, so that it can be used
  *  to retrieve files from a Git repository.
  *
+ *  The paths are resolved with an index of the trees of the commit, filled the first
+ *  time each directory is accessed, and the contents of the files are cached by object id,
+ *  so that the files identical in several IOVs are read only once. The streams and the
+ *  input sources returned give access to the cached content without copies.
+ *
  *  @author Marco Clemencic
  *  @date   2016-07-21
  */
@@ -100,6 +111,12 @@ private:
                                              "regular expression matching paths that should be ignored"};
   Gaudi::Property<bool>        m_limitToLastCommitTime{this, "LimitToLastCommitTime", false,
                                                 "force upper limit of IOVs is last commit time"};
+  Gaudi::Property<bool>        m_useTreeIndex{this, "UseTreeIndex", true,
+                                       "resolve the paths with an index of the trees of the commit "
+                                       "instead of looking up each of them in the repository"};
+  Gaudi::Property<unsigned int> m_blobCacheSize{this, "BlobCacheSize", 256,
+                                                "size limit (in MB) of the cache of the file contents, "
+                                                "0 to disable it"};
 
   /// internal flag used to track if we are using the Git database or checked out files
   bool m_useFiles = false;
@@ -119,6 +136,21 @@ private:
   };
   friend std::ostream& operator<<( std::ostream& s, const IOVInfo& info );
 
+public:
+  /// Shared content of a file.
+  using payload_t = std::shared_ptr<const std::string>;
+
+private:
+  /// Entry of the tree of the commit.
+  struct Entry {
+    git_oid oid;
+    bool    dir = false;
+
+    friend bool is_dir( const Entry& entry ) { return entry.dir; }
+  };
+  /// Names of the entries of a directory, with their directory flag.
+  using tree_content_t = std::vector<std::pair<std::string, bool>>;
+
   /// actual implementation of open method, depending on the use of git objects or files
   template <class T>
   std::pair<open_result_t, IOVInfo> i_open( const T& obj, const std::string& url ) {
@@ -147,8 +179,20 @@ private:
   /// for a given URL, retrieve the payload key to use for the current event time.
   IOVInfo i_getIOVInfo( const std::string& url );
 
-  /// Return the object containing the data at a given path in the repository.
-  git_object_ptr i_getData( boost::string_ref url ) const;
+  /// Return the entry of the given path in the repository.
+  Entry i_getData( boost::string_ref url ) const;
+
+  /// Return the content of a file, from the cache if possible.
+  payload_t i_getPayload( const Entry& entry ) const;
+
+  /// Return the entry of the given (normalized) path from the index, nullptr if it does not exist.
+  const Entry* i_findEntry( std::string path ) const;
+  /// Implementation of i_findEntry, indexing the parent directories if needed (m_indexMutex must be held).
+  const Entry* i_findEntryLocked( const std::string& path ) const;
+  /// Return the content of the given directory, indexing it if needed.
+  const tree_content_t& i_treeContent( const std::string& path ) const;
+  /// Add the entries of the given directory to the index (m_indexMutex must be held).
+  const tree_content_t& i_indexTree( const std::string& path, const Entry& entry ) const;
 
   struct dir_content {
     std::string              root;
@@ -158,7 +202,7 @@ private:
   /// helper to get the list of entries in a directory divided in directories and files
   dir_content i_listdir( const std::string& path, const std::string& url ) const;
   /// helper to get the list of entries in a directory divided in directories and files
-  dir_content i_listdir( const git_object_ptr& obj, const std::string& url ) const;
+  dir_content i_listdir( const Entry& obj, const std::string& url ) const;
 
   /// check if a url exists in the current repository
   bool i_exists( const std::string& url ) const;
@@ -176,6 +220,18 @@ private:
 
   /// cache for the string to be reported by the defaultTags() method.
   std::string m_defaultTag;
+
+  /// index of the entries of the commit, by path (the root directory is "")
+  mutable std::unordered_map<std::string, Entry> m_index;
+  /// content of the directories already indexed
+  mutable std::unordered_map<std::string, tree_content_t> m_treeContent;
+  mutable std::mutex                                      m_indexMutex;
+
+  /// cache of the contents of the files, by raw object id
+  mutable std::unordered_map<std::string, payload_t> m_payloads;
+  /// total size of the cached contents
+  mutable std::size_t m_payloadsSize = 0;
+  mutable std::mutex  m_payloadsMutex;
 };
 
 #endif // GITENTITYRESOLVER_H
@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+###############################################################################
+# (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      #
+#                                                                             #
+# This software is distributed under the terms of the GNU General Public      #
+# Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   #
+#                                                                             #
+# In applying this licence, CERN does not waive the privileges and immunities #
+# granted to it by virtue of its status as an Intergovernmental Organization  #
+# or submit itself to any jurisdiction.                                       #
+###############################################################################
+'''
+Measure the time to first event of a job loading the whole detector
+description (as the LoadDDDB test does) from the Git repositories of DDDB and
+LHCBCOND found in the given directory, with and without the tree index and the
+cache of file contents of GitEntityResolver.
+
+The job is run several times per configuration, and the minimum and median
+wall-clock times are reported.
+'''
+import os
+import subprocess
+import tempfile
+import time
+
+OPTIONS = '''
+from DetDescChecks.Options import LoadDDDBTest
+LoadDDDBTest({datatype!r})
+
+from Gaudi.Configuration import appendPostConfigAction
+def configureResolvers():
+    from Configurables import GitEntityResolver
+    from GaudiKernel.Configurable import Configurable
+    for c in Configurable.allConfigurables.values():
+        if isinstance(c, GitEntityResolver):
+            c.UseTreeIndex = {index!r}
+            c.BlobCacheSize = {cache!r}
+appendPostConfigAction(configureResolvers)
+'''
+
+CONFIGURATIONS = [
+    ('lookup by path, no cache', False, 0),
+    ('tree index, no cache', True, 0),
+    ('tree index and cache', True, 256),
+]
+
+
+def run(options, env):
+    '''
+    Run a job with the given options, returning its wall-clock time in seconds.
+    '''
+    with tempfile.NamedTemporaryFile(suffix='.py', mode='w') as opts:
+        opts.write(options)
+        opts.flush()
+        with open(os.devnull, 'w') as devnull:
+            start = time.time()
+            subprocess.check_call(['gaudirun.py', opts.name],
+                                  stdout=devnull,
+                                  env=env)
+            return time.time() - start
+
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser(
+        usage='%prog [options] directory',
+        description='directory must contain the DDDB and LHCBCOND '
+        'repositories')
+    parser.add_option(
+        '--datatype', help='data type of the job [default: %default]')
+    parser.add_option(
+        '-n',
+        '--repetitions',
+        type='int',
+        help='number of jobs per configuration [default: %default]')
+    parser.set_defaults(datatype='2016', repetitions=5)
+
+    opts, args = parser.parse_args()
+    if len(args) != 1:
+        parser.error('wrong number of arguments')
+
+    env = dict(os.environ)
+    env['GITCONDDBPATH'] = os.path.abspath(args[0])
+
+    for title, index, cache in CONFIGURATIONS:
+        options = OPTIONS.format(
+            datatype=opts.datatype, index=index, cache=cache)
+        times = sorted(run(options, env) for _ in range(opts.repetitions))
+        print('{:<30} min {:7.2f} s   median {:7.2f} s'.format(
+            title, times[0], times[len(times) // 2]))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,289 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+// Include Files
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <xercesc/dom/DOMAttr.hpp>
+#include <xercesc/dom/DOMDocument.hpp>
+#include <xercesc/dom/DOMElement.hpp>
+#include <xercesc/dom/DOMImplementation.hpp>
+#include <xercesc/dom/DOMImplementationRegistry.hpp>
+#include <xercesc/dom/DOMNamedNodeMap.hpp>
+#include <xercesc/util/XMLString.hpp>
+#include <xercesc/util/XMLUniDefs.hpp>
+
+#include "XmlDOMSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : XmlDOMSnapshot
+//
+// File layout (native byte order, all the fields aligned to 2 bytes):
+//   magic, key, number of documents, then for each document:
+//   file name, since, until, size of the serialized DOM tree, DOM tree
+// DOM tree: the nodes in document order, as
+//   Element: tag, name, number of attributes, (ID flag, name, value) per attribute,
+//            the child nodes, EndElement tag
+//   Text, CData: tag, value
+// where the strings are stored as length, XMLCh array and null terminator.
+//-----------------------------------------------------------------------------
+
+namespace {
+  constexpr char s_magic[8] = {'L', 'H', 'C', 'b', 'D', 'O', 'M', '1'};
+
+  enum Tag : std::uint16_t { Element = 1, EndElement, Text, CData };
+
+  struct Writer {
+    std::string out;
+
+    template <typename T>
+    void put( T value ) {
+      out.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+    }
+    void put( const XMLCh* str ) {
+      const auto len = static_cast<std::uint32_t>( xercesc::XMLString::stringLen( str ) );
+      put( len );
+      out.append( reinterpret_cast<const char*>( str ), ( len + 1 ) * sizeof( XMLCh ) );
+    }
+    void put( const std::string& str ) {
+      put( static_cast<std::uint32_t>( str.size() ) );
+      out += str;
+      if ( str.size() % 2 ) out += '\0';
+    }
+
+    void putNode( const xercesc::DOMNode* node ) {
+      switch ( node->getNodeType() ) {
+      case xercesc::DOMNode::ELEMENT_NODE: {
+        put( Element );
+        put( node->getNodeName() );
+        const auto* attrs = node->getAttributes();
+        const auto  n     = static_cast<std::uint32_t>( attrs->getLength() );
+        put( n );
+        for ( std::uint32_t i = 0; i < n; ++i ) {
+          const auto* attr = static_cast<const xercesc::DOMAttr*>( attrs->item( i ) );
+          put( static_cast<std::uint16_t>( attr->isId() ) );
+          put( attr->getName() );
+          put( attr->getValue() );
+        }
+        for ( auto child = node->getFirstChild(); child; child = child->getNextSibling() ) putNode( child );
+        put( EndElement );
+        break;
+      }
+      case xercesc::DOMNode::TEXT_NODE:
+        put( Text );
+        put( node->getNodeValue() );
+        break;
+      case xercesc::DOMNode::CDATA_SECTION_NODE:
+        put( CData );
+        put( node->getNodeValue() );
+        break;
+      default: // comments, processing instructions and document types are not used
+        break;
+      }
+    }
+  };
+
+  struct Reader {
+    const char* pos;
+    const char* end;
+
+    template <typename T>
+    T get() {
+      if ( pos + sizeof( T ) > end ) throw std::out_of_range( "truncated DOM snapshot" );
+      T value;
+      std::memcpy( &value, pos, sizeof( T ) );
+      pos += sizeof( T );
+      return value;
+    }
+    const XMLCh* getXMLCh() {
+      const auto len = get<std::uint32_t>();
+      if ( pos + ( len + 1 ) * sizeof( XMLCh ) > end ) throw std::out_of_range( "truncated DOM snapshot" );
+      auto str = reinterpret_cast<const XMLCh*>( pos );
+      pos += ( len + 1 ) * sizeof( XMLCh );
+      return str;
+    }
+    std::string getString() {
+      const auto len = get<std::uint32_t>();
+      if ( pos + len > end ) throw std::out_of_range( "truncated DOM snapshot" );
+      std::string str{pos, len};
+      pos += len + len % 2;
+      return str;
+    }
+  };
+} // namespace
+
+XmlDOMSnapshot::XmlDOMSnapshot( std::string path, std::string key ) : m_path{std::move( path )}, m_key{std::move( key )} {
+  const int fd = ::open( m_path.c_str(), O_RDONLY );
+  if ( fd < 0 ) return;
+  struct stat st;
+  if ( ::fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+    auto data = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( data != MAP_FAILED ) {
+      m_mapped  = data;
+      m_mapSize = st.st_size;
+    }
+  }
+  ::close( fd );
+  if ( !m_mapped ) return;
+
+  Reader in{static_cast<const char*>( m_mapped ), static_cast<const char*>( m_mapped ) + m_mapSize};
+  try {
+    if ( m_mapSize < sizeof( s_magic ) || std::memcmp( in.pos, s_magic, sizeof( s_magic ) ) != 0 ) return;
+    in.pos += sizeof( s_magic );
+    if ( in.getString() != m_key ) return;
+    for ( auto n = in.get<std::uint32_t>(); n; --n ) {
+      auto  name = in.getString();
+      Entry entry;
+      entry.since = Gaudi::Time( in.get<std::int64_t>() );
+      entry.until = Gaudi::Time( in.get<std::int64_t>() );
+      entry.size  = in.get<std::uint32_t>();
+      entry.data  = in.pos;
+      if ( in.pos + entry.size > in.end ) throw std::out_of_range( "truncated DOM snapshot" );
+      in.pos += entry.size;
+      m_entries[std::move( name )].push_back( std::move( entry ) );
+      ++m_nMapped;
+    }
+  } catch ( const std::out_of_range& ) {
+    // a damaged file is ignored, and replaced by the next write
+    m_entries.clear();
+    m_nMapped = 0;
+  }
+}
+
+XmlDOMSnapshot::~XmlDOMSnapshot() {
+  if ( m_mapped ) ::munmap( m_mapped, m_mapSize );
+}
+
+std::unique_ptr<IOVDOMDocument> XmlDOMSnapshot::restore( const std::string& fileName, const Gaudi::Time& when ) const {
+  const char* data = nullptr;
+  std::size_t size = 0;
+  Gaudi::Time since, until;
+  {
+    std::lock_guard guard{m_mutex};
+    auto            i = m_entries.find( fileName );
+    if ( i == m_entries.end() ) return {};
+    auto e = std::find_if( i->second.begin(), i->second.end(),
+                           [&when]( const Entry& e ) { return e.since <= when && when < e.until; } );
+    if ( e == i->second.end() ) return {};
+    // the entry itself may move when entries are added, but not the data it points to
+    data  = e->data;
+    size  = e->size;
+    since = e->since;
+    until = e->until;
+  }
+
+  static const XMLCh core[] = {xercesc::chLatin_C, xercesc::chLatin_o, xercesc::chLatin_r, xercesc::chLatin_e,
+                               xercesc::chNull};
+  auto doc = std::make_unique<IOVDOMDocument>(
+      xercesc::DOMImplementationRegistry::getDOMImplementation( core )->createDocument() );
+  doc->setValidity( since, until );
+  auto* dom = doc->getDOM();
+
+  Reader                         in{data, data + size};
+  std::vector<xercesc::DOMNode*> parents{dom};
+  try {
+    while ( in.pos < in.end ) {
+      switch ( in.get<std::uint16_t>() ) {
+      case Element: {
+        auto* element = dom->createElement( in.getXMLCh() );
+        for ( auto n = in.get<std::uint32_t>(); n; --n ) {
+          const bool isId  = in.get<std::uint16_t>();
+          const auto name  = in.getXMLCh();
+          const auto value = in.getXMLCh();
+          element->setAttribute( name, value );
+          if ( isId ) element->setIdAttribute( name, true );
+        }
+        parents.back()->appendChild( element );
+        parents.push_back( element );
+        break;
+      }
+      case EndElement:
+        if ( parents.size() < 2 ) throw std::out_of_range( "corrupted DOM snapshot" );
+        parents.pop_back();
+        break;
+      case Text:
+        parents.back()->appendChild( dom->createTextNode( in.getXMLCh() ) );
+        break;
+      case CData:
+        parents.back()->appendChild( dom->createCDATASection( in.getXMLCh() ) );
+        break;
+      default:
+        throw std::out_of_range( "corrupted DOM snapshot" );
+      }
+    }
+  } catch ( const std::out_of_range& ) {
+    // the document is parsed instead
+    return {};
+  }
+  return doc;
+}
+
+void XmlDOMSnapshot::add( const std::string& fileName, const IOVDOMDocument& document ) {
+  Writer out;
+  for ( auto child = document.getDOM()->getFirstChild(); child; child = child->getNextSibling() ) out.putNode( child );
+  Entry entry;
+  entry.since  = document.validSince();
+  entry.until  = document.validTill();
+  entry.buffer = std::make_unique<const std::string>( std::move( out.out ) );
+  entry.data   = entry.buffer->data();
+  entry.size   = entry.buffer->size();
+
+  std::lock_guard guard{m_mutex};
+  auto&           entries = m_entries[fileName];
+  // do not duplicate documents with the same validity
+  if ( std::any_of( entries.begin(), entries.end(), [&entry]( const Entry& e ) {
+         return e.since == entry.since && e.until == entry.until;
+       } ) )
+    return;
+  entries.push_back( std::move( entry ) );
+  ++m_nAdded;
+}
+
+bool XmlDOMSnapshot::write() {
+  std::lock_guard guard{m_mutex};
+  if ( !m_nAdded ) return true;
+
+  Writer      out;
+  std::size_t n = 0;
+  for ( const auto& [name, entries] : m_entries ) n += entries.size();
+  out.out.append( s_magic, sizeof( s_magic ) );
+  out.put( m_key );
+  out.put( static_cast<std::uint32_t>( n ) );
+  for ( const auto& [name, entries] : m_entries ) {
+    for ( const auto& entry : entries ) {
+      out.put( name );
+      out.put( static_cast<std::int64_t>( entry.since.ns() ) );
+      out.put( static_cast<std::int64_t>( entry.until.ns() ) );
+      out.put( static_cast<std::uint32_t>( entry.size ) );
+      out.out.append( entry.data, entry.size );
+    }
+  }
+
+  // write through a temporary file, so that concurrent jobs never see a partial snapshot
+  const std::string tmp = m_path + ".tmp" + std::to_string( ::getpid() );
+  {
+    std::ofstream file( tmp, std::ios::binary );
+    if ( !file.write( out.out.data(), out.out.size() ) ) return false;
+  }
+  if ( std::rename( tmp.c_str(), m_path.c_str() ) != 0 ) return false;
+  m_nAdded = 0;
+  return true;
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef XMLTOOLS_XMLDOMSNAPSHOT_H
+#define XMLTOOLS_XMLDOMSNAPSHOT_H
+
+// Include files
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "GaudiKernel/Time.h"
+
+#include "XmlTools/IOVDOMDocument.h"
+
+/** @class XmlDOMSnapshot XmlDOMSnapshot.h
+ *
+ *  Binary snapshot of parsed XML documents, used by XmlParserSvc to skip the
+ *  parsing (and the validation and the access to the database) of the files
+ *  already parsed by a previous job with the same version of the database.
+ *
+ *  The snapshot file holds, for each file name, the DOM trees of the documents
+ *  parsed from it, with their validity. The strings are stored as XMLCh arrays,
+ *  so that the documents are rebuilt straight from the memory mapped file. The
+ *  attributes of type ID are flagged, so that getElementById works on the
+ *  rebuilt documents as on the parsed ones.
+ *
+ *  The header of the file holds the key of the database version (tags and
+ *  commit ids): a file with a different key is ignored.
+ */
+class XmlDOMSnapshot final {
+public:
+  /// Map the snapshot file with the given key, if it exists.
+  XmlDOMSnapshot( std::string path, std::string key );
+
+  ~XmlDOMSnapshot();
+
+  XmlDOMSnapshot( const XmlDOMSnapshot& ) = delete;
+  XmlDOMSnapshot& operator=( const XmlDOMSnapshot& ) = delete;
+
+  /// Number of documents read from the file.
+  std::size_t size() const { return m_nMapped; }
+
+  /// Rebuild the document of the given file valid at the given time, nullptr if not in the snapshot.
+  std::unique_ptr<IOVDOMDocument> restore( const std::string& fileName, const Gaudi::Time& when ) const;
+
+  /// Add the document just parsed from the given file.
+  void add( const std::string& fileName, const IOVDOMDocument& document );
+
+  /// Write the file if documents were added, returns false in case of failure.
+  bool write();
+
+private:
+  struct Entry {
+    Gaudi::Time                        since, until;
+    const char*                        data = nullptr; ///< serialized DOM tree
+    std::size_t                        size = 0;
+    std::unique_ptr<const std::string> buffer; ///< owner of the data of the documents not read from the file
+  };
+
+  std::string                              m_path;
+  std::string                              m_key;
+  std::map<std::string, std::deque<Entry>> m_entries; ///< documents by file name
+  void*                                    m_mapped  = nullptr;
+  std::size_t                              m_mapSize = 0;
+  std::size_t                              m_nMapped = 0;
+  std::size_t                              m_nAdded  = 0;
+  mutable std::mutex                       m_mutex;
+};
+
+#endif // XMLTOOLS_XMLDOMSNAPSHOT_H
@@ -9,18 +9,27 @@
 * or submit itself to any jurisdiction.                                       *
 \*****************************************************************************/
 // Include Files
+#include <algorithm>
+#include <cstdint>
 #include <limits.h>
 #include <memory>
 
+#include <sys/stat.h>
+
+#include <xercesc/dom/DOMElement.hpp>
 #include <xercesc/dom/DOMException.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
 #include <xercesc/framework/MemBufInputSource.hpp>
 #include <xercesc/parsers/XercesDOMParser.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
+#include <xercesc/util/XMLUniDefs.hpp>
 
 #include "GaudiKernel/IAlgTool.h"
 #include "GaudiKernel/IConverter.h"
 #include "GaudiKernel/IDetDataSvc.h"
+#include "GaudiKernel/IProperty.h"
 #include "GaudiKernel/IToolSvc.h"
+#include "GaudiKernel/Property.h"
 #include "GaudiKernel/Timing.h"
 
 #include "XmlTools/IOVDOMDocument.h"
@@ -40,6 +49,82 @@ DECLARE_COMPONENT( XmlParserSvc )
 #define ON_VERBOSE if ( UNLIKELY( msgLevel( MSG::VERBOSE ) ) )
 #define VERBOSE_MSG ON_VERBOSE verbose()
 
+namespace {
+  /// whether the current thread parses files in the background
+  thread_local bool t_inBackground = false;
+  /// number of warnings and errors of the current background parsing
+  thread_local unsigned int t_nProblems = 0;
+
+  /// helper to convert a Xerces string
+  std::string toStd( const XMLCh* str ) {
+    char*       cString = xercesc::XMLString::transcode( str );
+    std::string result  = cString ? cString : "";
+    xercesc::XMLString::release( &cString );
+    return result;
+  }
+
+  /// The files referenced by the href attributes of the given document, resolved
+  /// as in XmlGenericCnv::createAddressForHref. Only the relative and absolute paths
+  /// are considered, not the URLs and the paths with environment variables.
+  std::vector<std::string> references( const std::string& fileName, const IOVDOMDocument& document ) {
+    static const XMLCh hrefString[] = {xercesc::chLatin_h, xercesc::chLatin_r, xercesc::chLatin_e, xercesc::chLatin_f,
+                                       xercesc::chNull};
+    static const XMLCh anyString[]  = {xercesc::chAsterisk, xercesc::chNull};
+
+    const std::string        dir = fileName.substr( 0, fileName.find_last_of( '/' ) + 1 );
+    std::vector<std::string> files;
+    auto*                    elements = document.getDOM()->getElementsByTagName( anyString );
+    for ( XMLSize_t i = 0; i < elements->getLength(); ++i ) {
+      auto* element = static_cast<xercesc::DOMElement*>( elements->item( i ) );
+      if ( !element->hasAttribute( hrefString ) ) continue;
+      const std::string href = toStd( element->getAttribute( hrefString ) );
+      std::string       location{href, 0, href.find( '#' )};
+      if ( location.empty() || location.find_first_of( ":$\\" ) != std::string::npos ) continue;
+      if ( location[0] != '/' ) location = dir + location;
+      // remove the "parent/../" patterns
+      static const std::string upwardString = "/../";
+      for ( auto pos = location.find( upwardString ); pos != std::string::npos && pos > 0;
+            pos      = location.find( upwardString ) ) {
+        const auto parentDirPos = location.find_last_of( '/', pos - 1 );
+        const auto start        = parentDirPos == std::string::npos ? 0 : parentDirPos + 1;
+        location.erase( start, pos + upwardString.size() - start );
+      }
+      if ( location != fileName && std::find( files.begin(), files.end(), location ) == files.end() ) {
+        files.push_back( std::move( location ) );
+      }
+    }
+    return files;
+  }
+
+  /// FNV-1a hash, used to name the snapshot files
+  std::uint64_t fnv1a( const std::string& str ) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for ( unsigned char c : str ) hash = ( hash ^ c ) * 0x100000001b3ull;
+    return hash;
+  }
+
+  /// Append to key the configuration of the given entity resolver, and of the ones it dispatches to.
+  /// Returns false if the content it resolves cannot be identified (no ICondDBInfo).
+  bool resolverConfiguration( IToolSvc& toolSvc, IAlgTool* tool, std::string& key ) {
+    SmartIF<IProperty> props{tool};
+    if ( !props ) return false;
+    key += tool->type() + '/' + tool->name() + '{';
+    for ( const auto* prop : props->getProperties() ) key += prop->name() + '=' + prop->toString() + ';';
+    key += '}';
+    if ( !props->hasProperty( "EntityResolvers" ) ) return SmartIF<ICondDBInfo>{tool}.isValid();
+    StringArrayProperty names{"EntityResolvers", {}};
+    if ( !props->getProperty( &names ).isSuccess() ) return false;
+    for ( const auto& name : names.value() ) {
+      IAlgTool* resolver = nullptr;
+      if ( !toolSvc.retrieveTool( name, resolver ).isSuccess() ) return false;
+      const bool known = resolverConfiguration( toolSvc, resolver, key );
+      toolSvc.releaseTool( resolver ).ignore();
+      if ( !known ) return false;
+    }
+    return true;
+  }
+} // namespace
+
 //=========================================================================
 //  Initialization
 //=========================================================================
@@ -62,25 +147,22 @@ StatusCode XmlParserSvc::initialize() {
     xercesc::XMLString::release( &message );
   }
 
-  // creates a new XercesDOMParser
-  m_parser = std::make_unique<LHCb::cxx::SynchronizedValue<xercesc::XercesDOMParser>>();
-  // if the creation was successful, sets some properties
-  if ( !m_parser ) {
-    Service::error() << "Could not create xercesc::XercesDOMParser" << endmsg;
-    return StatusCode::FAILURE;
-  }
-  m_parser->with_lock( [&]( xercesc::XercesDOMParser& parser ) {
+  // creates the XercesDOMParsers
+  for ( unsigned int i = 0; i < std::max( 1u, m_nParsers.value() ); ++i ) {
+    auto parser = std::make_unique<xercesc::XercesDOMParser>();
     // sets the error handler to this object
-    parser.setErrorHandler( this );
+    parser->setErrorHandler( this );
     // asks the parser to validate the parsed xml
-    parser.setValidationScheme( xercesc::XercesDOMParser::Val_Auto );
+    parser->setValidationScheme( xercesc::XercesDOMParser::Val_Auto );
     // asks the parser to continue parsing after a fatal error
-    parser.setExitOnFirstFatalError( false );
+    parser->setExitOnFirstFatalError( false );
     // asks the parser to ignore whitespaces when possible
-    parser.setIncludeIgnorableWhitespace( false );
+    parser->setIncludeIgnorableWhitespace( false );
     // asks the parser to avoid the creation of EntityReference nodes
-    parser.setCreateEntityReferenceNodes( false );
-  } );
+    parser->setCreateEntityReferenceNodes( false );
+    m_freeParsers.push_back( parser.get() );
+    m_parsers.push_back( std::move( parser ) );
+  }
 
   if ( !m_resolverName.empty() ) {
     m_toolSvc = service( "ToolSvc", true );
@@ -99,9 +181,37 @@ StatusCode XmlParserSvc::initialize() {
       Service::error() << "Could not get the IXmlEntityResolver interface of" << m_resolverName.value() << endmsg;
       return sc;
     }
-    m_parser->with_lock( &xercesc::XercesDOMParser::setEntityResolver, m_resolver->resolver() );
+    m_serialResolver.target = m_resolver->resolver();
+    for ( auto& parser : m_parsers ) parser->setEntityResolver( &m_serialResolver );
     DEBUG_MSG << "using the xercesc::EntityResolver provided by " << m_resolverName.value() << endmsg;
   }
+
+  if ( !m_snapshotDir.empty() ) {
+    // the snapshot is valid only for the same content of the database, identified by its tags,
+    // and for the same resolvers and mappings (the documents are snapshotted by system id)
+    std::vector<LHCb::CondDBNameTagPair> tags;
+    if ( auto cdbInfo = m_resolver.as<ICondDBInfo>() ) cdbInfo->defaultTags( tags );
+    std::string key;
+    for ( const auto& [db, tag] : tags ) key += db + '=' + tag + ';';
+    if ( key.empty() || key.find( "<files>" ) != std::string::npos ||
+         !resolverConfiguration( *m_toolSvc, m_resolverTool, key ) ) {
+      Service::warning() << "the content of the database cannot be identified from its tags:"
+                         << " snapshot of the parsed documents disabled" << endmsg;
+    } else {
+      ::mkdir( m_snapshotDir.value().c_str(), 0755 );
+      const std::string path = m_snapshotDir.value() + '/' + format( "%016llx", (unsigned long long)fnv1a( key ) ) +
+                               ".domsnapshot";
+      m_snapshot = std::make_unique<XmlDOMSnapshot>( path, key );
+      info() << "using snapshot " << path << " of the parsed documents (" << m_snapshot->size() << " documents)"
+             << endmsg;
+      DEBUG_MSG << "snapshot key: " << key << endmsg;
+    }
+  }
+
+  // starts the background parsing
+  m_stopPrefetch = false;
+  for ( unsigned int i = 1; i < m_parsers.size(); ++i ) m_prefetchThreads.emplace_back( [this]() { prefetchLoop(); } );
+
   return StatusCode::SUCCESS;
 }
 
@@ -109,9 +219,25 @@ StatusCode XmlParserSvc::initialize() {
 //  Finalization
 //=========================================================================
 StatusCode XmlParserSvc::finalize() {
+  // stops the background parsing
+  {
+    std::lock_guard guard{m_cacheMutex};
+    m_stopPrefetch = true;
+    m_prefetchQueue.clear();
+  }
+  m_cacheChanged.notify_all();
+  for ( auto& thread : m_prefetchThreads ) thread.join();
+  m_prefetchThreads.clear();
+
+  if ( m_snapshot ) {
+    if ( !m_snapshot->write() ) Service::warning() << "failed to write the snapshot of the parsed documents" << endmsg;
+    m_snapshot.reset();
+  }
+
   clearCache();
 
-  m_parser.reset();
+  m_freeParsers.clear();
+  m_parsers.clear();
 
   if ( m_toolSvc && m_resolver ) {
     m_resolver.reset();
@@ -151,112 +277,254 @@ IDetDataSvc* XmlParserSvc::detDataSvc() {
 //  Parse
 // -----------------------------------------------------------------------
 IOVDOMDocument* XmlParserSvc::parse( const char* fileName ) {
-
-  // first look in the cache
-  auto it = m_cache.find( fileName );
-  if ( it != m_cache.end() ) {
-    // we found an object in the cache
-    if ( detDataSvc()->validEventTime() ) {
-      // since we have a service that knows the event time,
-      // we can check if the cached item is still valid
-      if ( it->second.document->isValid( detDataSvc()->eventTime() ) ) {
-        // the cached DOM is valid for the current event, so it is what we wanted
-        increaseCacheAge();
-        ++it->second.utility;
-        ++it->second.lock;
-        return it->second.document.get();
-      }
-      // the document is not valid: Try to remove it from the cache
-      if ( !it->second.lock ) {
-        // we can remove the object from the cache
-        m_cache.erase( it );
-      } else {
-        // This should never happen: a document that is not valid cannot be locked!
-        throw GaudiException( "BAD status of XmlParserSvc cache:"
-                              " a cache document is invalid and locked at the same time",
-                              "XmlParserSvc::parse", StatusCode::FAILURE );
+  const bool        validEventTime = detDataSvc()->validEventTime();
+  const Gaudi::Time eventTime      = validEventTime ? detDataSvc()->eventTime() : Gaudi::Time::epoch();
+  {
+    std::unique_lock guard{m_cacheMutex};
+    // if the file is being parsed (e.g. in the background), wait for it
+    m_cacheChanged.wait( guard, [&]() { return !m_inProgress.count( fileName ); } );
+
+    // first look in the cache
+    auto it = m_cache.find( fileName );
+    if ( it != m_cache.end() ) {
+      // we found an object in the cache
+      if ( validEventTime ) {
+        // since we have a service that knows the event time,
+        // we can check if the cached item is still valid
+        if ( it->second.document->isValid( eventTime ) ) {
+          // the cached DOM is valid for the current event, so it is what we wanted
+          increaseCacheAge();
+          ++it->second.utility;
+          ++it->second.lock;
+          it->second.prefetched = false;
+          return it->second.document.get();
+        }
+        // the document is not valid: Try to remove it from the cache
+        if ( !it->second.lock ) {
+          // we can remove the object from the cache
+          m_cache.erase( it );
+        } else {
+          // This should never happen: a document that is not valid cannot be locked!
+          throw GaudiException( "BAD status of XmlParserSvc cache:"
+                                " a cache document is invalid and locked at the same time",
+                                "XmlParserSvc::parse", StatusCode::FAILURE );
+        }
       }
     }
+    m_inProgress.insert( fileName );
   }
-  // There was nothing in the cache, try to parse the file if a parser exists
+
+  // There was nothing in the cache, try to parse the file
+  std::unique_ptr<IOVDOMDocument> document;
+  std::vector<std::string>        refs;
   try {
-    return m_parser ? m_parser->with_lock( [&]( xercesc::XercesDOMParser& parser ) -> IOVDOMDocument* {
-      // resets it
-      parser.reset();
-      // parses the file
-      DEBUG_MSG << "parsing file " << fileName << endmsg;
-      long long start1 = 0;
-      long long start2 = 0;
-      if ( UNLIKELY( m_measureTime ) ) {
-        start1 = System::cpuTime( System::microSec );
-        start2 = System::currentTime( System::microSec );
-      }
+    document = parseFile( fileName );
+    if ( document && !m_prefetchThreads.empty() ) refs = references( fileName, *document );
+  } catch ( ... ) {
+    {
+      std::lock_guard guard{m_cacheMutex};
+      m_inProgress.erase( fileName );
+    }
+    m_cacheChanged.notify_all();
+    throw;
+  }
 
-      xercesc::DOMDocument*                 doc = nullptr;
-      std::unique_ptr<xercesc::InputSource> is;
-      // If we have an entity resolver, we try to use it
-      if ( m_resolver ) {
-        XMLCh* sysId = xercesc::XMLString::transcode( fileName );
-        is.reset( m_resolver->resolver()->resolveEntity( nullptr, sysId ) );
-        xercesc::XMLString::release( &sysId );
-      }
-      if ( is ) { // If the entity resolver succeeded, we parse the InputSource
-        parser.parse( *is );
-      } else { // otherwise try to pass the filename to XercesC
-        parser.parse( fileName );
-      }
-      // get a pointer to the DOM Document and also take the responsibility of
-      // freeing the memory
-      doc = parser.adoptDocument();
-      // if the document is not null, cache it
-      if ( !doc ) return nullptr;
-      std::unique_ptr<IOVDOMDocument> cache_doc{new IOVDOMDocument( doc )};
-      // Try to see if the InputSource knows about validity/
-      ValidInputSource* iov_is = dynamic_cast<ValidInputSource*>( is.get() );
-      if ( iov_is ) { // it does
-        cache_doc->setValidity( iov_is->validSince(), iov_is->validTill() );
-      }
-      auto myDoc = cacheItem( fileName, std::move( cache_doc ) );
-      // returns the parsed document
-      if ( UNLIKELY( m_measureTime ) ) {
-        double cpu1 = .001 * double( System::cpuTime( System::microSec ) - start1 );
-        double cpu2 = .001 * double( System::currentTime( System::microSec ) - start2 );
+  std::lock_guard guard{m_cacheMutex};
+  m_inProgress.erase( fileName );
+  m_cacheChanged.notify_all();
+  // no way to parse the file, returns an empty document
+  if ( !document ) return nullptr;
+  prefetch( std::move( refs ) );
+  return cacheItem( fileName, std::move( document ) );
+}
+
+// -----------------------------------------------------------------------
+//  Parse a file, without caching the document
+// -----------------------------------------------------------------------
+std::unique_ptr<IOVDOMDocument> XmlParserSvc::parseFile( const std::string& fileName ) {
+  // documents already parsed by a previous job on the same database
+  if ( m_snapshot ) {
+    auto document = m_snapshot->restore(
+        fileName, detDataSvc()->validEventTime() ? detDataSvc()->eventTime() : Gaudi::Time::epoch() );
+    if ( document ) {
+      DEBUG_MSG << "restored file " << fileName << " from the snapshot" << endmsg;
+      return document;
+    }
+  }
+
+  // takes a parser from the pool for the duration of the parsing
+  struct ParserLock {
+    XmlParserSvc&             svc;
+    xercesc::XercesDOMParser* parser;
+    ~ParserLock() { svc.releaseParser( parser ); }
+  } lock{*this, acquireParser()};
+  auto& parser = *lock.parser;
+
+  try {
+    // resets it
+    parser.reset();
+    // parses the file
+    DEBUG_MSG << "parsing file " << fileName << endmsg;
+    long long start1 = 0;
+    long long start2 = 0;
+    if ( UNLIKELY( m_measureTime ) ) {
+      start1 = System::cpuTime( System::microSec );
+      start2 = System::currentTime( System::microSec );
+    }
+
+    xercesc::DOMDocument*                 doc = nullptr;
+    std::unique_ptr<xercesc::InputSource> is;
+    // If we have an entity resolver, we try to use it
+    if ( m_resolver ) {
+      XMLCh* sysId = xercesc::XMLString::transcode( fileName.c_str() );
+      is.reset( m_serialResolver.resolveEntity( nullptr, sysId ) );
+      xercesc::XMLString::release( &sysId );
+    }
+    if ( is ) { // If the entity resolver succeeded, we parse the InputSource
+      parser.parse( *is );
+    } else { // otherwise try to pass the filename to XercesC
+      parser.parse( fileName.c_str() );
+    }
+    // get a pointer to the DOM Document and also take the responsibility of
+    // freeing the memory
+    doc = parser.adoptDocument();
+    if ( !doc ) return nullptr;
+    auto document = std::make_unique<IOVDOMDocument>( doc );
+    // Try to see if the InputSource knows about validity/
+    ValidInputSource* iov_is = dynamic_cast<ValidInputSource*>( is.get() );
+    if ( iov_is ) { // it does
+      document->setValidity( iov_is->validSince(), iov_is->validTill() );
+    }
+    // only the documents of the resolvers are identified by the key of the snapshot
+    if ( m_snapshot && is && !( t_inBackground && t_nProblems ) ) m_snapshot->add( fileName, *document );
+    if ( UNLIKELY( m_measureTime ) ) {
+      double cpu1 = .001 * double( System::cpuTime( System::microSec ) - start1 );
+      double cpu2 = .001 * double( System::currentTime( System::microSec ) - start2 );
+      {
+        std::lock_guard guard{m_cacheMutex};
         m_sumCpu += cpu1;
         m_sumClock += cpu2;
-        if ( m_printTime )
-          info() << format( "%7.1f ms user and %7.1f ms clock time for ", cpu1, cpu2 ) << fileName << endmsg;
       }
-      return myDoc;
-    } )
-                    : nullptr;
+      if ( m_printTime )
+        info() << format( "%7.1f ms user and %7.1f ms clock time for ", cpu1, cpu2 ) << fileName << endmsg;
+    }
+    // returns the parsed document
+    return document;
   } catch ( const xercesc::XMLPlatformUtilsException& e ) {
-    char* message = xercesc::XMLString::transcode( e.getMessage() );
-    Service::error() << "Unable to find file " << fileName << ",  Exception message:" << message << endmsg;
-    xercesc::XMLString::release( &message );
+    if ( t_inBackground ) {
+      ++t_nProblems;
+    } else {
+      char* message = xercesc::XMLString::transcode( e.getMessage() );
+      Service::error() << "Unable to find file " << fileName << ",  Exception message:" << message << endmsg;
+      xercesc::XMLString::release( &message );
+    }
   }
   // no way to parse the file, returns an empty document
   return nullptr;
 }
 
+// -----------------------------------------------------------------------
+//  Queue files to be parsed in the background
+// -----------------------------------------------------------------------
+void XmlParserSvc::prefetch( std::vector<std::string> fileNames ) {
+  if ( m_prefetchThreads.empty() || m_stopPrefetch ) return;
+  // do not parse ahead more documents than the cache can hold
+  std::size_t nAhead = m_prefetchQueue.size() + m_inProgress.size() +
+                       std::count_if( m_cache.begin(), m_cache.end(),
+                                      []( cacheType::const_reference i ) { return i.second.prefetched; } );
+  for ( auto& fileName : fileNames ) {
+    if ( nAhead >= m_maxDocNbInCache ) break;
+    if ( m_cache.count( fileName ) || m_inProgress.count( fileName ) ||
+         std::find( m_prefetchQueue.begin(), m_prefetchQueue.end(), fileName ) != m_prefetchQueue.end() )
+      continue;
+    m_prefetchQueue.push_back( std::move( fileName ) );
+    ++nAhead;
+  }
+  m_cacheChanged.notify_all();
+}
+
+// -----------------------------------------------------------------------
+//  Body of the background parsing threads
+// -----------------------------------------------------------------------
+void XmlParserSvc::prefetchLoop() {
+  // the problems are not reported in the background: the documents with problems
+  // are dropped, and parsed again when requested, reporting them
+  t_inBackground = true;
+  std::unique_lock guard{m_cacheMutex};
+  while ( true ) {
+    m_cacheChanged.wait( guard, [this]() { return m_stopPrefetch || !m_prefetchQueue.empty(); } );
+    if ( m_stopPrefetch ) return;
+    auto fileName = std::move( m_prefetchQueue.front() );
+    m_prefetchQueue.pop_front();
+    if ( m_cache.count( fileName ) || m_inProgress.count( fileName ) ) continue;
+    m_inProgress.insert( fileName );
+    guard.unlock();
+
+    std::unique_ptr<IOVDOMDocument> document;
+    std::vector<std::string>        refs;
+    t_nProblems = 0;
+    try {
+      document = parseFile( fileName );
+      if ( document ) refs = references( fileName, *document );
+    } catch ( ... ) { ++t_nProblems; }
+    if ( t_nProblems ) {
+      DEBUG_MSG << "problems parsing " << fileName << " in the background, left for later" << endmsg;
+      document.reset();
+    }
+
+    guard.lock();
+    m_inProgress.erase( fileName );
+    if ( document && !m_cache.count( fileName ) ) {
+      prefetch( std::move( refs ) );
+      cacheItem( std::move( fileName ), std::move( document ), true );
+    }
+    m_cacheChanged.notify_all();
+  }
+}
+
+// -----------------------------------------------------------------------
+//  Pool of parsers
+// -----------------------------------------------------------------------
+xercesc::XercesDOMParser* XmlParserSvc::acquireParser() {
+  std::unique_lock guard{m_parsersMutex};
+  m_parserReleased.wait( guard, [this]() { return !m_freeParsers.empty(); } );
+  auto parser = m_freeParsers.back();
+  m_freeParsers.pop_back();
+  return parser;
+}
+
+void XmlParserSvc::releaseParser( xercesc::XercesDOMParser* parser ) {
+  {
+    std::lock_guard guard{m_parsersMutex};
+    m_freeParsers.push_back( parser );
+  }
+  m_parserReleased.notify_one();
+}
+
 // -----------------------------------------------------------------------
 // Parses an Xml file and provides the DOM tree representing it
 // -----------------------------------------------------------------------
 IOVDOMDocument* XmlParserSvc::parseString( std::string source ) {
   // there is of course no cache for parsing XML strings directly
   // try to parse the string if a parser exists
-  if ( !m_parser ) return nullptr;
-  return m_parser->with_lock( [&]( xercesc::XercesDOMParser& parser ) {
+  if ( m_parsers.empty() ) return nullptr;
+  auto parser = acquireParser();
+  try {
     // resets it
-    parser.reset();
+    parser->reset();
     // builds a new InputSource
     xercesc::MemBufInputSource inputSource( (const XMLByte*)source.data(), source.length(), "" );
     // parses the file
-    parser.parse( inputSource );
+    parser->parse( inputSource );
     if ( msgLevel( MSG::DEBUG ) ) debug() << "parsing xml string..." << endmsg;
-    xercesc::DOMDocument* doc = parser.adoptDocument();
+    xercesc::DOMDocument* doc = parser->adoptDocument();
+    releaseParser( parser );
     // returns the parsed document if successful
     return doc ? new IOVDOMDocument( doc ) : nullptr;
-  } );
+  } catch ( ... ) {
+    releaseParser( parser );
+    throw;
+  }
 }
 
 // -----------------------------------------------------------------------
@@ -265,7 +533,13 @@ IOVDOMDocument* XmlParserSvc::parseString( std::string source ) {
 void XmlParserSvc::clearCache() {
   // remove everything from the cache
   //    first delete the DOM documents
-  m_parser->with_lock( &xercesc::XercesDOMParser::resetDocumentPool );
+  std::vector<xercesc::XercesDOMParser*> parsers;
+  for ( std::size_t i = 0; i < m_parsers.size(); ++i ) parsers.push_back( acquireParser() );
+  for ( auto parser : parsers ) {
+    parser->resetDocumentPool();
+    releaseParser( parser );
+  }
+  std::lock_guard guard{m_cacheMutex};
   //    check the lock status of the cached objects
   for ( auto& i : m_cache ) {
     if ( i.second.lock > 0 ) {
@@ -280,6 +554,7 @@ void XmlParserSvc::clearCache() {
 //  Release the lock for documents in cache
 //=========================================================================
 void XmlParserSvc::releaseDoc( IOVDOMDocument* doc ) {
+  std::lock_guard guard{m_cacheMutex};
   // find the DOMDocument in the cache
   auto it = std::find_if( m_cache.begin(), m_cache.end(),
                           [&]( cacheType::const_reference i ) { return i.second.document.get() == doc; } );
@@ -298,6 +573,11 @@ void XmlParserSvc::releaseDoc( IOVDOMDocument* doc ) {
 //  Implementations of the SAX ErrorHandler interface
 // -----------------------------------------------------------------------
 void XmlParserSvc::warning( const xercesc::SAXParseException& exception ) {
+  // problems in the background parsing are reported when the file is parsed again
+  if ( t_inBackground ) {
+    ++t_nProblems;
+    return;
+  }
 
   char* aSysId = xercesc::XMLString::transcode( exception.getSystemId() );
   char* aMsg   = xercesc::XMLString::transcode( exception.getMessage() );
@@ -312,6 +592,11 @@ void XmlParserSvc::warning( const xercesc::SAXParseException& exception ) {
 //  Implementations of the SAX ErrorHandler interface
 // -----------------------------------------------------------------------
 void XmlParserSvc::error( const xercesc::SAXParseException& exception ) {
+  // problems in the background parsing are reported when the file is parsed again
+  if ( t_inBackground ) {
+    ++t_nProblems;
+    return;
+  }
 
   char* aSysId = xercesc::XMLString::transcode( exception.getSystemId() );
   char* aMsg   = xercesc::XMLString::transcode( exception.getMessage() );
@@ -326,6 +611,11 @@ void XmlParserSvc::error( const xercesc::SAXParseException& exception ) {
 //  Implementations of the SAX ErrorHandler interface
 // -----------------------------------------------------------------------
 void XmlParserSvc::fatalError( const xercesc::SAXParseException& exception ) {
+  // problems in the background parsing are reported when the file is parsed again
+  if ( t_inBackground ) {
+    ++t_nProblems;
+    return;
+  }
 
   char* aSysId = xercesc::XMLString::transcode( exception.getSystemId() );
   char* aMsg   = xercesc::XMLString::transcode( exception.getMessage() );
@@ -345,7 +635,8 @@ void XmlParserSvc::resetErrors() {}
 // -----------------------------------------------------------------------
 // CacheItem
 // -----------------------------------------------------------------------
-IOVDOMDocument* XmlParserSvc::cacheItem( std::string fileName, std::unique_ptr<IOVDOMDocument> document ) {
+IOVDOMDocument* XmlParserSvc::cacheItem( std::string fileName, std::unique_ptr<IOVDOMDocument> document,
+                                         bool prefetched ) {
   // first increase the cache age
   increaseCacheAge();
 
@@ -353,16 +644,22 @@ IOVDOMDocument* XmlParserSvc::cacheItem( std::string fileName, std::unique_ptr<I
   if ( m_maxDocNbInCache <= m_cache.size() ) {
     // the cache is full, scan the elements and find the minimum for
     // birthDate+cacheBehavior*utility
+    // (the documents parsed in the background and not yet used are removed last)
     unsigned long smallestScore = ULONG_MAX; // highest possible value
     auto          winner        = m_cache.end();
-    for ( auto it = m_cache.begin(); it != m_cache.end(); ++it ) {
-      unsigned long score = it->second.birthDate + m_cacheBehavior * it->second.utility;
-      if ( score < smallestScore && it->second.lock == 0 ) {
-        smallestScore = score;
-        winner        = it;
+    for ( bool pass : {false, true} ) {
+      for ( auto it = m_cache.begin(); it != m_cache.end(); ++it ) {
+        unsigned long score = it->second.birthDate + m_cacheBehavior * it->second.utility;
+        if ( score < smallestScore && it->second.lock == 0 && it->second.prefetched == pass ) {
+          smallestScore = score;
+          winner        = it;
+        }
       }
+      if ( m_cache.end() != winner ) break;
     }
     if ( m_cache.end() == winner ) {
+      // a document parsed in the background is not worth a larger cache
+      if ( prefetched ) return nullptr;
       // This means that the cache is too small: increase it
       Service::warning() << "The cache is full and I cannot delete anything: I increase the max size to "
                          << ++m_maxDocNbInCache << endmsg;
@@ -376,9 +673,10 @@ IOVDOMDocument* XmlParserSvc::cacheItem( std::string fileName, std::unique_ptr<I
   cachedItem newItem;
   newItem.birthDate = m_cacheAge;
   if ( fileName.find( "/Conditions/" ) != std::string::npos ) newItem.birthDate += 1000; // Prefer conditions!
-  newItem.utility  = 0;
-  newItem.lock     = 1;
-  newItem.document = std::move( document );
+  newItem.utility    = 0;
+  newItem.lock       = prefetched ? 0 : 1;
+  newItem.prefetched = prefetched;
+  newItem.document   = std::move( document );
   auto c           = m_cache.emplace( fileName, std::move( newItem ) );
   return c.first->second.document.get();
 }
@@ -12,8 +12,16 @@
 #define DETDESCCNV_XMLPARSERSVC_H
 
 // Include files
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
+#include <xercesc/sax/EntityResolver.hpp>
 #include <xercesc/sax/ErrorHandler.hpp>
 #include <xercesc/sax/SAXParseException.hpp>
 
@@ -21,9 +29,10 @@
 #include "GaudiKernel/Service.h"
 
 #include "Kernel/ICondDBInfo.h"
-#include "Kernel/SynchronizedValue.h"
 #include "XmlTools/IXmlParserSvc.h"
 
+#include "XmlDOMSnapshot.h"
+
 // Forward and external declarations
 struct IXmlEntityResolver;
 class IDetDataSvc;
@@ -35,6 +44,16 @@ class IAlgTool;
  * A parsing service for Xml files. Besides pure parsing, it also sperforms
  * some caching.
  *
+ * With more than one parser (option NumberOfParsers), the extra parsers parse
+ * in the background the files referenced (href attributes) by the parsed
+ * documents, so that the files of the sub-catalogs, detector elements and
+ * logical volumes are already in the cache when they are converted.
+ *
+ * With a SnapshotDirectory, the parsed documents are also stored in a binary
+ * snapshot keyed by the tags of the database (e.g. the commit used by the
+ * GitEntityResolver), from which the next jobs with the same tags rebuild the
+ * documents without parsing the XML.
+ *
  * @author Sebastien Ponce
  * @author Marco Clemencic
  */
@@ -146,8 +165,9 @@ private:
    * item if the cache was full
    * @param fileName the name of the file that was just parsed
    * @param document the document that is the result of the parsing
+   * @param prefetched true for the documents parsed in the background (not locked)
    */
-  IOVDOMDocument* cacheItem( std::string fileName, std::unique_ptr<IOVDOMDocument> document );
+  IOVDOMDocument* cacheItem( std::string fileName, std::unique_ptr<IOVDOMDocument> document, bool prefetched = false );
 
   /**
    * this only increases the age of the cache.
@@ -159,8 +179,34 @@ private:
   /// Return the pointer to the detector data service (loading it if not yet done).
   IDetDataSvc* detDataSvc();
 
+  /// Parse the given file (or restore it from the snapshot), without caching the document.
+  std::unique_ptr<IOVDOMDocument> parseFile( const std::string& fileName );
+
+  /// Queue the given files (referenced by a document just parsed), to be parsed in the background.
+  /// Must be called with m_cacheMutex held.
+  void prefetch( std::vector<std::string> fileNames );
+
+  /// Body of the threads parsing the files in the background.
+  void prefetchLoop();
+
+  /// Take a parser from the pool, waiting for one to be available.
+  xercesc::XercesDOMParser* acquireParser();
+
+  /// Give back a parser to the pool.
+  void releaseParser( xercesc::XercesDOMParser* parser );
+
+  /// The entity resolver used by all the parsers, serializing the calls to the one of the tool.
+  struct SerialEntityResolver final : xercesc::EntityResolver {
+    xercesc::InputSource* resolveEntity( const XMLCh* const publicId, const XMLCh* const systemId ) override {
+      std::lock_guard guard{mutex};
+      return target->resolveEntity( publicId, systemId );
+    }
+    xercesc::EntityResolver* target = nullptr;
+    std::mutex               mutex;
+  };
+
 private:
-  /// the actual DOM parser
+  /// the actual DOM parsers
   //
   // from https://xerces.apache.org/xerces-c/faq-parse-3.html#faq-6:
   // Within an address space, an instance of the parser may be used without
@@ -168,9 +214,53 @@ private:
   // accessed from multiple threads, provided the application guarantees that
   // only one thread has entered a method of the parser at any one time.
   //
-  // i.e. we need to protect the parser with a mutex...
+  // i.e. each parser is used by one thread at a time, taken from a pool...
   //
-  std::unique_ptr<LHCb::cxx::SynchronizedValue<xercesc::XercesDOMParser>> m_parser;
+  std::vector<std::unique_ptr<xercesc::XercesDOMParser>> m_parsers;
+
+  /// the parsers not in use
+  std::vector<xercesc::XercesDOMParser*> m_freeParsers;
+
+  /// guard of the pool of parsers
+  std::mutex m_parsersMutex;
+
+  /// notified when a parser is given back to the pool
+  std::condition_variable m_parserReleased;
+
+  /// Number of parsers, the ones beyond the first parse ahead the referenced files.
+  Gaudi::Property<unsigned int> m_nParsers{
+      this, "NumberOfParsers", 1,
+      "Number of XML parsers. With more than one, the files referenced by the parsed documents are parsed "
+      "in the background by NumberOfParsers - 1 threads"};
+
+  /// threads parsing the referenced files in the background
+  std::vector<std::thread> m_prefetchThreads;
+
+  /// files to parse in the background
+  std::deque<std::string> m_prefetchQueue;
+
+  /// files being parsed
+  std::set<std::string> m_inProgress;
+
+  /// notified when the prefetch queue or the cache change
+  std::condition_variable m_cacheChanged;
+
+  /// flag telling the background threads to stop
+  bool m_stopPrefetch = false;
+
+  /// guard of the cache, of the prefetch queue and of the timing counters
+  std::mutex m_cacheMutex;
+
+  /// the entity resolver given to the parsers
+  SerialEntityResolver m_serialResolver;
+
+  /// Directory of the snapshots of the parsed documents.
+  Gaudi::Property<std::string> m_snapshotDir{
+      this, "SnapshotDirectory", "",
+      "Directory of the binary snapshots of the parsed documents, keyed by the database tags (empty to disable)"};
+
+  /// Snapshot of the parsed documents for the current database tags.
+  std::unique_ptr<XmlDOMSnapshot> m_snapshot;
 
   /**
    * this is a parameter that defines the cache behavior.
@@ -193,6 +283,7 @@ private:
     std::unique_ptr<IOVDOMDocument> document;
     unsigned int                    birthDate, utility;
     int                             lock;
+    bool                            prefetched = false; ///< parsed in the background and not yet used
   };
 
   /**
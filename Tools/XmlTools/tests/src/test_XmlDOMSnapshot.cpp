@@ -0,0 +1,168 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_XmlDOMSnapshot
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "../../src/component/XmlDOMSnapshot.h"
+
+#include <xercesc/dom/DOMElement.hpp>
+#include <xercesc/framework/MemBufInputSource.hpp>
+#include <xercesc/parsers/XercesDOMParser.hpp>
+#include <xercesc/util/PlatformUtils.hpp>
+#include <xercesc/util/XMLString.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  const std::string s_xml = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!DOCTYPE DDDB [
+<!ELEMENT DDDB (condition*)>
+<!ELEMENT condition (param*)>
+<!ATTLIST condition name ID #REQUIRED classID CDATA "6">
+<!ELEMENT param (#PCDATA)>
+<!ATTLIST param name CDATA #REQUIRED type CDATA "double">
+]>
+<DDDB>
+  <!-- comments are not kept -->
+  <condition name="Alignment">
+    <param name="dPosXYZ">0 1.5 -2</param>
+    <param name="pivotXYZ" type="other">0.0 0.0 0.0</param>
+  </condition>
+  <condition name="Text"><param name="text"><![CDATA[a <b> & c]]></param></condition>
+</DDDB>
+)";
+
+  /// parse the test document, without its comments which are not kept by the snapshot
+  std::unique_ptr<IOVDOMDocument> parse( const Gaudi::Time& since, const Gaudi::Time& until ) {
+    xercesc::XercesDOMParser parser;
+    parser.setValidationScheme( xercesc::XercesDOMParser::Val_Auto );
+    xercesc::MemBufInputSource source( reinterpret_cast<const XMLByte*>( s_xml.data() ), s_xml.size(), "test.xml" );
+    parser.parse( source );
+    auto doc = std::make_unique<IOVDOMDocument>( parser.adoptDocument() );
+    doc->setValidity( since, until );
+    auto* element = doc->getDOM()->getDocumentElement();
+    for ( auto child = element->getFirstChild(); child; ) {
+      auto next = child->getNextSibling();
+      if ( child->getNodeType() == xercesc::DOMNode::COMMENT_NODE ) element->removeChild( child )->release();
+      child = next;
+    }
+    return doc;
+  }
+
+  /// same content as the freshly parsed document
+  bool sameContent( const IOVDOMDocument& restored, const IOVDOMDocument& parsed ) {
+    return restored.getDOM()->getDocumentElement()->isEqualNode( parsed.getDOM()->getDocumentElement() ) &&
+           restored.validSince() == parsed.validSince() && restored.validTill() == parsed.validTill();
+  }
+
+  struct XercesInit {
+    XercesInit() { xercesc::XMLPlatformUtils::Initialize(); }
+    ~XercesInit() { xercesc::XMLPlatformUtils::Terminate(); }
+  };
+
+  struct Fixture {
+    const std::string path = ( boost::filesystem::temp_directory_path() /
+                               boost::filesystem::unique_path( "test_XmlDOMSnapshot-%%%%%%%%.domsnapshot" ) )
+                                 .string();
+    ~Fixture() { boost::filesystem::remove( path ); }
+  };
+} // namespace
+
+BOOST_GLOBAL_FIXTURE( XercesInit );
+
+BOOST_FIXTURE_TEST_CASE( round_trip, Fixture ) {
+  const Gaudi::Time since( 1000 ), until( 2000 );
+  {
+    XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+    BOOST_CHECK_EQUAL( snapshot.size(), 0u );
+    snapshot.add( "conddb:/Conditions/test.xml", *parse( since, until ) );
+    BOOST_CHECK( snapshot.write() );
+  }
+
+  const XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+  BOOST_CHECK_EQUAL( snapshot.size(), 1u );
+
+  const auto restored = snapshot.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 1500 ) );
+  BOOST_REQUIRE( restored );
+  BOOST_CHECK( sameContent( *restored, *parse( since, until ) ) );
+
+  // the attributes of type ID are still known as such
+  XMLCh* id = xercesc::XMLString::transcode( "Alignment" );
+  BOOST_CHECK( restored->getDOM()->getElementById( id ) );
+  xercesc::XMLString::release( &id );
+
+  // outside the validity, or for another file
+  BOOST_CHECK( !snapshot.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 2000 ) ) );
+  BOOST_CHECK( !snapshot.restore( "conddb:/Conditions/other.xml", Gaudi::Time( 1500 ) ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( other_key, Fixture ) {
+  {
+    XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+    snapshot.add( "conddb:/Conditions/test.xml", *parse( Gaudi::Time( 0 ), Gaudi::Time( 10 ) ) );
+    BOOST_CHECK( snapshot.write() );
+  }
+  const XmlDOMSnapshot snapshot( path, "DDDB=v2;" );
+  BOOST_CHECK_EQUAL( snapshot.size(), 0u );
+  BOOST_CHECK( !snapshot.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 5 ) ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( restore_while_adding, Fixture ) {
+  // documents of the same file are added while others are restored, as done by several parsers
+  constexpr int  nDocuments = 200;
+  XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+  snapshot.add( "conddb:/Conditions/test.xml", *parse( Gaudi::Time( 0 ), Gaudi::Time( 10 ) ) );
+
+  std::atomic<bool> done{false};
+  std::atomic<int>  nBad{0};
+  auto              reader = [&]() {
+    const auto reference = parse( Gaudi::Time( 0 ), Gaudi::Time( 10 ) );
+    while ( !done ) {
+      const auto restored = snapshot.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 5 ) );
+      if ( !restored || !sameContent( *restored, *reference ) ) ++nBad;
+    }
+  };
+  std::vector<std::thread> readers;
+  for ( int i = 0; i < 3; ++i ) readers.emplace_back( reader );
+  for ( int i = 1; i < nDocuments; ++i ) {
+    snapshot.add( "conddb:/Conditions/test.xml", *parse( Gaudi::Time( 10 * i ), Gaudi::Time( 10 * ( i + 1 ) ) ) );
+  }
+  done = true;
+  for ( auto& thread : readers ) thread.join();
+  BOOST_CHECK_EQUAL( nBad.load(), 0 );
+
+  BOOST_CHECK( snapshot.write() );
+  const XmlDOMSnapshot restored( path, "DDDB=v1;" );
+  BOOST_CHECK_EQUAL( restored.size(), std::size_t( nDocuments ) );
+  BOOST_CHECK( restored.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 10 * nDocuments - 5 ) ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( truncated, Fixture ) {
+  {
+    XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+    snapshot.add( "conddb:/Conditions/test.xml", *parse( Gaudi::Time( 0 ), Gaudi::Time( 10 ) ) );
+    BOOST_CHECK( snapshot.write() );
+  }
+  // a damaged file, down to a part of the magic number, is ignored
+  for ( auto size = boost::filesystem::file_size( path ); size > 1; ) {
+    size = size > 64 ? size - 17 : size - 1;
+    boost::filesystem::resize_file( path, size );
+    const XmlDOMSnapshot snapshot( path, "DDDB=v1;" );
+    BOOST_CHECK_EQUAL( snapshot.size(), 0u );
+    BOOST_CHECK( !snapshot.restore( "conddb:/Conditions/test.xml", Gaudi::Time( 5 ) ) );
+  }
+}
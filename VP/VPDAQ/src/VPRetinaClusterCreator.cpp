@@ -15,8 +15,11 @@
 // Rec
 #include "VPKernel/PixelUtils.h"
 
+#include "LHCbMath/SIMDWrapper.h"
+
 // Local
 #include "VPRetinaClusterCreator.h"
+#include "VPRetinaPhiSort.h"
 #include <iomanip>
 
 using namespace LHCb;
@@ -133,6 +136,51 @@ namespace {
   // There are 256 patterns and there can be at most two
   // distinct clusters in an SP.
   static const std::array<SPCache, 256> s_SPCaches = create_SPPatterns();
+
+  using simd = SIMDWrapper::best::types;
+
+  //=========================================================================
+  // Clusters of isolated super pixels as offsets to the super pixel address.
+  // The cluster word is ( sp_col << 15 ) + ( sp_row << 5 ) + offset.
+  //=========================================================================
+  struct SPClusterTable {
+    std::array<int, 256> first{};
+    std::array<int, 256> second{};
+    std::array<int, 256> count{};
+  };
+  auto create_SPClusterTable() {
+    SPClusterTable table;
+    for ( unsigned int sp = 1; sp < 256; ++sp ) {
+      const auto& spcache = s_SPCaches[sp];
+      const int   idx     = spcache.pattern;
+      table.first[sp]     = ( ( ( ( ( idx >> 2 ) & 1 ) << 3 ) + int( spcache.fxy[0] * 8 ) ) << 11 ) |
+                        ( ( ( idx & 3 ) << 3 ) + int( spcache.fxy[1] * 8 ) );
+      if ( idx & 8 ) {
+        table.second[sp] = ( ( ( ( ( idx >> 6 ) & 1 ) << 3 ) + int( spcache.fxy[2] * 8 ) ) << 11 ) |
+                           ( ( ( ( idx >> 4 ) & 3 ) << 3 ) + int( spcache.fxy[3] * 8 ) );
+      }
+      table.count[sp] = ( idx & 8 ) ? 2 : 1;
+    }
+    return table;
+  }
+  static const SPClusterTable s_SPClusters = create_SPClusterTable();
+
+  //=========================================================================
+  // Clusters of a batch of simd::size super pixels. For isolated ones the
+  // clustering boils down to a simple pattern look up, and their number of
+  // clusters is returned. The count is 0 for the others.
+  //=========================================================================
+  void isolatedSPClusters( const uint32_t* sp_words, int* first, int* second, int* counts ) {
+    const simd::int_v word{reinterpret_cast<const int*>( sp_words )};
+    // the highest bit is set for super pixels without neighbours
+    const auto        isolated = word < simd::int_v{0};
+    const simd::int_v sp       = word & simd::int_v{0xFF};
+    const simd::int_v sp_addr  = ( word >> 8 ) & simd::int_v{0x7FFF};
+    const simd::int_v base     = ( ( sp_addr >> 6 ) << 15 ) + ( ( sp_addr & simd::int_v{0x3F} ) << 5 );
+    ( base + gather( s_SPClusters.first.data(), sp ) ).store( first );
+    ( base + gather( s_SPClusters.second.data(), sp ) ).store( second );
+    select( isolated, gather( s_SPClusters.count.data(), sp ), simd::int_v{0} ).store( counts );
+  }
 } // namespace
 
 //=============================================================================
@@ -250,10 +298,23 @@ LHCb::RawEvent VPRetinaClusterCreator::operator()( const LHCb::RawEvent& rawEven
     return result;
   }
 
-  LHCb::VPRetinaClusters toSortClusters;
-
   debug() << "Read " << tBanks.size() << " raw banks from TES" << endmsg;
 
+  // buffers for the whole event, sized from the number of super pixels of the largest module
+  std::size_t maxModuleSP = 0, moduleSP = 0;
+  for ( auto iterBank : tBanks ) {
+    moduleSP += *iterBank->data();
+    if ( iterBank->sourceID() % VP::NSensorsPerModule == VP::NSensorsPerModule - 1 ) {
+      maxModuleSP = std::max( maxModuleSP, moduleSP );
+      moduleSP    = 0;
+    }
+  }
+  VPRetina::ModuleClusters moduleClusters;
+  moduleClusters.reserve( 2 * std::max( maxModuleSP, moduleSP ) );
+  std::vector<VPRetinaMatrix> retinas;
+  retinas.reserve( 20 );
+  std::vector<uint32_t> sortedClusters;
+
   unsigned int nBanks = 0;
 
   // Loop over VP RawBanks
@@ -265,55 +326,40 @@ LHCb::RawEvent VPRetinaClusterCreator::operator()( const LHCb::RawEvent& rawEven
 
     const float* ltg = m_ltg + 16 * sensor;
 
-    const uint32_t* bank = iterBank->data();
-
-    auto retinaClusters = makeRetinaClusters( bank );
+    const std::size_t first = moduleClusters.words.size();
+    makeRetinaClusters( iterBank->data(), moduleClusters.words, retinas );
+    moduleClusters.gx.resize( moduleClusters.words.size() );
+    moduleClusters.gy.resize( moduleClusters.words.size() );
 
-    for ( auto iterCluster : retinaClusters ) {
-      const uint32_t cx = iterCluster >> 14 & 0x3FF;
-      const float    fx = ( ( iterCluster >> 11 ) & 0x7 ) / 8.;
-      const uint32_t cy = ( iterCluster >> 3 ) & 0xFF;
-      const float    fy = ( iterCluster & 0x7 ) / 8.;
+    for ( std::size_t i = first; i < moduleClusters.words.size(); ++i ) {
+      const uint32_t word = moduleClusters.words[i];
+      const uint32_t cx   = word >> 14 & 0x3FF;
+      const float    fx   = ( ( word >> 11 ) & 0x7 ) / 8.;
+      const uint32_t cy   = ( word >> 3 ) & 0xFF;
+      const float    fy   = ( word & 0x7 ) / 8.;
 
       const float local_x = m_local_x[cx] + fx * m_x_pitch[cx];
       const float local_y = ( cy + 0.5 + fy ) * m_pixel_size;
 
-      // gx
-      const float gx = ( ltg[0] * local_x + ltg[1] * local_y + ltg[9] );
-      // gy
-      const float gy = ( ltg[3] * local_x + ltg[4] * local_y + ltg[10] );
-      // phi
-      float tan = gy / gx;
-
-      toSortClusters.push_back( LHCb::VPRetinaCluster( iterCluster + ( sensorID_in_module << 24 ), gx, gy, tan ) );
+      moduleClusters.words[i] = word + ( sensorID_in_module << 24 );
+      moduleClusters.gx[i]    = ( ltg[0] * local_x + ltg[1] * local_y + ltg[9] );
+      moduleClusters.gy[i]    = ( ltg[3] * local_x + ltg[4] * local_y + ltg[10] );
     }
 
     if ( sensorID_in_module == VP::NSensorsPerModule - 1 ) {
 
       const bool odd = ( module - 1 ) % 2 == 1;
 
-      std::stable_sort( toSortClusters.begin(), toSortClusters.end(),
-                        [&odd]( const LHCb::VPRetinaCluster& a, const LHCb::VPRetinaCluster& b ) {
-                          // sorting in phi for even modules
-                          return (
-                              // odd modules, change in y value
-                              ( odd && ( a.gy() < 0.f && b.gy() > 0.f ) ) ||
-                              // or even modules, change in y value, but swap logic
-                              ( !odd && ( a.gy() > 0.f && b.gy() < 0.f ) ) ||
-                              // same y side even and odd modules, check y1/x1 < y2/x2
-                              ( ( a.gy() * b.gy() ) > 0.f && ( a.gy() * b.gx() < b.gy() * a.gx() ) ) );
-                        } );
-
-      std::vector<uint32_t> sortedClusters;
-      sortedClusters.reserve( toSortClusters.size() + 1 );
-      sortedClusters.push_back( toSortClusters.size() );
-      for ( auto iterCluster : toSortClusters ) sortedClusters.push_back( iterCluster.word() );
+      sortedClusters.clear();
+      sortedClusters.reserve( moduleClusters.words.size() + 1 );
+      sortedClusters.push_back( moduleClusters.words.size() );
+      VPRetina::sortInPhi( moduleClusters, odd, sortedClusters );
 
       result.addBank( module, LHCb::RawBank::VPRetinaCluster, m_bankVersion, sortedClusters );
 
       ++nBanks;
 
-      toSortClusters.clear();
+      moduleClusters.clear();
     }
 
   } // loop over all banks
@@ -326,74 +372,55 @@ LHCb::RawEvent VPRetinaClusterCreator::operator()( const LHCb::RawEvent& rawEven
 //=============================================================================
 // make RetinaClusters from bank
 //=============================================================================
-std::vector<uint32_t> VPRetinaClusterCreator::makeRetinaClusters( const uint32_t* bank ) const {
+void VPRetinaClusterCreator::makeRetinaClusters( const uint32_t* bank, std::vector<uint32_t>& clusters,
+                                                 std::vector<VPRetinaMatrix>& retinas ) const {
   const uint32_t nsp = *bank++;
 
-  std::vector<VPRetinaMatrix> RetinaMatrixVector;
-  RetinaMatrixVector.reserve( 20 );
-  std::vector<uint32_t> RetinaCluster;
-
-  // Read super pixel
-  for ( unsigned int i = 0; i < nsp; ++i ) {
-    const uint32_t sp_word = *bank++;
-
-    uint8_t sp = sp_word & 0xFFU;
-
-    if ( 0 == sp ) continue; // protect against zero super pixels.
-
-    const uint32_t sp_addr          = ( sp_word & 0x007FFF00U ) >> 8;
-    const uint32_t sp_row           = sp_addr & 0x3FU;
-    const uint32_t sp_col           = ( sp_addr >> 6 );
-    const uint32_t no_sp_neighbours = sp_word & 0x80000000U;
-
-    // if a super pixel is isolated the clustering boils
-    // down to a simple pattern look up.
-    if ( no_sp_neighbours ) {
-
-      // there is always at least one cluster in the super
-      // pixel. look up the pattern and add it.
-
-      // remove after caches rewrite
-      const auto&    spcache = s_SPCaches[sp];
-      const uint32_t idx     = spcache.pattern;
-
-      const uint32_t row = idx & 0x03U;
-      const uint32_t col = ( idx >> 2 ) & 1;
-
-      const uint64_t cX = ( ( sp_col * 2 + col ) << 3 ) + ( uint64_t )( spcache.fxy[0] * 8 );
-      const uint64_t cY = ( ( sp_row * 4 + row ) << 3 ) + ( uint64_t )( spcache.fxy[1] * 8 );
+  retinas.clear();
 
-      RetinaCluster.push_back( cX << 11 | cY );
-      if ( idx & 8 ) {
-        const uint32_t row = ( idx >> 4 ) & 3;
-        const uint32_t col = ( idx >> 6 ) & 1;
-
-        const uint64_t cX = ( ( sp_col * 2 + col ) << 3 ) + ( uint64_t )( spcache.fxy[2] * 8 );
-        const uint64_t cY = ( ( sp_row * 4 + row ) << 3 ) + ( uint64_t )( spcache.fxy[3] * 8 );
+  // isolated super pixels give at most 2 clusters each
+  std::size_t nClusters = clusters.size();
+  clusters.resize( nClusters + 2 * nsp );
 
-        RetinaCluster.push_back( cX << 11 | cY );
-      }
-
-      continue;
+  // Read super pixels by batches, isolated ones being clustered by pattern look up
+  alignas( 64 ) std::array<int, simd::size> firstWords, secondWords, counts;
+  alignas( 64 ) std::array<uint32_t, simd::size> tail{};
+  for ( unsigned int i = 0; i < nsp; i += simd::size ) {
+    const uint32_t* sp_words = bank + i;
+    if ( i + simd::size > nsp ) {
+      std::copy( sp_words, bank + nsp, tail.begin() );
+      sp_words = tail.data();
     }
-
-    // this one is not isolated, we fill a Retina
-
-    // we look for already created Retina
-    auto iterRetina = std::find_if( RetinaMatrixVector.begin(), RetinaMatrixVector.end(),
-                                    [&]( const VPRetinaMatrix& m ) { return m.IsInRetina( sp_row, sp_col ); } );
-    if ( iterRetina != RetinaMatrixVector.end() ) {
-      ( *iterRetina ).AddSP( sp_row, sp_col, sp );
-    } else {
-      RetinaMatrixVector.emplace_back( sp_row, sp_col, sp );
+    isolatedSPClusters( sp_words, firstWords.data(), secondWords.data(), counts.data() );
+
+    for ( unsigned int j = 0; j < simd::size && i + j < nsp; ++j ) {
+      // branchless for isolated super pixels, count being 0 otherwise
+      clusters[nClusters]     = firstWords[j];
+      clusters[nClusters + 1] = secondWords[j];
+      nClusters += counts[j];
+      if ( counts[j] ) continue;
+
+      const uint32_t sp_word = sp_words[j];
+      const uint8_t  sp      = sp_word & 0xFFU;
+      if ( 0 == sp ) continue; // protect against zero super pixels.
+
+      // this one is not isolated, we fill a Retina
+      const uint32_t sp_addr = ( sp_word & 0x007FFF00U ) >> 8;
+      const uint32_t sp_row  = sp_addr & 0x3FU;
+      const uint32_t sp_col  = ( sp_addr >> 6 );
+
+      // we look for already created Retina
+      auto iterRetina = std::find_if( retinas.begin(), retinas.end(),
+                                      [&]( const VPRetinaMatrix& m ) { return m.IsInRetina( sp_row, sp_col ); } );
+      if ( iterRetina != retinas.end() ) {
+        ( *iterRetina ).AddSP( sp_row, sp_col, sp );
+      } else {
+        retinas.emplace_back( sp_row, sp_col, sp );
+      }
     }
   } // loop over super pixels in raw bank
+  clusters.resize( nClusters );
 
   // searchRetinaCluster
-  for ( auto& m : RetinaMatrixVector ) {
-    const auto& clusters = m.SearchCluster();
-    RetinaCluster.insert( end( RetinaCluster ), begin( clusters ), end( clusters ) );
-  };
-
-  return RetinaCluster;
+  for ( auto& m : retinas ) m.SearchCluster( clusters );
 }
@@ -29,7 +29,6 @@
 #include "VPKernel/VeloPixelInfo.h"
 
 // local
-#include "VPRetinaCluster.h"
 #include "VPRetinaMatrix.h"
 
 /** @class VPRetinaClusterCreator VPRetinaClusterCreator.h
@@ -74,8 +73,9 @@ private:
   /// bank version. (change this every time semantics change!)
   const unsigned int m_bankVersion = 1;
 
-  /// make RetinaClusters from bank
-  std::vector<uint32_t> makeRetinaClusters( const uint32_t* bank ) const;
+  /// make RetinaClusters from bank, appending them to clusters. retinas is a buffer for the non isolated super pixels
+  void makeRetinaClusters( const uint32_t* bank, std::vector<uint32_t>& clusters,
+                           std::vector<VPRetinaMatrix>& retinas ) const;
 
   /// Recompute the geometry in case of change
   StatusCode rebuildGeometry();
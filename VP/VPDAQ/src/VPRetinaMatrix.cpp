@@ -68,10 +68,7 @@ void VPRetinaMatrix::AddSP( uint32_t SP_row, uint32_t SP_col, uint8_t SP_pixel )
 // Search cluster
 //=============================================================================
 
-std::vector<uint32_t> VPRetinaMatrix::SearchCluster() const {
-  std::vector<uint32_t> RetinaCluster;
-  RetinaCluster.reserve( 63 );
-
+void VPRetinaMatrix::SearchCluster( std::vector<uint32_t>& RetinaCluster ) const {
   for ( unsigned int iX = 1; iX < 10 - 2; ++iX )
     for ( unsigned int iY = 1; iY < 12 - 2; ++iY ) {
       if ( ( ( Pixel_Matrix[iY][iX] == 1 ) |
@@ -95,5 +92,4 @@ std::vector<uint32_t> VPRetinaMatrix::SearchCluster() const {
         RetinaCluster.push_back( cX << 11 | cY );
       }
     }
-  return RetinaCluster;
 }
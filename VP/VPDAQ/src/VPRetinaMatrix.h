@@ -41,8 +41,8 @@ public:
   /// Add a SP to the Retina
   void AddSP( uint32_t SP_row, uint32_t SP_col, uint8_t SP_pixel );
 
-  /// Search cluster
-  std::vector<uint32_t> SearchCluster() const;
+  /// Search cluster, appending them to RetinaCluster
+  void SearchCluster( std::vector<uint32_t>& RetinaCluster ) const;
 
 private:
   // Coordinate of the lower left SP
@@ -0,0 +1,120 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2018 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#ifndef VPRETINAPHISORT_H
+#define VPRETINAPHISORT_H 1
+
+#include "LHCbMath/SIMDWrapper.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/** @file VPRetinaPhiSort.h
+ *  Sorting in phi of the Retina clusters of a VP module, in the order of the VPRetinaCluster banks
+ */
+
+namespace VPRetina {
+
+  using simd = SIMDWrapper::best::types;
+
+  //=========================================================================
+  // Clusters of a module, with their global position
+  //=========================================================================
+  struct ModuleClusters {
+    std::vector<uint32_t> words;
+    std::vector<float>    gx;
+    std::vector<float>    gy;
+    // buffers for the sorting
+    std::vector<int>      keys;
+    std::vector<uint32_t> order;
+
+    void reserve( std::size_t n ) {
+      words.reserve( n );
+      gx.reserve( n + simd::size );
+      gy.reserve( n + simd::size );
+      keys.reserve( n + simd::size );
+      order.reserve( n );
+    }
+    void clear() {
+      words.clear();
+      gx.clear();
+      gy.clear();
+    }
+  };
+
+  // sorting in phi: odd modules start with negative y, even ones with positive y,
+  // then by increasing phi on each side
+  inline bool phiOrdered( float agx, float agy, float bgx, float bgy, bool odd ) {
+    return ( odd && ( agy < 0.f && bgy > 0.f ) ) || ( !odd && ( agy > 0.f && bgy < 0.f ) ) ||
+           ( ( agy * bgy ) > 0.f && ( agy * bgx < bgy * agx ) );
+  }
+
+  constexpr int nPhiBuckets = 128;
+
+  //=========================================================================
+  // Sort the clusters of a module in phi and append their words to sorted,
+  // in the same order as a std::stable_sort with phiOrdered.
+  // The clusters are first radix sorted on ( side, phi bucket ), the bucket
+  // coming from the "diamond angle" of the cluster, monotonic with phi.
+  // An insertion sort with the exact ordering then fixes the order within
+  // the buckets, and across their edges where rounding may have put near
+  // ties in the wrong bucket.
+  //=========================================================================
+  inline void sortInPhi( ModuleClusters& clusters, bool odd, std::vector<uint32_t>& sorted ) {
+    const std::size_t n = clusters.words.size();
+    if ( n == 0 ) return;
+
+    // keys computed by batches, on padded inputs
+    const std::size_t padded = ( n + simd::size - 1 ) / simd::size * simd::size;
+    clusters.gx.resize( padded, 0.f );
+    clusters.gy.resize( padded, 0.f );
+    clusters.keys.resize( padded );
+    const simd::float_v zero{0.f}, one{1.f}, scale{nPhiBuckets / 2.f}, maxBucket{nPhiBuckets - 1.f};
+    for ( std::size_t i = 0; i < padded; i += simd::size ) {
+      const simd::float_v gx{clusters.gx.data() + i};
+      const simd::float_v gy{clusters.gy.data() + i};
+      const auto          firstSide = odd ? gy < zero : gy > zero;
+      const simd::float_v t         = gx / max( abs( gx ) + abs( gy ), simd::float_v{1e-30f} );
+      // from -1 to 1 with increasing phi on both sides
+      const simd::float_v diamond = select( gy < zero, t, zero - t );
+      const simd::int_v   bucket  = min( max( ( diamond + one ) * scale, zero ), maxBucket );
+      ( bucket + select( firstSide, simd::int_v{0}, simd::int_v{nPhiBuckets} ) ).store( clusters.keys.data() + i );
+    }
+
+    // stable counting sort on the keys
+    std::array<uint32_t, 2 * nPhiBuckets + 1> offsets{};
+    for ( std::size_t i = 0; i < n; ++i ) ++offsets[clusters.keys[i] + 1];
+    for ( int k = 0; k < 2 * nPhiBuckets; ++k ) offsets[k + 1] += offsets[k];
+    clusters.order.resize( n );
+    for ( std::size_t i = 0; i < n; ++i ) clusters.order[offsets[clusters.keys[i]]++] = i;
+
+    // insertion sort, clusters moving only within their bucket or just across its edges.
+    // Equivalent clusters are kept in their original order, as the bucketing may have swapped them
+    const auto& gx     = clusters.gx;
+    const auto& gy     = clusters.gy;
+    auto&       order  = clusters.order;
+    const auto  before = [&gx, &gy, odd]( uint32_t a, uint32_t b ) {
+      return phiOrdered( gx[a], gy[a], gx[b], gy[b], odd ) ||
+             ( a < b && !phiOrdered( gx[b], gy[b], gx[a], gy[a], odd ) );
+    };
+    for ( std::size_t i = 1; i < n; ++i ) {
+      const uint32_t current = order[i];
+      std::size_t    j       = i;
+      for ( ; j > 0 && before( current, order[j - 1] ); --j ) order[j] = order[j - 1];
+      order[j] = current;
+    }
+
+    for ( const auto i : order ) sorted.push_back( clusters.words[i] );
+  }
+
+} // namespace VPRetina
+
+#endif // VPRETINAPHISORT_H
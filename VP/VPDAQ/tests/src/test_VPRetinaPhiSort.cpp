@@ -0,0 +1,134 @@
+/*****************************************************************************\
+* (c) Copyright 2000-2019 CERN for the benefit of the LHCb Collaboration      *
+*                                                                             *
+* This software is distributed under the terms of the GNU General Public      *
+* Licence version 3 (GPL Version 3), copied verbatim in the file "COPYING".   *
+*                                                                             *
+* In applying this licence, CERN does not waive the privileges and immunities *
+* granted to it by virtue of its status as an Intergovernmental Organization  *
+* or submit itself to any jurisdiction.                                       *
+\*****************************************************************************/
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE test_VPRetinaPhiSort
+#include <boost/test/unit_test.hpp>
+
+#include "VPRetinaPhiSort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+  struct Point {
+    float x, y;
+  };
+
+  /// points of a module, with their directions spread in phi
+  std::vector<Point> modulePoints( std::size_t n, std::mt19937& rng ) {
+    std::uniform_real_distribution<float> r( 5.f, 80.f ), phi( -M_PI, M_PI );
+    std::vector<Point>                    points;
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const float a = phi( rng ), b = r( rng );
+      points.push_back( {b * std::cos( a ), b * std::sin( a )} );
+    }
+    return points;
+  }
+
+  /** points around the directions of the edges of the phi buckets, a few ulps apart, with exact ties.
+   *  phiOrdered compares rounded products, so that it is only a strict weak ordering, and the order
+   *  of std::stable_sort well defined, if near ties differ by their x only, at the same y up to a power of 2 */
+  std::vector<Point> bucketEdges() {
+    std::vector<Point> points;
+    for ( int k = 0; k <= VPRetina::nPhiBuckets; ++k ) {
+      const float d = -1.f + 2.f * k / VPRetina::nPhiBuckets;
+      const float r = 1.f + ( k % 5 ) * 9.7f;
+      for ( const float side : {-1.f, 1.f} ) {
+        // diamond angle d, see VPRetina::sortInPhi
+        const float t = side < 0 ? d : -d;
+        const float y = side * ( 1.f - std::abs( t ) ) * r;
+        // the ordering is not defined on the x axis
+        if ( y == 0.f ) continue;
+        float x = t * r;
+        for ( int ulp = 0; ulp < 3; ++ulp ) x = std::nextafter( x, -100.f );
+        for ( int ulp = 0; ulp < 6; ++ulp, x = std::nextafter( x, 100.f ) ) {
+          // the same direction, exactly
+          points.push_back( {x, y} );
+          points.push_back( {2.f * x, 2.f * y} );
+          points.push_back( {0.5f * x, 0.5f * y} );
+        }
+      }
+    }
+    return points;
+  }
+
+  /// the indices of the points, sorted with VPRetina::sortInPhi after the given prefix
+  std::vector<uint32_t> sortInPhi( const std::vector<Point>& points, bool odd, std::vector<uint32_t> sorted = {} ) {
+    VPRetina::ModuleClusters clusters;
+    for ( std::size_t i = 0; i < points.size(); ++i ) {
+      clusters.words.push_back( i );
+      clusters.gx.push_back( points[i].x );
+      clusters.gy.push_back( points[i].y );
+    }
+    VPRetina::sortInPhi( clusters, odd, sorted );
+    return sorted;
+  }
+
+  /// compare VPRetina::sortInPhi with a std::stable_sort of phiOrdered
+  void check( const std::vector<Point>& points, bool odd ) {
+    const auto sorted = sortInPhi( points, odd, {42} );
+
+    std::vector<uint32_t> expected( points.size() );
+    std::iota( expected.begin(), expected.end(), 0 );
+    std::stable_sort( expected.begin(), expected.end(), [&]( uint32_t a, uint32_t b ) {
+      return VPRetina::phiOrdered( points[a].x, points[a].y, points[b].x, points[b].y, odd );
+    } );
+    expected.insert( expected.begin(), 42 );
+    BOOST_CHECK_EQUAL_COLLECTIONS( sorted.begin(), sorted.end(), expected.begin(), expected.end() );
+  }
+
+  /// check that no consecutive points are out of order after VPRetina::sortInPhi
+  void checkOrdered( const std::vector<Point>& points, bool odd ) {
+    const auto sorted = sortInPhi( points, odd );
+    BOOST_CHECK_EQUAL( sorted.size(), points.size() );
+    for ( std::size_t i = 1; i < sorted.size(); ++i ) {
+      const auto &a = points[sorted[i - 1]], &b = points[sorted[i]];
+      BOOST_CHECK( !VPRetina::phiOrdered( b.x, b.y, a.x, a.y, odd ) );
+    }
+  }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE( module_sample ) {
+  std::mt19937 rng( 42 );
+  for ( const std::size_t n : {1, 2, 3, 7, 17, 100, 1000, 5000} ) {
+    const auto points = modulePoints( n, rng );
+    check( points, false );
+    check( points, true );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( near_ties ) {
+  std::mt19937 rng( 7 );
+  auto         points = bucketEdges();
+  // in any order, and mixed with other clusters
+  std::shuffle( points.begin(), points.end(), rng );
+  check( points, false );
+  check( points, true );
+  const auto others = modulePoints( 2000, rng );
+  points.insert( points.end(), others.begin(), others.end() );
+  std::shuffle( points.begin(), points.end(), rng );
+  check( points, false );
+  check( points, true );
+
+  // near ties of different radii, for which the order of std::stable_sort depends on its implementation
+  std::vector<Point> radii;
+  for ( const auto& p : bucketEdges() ) {
+    for ( const float r : {1.f, 7.3f, 42.f} ) radii.push_back( {p.x * r, p.y * r} );
+  }
+  std::shuffle( radii.begin(), radii.end(), rng );
+  checkOrdered( radii, false );
+  checkOrdered( radii, true );
+}